@@ -8,6 +8,7 @@
 typedef struct {
     Member* member;
     Config* config;
+    int recruited;   // Joined while the game ran; starts fresh even in a restored gang
 } ThreadArgs;
 
 // External variables needed by the thread function
@@ -0,0 +1,80 @@
+#ifndef AGENT_MAILBOX_H
+#define AGENT_MAILBOX_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+/*
+ * Last-value mailboxes for the secret agents' knowledge reports.
+ *
+ * The police only care about the newest knowledge of each agent, so a report
+ * isn't queued: the agent overwrites its slot of the gang's row and the
+ * officer reads the slot when its sequence moved. Stale reports never pile
+ * up, and the queue is left to the messages that must not be lost
+ * (handshakes, deaths).
+ *
+ * A report over the knowledge threshold is urgent: it carries the time the
+ * agent raised it (raised_us), the agent rings the gang's priority lane, and
+ * the officer reads it as soon as it wakes instead of on its next rounds.
+ *
+ * sequence works as a sequence lock: it is odd while the slot is written and
+ * grows by two with every write. Each slot has a single writer at a time:
+ * the gang's main thread while it gives the slot to a new agent, the agent
+ * afterwards.
+ */
+
+#define AGENT_MAILBOX_FREE -1  // agent_id of a slot no agent holds
+
+typedef struct {
+    uint32_t sequence;
+    int32_t agent_id;
+    float knowledge;
+    int32_t game_time;   // elapsed_time of the report, -1 before the first
+    uint32_t raised_us;  // agent_mailbox_now_us() of an urgent report, 0 for a routine one
+} AgentMailbox;
+
+// A consistent copy of a slot
+typedef struct {
+    uint32_t sequence;
+    int32_t agent_id;
+    float knowledge;
+    int32_t game_time;
+    uint32_t raised_us;
+} AgentReport;
+
+// Free a slot; readers see its sequence move
+void agent_mailbox_clear(AgentMailbox *box);
+
+// Give a slot to an agent that hasn't reported yet
+void agent_mailbox_claim(AgentMailbox *box, int32_t agent_id);
+
+// The agent's report, replacing the one before; raised_us is 0 unless it is urgent
+void agent_mailbox_post(AgentMailbox *box, float knowledge, int32_t game_time, uint32_t raised_us);
+
+// Monotonic clock in microseconds, wrapping every 71 minutes and never 0, for
+// raised_us; an alert's age is the unsigned difference to it
+uint32_t agent_mailbox_now_us(void);
+
+/**
+ * Copy a slot out
+ *
+ * @return 0 on success, -1 if the writer stayed in the middle of a write
+ *         (it died there, or was parked)
+ */
+int agent_mailbox_read(const AgentMailbox *box, AgentReport *report);
+
+/**
+ * Slot of a row held by agent_id (AGENT_MAILBOX_FREE finds a free one)
+ *
+ * @return Its index, -1 if none
+ */
+int agent_mailbox_find(const AgentMailbox *row, int num_slots, int32_t agent_id);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // AGENT_MAILBOX_H
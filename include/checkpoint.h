@@ -0,0 +1,163 @@
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <pthread.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "message.h"
+#include "random_stream.h"
+
+/*
+ * Full-state checkpoints.
+ *
+ * main asks every simulation thread to park at its next plan boundary (a
+ * gang's main thread also parks while it waits for the members to prepare,
+ * and they park mid-preparation; a restored gang starts that plan over).
+ * Parked threads save their random stream into shared memory (police first
+ * copies its private state there too), so once all of them are parked the
+ * segment, the gangs' member segments and the messages pending on the gangs'
+ * queues are the whole game. That is written to one file:
+ *
+ *   header    magic, version, struct sizes, section offsets
+ *   shm       the shared memory segment, page aligned so it can be mapped
+ *   segments  a table of (offset, size), one per gang slot, then each
+ *             member segment page aligned; empty slots have size 0
+ *   messages  pending messages, each tagged with the gang slot whose queue
+ *             it was on, in queue order
+ *
+ * A restored run copies the segments back, re-sends the messages onto the
+ * new queues of their slots and starts the processes with `restored` set, so
+ * they load their state instead of generating it.
+ */
+
+#define CHECKPOINT_MAGIC 0x504B434Fu  // "OCKP"
+#define CHECKPOINT_VERSION 3
+#define CHECKPOINT_ALIGN 4096
+
+typedef struct {
+    pthread_mutex_t mutex;       // process-shared
+    pthread_cond_t cond;         // process-shared
+    int requested;               // main wants the threads to park
+    int registered;              // threads that take part
+    int parked;                  // threads currently parked
+    uint32_t resume_generation;  // bumped by main to let the parked threads go
+    int restored;                // this run was restored from a checkpoint
+    int64_t saved_wall_time;     // time() when that checkpoint was taken
+} CheckpointControl;
+
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t game_size;          // sizeof(Game), sizeof(Gang), sizeof(Member) of
+    uint32_t gang_size;          // the writer; a build with a different layout
+    uint32_t member_size;        // can't restore the file
+    uint32_t message_count;
+    uint32_t segment_count;
+    uint32_t reserved;
+    uint64_t shm_offset;
+    uint64_t shm_size;
+    uint64_t segments_offset;    // CheckpointBlock[segment_count]
+    uint64_t messages_offset;
+    uint64_t file_size;
+    int64_t wall_time;           // time() when the checkpoint was taken
+} CheckpointHeader;
+
+// Where a segment is in the file
+typedef struct {
+    uint64_t offset;
+    uint64_t size;
+} CheckpointBlock;
+
+// A pending message and the queue (gang slot) it was on
+typedef struct {
+    uint32_t queue;
+    uint32_t reserved;
+    Message message;
+} CheckpointMessage;
+
+// A segment to save next to the shared memory segment (size 0 for none)
+typedef struct {
+    const void *data;
+    size_t size;
+} CheckpointSegment;
+
+// A checkpoint file mapped read-only
+typedef struct {
+    void *map;
+    size_t map_size;
+    const CheckpointHeader *header;
+    const void *shm;
+    const CheckpointBlock *segments;
+    const CheckpointMessage *messages;
+} CheckpointImage;
+
+// Owner only: set up the control block (restored runs pass the checkpoint time)
+int checkpoint_control_init(CheckpointControl *control, int restored, int64_t saved_wall_time);
+
+// Add `threads` threads that will park when asked
+void checkpoint_register(CheckpointControl *control, int threads);
+
+// Take out threads that are gone for good (a retired gang's); a checkpoint
+// waiting for them goes ahead without them
+void checkpoint_unregister(CheckpointControl *control, int threads);
+
+static inline int checkpoint_requested(const CheckpointControl *control) {
+    return __atomic_load_n(&control->requested, __ATOMIC_ACQUIRE);
+}
+
+// Save the calling thread's random stream into rng (unless NULL) and block
+// until main resumes the game
+void checkpoint_park(CheckpointControl *control, RandomStream *rng);
+
+// Main: ask every registered thread to park at its next park point; threads
+// that sleep on something else than the control have to be woken by main
+void checkpoint_request(CheckpointControl *control);
+
+/**
+ * Main: ask every registered thread to park (if checkpoint_request hasn't
+ * yet) and wait for them
+ *
+ * @return 0 once all are parked, -1 on timeout (the threads stay requested
+ *         until checkpoint_resume)
+ */
+int checkpoint_quiesce(CheckpointControl *control, int timeout_ms);
+
+// Main: release the parked threads
+void checkpoint_resume(CheckpointControl *control);
+
+/**
+ * Main, with every thread parked: write the segment, the member segments and
+ * the pending messages of the queues in msgq_ids (-1 for none) to path. The
+ * messages are put back on their queues.
+ *
+ * @return Bytes written, or -1 on error
+ */
+long checkpoint_write(const char *path, const void *shm, size_t shm_size,
+                      const CheckpointSegment *segments, uint32_t segment_count,
+                      size_t game_size, size_t gang_size, size_t member_size,
+                      const int *msgq_ids, uint32_t queue_count);
+
+/**
+ * Map and validate a checkpoint file
+ *
+ * @return 0 on success, -1 on error
+ */
+int checkpoint_open(CheckpointImage *image, const char *path, size_t game_size, size_t gang_size, size_t member_size);
+void checkpoint_close(CheckpointImage *image);
+
+// Data of segment i of an open checkpoint; NULL (size 0) when it was empty
+const void *checkpoint_segment(const CheckpointImage *image, uint32_t i, size_t *size);
+
+// Put a checkpoint's pending messages back on fresh queues, msgq_ids[q] for
+// the ones saved from queue q; messages of a queue with no ID are dropped
+int checkpoint_requeue(const CheckpointImage *image, const int *msgq_ids, uint32_t queue_count);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // CHECKPOINT_H
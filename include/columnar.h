@@ -0,0 +1,114 @@
+#ifndef COLUMNAR_H
+#define COLUMNAR_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdio.h>
+
+/*
+ * Append-only columnar table file.
+ *
+ *   header   magic, version, num_columns, ColumnDesc[num_columns]
+ *   chunk*   magic, rows, then for each column rows x 4-byte values
+ *
+ * Rows are buffered and written a chunk at a time. A chunk that was cut short
+ * (crash, kill) is dropped when the file is reopened for appending, so a
+ * writer can always resume after the last complete chunk.
+ */
+
+#define COLUMNAR_MAGIC 0x4C4F434Fu        // "OCOL"
+#define COLUMNAR_CHUNK_MAGIC 0x4B4E4843u  // "CHNK"
+#define COLUMNAR_VERSION 1
+#define COLUMN_NAME_LEN 32
+
+typedef enum {
+    COLUMN_INT32,
+    COLUMN_UINT32,
+    COLUMN_FLOAT32
+} ColumnType;
+
+typedef struct {
+    char name[COLUMN_NAME_LEN];
+    uint32_t type;
+} ColumnDesc;
+
+typedef union {
+    int32_t i;
+    uint32_t u;
+    float f;
+} ColumnValue;
+
+typedef struct {
+    FILE *file;
+    int num_columns;
+    ColumnDesc *columns;
+    int chunk_rows;       // Rows buffered before a chunk is written
+    int rows;             // Rows currently buffered
+    ColumnValue *buffer;  // Column-major, chunk_rows values per column
+} ColumnarWriter;
+
+typedef struct {
+    FILE *file;
+    int num_columns;
+    ColumnDesc *columns;
+    int rows;             // Rows in the current chunk
+    int capacity;
+    ColumnValue *data;    // Column-major, capacity values per column
+} ColumnarReader;
+
+/**
+ * Open a table for writing. An existing file with the same columns is
+ * appended to (after dropping any partial chunk); a missing file is created.
+ *
+ * @return 0 on success, -1 on error or if the existing columns differ
+ */
+int columnar_open(ColumnarWriter *writer, const char *path, const ColumnDesc *columns, int num_columns, int chunk_rows);
+
+/**
+ * Buffer one row (num_columns values); writes a chunk when the buffer is full
+ */
+int columnar_append(ColumnarWriter *writer, const ColumnValue *row);
+
+/**
+ * Write the buffered rows as a chunk and flush the file
+ */
+int columnar_flush(ColumnarWriter *writer);
+
+/**
+ * Flush and close
+ */
+int columnar_close(ColumnarWriter *writer);
+
+/**
+ * Open a table for reading
+ *
+ * @return 0 on success, -1 on error
+ */
+int columnar_reader_open(ColumnarReader *reader, const char *path);
+
+/**
+ * Load the next chunk
+ *
+ * @return Number of rows in the chunk, 0 at the end (or at a partial chunk)
+ */
+int columnar_reader_next(ColumnarReader *reader);
+
+void columnar_reader_close(ColumnarReader *reader);
+
+/**
+ * Index of a column by name, or -1
+ */
+int columnar_find_column(const ColumnDesc *columns, int num_columns, const char *name);
+
+static inline ColumnValue *columnar_column(const ColumnarReader *reader, int column) {
+    return reader->data + (size_t)column * reader->capacity;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // COLUMNAR_H
@@ -4,6 +4,7 @@
 extern "C" {
 #endif
 
+#include <stdint.h>
 
 typedef struct {
     int max_thwarted_plans;
@@ -31,13 +32,86 @@ typedef struct {
     int num_gangs;
     int min_prison_period;
     int max_prison_period;
+    unsigned int random_seed;   // Master seed for all RNG streams (0 = pick one at startup)
+    int num_targets;            // Set at startup from the target catalog
+    int num_attributes;
+    int viewer_snapshot_hz;     // How often the viewer copies shared memory (optional, 0 = default of 10)
+    int shm_huge_pages;         // SHM_PAGES_*: what backs the shared memory (optional, default 0)
+    int shm_prefault;           // Fault the segments in when they're mapped (optional, default 1)
+    int shm_lock;               // mlock the segments in every process (optional, default 0)
+    int gang_size_limit;        // Members a gang may grow to (optional, 0 = max_gang_size; resolved at startup)
+    int active_gangs;           // Gangs to keep running, spawning or retiring to match (optional, 0 = as started)
+    int recruits_per_success;   // Members a gang recruits after a successful plan (optional, default 0)
+    int police_departments;     // Police processes started (optional, 0 = 1; resolved at startup)
+    int active_departments;     // Departments sharing out the gangs (optional, 0 = all of them)
+    int gang_queue_bytes;       // Bytes each gang's message queue holds (optional, 0 = system default)
 } Config;
 
+// Pages behind the game segment. Each mode falls back to the one before it
+// when the system can't provide it.
+enum {
+    SHM_PAGES_DEFAULT,          // Plain shm_open, 4 KB pages
+    SHM_PAGES_TRANSPARENT,      // shm_open with MADV_HUGEPAGE advice
+    SHM_PAGES_HUGETLB           // memfd from the hugetlb pool
+};
+
+#define CONFIG_BLOCK_MAGIC   0x4F434643u  // "OCFC"
+#define CONFIG_BLOCK_VERSION 1
+
+// Config as published by main in the shared memory header. Children copy it
+// out instead of parsing argv. generation works as a sequence lock: it is odd
+// while main is writing and grows by two with every publish, so a process can
+// tell that the config changed by comparing it with the value it last read.
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t size;          // sizeof(Config) of the writer
+    uint32_t checksum;      // FNV-1a over config
+    uint32_t generation;
+    Config config;
+} ConfigBlock;
+
 int load_config(const char *filename, Config *config);
 void print_config(Config *config);
 int check_parameter_correctness(const Config *config);
 void serialize_config(Config *config, char *buffer);
 void deserialize_config(const char *buffer, Config *config);
+uint32_t config_checksum(const Config *config);
+
+/**
+ * Publish a config into a shared block and bump its generation
+ */
+void config_block_publish(ConfigBlock *block, const Config *config);
+
+/**
+ * Copy a consistent snapshot of a shared config block
+ *
+ * @param generation If not NULL, receives the generation of the snapshot
+ * @return 0 on success, -1 if the block is missing, from another version or corrupt
+ */
+int config_block_read(const ConfigBlock *block, Config *config, uint32_t *generation);
+
+/**
+ * Current generation of a shared config block (cheap change check)
+ */
+uint32_t config_block_generation(const ConfigBlock *block);
+
+/**
+ * Copy the parameters that may change while the simulation is running.
+ * Anything that shapes shared memory, the message types or the RNG streams
+ * (gang slots and sizes, agents per gang, ranks, seed, catalog shape) stays;
+ * how many gangs run (active_gangs) and how they recruit may change, and
+ * so may how many police departments share the gangs (active_departments).
+ */
+void config_apply_reloadable(Config *dst, const Config *src);
+
+/**
+ * Pick up a newer published config at a safe point
+ *
+ * @param generation Generation the caller last saw; updated on reload
+ * @return 1 if config was updated, 0 otherwise
+ */
+int config_refresh(const ConfigBlock *block, Config *config, uint32_t *generation);
 
 #ifdef __cplusplus
 }
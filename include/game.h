@@ -5,33 +5,80 @@
 #include "config.h"
 #include "gang.h"
 #include "police.h"
+#include "target_catalog.h"
+#include "startup.h"
+#include "checkpoint.h"
+#include "shm_arena.h"
+#include "gang_directory.h"
+#include "notify.h"
+#include "routing.h"
 
 
 typedef struct Game {
 
+    // Run configuration published by main; children read theirs from here
+    ConfigBlock config_block;
+
     int num_thwarted_plans;
     int num_successfull_plans;
     int num_executed_agents;
     int elapsed_time;
 
-    // Target definitions
-    PoliceForce police_force;
-    Target targets[NUM_TARGETS];
+    // Sizes of the police tables (SHM_REGION_POLICE), set by the police
+    PoliceSummary police;
+
+    // Children wait here until all of them are up, then the clock starts
+    StartupBarrier startup;
+
+    // Threads park here at a plan boundary while main takes a checkpoint
+    CheckpointControl checkpoint;
+
+    // Next sequence number of the event journal (--journal)
+    uint64_t journal_seq;
+
+    // What observers sleep on instead of polling (notify.h)
+    NotifyBoard notify;
+
+    // Message types of the queues' endpoints, laid out by main (routing.h)
+    RoutingTable routing;
 
 } Game;
 
 
 // To this:
 typedef struct ShmPtrs {
+    ShmArena *arena;            // Start of the mapping; offsets in the segment are from here
+    size_t size;                // Bytes of the arena
+    size_t mapped_size;         // Bytes mapped, size rounded up to the backing's page size
     Game *shared_game;
-    Gang *gangs;
-    Member **gang_members;
+    Gang *gangs;                // One per directory slot
+    TargetCatalog *catalog;
+    GangDirectory *directory;
+    GangMapping *mappings;      // Per slot, private to this process
+    PoliceTables police;        // Officers, agents and arrests, one officer per slot
+    uint32_t directory_generation; // Generation of the directory the mappings follow
+    uint32_t config_generation; // Generation of the config this process last read
 } ShmPtrs;
 
+// A gang's members, wherever this process mapped its segment
+static inline Member *shm_members(const ShmPtrs *shm, int gang) {
+    return shm->mappings[gang].members;
+}
+
+// Members of a gang this process can read: a gang that just grew may count
+// members beyond what this process has seen of its segment so far
+static inline int shm_member_count(const ShmPtrs *shm, int gang) {
+    int count = __atomic_load_n(&shm->gangs[gang].max_member_count, __ATOMIC_ACQUIRE);
+    int capacity = shm->mappings[gang].members != NULL ? (int)shm->mappings[gang].capacity : 0;
+    if (count < 0) count = 0;
+    return count < capacity ? count : capacity;
+}
+
 
 // Still can keep these (but optional now)
-pid_t start_process(const char *binary, Config *cfg, int id);
-int game_init(Game *game, pid_t *processes, Config *cfg);
+pid_t start_process(const char *binary, int id);
+pid_t start_process_argv(char *const argv[]);
+int game_init(const ShmPtrs *shm, pid_t *processes, Config *cfg, int headless);
 void game_destroy(int shm_fd, Game *shared_game);
 void game_create(int *shm_fd, Game *shared_game);
 int check_game_conditions(const Game *game, const Config *cfg);
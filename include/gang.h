@@ -8,6 +8,9 @@
 #include <stdbool.h>
 #include <pthread.h>
 #include <stdint.h>
+#include "notify.h"
+#include "startup.h"
+#include "random_stream.h"
 
 // Information spreading system
 typedef enum {
@@ -49,6 +52,9 @@ typedef enum {
     NUM_ATTRIBUTES
 } AttributeType;
 
+// Built-in attributes come first; config.json may define more, up to this limit
+#define MAX_ATTRIBUTES 16
+
 typedef struct {
     int member_id;  // Unique ID for each member
     bool is_alive;  // Whether the member is alive or not
@@ -56,12 +62,12 @@ typedef struct {
     int rank;       // Rank of the member in the gang
     int XP;        // Experience points of the member
     int prep_contribution;
-    int8_t agent_id; // ID of the agent (if any)
+    int32_t agent_id; // ID of the agent (if any)
     float knowledge; // Knowledge level of the member (0.0 to 1.0)
     float suspicion; // Suspicion level of the agent
     float faithfulness; // Faithfulness level of the agent
     pthread_t thread; // Thread for the member
-    float attributes[NUM_ATTRIBUTES];
+    float attributes[MAX_ATTRIBUTES];
     float discretion;       // Ability to hide suspicion when asking questions
     float shrewdness;       // Ability to extract information
     int askers[MAX_ASKERS];
@@ -72,6 +78,9 @@ typedef struct {
     InformationPacket received_info[5]; // Last 5 pieces of information received
     int info_count;                     // Number of information packets received
     float misinformation_level;         // How much false info this member has (0.0 to 1.0)
+
+    bool preparing;                     // Inside the preparation loop (carried across a checkpoint)
+    RandomStream rng;                   // Thread's stream, saved when parked for a checkpoint
 } Member;
 
 // Function to calculate XP from rank (XP = rank^2)
@@ -90,10 +99,9 @@ static inline void update_member_xp(Member *member) {
 typedef struct {
     int gang_id;
     pid_t pid;
-    int target_type;
+    int target_type; // Index into the target catalog
     int prep_time;
     int prep_level;
-    // Note: members pointer is NOT stored in shared memory - it's calculated locally in each process
     int num_alive_members; // Number of alive members in the gang
     int max_member_count; // max number of members
     int num_successful_plans; // Number of successful plans
@@ -101,7 +109,6 @@ typedef struct {
     int num_executed_agents; // Number of executed agents
     int num_agents; // Number of agents in the gang
     float notoriety; // Notoriety level of the gang
-    float heat[NUM_TARGETS]; // Heat level for each target
     
     // Information spreading system
     int last_info_spread_time;           // Last time information was spread
@@ -116,8 +123,43 @@ typedef struct {
     int plan_success;                    // Whether the plan succeeded (0=not determined, 1=success, -1=failure)
     int plan_in_progress;                // Whether a plan is currently in progress
     float current_success_rate;          // Current plan's calculated success rate (0-100%)
+
+    StartupTimes startup;                // Per-phase startup latency of the gang process
+
+    int leader_id;                       // Highest-ranked member at startup; selects the target
+    int parking;                         // Main thread is parked for a checkpoint; members follow
+    RandomStream rng;                    // Main thread's stream, saved when parked for a checkpoint
+    uint32_t version;                    // Bumped after every change the viewer shows
+    int checkpoint_threads;              // Threads the gang registered for checkpoints
+    int retiring;                        // Set by main: leave at the next plan boundary
+    int restored;                        // Set by main: resume from a checkpoint instead of starting fresh
+
+    // The gang's own queue for its police and agent traffic; main creates it
+    // with the gang and removes it when the gang is retired
+    int msgq_id;
+    uint32_t queue_depth;                // Messages waiting on it, sampled by main
+    uint32_t queue_bytes;                // Bytes waiting on it
+    uint32_t queue_peak;                 // Most messages seen waiting at once
+    uint32_t alerts;                     // Priority lane: bumped after a death notice, a handshake
+                                         // reply or an urgent agent report, woken on by the officer
 } Gang;
 
+// Tell readers of the segment (the viewer, an officer waiting on the gang)
+// that the gang or its members changed
+static inline void gang_touch(Gang *gang) {
+    notify_bump(&gang->version);
+    notify_changed();
+}
+
+// Wake the gang's officer for something it must see before its next rounds
+static inline void gang_alert(Gang *gang) {
+    notify_bump(&gang->alerts);
+}
+
+static inline uint32_t gang_version(const Gang *gang) {
+    return notify_generation(&gang->version);
+}
+
 // Target struct
 typedef struct {
     TargetType type;
@@ -0,0 +1,140 @@
+#ifndef GANG_DIRECTORY_H
+#define GANG_DIRECTORY_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+#include "gang.h"
+
+/*
+ * Directory of the gang slots and their member segments.
+ *
+ * Each gang keeps its members in a shm object of its own, so gangs can be
+ * spawned, grown and retired while the game runs without touching the main
+ * segment. The directory lives in the main arena and has one slot per gang
+ * the config allows (max_gangs); a slot names its segment by slot number and
+ * incarnation, which goes up every time the slot is spawned, so a process
+ * still holding a retired gang's mapping never mistakes it for the new one.
+ *
+ * Every process maps a segment at the slot's limit with MAP_NORESERVE and
+ * the object grows underneath with ftruncate, so growing never moves the
+ * members in any process. Growth is published in order: the object is
+ * resized, then the slot capacity, then the directory generation, so a
+ * reader that sees a capacity can always touch that many members.
+ *
+ * Every change to a slot bumps the directory generation. Processes that
+ * attach late or keep mappings of every gang compare it with the last one
+ * they saw at their safe points and remap what changed.
+ */
+
+#define GANG_SEGMENT_PREFIX "/game_gang"
+
+enum {
+    GANG_SLOT_FREE,      // Never used
+    GANG_SLOT_ACTIVE,    // A gang process runs on the slot's segment
+    GANG_SLOT_RETIRED    // Its gang was stopped and the segment removed
+};
+
+typedef struct {
+    uint32_t state;        // GANG_SLOT_*
+    uint32_t incarnation;  // Bumped on every spawn; part of the segment name
+    uint32_t capacity;     // Members the segment holds now
+    uint32_t limit;        // Members it may grow to; every process maps this many
+} GangSlot;
+
+typedef struct {
+    uint32_t generation;   // Bumped after every change to a slot
+    uint32_t num_slots;
+    uint32_t num_active;
+    uint32_t reserved;
+    GangSlot slots[];
+} GangDirectory;
+
+// Where a process mapped a slot's members; each process keeps its own table
+typedef struct {
+    Member *members;       // NULL while the slot isn't mapped
+    uint32_t incarnation;  // Incarnation of the slot that is mapped
+    uint32_t capacity;     // Members of that incarnation known to exist
+    uint32_t settled;      // Members whose pages the process has set up (shm_settle_gang)
+} GangMapping;
+
+/**
+ * Bytes a directory of num_slots slots takes
+ */
+size_t gang_directory_size(int num_slots);
+
+/**
+ * Lay out an empty directory: every slot free and limited to limit members
+ */
+void gang_directory_init(GangDirectory *directory, int num_slots, int limit);
+
+static inline uint32_t gang_directory_generation(const GangDirectory *directory) {
+    return __atomic_load_n(&directory->generation, __ATOMIC_ACQUIRE);
+}
+
+static inline int gang_slot_active(const GangDirectory *directory, int slot) {
+    return slot >= 0 && (uint32_t)slot < directory->num_slots &&
+           __atomic_load_n(&directory->slots[slot].state, __ATOMIC_ACQUIRE) == GANG_SLOT_ACTIVE;
+}
+
+/**
+ * Name of the shm object of a slot's incarnation, for this instance
+ */
+const char *gang_segment_name(int slot, uint32_t incarnation, char *buf, size_t len);
+
+/**
+ * Main: create the segment of a new incarnation of a free or retired slot,
+ * sized for capacity members, and mark the slot active
+ *
+ * @param incarnation Incarnation to create; 0 takes the next one
+ * @return 0 on success, -1 on error
+ */
+int gang_segment_create(GangDirectory *directory, int slot, int capacity, uint32_t incarnation);
+
+/**
+ * Grow an active slot's segment to hold at least capacity members. Called
+ * by the gang that owns it.
+ *
+ * @return The new capacity (at most the slot's limit), or -1 on error
+ */
+int gang_segment_grow(GangDirectory *directory, int slot, int capacity);
+
+/**
+ * Main: mark an active slot retired and remove its segment. Mappings other
+ * processes hold stay valid until they let go of them.
+ */
+void gang_segment_retire(GangDirectory *directory, int slot);
+
+/**
+ * Map a slot's segment at its limit
+ *
+ * @param incarnation Receives the incarnation mapped
+ * @param capacity    Receives the capacity at the time it was mapped
+ * @return The members, or NULL if the slot isn't active or can't be mapped
+ */
+Member *gang_segment_map(const GangDirectory *directory, int slot, uint32_t *incarnation, uint32_t *capacity);
+
+void gang_segment_unmap(const GangDirectory *directory, int slot, Member *members);
+
+/**
+ * Bring a table of mappings (one per slot, zeroed at first) up to date with
+ * the directory: map slots that became active or were spawned again, drop
+ * the ones that were retired and take in growth. Call it at a point where
+ * no other thread of the process reads the mappings.
+ *
+ * @param generation Directory generation the table follows; updated
+ * @return 1 if the directory changed since the last call, 0 otherwise
+ */
+int gang_mappings_refresh(const GangDirectory *directory, GangMapping *mappings, uint32_t *generation);
+
+// Unmap every slot of a table
+void gang_mappings_release(const GangDirectory *directory, GangMapping *mappings);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // GANG_DIRECTORY_H
@@ -0,0 +1,31 @@
+#ifndef INSTANCE_H
+#define INSTANCE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+#include <sys/types.h>
+
+// Several simulations can run side by side (e.g. under ocf-sweep). Each one
+// is started with a distinct OCF_INSTANCE, which child processes inherit, and
+// every named IPC object is suffixed with it. Unset or 0 keeps the plain names.
+#define INSTANCE_ENV "OCF_INSTANCE"
+#define MAX_INSTANCE 32767
+#define IPC_NAME_LEN 64
+
+// Instance number of this process (0 when unset)
+int instance_id(void);
+
+// Name of a named IPC object (shm, semaphore) for this instance
+const char *instance_ipc_name(const char *base, char *buf, size_t len);
+
+// SysV IPC key for this instance
+key_t instance_ipc_key(key_t base);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // INSTANCE_H
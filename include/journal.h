@@ -0,0 +1,204 @@
+#ifndef JOURNAL_H
+#define JOURNAL_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+#include "config.h"
+#include "gang.h"
+#include "message.h"
+#include "random_stream.h"
+
+/*
+ * Deterministic event journal.
+ *
+ * Every process appends the nondeterministic inputs it sees to one shared
+ * file: the run's seed, config and catalog, config reloads, clock ticks,
+ * message arrivals, arrests and releases, and at each plan boundary the
+ * gang's RNG stream together with the state the member threads left behind
+ * (which members got ready and with what contribution is the outcome of the
+ * thread interleaving). ocf-replay re-executes the plan boundaries from the
+ * journal in one process and checks the results against the hashes the
+ * original run recorded.
+ *
+ *   header   JournalFileHeader
+ *   record*  JournalRecord, body (padded to 8 bytes)
+ *
+ * Records carry a run-wide sequence number taken from a counter in shared
+ * memory. Each record is written with one writev on an O_APPEND descriptor,
+ * so records from different processes never interleave, but they can land in
+ * the file out of sequence order; the reader sorts them.
+ */
+
+#define JOURNAL_MAGIC   0x524A434Fu  // "OCJR"
+#define JOURNAL_VERSION 1
+#define JOURNAL_ENV     "OCF_JOURNAL"  // Journal path handed to the children
+
+// Record sources besides gang IDs
+#define JOURNAL_SOURCE_POLICE -1
+#define JOURNAL_SOURCE_MAIN   -2
+
+typedef enum {
+    JOURNAL_RUN = 1,      // JournalRun + target catalog
+    JOURNAL_CONFIG,       // JournalConfig, a reload published by main
+    JOURNAL_TICK,         // JournalTick, one per game second
+    JOURNAL_MESSAGE,      // JournalMessage, a message taken off the queue
+    JOURNAL_PLAN,         // JournalPlan + Member[max_member_count]
+    JOURNAL_PLAN_OUTCOME, // JournalPlanOutcome, written where the counters change
+    JOURNAL_PLAN_CHECK,   // JournalPlanCheck, gang state after the boundary
+    JOURNAL_ARREST,       // JournalArrest
+    JOURNAL_RELEASE,      // JournalRelease
+    JOURNAL_END           // JournalTick with the final counters
+} JournalType;
+
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t config_size;   // Layout of the writer; replay needs the same build
+    uint32_t gang_size;
+    uint32_t member_size;
+    uint32_t message_size;
+} JournalFileHeader;
+
+typedef struct {
+    uint32_t size;          // Whole record including this header and padding
+    uint16_t type;          // JournalType
+    int16_t source;         // Gang ID or JOURNAL_SOURCE_*
+    uint64_t seq;
+    int32_t tick;           // Game time when the record was written
+    uint32_t reserved;
+} JournalRecord;
+
+typedef struct {
+    uint32_t random_seed;
+    uint32_t config_generation;
+    int32_t num_successful_plans;  // Non-zero for a restored game
+    int32_t num_thwarted_plans;
+    int32_t num_executed_agents;
+    int32_t elapsed_time;
+    Config config;
+} JournalRun;
+
+typedef struct {
+    uint32_t generation;
+    Config config;
+} JournalConfig;
+
+typedef struct {
+    uint64_t monotonic_ns;
+    int32_t num_successful_plans;
+    int32_t num_thwarted_plans;
+    int32_t num_executed_agents;   // Not covered by the hash (updated without a lock)
+    uint32_t reserved;
+    uint64_t hash;                 // journal_hash_counters
+} JournalTick;
+
+typedef struct {
+    uint32_t arrival;       // Per-process arrival number
+    uint32_t reserved;
+    Message message;
+} JournalMessage;
+
+typedef struct {
+    int32_t plan;           // Per-gang plan number
+    uint32_t config_generation;
+    RandomStream rng;       // Gang main thread's stream before the outcome draw
+    Gang gang;
+} JournalPlan;
+
+typedef struct {
+    int32_t plan;
+    int32_t success;
+    float success_rate;
+    uint32_t reserved;
+} JournalPlanOutcome;
+
+typedef struct {
+    int32_t plan;
+    int32_t executed_agents;
+    uint64_t hash;          // journal_hash_gang after the outcome and investigation
+} JournalPlanCheck;
+
+typedef struct {
+    int32_t gang_id;
+    int32_t period;
+} JournalArrest;
+
+typedef struct {
+    int32_t gang_id;
+    int32_t reserved;
+} JournalRelease;
+
+/**
+ * Create (or truncate) the journal and export its path to child processes
+ *
+ * @param seq Run-wide sequence counter, in shared memory
+ * @param clock Game clock stamped into every record
+ * @return 0 on success, -1 on error
+ */
+int journal_create(const char *path, uint64_t *seq, const int *clock);
+
+/**
+ * Open the journal named by JOURNAL_ENV for appending, if there is one
+ *
+ * @return 0 on success or when journaling is off, -1 on error
+ */
+int journal_attach(uint64_t *seq, const int *clock);
+
+int journal_enabled(void);
+void journal_close(void);
+
+/**
+ * Append one record; extra follows body (either may be empty)
+ *
+ * @return 0 on success (or journaling off), -1 on error
+ */
+int journal_append(int type, int source, const void *body, size_t body_size,
+                   const void *extra, size_t extra_size);
+
+/**
+ * Append a JOURNAL_MESSAGE record for a message taken off the queue
+ */
+void journal_message(int source, const Message *message);
+
+// FNV-1a over the bytes, continuing from hash
+uint64_t journal_hash(uint64_t hash, const void *data, size_t size);
+#define JOURNAL_HASH_INIT 0xcbf29ce484222325ull
+
+// Fields a plan boundary decides: outcome, counters, survivors and suspicion
+uint64_t journal_hash_gang(const Gang *gang, const Member *members);
+uint64_t journal_hash_counters(int tick, int successful, int thwarted);
+
+typedef struct {
+    void *data;
+    size_t size;
+    JournalFileHeader *header;
+    JournalRecord **records;   // Sorted by sequence number
+    size_t count;
+    size_t dropped_bytes;      // Cut-off record at the end of the file
+} JournalReader;
+
+/**
+ * Load a journal and sort its records
+ *
+ * @return 0 on success, -1 on error or a foreign layout
+ */
+int journal_read(JournalReader *reader, const char *path);
+void journal_reader_close(JournalReader *reader);
+
+static inline const void *journal_body(const JournalRecord *record) {
+    return record + 1;
+}
+
+static inline size_t journal_body_size(const JournalRecord *record) {
+    return record->size - sizeof(JournalRecord);
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // JOURNAL_H
@@ -8,10 +8,12 @@ extern "C" {
 #endif
 
 #include "gang.h"
+#include "target_catalog.h"
 
 TargetType get_target_type_from_name(const char* name);
 AttributeType get_attribute_type_from_name(const char* name);
 int load_targets_from_json(const char* filename, Target targets[]);
+TargetCatalog *load_target_catalog_from_json(const char* filename, int num_gangs);
 bool validate_target_weights(const Target* target);
 void print_target(const Target* target);
 
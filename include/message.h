@@ -1,19 +1,17 @@
 #ifndef POLICE_REPORT
 #define POLICE_REPORT
 
-#include <stdint.h>  // For uint8_t type
+#include <stdint.h>  // For uint8_t and int32_t types
 #include <time.h>    // For time_t type
 
-// define message queue keys
-#define POLICE_GANG_KEY 0x1234
 #define MESSAGE_SIZE sizeof(Message) - sizeof(long)
 
 // Message modes for police-gang communication
 typedef enum {
     MSG_HANDSHAKE = 0,      // Police handshaking process for planting agent
     MSG_AGENT_DEATH = 1,    // Secret agent death notification
-    MSG_POLICE_REQUEST = 2, // Police request for information from agent
-    MSG_POLICE_REPORT = 3   // Agent report with knowledge level
+    MSG_POLICE_REQUEST = 2, // Unused: agents report through their mailboxes (agent_mailbox.h)
+    MSG_POLICE_REPORT = 3   // Unused, as above; kept so journals decode the same
 } MessageMode;
 
 typedef struct {
@@ -36,12 +34,21 @@ typedef struct {
 
 // Function declarations
 int create_message_queue(int key);
+
+/**
+ * Create a queue no key names (a gang's): whoever uses it is given its ID.
+ * max_bytes caps what it holds, 0 for the system default (msgmnb); a cap
+ * above what the system allows without privileges falls back to the default.
+ *
+ * @return Queue ID, or -1 on error
+ */
+int create_private_queue(int max_bytes);
+
+// Messages and bytes waiting on a queue; -1 if it is gone
+int message_queue_depth(int msgid, uint32_t *messages, uint32_t *bytes);
 int send_message(int msgid, Message *message);
 int receive_message(int msgid, Message *message, long mtype);
 int receive_message_nonblocking(int msgid, Message *message, long mtype);
 int delete_message_queue(int msgid);
-long get_agent_msgtype(int MAX_AGENTS, int8_t gang_id, int8_t agent_id);
-long get_gang_msgtype(int MAX_AGENTS, int8_t gang_id);
-long get_police_msgtype(int MAX_AGENTS, int NUM_GANGS, int8_t police_id);
 
 #endif // POLICE_REPORT
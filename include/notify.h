@@ -0,0 +1,97 @@
+#ifndef NOTIFY_H
+#define NOTIFY_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+/*
+ * Change notification through shared memory.
+ *
+ * A generation is a 32-bit counter writers bump after a change. Observers
+ * remember the value they last saw and sleep on a futex until it moves,
+ * instead of polling the data at a fixed rate. Counters that are slept on
+ * go up in steps of NOTIFY_STEP: a sleeper sets the low bit, so a bump only
+ * makes the wake-up syscall when somebody actually sleeps on the word.
+ *
+ * Besides its own counter (a gang's version, the directory generation)
+ * every writer bumps the game's NotifyBoard: game after changes to what the
+ * header holds (counters, clock, config, directory) and any after every
+ * change an observer can see. A subscription sleeps on one of those and
+ * tells which of the counters it watches moved; watched counters are only
+ * read, so any counter can be watched, sequence locks included. (One that
+ * is also slept on directly can be reported moved when a sleeper marks it.)
+ */
+
+#define NOTIFY_WAITING 1u  // Somebody sleeps on the word
+#define NOTIFY_STEP 2u     // Bump of a counter that is slept on
+
+typedef struct {
+    uint32_t game;  // The header: counters, clock, config, directory
+    uint32_t any;   // Anything observers see: the header, gangs, police
+} NotifyBoard;
+
+// Board of the segment this process is attached to; NULL while it isn't
+extern NotifyBoard *notify_board;
+
+void notify_attach(NotifyBoard *board);
+
+static inline uint32_t notify_generation(const uint32_t *word) {
+    return __atomic_load_n(word, __ATOMIC_ACQUIRE) & ~NOTIFY_WAITING;
+}
+
+// Bump a counter after a change and wake whoever sleeps on it
+void notify_bump(uint32_t *word);
+
+// Bump the board after a change to a gang or the police
+void notify_changed(void);
+
+// Bump the board after a change to what the game header holds
+void notify_game_changed(void);
+
+/**
+ * Sleep until the counter moves from seen, or timeout_ms passes (-1 waits
+ * as long as it takes). A signal cuts the sleep short.
+ *
+ * @return 1 if it moved, 0 if not
+ */
+int notify_wait(uint32_t *word, uint32_t seen, int timeout_ms);
+
+typedef struct {
+    uint32_t *sleep_on;        // Bumped after every watched counter
+    int num_watched;
+    int max_watched;
+    const uint32_t **watched;  // [max_watched]
+    uint32_t *seen;            // [max_watched] Values last reported
+} NotifySubscription;
+
+/**
+ * @return 0 on success, -1 if it can't be allocated
+ */
+int notify_subscribe(NotifySubscription *sub, uint32_t *sleep_on, int max_watched);
+
+/**
+ * Watch one more counter, from its current value
+ *
+ * @return Its index in the subscription, -1 if the subscription is full
+ */
+int notify_watch(NotifySubscription *sub, const uint32_t *word);
+
+/**
+ * Wait until any watched counter moved since it was last reported, or
+ * timeout_ms passes (-1 waits as long as it takes), or a signal comes
+ *
+ * @param changed If not NULL, receives the indices of the ones that moved
+ * @return Number of counters that moved, 0 if none did
+ */
+int notify_wait_any(NotifySubscription *sub, int timeout_ms, int *changed);
+
+void notify_unsubscribe(NotifySubscription *sub);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // NOTIFY_H
@@ -7,14 +7,21 @@
 
 #include <pthread.h>
 #include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "agent_mailbox.h"
 #include "config.h"
 #include "message.h"
+#include "police_shard.h"
+#include "random_stream.h"
+#include "timer_wheel.h"
 
-#define MAX_GANGS_POLICE 20
-#define MAX_AGENTS_PER_GANG 20
 #define KNOWLEDGE_THRESHOLD 0.8f
-#define MSG_QUEUE_KEY 0x1234
 #define MAX_PLANT_ATTEMPTS 3  // Maximum attempts to plant an agent
+#define PATROL_INTERVAL_MS 1000  // An officer's rounds, and the department's
+#define ARREST_TICK_MS 1000      // One time unit of a prison sentence
+#define REPORT_TIMEOUT_MS 10000  // Silence after which an agent is asked for a report
+#define HANDSHAKE_TIMEOUT_MS 2000  // Wait for a gang to answer a handshake
 
 typedef struct ShmPtrs ShmPtrs;
 
@@ -24,43 +31,130 @@ typedef struct {
     float knowledge_level;
     bool is_active;
     time_t last_report_time;
+    uint32_t report_seen;      // Sequence of its mailbox last read
 } AgentInfo;
 
+// An officer thread's timers, on a wheel ticking in milliseconds; they live
+// as long as the thread and are armed again from the row by the next one
+typedef struct {
+    TimerWheel wheel;
+    TimerNode patrol;     // The officer's rounds
+    TimerNode arrest;     // Counts the gang's sentence down while it is arrested
+    TimerNode *reports;   // [max_agents] Report timeout of each agent slot
+} OfficerTimers;
+
 typedef struct {
     int police_id;
     int gang_id_monitoring;  // Which gang this police officer monitors (same as police_id)
     bool is_active;
     pthread_t thread;
+    bool running;            // Thread started and not yet joined
+    bool restored;           // State came from shared memory; go on from it
+    bool held;               // This department holds the officer (private)
+    int department;          // Department holding it (shared; -1 = none)
+    uint32_t incarnation;    // Incarnation of the gang slot being monitored
 
-    // Message queue communication
+    // Queue of the monitored gang
     int msgq_id;
 
-    // Agent management
+    // Agent management; the officer's agents are its row of the agents table
     int num_agents;
-    AgentInfo agents[MAX_AGENTS_PER_GANG];
 
     // Knowledge and monitoring
     float knowledge_level;
 
     pthread_mutex_t officer_mutex;
 
+    RandomStream rng;  // Thread's stream, saved when parked for a checkpoint
+    OfficerTimers *timers;   // The running thread's timers (private)
+
 } PoliceOfficer;
 
+/*
+ * The police tables: one officer per gang slot, max_agents_per_gang agent
+ * slots per officer, and one arrest timer per gang. They are sized from the
+ * config and laid out in a single block, officers first, so each police
+ * department keeps a private block and publishes the rows of its officers
+ * into SHM_REGION_POLICE with the same layout.
+ *
+ * The shared rows are also how officers move between departments. The
+ * department a row belongs to on the ring (police_shard.h) claims it by
+ * swapping its department from -1 to its own ID and carries on from what
+ * the row holds; a department that loses a row on the ring stops its
+ * officer, publishes the row one last time and sets it back to -1. The
+ * arrest timers are only kept in the shared table, by whoever holds the
+ * gang's officer.
+ *
+ * Last come the agents' mailboxes (agent_mailbox.h), a row per gang slot
+ * with a slot per agent. The gang writes them and the officer reads the
+ * shared ones; a department's private copy of them goes unused.
+ */
+typedef struct {
+    PoliceOfficer *officers;  // [num_officers]
+    AgentInfo *agents;        // [num_officers][max_agents]
+    int *arrested_gangs;      // [num_officers], time until release (0 = not arrested)
+    AgentMailbox *mailboxes;  // [num_officers][max_agents]
+} PoliceTables;
+
+static inline size_t police_tables_size(int num_officers, int max_agents) {
+    return (size_t)num_officers * sizeof(PoliceOfficer) +
+           (size_t)num_officers * (size_t)max_agents * sizeof(AgentInfo) +
+           (size_t)num_officers * sizeof(int) +
+           (size_t)num_officers * (size_t)max_agents * sizeof(AgentMailbox);
+}
+
+// Resolve the tables of a block laid out for num_officers and max_agents
+static inline PoliceTables police_tables_at(void *block, int num_officers, int max_agents) {
+    PoliceTables tables;
+    tables.officers = (PoliceOfficer *)block;
+    tables.agents = (AgentInfo *)(tables.officers + num_officers);
+    tables.arrested_gangs = (int *)(tables.agents + (size_t)num_officers * (size_t)max_agents);
+    tables.mailboxes = (AgentMailbox *)(tables.arrested_gangs + num_officers);
+    return tables;
+}
+
+// An officer's row of the agents table
+static inline AgentInfo *police_agents(const PoliceTables *tables, int max_agents, int officer) {
+    return tables->agents + (size_t)officer * (size_t)max_agents;
+}
+
+// A gang slot's row of the mailboxes
+static inline AgentMailbox *police_mailboxes(const PoliceTables *tables, int max_agents, int gang) {
+    return tables->mailboxes + (size_t)gang * (size_t)max_agents;
+}
+
+// What the police publishes in the Game header next to its tables
+typedef struct {
+    int num_officers;
+    int max_agents;           // Agent slots per officer
+    int num_departments;      // Police processes started
+
+    // Urgent agent reports acted on, and how long after the agent raised
+    // them the officer evaluated the gang (those raised during a sentence are
+    // dropped, not counted); every department adds to these
+    uint32_t alerts_handled;
+    uint32_t alert_latency_max_us;
+    uint64_t alert_latency_total_us;
+} PoliceSummary;
+
 typedef struct {
     int num_officers;
+    int max_agents;
+    int department;           // This process's department ID
+    PoliceRing ring;          // Departments on duty, and so this one's shard
 
     // Arrested gangs array - indexed by gang_id, value is time until release (0 = not arrested)
     pthread_mutex_t arrest_mutex;
 
-    // Message queue for communication
-    int msgq_id;
-
     // Coordination
     pthread_mutex_t police_mutex;
     bool shutdown_requested;
 
-    int arrested_gangs[MAX_GANGS_POLICE];
-    PoliceOfficer officers[MAX_GANGS_POLICE];
+    // Private tables; see PoliceTables. The arrests are the shared ones.
+    void *block;
+    int *arrested_gangs;
+    PoliceOfficer *officers;
+    AgentInfo *agents;
 
 } PoliceForce;
 
@@ -70,17 +164,18 @@ void monitor_gang_activity(PoliceOfficer* officer, ShmPtrs *shm_ptr);
 void take_police_action(PoliceOfficer* officer, ShmPtrs *shm_ptrs);
 bool attempt_plant_agent_handshake(PoliceOfficer* officer, Config* config);
 void handle_agent_death_notification(PoliceOfficer* officer, Message* msg);
-void request_information_from_agent(PoliceOfficer* officer, int agent_index);
+bool collect_agent_report(PoliceOfficer* officer, int agent_index, bool urgent_only);
+bool drain_priority_lane(PoliceOfficer* officer, Message* handshake_reply);
 void communicate_with_agents(PoliceOfficer* officer);
-void process_agent_message(PoliceOfficer* officer, Message* msg);
+void process_agent_report(PoliceOfficer* officer, int agent_index, float knowledge, uint32_t raised_us);
 void evaluate_imprisonment_probability(PoliceOfficer* officer);
 void imprison_gang(PoliceOfficer* officer);
 void investigate_gang(PoliceOfficer* officer);
 void handle_gang_arrest(PoliceOfficer* officer);
 void handle_gang_release(PoliceOfficer* officer);
-void process_arrest_timers(PoliceForce* force);
-void init_police_force(Config *config);
+void init_police_force(Config *config, int department);
 void sync_police_data_to_shared_memory(void);
+void sync_officers(void);
 
 // Initialization and cleanup
 void start_police_operations(void);
@@ -0,0 +1,53 @@
+#ifndef POLICE_SHARD_H
+#define POLICE_SHARD_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+/*
+ * Which police department watches which gang slot.
+ *
+ * Each department on duty puts POLICE_RING_POINTS points on a 64-bit hash
+ * ring; a gang slot belongs to the department whose point comes first at
+ * or after the slot's own hash. Every department builds the same ring from
+ * the same count, so they agree on the shards without talking, and when the
+ * count changes only the slots between the moved points change hands
+ * (about 1/N of them) instead of most of them as with slot % N.
+ */
+
+#define POLICE_RING_POINTS 64  // Points per department; more evens out the shards
+
+typedef struct {
+    uint64_t hash;
+    int32_t department;
+} PoliceRingPoint;
+
+typedef struct {
+    int num_departments;
+    int num_points;
+    PoliceRingPoint *points;  // Sorted by hash
+} PoliceRing;
+
+/**
+ * Build the ring of departments 0 .. num_departments-1, replacing what the
+ * ring held. A ring of no departments owns nothing.
+ *
+ * @return 0 on success, -1 if it can't be allocated (the ring is left as it was)
+ */
+int police_ring_build(PoliceRing *ring, int num_departments);
+
+/**
+ * Department a gang slot belongs to, or -1 if the ring is empty
+ */
+int police_ring_owner(const PoliceRing *ring, int gang);
+
+void police_ring_free(PoliceRing *ring);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // POLICE_SHARD_H
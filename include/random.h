@@ -5,16 +5,74 @@
 #ifndef RANDOM_H
 #define RANDOM_H
 
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
 #include "gang.h"  // For NUM_ATTRIBUTES
 
+// Process roles used when deriving a stream from the master seed
+#define RANDOM_PROC_MAIN   0
+#define RANDOM_PROC_POLICE 1
+#define RANDOM_PROC_GANG   2
+#define RANDOM_PROC_VIEWER 3
+#define RANDOM_PROC_GANG_INIT 4  // Bulk member generation, one stream per chunk
+#define RANDOM_PROC_SWEEP 5      // ocf-sweep point sampling and run seeds
+
+#include "random_stream.h"
+
+// Seed the process from the clock (used when no master seed is configured)
 void init_random();
+
+// Seed the process from a master seed; process_id is one of RANDOM_PROC_*
+void init_random_seeded(uint64_t master_seed, int process_id);
+uint64_t random_master_seed(void);
+
+// Derive the calling thread's stream from (master seed, process, gang, member).
+// Pass -1 for IDs that don't apply. Unseeded threads get a fallback stream
+// on first use.
+void random_seed_thread(int gang_id, int member_id);
+
+// Explicit stream API (the functions below all use the calling thread's stream)
+void random_stream_seed(RandomStream *stream, uint64_t master_seed, int process_id, int gang_id, int member_id);
+uint64_t random_stream_next(RandomStream *stream);
+
+// Make the calling thread draw from a caller-owned stream (NULL restores its own)
+void random_bind_stream(RandomStream *stream);
+
+// Copy the calling thread's stream out, or replace it (checkpoint/restore)
+void random_save_thread(RandomStream *out);
+void random_load_thread(const RandomStream *in);
+
+uint64_t random_u64(void);
 float random_float(float min, float max);
 int random_int(int min, int max);
 
-// Box-Muller transform to generate univariate normal distribution
+// Ziggurat sampler for the univariate normal distribution
 float random_normal(float mean, float stddev);
 
+// Fill out[0..n) with standard normal samples
+void random_normal_fill(float *out, int n);
+
 // Generate correlated attributes using multivariate Gaussian distribution
 void generate_multivariate_attributes(float* attributes, const float* means, const float* stddevs, const float correlation_matrix[NUM_ATTRIBUTES][NUM_ATTRIBUTES]);
 
+/**
+ * Batch version of generate_multivariate_attributes for n members.
+ *
+ * The scaled factor is built once and the normals are drawn and combined in
+ * column blocks, so the inner loops vectorize.
+ *
+ * @param out Attribute array of the first member
+ * @param stride Bytes between consecutive members' attribute arrays
+ * @param n Number of members
+ */
+void generate_multivariate_attributes_batch(float *out, size_t stride, int n, const float* means, const float* stddevs, const float correlation_matrix[NUM_ATTRIBUTES][NUM_ATTRIBUTES]);
+
+#ifdef __cplusplus
+}
+#endif
+
 #endif //RANDOM_H
@@ -0,0 +1,13 @@
+#ifndef RANDOM_STREAM_H
+#define RANDOM_STREAM_H
+
+#include <stdint.h>
+
+// xoshiro256** generator state. Every thread owns one stream, so draws
+// never touch shared state and a master seed reproduces the whole run.
+// Kept apart from random.h so shared-memory structs can hold saved streams.
+typedef struct {
+    uint64_t s[4];
+} RandomStream;
+
+#endif // RANDOM_STREAM_H
@@ -0,0 +1,84 @@
+#ifndef ROUTING_H
+#define ROUTING_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include "message.h"
+
+/*
+ * Addressing of the gangs' message queues.
+ *
+ * Every endpoint that takes messages off a queue has a message type of its
+ * own. main lays the types out once, for the gang slots the shared memory
+ * was made with, and publishes the table in the game header; senders and
+ * receivers look their types up there instead of working them out from
+ * whatever sizes they have at hand, so nothing is addressed to a type
+ * nobody reads. Each kind of endpoint has a block of types, one per slot,
+ * and the blocks don't overlap. (Agents have no endpoint: they report
+ * through their mailboxes, agent_mailbox.h.)
+ *
+ * Sends don't block: a message for no endpoint, or one its queue has no room
+ * for, is undeliverable, reported and counted. A message nobody took in
+ * time is withdrawn and only counted, apart: that is routine for handshakes,
+ * which a gang only looks for between plans. Either way a queue only holds
+ * what its readers keep up with.
+ */
+
+typedef enum {
+    ENDPOINT_GANG,     // A gang's main thread: handshakes
+    ENDPOINT_OFFICER,  // The officer watching a slot: handshake replies, death notices
+    ENDPOINT_KINDS
+} EndpointKind;
+
+typedef struct {
+    int32_t slots;               // Endpoints of each kind
+    uint32_t undeliverable;      // Messages that couldn't be routed or queued, counted by every process
+    uint32_t withdrawn;          // Messages taken back unread (route_withdraw)
+    long base[ENDPOINT_KINDS];   // Type of each kind's endpoint for slot 0
+} RoutingTable;
+
+/**
+ * Lay out the types for slots gang slots
+ *
+ * @return 0 on success, -1 if the slots don't fit in positive types
+ */
+int routing_init(RoutingTable *table, int slots);
+
+// Type of an endpoint
+static inline long route_to(const RoutingTable *table, EndpointKind kind, int slot) {
+    return table->base[kind] + slot;
+}
+
+/**
+ * Endpoint a type belongs to
+ *
+ * @return 0 on success, -1 if it is no endpoint's
+ */
+int route_resolve(const RoutingTable *table, long mtype, EndpointKind *kind, int *slot);
+
+// Count a message no endpoint took and say which and why
+void route_undeliverable(RoutingTable *table, const Message *message, const char *reason);
+
+/**
+ * Put a message on a queue without waiting for room
+ *
+ * @return 0 on success, -1 if it was undeliverable
+ */
+int route_send(RoutingTable *table, int msgid, Message *message);
+
+/**
+ * Take back what is still waiting for an endpoint that won't read it; these
+ * are counted in withdrawn, not reported one by one
+ *
+ * @return Number of messages withdrawn
+ */
+int route_withdraw(RoutingTable *table, int msgid, long mtype);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // ROUTING_H
@@ -12,10 +12,8 @@ void secret_agent_record_asker(ShmPtrs* shm_ptrs,Config config, Member* agent, i
 void secret_agent_ask_member(ShmPtrs* shm_ptrs,Member* agent,Member *target);
 void conduct_internal_investigation(Config config, ShmPtrs* shm_ptrs, int gang_id);
 
-void police_request_agent_knowledge(int police_msgid, Game* shared_game, int8_t gang_id, int8_t agent_id, Config config, Gang* gang);
-void agent_report_knowledge(Member* agent, Game* shared_game, int police_msgid, int police_id, Gang* gang, Config config);
-void secret_agent_handle_police_requests(Member* agent, Game* shared_game, int police_msgid, int police_id, Gang* gang, Config config);
-void secret_agent_periodic_communication(ShmPtrs* shm_ptrs, Member* agent, Game* shared_game, int police_msgid, int police_id, Gang* gang, Config config);
-void notify_police_agent_death(int police_msgid, int gang_id, int agent_id, int police_id, Gang* gang, Config config);
+// Post the agent's knowledge to its mailbox for the police
+void secret_agent_periodic_communication(ShmPtrs* shm_ptrs, Member* agent, Game* shared_game, Gang* gang, Config config);
+void notify_police_agent_death(int police_msgid, RoutingTable* routing, int gang_id, int agent_id, Gang* gang);
 
 #endif // SECRET_AGENT_UTILS_H
@@ -13,6 +13,7 @@
 // Function declarations
 int init_semaphores(void);
 void cleanup_semaphores(void);
+void unlink_semaphores(void);
 sem_t* get_game_stats_semaphore(void);
 sem_t* get_gang_stats_semaphore(void);
 
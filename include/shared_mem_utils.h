@@ -9,9 +9,36 @@
 // For the main process (first to run) - creates and initializes shared memory
 Game* setup_shared_memory_owner(Config *cfg, ShmPtrs *shm_ptrs);
 
-// For secondary processes - only maps to existing shared memory
+// For secondary processes - only maps to existing shared memory and copies
+// the config main published there into cfg
 Game* setup_shared_memory_user(Config *cfg, ShmPtrs *shm_ptrs);
 
-void cleanup_shared_memory(Game *shared_game);
+// Bring this process's gang mappings up to date with the directory (see
+// gang_mappings_refresh); returns 1 if anything changed
+int shm_refresh_gangs(ShmPtrs *shm_ptrs);
+
+// Map a single gang's members, for the gang process itself
+int shm_map_gang(ShmPtrs *shm_ptrs, int slot);
+
+// Main: start a gang on a free or retired slot with a fresh member segment
+// and message queue
+int shm_spawn_gang(ShmPtrs *shm_ptrs, const Config *cfg, int slot);
+
+// Main, restoring a checkpoint: recreate an active slot's segment as saved,
+// and give it a new, empty queue
+int shm_restore_gang(ShmPtrs *shm_ptrs, const Config *cfg, int slot, const void *members, size_t size);
+
+// Main: retire a slot once its gang process is gone; its queue is removed
+void shm_retire_gang(ShmPtrs *shm_ptrs, int slot);
+
+// Gang: make room for capacity members in its own segment; returns the new
+// capacity, or -1
+int shm_grow_gang(ShmPtrs *shm_ptrs, int slot, int capacity);
+
+// Unmap the whole segment and every gang mapping
+void detach_shared_memory(ShmPtrs *shm_ptrs);
+
+// Unmap the segment and remove it with every gang segment (main only)
+void cleanup_shared_memory(ShmPtrs *shm_ptrs);
 
 #endif // SHARED_MEM_UTILS_H
\ No newline at end of file
@@ -0,0 +1,115 @@
+#ifndef SHM_ARENA_H
+#define SHM_ARENA_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Relocatable arena for the game's shared memory segment.
+ *
+ * The segment starts with a ShmArena header; everything after it is handed
+ * out by a bump allocator in SHM_ARENA_ALIGN byte steps and addressed by
+ * ShmOffset, the byte distance from the header. Offsets mean the same thing
+ * in every process whatever address the segment is mapped at, so structs in
+ * the segment store offsets instead of pointers and each process resolves
+ * them with shm_arena_ptr in O(1).
+ *
+ * The header also carries a table of the named regions (the Game, the
+ * gangs, the catalog, the gang directory, the police tables) with their element size and count, so a process that
+ * attaches finds the layout in the segment instead of recomputing it, and
+ * can tell when the segment was built by an incompatible binary.
+ */
+
+#define SHM_ARENA_MAGIC 0x5241434Fu  // "OCAR"
+#define SHM_ARENA_VERSION 1
+#define SHM_ARENA_ALIGN 64           // Every allocation starts on a cache line
+
+typedef uint64_t ShmOffset;          // Bytes from the arena header; 0 is null
+
+enum {
+    SHM_REGION_GAME,
+    SHM_REGION_GANGS,
+    SHM_REGION_CATALOG,
+    SHM_REGION_DIRECTORY,
+    SHM_REGION_POLICE,
+    SHM_MAX_REGIONS = 8
+};
+
+typedef struct {
+    ShmOffset offset;
+    uint64_t size;                   // Bytes, count * elem_size for arrays
+    uint32_t count;
+    uint32_t elem_size;
+} ShmRegion;
+
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t total_size;             // Bytes in the segment, header included
+    uint64_t used;                   // Allocator top, an offset
+    ShmRegion regions[SHM_MAX_REGIONS];
+} ShmArena;
+
+static inline size_t shm_arena_align(size_t size) {
+    return (size + SHM_ARENA_ALIGN - 1) & ~(size_t)(SHM_ARENA_ALIGN - 1);
+}
+
+/**
+ * Bytes the header takes; the first allocation starts here
+ */
+static inline size_t shm_arena_header_size(void) {
+    return shm_arena_align(sizeof(ShmArena));
+}
+
+/**
+ * Write an empty header at the start of a zeroed block of total_size bytes
+ */
+void shm_arena_init(ShmArena *arena, size_t total_size);
+
+/**
+ * Allocate size bytes, zeroed if the block was. Safe to call from several
+ * processes at once.
+ *
+ * @return Offset of the allocation, or 0 when the arena is full
+ */
+ShmOffset shm_arena_alloc(ShmArena *arena, size_t size);
+
+/**
+ * Allocate an array of count elements and record it as a named region
+ *
+ * @return Offset of the region, or 0 when the arena is full
+ */
+ShmOffset shm_arena_add_region(ShmArena *arena, int region, uint32_t count, uint32_t elem_size);
+
+/**
+ * Validate the header of a segment that was just mapped
+ *
+ * @param mapped_size Bytes mapped
+ * @return 0 if the header and its region table fit in the mapping, -1 otherwise
+ */
+int shm_arena_check(const ShmArena *arena, size_t mapped_size);
+
+/**
+ * Check a region holds elements of the size this binary was built with
+ *
+ * @return 0 on success, -1 if it's missing or its element size differs
+ */
+int shm_arena_check_region(const ShmArena *arena, int region, uint32_t elem_size);
+
+static inline void *shm_arena_ptr(const ShmArena *arena, ShmOffset offset) {
+    return offset ? (char *)arena + offset : NULL;
+}
+
+static inline void *shm_arena_region(const ShmArena *arena, int region) {
+    return shm_arena_ptr(arena, arena->regions[region].offset);
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SHM_ARENA_H
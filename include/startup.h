@@ -0,0 +1,75 @@
+#ifndef STARTUP_H
+#define STARTUP_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <pthread.h>
+#include <stdint.h>
+
+/*
+ * Startup barrier and per-phase startup timing.
+ *
+ * main launches every child in one batch and waits until they have all
+ * attached and initialized before starting the game clock. Each child stamps
+ * its phases (nanoseconds since main began launching) so main can report
+ * where the startup time went.
+ */
+
+typedef enum {
+    STARTUP_EXEC,    // process entered main()
+    STARTUP_ATTACH,  // shared memory mapped and config read
+    STARTUP_IPC,     // semaphores and message queue opened
+    STARTUP_INIT,    // members / officers initialized
+    STARTUP_READY,   // arrived at the barrier
+    NUM_STARTUP_PHASES
+} StartupPhase;
+
+typedef struct {
+    uint64_t phase_ns[NUM_STARTUP_PHASES];  // 0 = phase not reached
+} StartupTimes;
+
+typedef struct {
+    pthread_mutex_t mutex;  // process-shared
+    pthread_cond_t cond;    // process-shared
+    int expected;           // children that must arrive
+    int ready;              // children that have arrived
+    int released;           // set by main once the game starts
+    uint64_t launch_ns;     // CLOCK_MONOTONIC when main began launching
+    uint64_t release_ns;    // CLOCK_MONOTONIC when main released the barrier
+    StartupTimes police;    // gangs keep theirs in Gang.startup
+} StartupBarrier;
+
+uint64_t startup_now_ns(void);
+
+// Owner only: set up the barrier for `expected` children and stamp the launch time
+int startup_barrier_init(StartupBarrier *barrier, int expected);
+void startup_barrier_destroy(StartupBarrier *barrier);
+
+// Record that a phase finished at `now_ns` (from startup_now_ns)
+void startup_mark(const StartupBarrier *barrier, StartupTimes *times, StartupPhase phase, uint64_t now_ns);
+
+// Child: stamp STARTUP_READY, announce readiness and block until main releases
+void startup_arrive_and_wait(StartupBarrier *barrier, StartupTimes *times);
+
+/**
+ * Main: wait for every child to arrive, or until timeout_ms passes
+ *
+ * @return Number of children that arrived
+ */
+int startup_wait_all(StartupBarrier *barrier, int timeout_ms);
+
+// Main: let the children go
+void startup_release(StartupBarrier *barrier);
+
+// Print one process's phase timings in milliseconds
+void startup_print(const char *label, const StartupTimes *times);
+
+extern const char *const startup_phase_names[NUM_STARTUP_PHASES];
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // STARTUP_H
@@ -0,0 +1,139 @@
+#ifndef STATE_STREAM_H
+#define STATE_STREAM_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+#include "config.h"
+#include "game.h"
+
+/*
+ * Game state streamed to viewers that don't map shared memory.
+ *
+ * main publishes on a Unix domain socket, or on loopback TCP when the
+ * address is ":PORT". Every message starts with a StreamHeader:
+ *
+ *   HELLO  server -> viewer once: StreamHello, the Config, the catalog
+ *   FRAME  server -> viewer: StreamFrame, then what changed since the
+ *          frame the viewer last acknowledged:
+ *            num_game_blocks x (uint32_t index, block of the Game)
+ *            num_catalog_blocks x (uint32_t index, block of the catalog)
+ *            num_police_blocks x (uint32_t index, block of the police
+ *                                 tables)
+ *            num_gangs x (StreamGangRecord, Gang,
+ *                         num_members x (uint32_t index, Member))
+ *          The game header, the catalog and the police tables are diffed
+ *          in STREAM_BLOCK byte blocks (the last one short), so the clock
+ *          ticking doesn't resend the whole police force.
+ *   ACK    viewer -> server: header only, frame = the frame applied
+ *
+ * A viewer has at most one frame in flight; the next one is cut once it
+ * acknowledges, so a slow viewer gets fewer, larger deltas and traffic
+ * follows how much changes, not how much state there is. Structs travel
+ * as they are in memory, so both ends must come from the same build;
+ * HELLO carries the sizes to check.
+ */
+
+#define STREAM_MAGIC 0x46534F43u  // "OCSF"
+#define STREAM_VERSION 2
+#define STREAM_MAX_PEERS 16
+
+enum { STREAM_HELLO = 1, STREAM_FRAME, STREAM_ACK };
+
+#define STREAM_BLOCK 256
+
+typedef struct {
+    uint32_t magic;
+    uint16_t type;
+    uint16_t version;
+    uint32_t size;       // Whole message, header included
+    uint32_t reserved;
+    uint64_t frame;
+} StreamHeader;
+
+typedef struct {
+    uint32_t config_size;
+    uint32_t game_size;
+    uint32_t gang_size;
+    uint32_t member_size;
+    uint64_t catalog_size;
+    uint64_t police_size;  // Police tables for the config's max_gangs and max_agents_per_gang
+} StreamHello;
+
+typedef struct {
+    uint32_t num_game_blocks;
+    uint32_t num_catalog_blocks;
+    uint32_t num_police_blocks;
+    uint32_t num_gangs;  // Gang records that follow
+} StreamFrame;
+
+typedef struct {
+    int32_t gang;
+    uint32_t version;    // The gang's version counter when it was copied
+    uint32_t num_members;
+    uint32_t reserved;
+} StreamGangRecord;
+
+/**
+ * Serve the game in shm to viewers from a thread of this process
+ *
+ * @param address Unix socket path, or ":PORT" for 127.0.0.1:PORT
+ * @param hz      How often the state is compared for changes
+ * @return 0 on success, -1 on error
+ */
+int stream_publisher_start(const char *address, const ShmPtrs *shm, const Config *config, int hz);
+
+/**
+ * Stop serving and report what was sent
+ */
+void stream_publisher_stop(void);
+
+typedef struct {
+    int fd;
+    Config config;
+    TargetCatalog *catalog;   // Kept current by stream_apply
+    size_t catalog_size;
+    uint8_t *police;          // Police tables block, kept current by stream_apply
+    size_t police_size;
+    uint8_t *buffer;          // Body of the last message read
+    size_t length;
+    size_t capacity;
+    uint64_t frame;           // Frame in the buffer
+    int *changed;             // Gangs the last applied frame touched
+    int num_changed;
+    uint64_t bytes_read;
+} StreamClient;
+
+/**
+ * Connect to a publisher and read its HELLO (config and catalog)
+ *
+ * @return 0 on success, -1 on error
+ */
+int stream_connect(StreamClient *client, const char *address);
+
+/**
+ * Wait up to timeout_ms for the next frame
+ *
+ * @return 1 with a frame in the buffer, 0 on timeout, -1 when the stream ended
+ */
+int stream_next(StreamClient *client, int timeout_ms);
+
+/**
+ * Copy the frame in the buffer into a mirror of the shm state, then
+ * acknowledge it. Fills client->changed with the gangs it touched.
+ *
+ * @param versions Per-gang version of the mirror's copies (may be NULL)
+ * @return 0 on success, -1 on a malformed frame or a dead connection
+ */
+int stream_apply(StreamClient *client, Game *game, Gang *gangs, Member **gang_members, uint32_t *versions);
+
+void stream_close(StreamClient *client);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // STATE_STREAM_H
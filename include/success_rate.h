@@ -10,21 +10,21 @@
  * 
  * @param gang The gang executing the plan
  * @param members The gang's members array
- * @param target_type The type of target for the plan
+ * @param target_type The target index for the plan
  * @param config The game configuration
  * @return The calculated success rate between 0-100%
  */
-float calculate_success_rate(Gang *gang, Member *members, TargetType target_type, Config *config);
+float calculate_success_rate(Gang *gang, Member *members, int target_type, Config *config);
 
 /**
  * Determine if a plan succeeds based on the calculated success rate
  * 
  * @param gang The gang executing the plan
  * @param members The gang's members array
- * @param target_type The type of target for the plan
+ * @param target_type The target index for the plan
  * @param config The game configuration
  * @return true if the plan succeeds, false otherwise
  */
-bool determine_plan_success(Gang *gang, Member *members, TargetType target_type, Config *config);
+bool determine_plan_success(Gang *gang, Member *members, int target_type, Config *config);
 
 #endif // SUCCESS_RATE_H
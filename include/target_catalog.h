@@ -0,0 +1,107 @@
+#ifndef TARGET_CATALOG_H
+#define TARGET_CATALOG_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+#include "gang.h"  // For MAX_ATTRIBUTES
+
+#define CATALOG_NAME_LEN 32
+#define CATALOG_ALIGN 64      // Weight rows and heat rows start on a cache line
+#define TARGET_TOP_K 3        // Best-fitting coolest targets the leader chooses between
+
+/*
+ * Target catalog loaded from config.json.
+ *
+ * The catalog is one position-independent block: the header is followed by
+ * the regions below, all addressed by byte offsets from the header, so the
+ * same block works on the heap and in shared memory.
+ *
+ *   names        char[num_targets][CATALOG_NAME_LEN]
+ *   attr_names   char[MAX_ATTRIBUTES][CATALOG_NAME_LEN]
+ *   weights      float[num_targets][MAX_ATTRIBUTES]   (one cache line per row)
+ *   target_heat  float[heat_stride]                   (how pursued each target is)
+ *   gang_heat    float[num_gangs][heat_stride]        (each gang's heat per target)
+ */
+typedef struct {
+    int num_targets;
+    int num_attributes;
+    int num_gangs;
+    int heat_stride;          // num_targets rounded up to a whole cache line of floats
+    size_t names_offset;
+    size_t attr_names_offset;
+    size_t weights_offset;
+    size_t target_heat_offset;
+    size_t gang_heat_offset;
+    size_t total_size;
+} TargetCatalog;
+
+/**
+ * Number of bytes needed for a catalog of the given shape
+ */
+size_t target_catalog_size(int num_targets, int num_attributes, int num_gangs);
+
+/**
+ * Lay out an empty (zeroed) catalog in a block of target_catalog_size() bytes
+ */
+void target_catalog_init(TargetCatalog *catalog, int num_targets, int num_attributes, int num_gangs);
+
+/**
+ * Copy a catalog into a block laid out for the same shape
+ *
+ * @return 0 on success, -1 if the shapes differ
+ */
+int target_catalog_copy(TargetCatalog *dst, const TargetCatalog *src);
+
+/**
+ * Find a target by name
+ *
+ * @return Target index, or -1 if not found
+ */
+int catalog_find_target(const TargetCatalog *catalog, const char *name);
+
+/**
+ * Weighted fit of a member's attributes for a target (dot product of one row)
+ */
+float catalog_score(const TargetCatalog *catalog, int target, const float *attributes);
+
+/**
+ * Select the target for a gang's next plan.
+ *
+ * Takes the targets with the minimum heat (target heat x gang heat), keeps the
+ * TARGET_TOP_K that best fit the leader's attributes and picks one at random.
+ *
+ * @param catalog The target catalog
+ * @param gang_id The gang selecting a target
+ * @param attributes Attributes of the gang leader
+ * @return The selected target index, or 0 if the catalog is empty
+ */
+int catalog_select_target(const TargetCatalog *catalog, int gang_id, const float *attributes);
+
+static inline char *catalog_target_name(const TargetCatalog *catalog, int target) {
+    return (char *)catalog + catalog->names_offset + (size_t)target * CATALOG_NAME_LEN;
+}
+
+static inline char *catalog_attribute_name(const TargetCatalog *catalog, int attribute) {
+    return (char *)catalog + catalog->attr_names_offset + (size_t)attribute * CATALOG_NAME_LEN;
+}
+
+static inline float *catalog_weights(const TargetCatalog *catalog, int target) {
+    return (float *)((char *)catalog + catalog->weights_offset) + (size_t)target * MAX_ATTRIBUTES;
+}
+
+static inline float *catalog_target_heat(const TargetCatalog *catalog) {
+    return (float *)((char *)catalog + catalog->target_heat_offset);
+}
+
+static inline float *catalog_gang_heat(const TargetCatalog *catalog, int gang_id) {
+    return (float *)((char *)catalog + catalog->gang_heat_offset) + (size_t)gang_id * catalog->heat_stride;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // TARGET_CATALOG_H
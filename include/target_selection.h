@@ -34,29 +34,22 @@ int find_highest_ranked_member(Gang *gang, Member *members);
 /**
  * Select a new target for the gang based on attributes of the highest-ranked member
  * 
- * @param game The game state
- * @param gang The gang that's selecting a target
- * @param highest_rank_member_id The ID of the highest-ranked member
- * @return The selected target type
- /**
- * Select a new target for the gang based on attributes of the highest-ranked member
- * 
- * @param game The game state
+ * @param catalog The target catalog in shared memory
  * @param gang The gang that's selecting a target
  * @param members The gang members array
  * @param highest_rank_member_id The ID of the highest-ranked member
- * @return The selected target type
+ * @return The selected target index
  */
-TargetType select_target(Game *game, Gang *gang, Member *members, int highest_rank_member_id);
+int select_target(TargetCatalog *catalog, Gang *gang, Member *members, int highest_rank_member_id);
 
 /**
  * Set the preparation parameters for a gang's target
  * 
  * @param gang The gang to set parameters for
- * @param target_type The selected target type
+ * @param target_type The selected target index
  * @param config The game configuration
  */
-void set_preparation_parameters(Gang *gang, TargetType target_type, Config *config);
+void set_preparation_parameters(Gang *gang, int target_type, Config *config);
 
 /**
  * Reset all gang members' preparation contributions to 0
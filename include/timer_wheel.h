@@ -0,0 +1,117 @@
+#ifndef TIMER_WHEEL_H
+#define TIMER_WHEEL_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <time.h>
+
+/*
+ * Hierarchical timing wheel.
+ *
+ * Timers are intrusive nodes kept in TIMER_WHEEL_LEVELS wheels of
+ * TIMER_WHEEL_SLOTS slots; level l holds the timers due 64^l to 64^(l+1)
+ * ticks from now, and its slots are cascaded down a level as the wheel
+ * turns. Arming and cancelling are O(1), and advancing the wheel costs the
+ * timers that expire or cascade, not the timers pending or the ticks passed.
+ *
+ * The ticks are whatever the owner drives the wheel with: milliseconds of
+ * the monotonic clock for timer_wheel_wait, game time units for others.
+ * A wheel belongs to one thread, which runs the callbacks in
+ * timer_wheel_advance; a callback may arm or cancel any timer of the wheel,
+ * including its own.
+ */
+
+#define TIMER_WHEEL_BITS 6
+#define TIMER_WHEEL_SLOTS (1 << TIMER_WHEEL_BITS)
+#define TIMER_WHEEL_LEVELS 4  // 64^4 ticks ahead; timers further out are cascaded again
+
+typedef struct TimerNode TimerNode;
+typedef void (*TimerCallback)(TimerNode *timer, void *arg);
+
+struct TimerNode {
+    TimerNode *next;         // NULL when not pending
+    TimerNode *prev;
+    uint64_t expires;        // Tick it is due at
+    int slot;                // Level * TIMER_WHEEL_SLOTS + index, -1 while being fired
+    TimerCallback callback;
+    void *arg;
+};
+
+typedef struct {
+    uint64_t now;                                       // Last tick advanced to
+    int num_pending;
+    uint64_t occupied[TIMER_WHEEL_LEVELS];              // Slots holding timers
+    TimerNode slots[TIMER_WHEEL_LEVELS][TIMER_WHEEL_SLOTS];  // List heads
+} TimerWheel;
+
+void timer_wheel_init(TimerWheel *wheel, uint64_t now);
+
+// Set up a timer that isn't pending; call before arming it the first time
+void timer_init(TimerNode *timer, TimerCallback callback, void *arg);
+
+static inline bool timer_pending(const TimerNode *timer) {
+    return timer->next != NULL;
+}
+
+/**
+ * Fire the timer delay ticks from the wheel's now, at the earliest on the
+ * next tick. A pending timer is moved.
+ */
+void timer_arm(TimerWheel *wheel, TimerNode *timer, uint64_t delay);
+
+/**
+ * @return true if the timer was pending and won't fire now
+ */
+bool timer_cancel(TimerWheel *wheel, TimerNode *timer);
+
+/**
+ * Hand what src is pending for over to dst, which keeps its own callback;
+ * src is left not pending, and so is dst if src wasn't
+ */
+void timer_move(TimerWheel *wheel, TimerNode *dst, TimerNode *src);
+
+/**
+ * Turn the wheel to now, firing every timer due by then in the order they
+ * are due
+ *
+ * @return Number of timers fired
+ */
+int timer_wheel_advance(TimerWheel *wheel, uint64_t now);
+
+/**
+ * Ticks after the wheel's now at which it has to be advanced next: exact for
+ * timers due within TIMER_WHEEL_SLOTS ticks, otherwise when the next one is
+ * cascaded. UINT64_MAX if nothing is pending.
+ */
+uint64_t timer_wheel_next(const TimerWheel *wheel);
+
+// Milliseconds of the monotonic clock, the ticks of timer_wheel_wait
+static inline uint64_t timer_now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000ULL + (uint64_t)ts.tv_nsec / 1000000ULL;
+}
+
+/**
+ * For a wheel ticking in timer_now_ms: milliseconds from the clock's now
+ * until its next timer is due, at most max_ms
+ */
+uint64_t timer_wheel_timeout(const TimerWheel *wheel, uint64_t max_ms);
+
+/**
+ * For a wheel ticking in timer_now_ms: sleep until its next timer is due,
+ * or at most max_ms, then fire what is due
+ *
+ * @return Number of timers fired
+ */
+int timer_wheel_wait(TimerWheel *wheel, uint64_t max_ms);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // TIMER_WHEEL_H
@@ -0,0 +1,147 @@
+#ifndef TIMESERIES_H
+#define TIMESERIES_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdio.h>
+#include "columnar.h"
+
+/*
+ * Time-series file: several tables sampled together, each holding a fixed
+ * number of entities (gangs, officers) with the same columns.
+ *
+ *   header   magic, version, num_tables, then per table its name, entity
+ *            count and ColumnDesc[num_columns]
+ *   chunk*   TimeSeriesChunk header and an encoded payload
+ *
+ * A chunk holds up to chunk_samples samples of one table. Its payload is the
+ * sample times, then each column entity by entity, every value stored as the
+ * difference to the same entity's previous sample (integers: zigzag delta,
+ * floats: XOR of the bit patterns). The residuals are written as LEB128
+ * varints with runs of zeros collapsed, so a value that didn't change costs
+ * next to nothing. Chunks stand alone, and a cut-off chunk at the end of
+ * the file is ignored by the reader.
+ */
+
+#define TIMESERIES_MAGIC 0x5354434Fu        // "OCTS"
+#define TIMESERIES_CHUNK_MAGIC 0x4B435354u  // "TSCK"
+#define TIMESERIES_VERSION 1
+#define TIMESERIES_MAX_TABLES 8
+
+typedef struct {
+    const char *name;
+    const ColumnDesc *columns;
+    int num_columns;
+    int num_entities;
+} TimeSeriesTableDesc;
+
+typedef struct {
+    char name[COLUMN_NAME_LEN];
+    int num_entities;
+    int num_columns;
+    ColumnDesc *columns;
+    ColumnValue *buffer;   // [column][entity][sample], chunk_samples per series
+} TimeSeriesTable;
+
+typedef struct {
+    uint32_t magic;
+    uint16_t table;
+    uint16_t reserved;
+    uint32_t samples;
+    uint32_t num_entities;
+    uint64_t first_sample;
+    uint32_t payload_size;
+    uint32_t reserved2;
+} TimeSeriesChunk;
+
+typedef struct {
+    FILE *file;
+    int num_tables;
+    TimeSeriesTable tables[TIMESERIES_MAX_TABLES];
+    int chunk_samples;     // Samples buffered before the chunks are written
+    int samples;           // Samples currently buffered
+    uint64_t first_sample; // Index of the first buffered sample
+    uint32_t *times;       // Sample times in ms
+    uint32_t *residuals;   // Encoding scratch, one series at a time
+    uint8_t *scratch;      // Encoded payload of the largest table
+    uint64_t bytes_written;
+} TimeSeriesWriter;
+
+typedef struct {
+    FILE *file;
+    int num_tables;
+    TimeSeriesTable tables[TIMESERIES_MAX_TABLES];  // buffer unused
+    // Current chunk
+    int table;
+    int samples;
+    uint64_t first_sample;
+    uint32_t *times;
+    ColumnValue *data;     // [column][entity][sample]
+    size_t data_capacity;  // Values
+    uint8_t *payload;
+    size_t payload_capacity;
+} TimeSeriesReader;
+
+/**
+ * Create a time-series file for the given tables
+ *
+ * @param chunk_samples Samples per chunk; bounds the writer's memory
+ * @return 0 on success, -1 on error
+ */
+int timeseries_open(TimeSeriesWriter *writer, const char *path, const TimeSeriesTableDesc *tables,
+                    int num_tables, int chunk_samples);
+
+/**
+ * Set one entity's row (num_columns values) of the sample being filled
+ */
+void timeseries_put(TimeSeriesWriter *writer, int table, int entity, const ColumnValue *row);
+
+/**
+ * Finish the sample being filled; writes the chunks when the buffer is full
+ */
+int timeseries_commit(TimeSeriesWriter *writer, uint32_t time_ms);
+
+/**
+ * Write the buffered samples as chunks and flush the file
+ */
+int timeseries_flush(TimeSeriesWriter *writer);
+
+/**
+ * Flush and close
+ */
+int timeseries_close(TimeSeriesWriter *writer);
+
+/**
+ * Open a time-series file for reading
+ *
+ * @return 0 on success, -1 on error
+ */
+int timeseries_reader_open(TimeSeriesReader *reader, const char *path);
+
+/**
+ * Load the next chunk (of any table; see reader->table)
+ *
+ * @return Number of samples in the chunk, 0 at the end (or at a cut-off chunk)
+ */
+int timeseries_reader_next(TimeSeriesReader *reader);
+
+void timeseries_reader_close(TimeSeriesReader *reader);
+
+/**
+ * Index of a table by name, or -1
+ */
+int timeseries_find_table(const TimeSeriesReader *reader, const char *name);
+
+static inline ColumnValue timeseries_value(const TimeSeriesReader *reader, int column, int entity, int sample) {
+    const TimeSeriesTable *table = &reader->tables[reader->table];
+    return reader->data[((size_t)column * table->num_entities + entity) * reader->samples + sample];
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // TIMESERIES_H
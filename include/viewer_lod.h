@@ -0,0 +1,78 @@
+#ifndef VIEWER_LOD_H
+#define VIEWER_LOD_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include "gang.h"
+#include "target_catalog.h"
+
+/*
+ * Aggregate views the viewer draws instead of member cards once the
+ * population is too large to show member by member. Each view is a small
+ * image, one value in [0, 1] per cell, that the viewer uploads as a
+ * texture and stretches over a panel:
+ *
+ *   suspicion  rows of gangs x LOD_HIST_BINS, agents' suspicion from 0 to
+ *              the suspicion threshold (last bin: at or above it)
+ *   knowledge  rows of gangs x LOD_HIST_BINS, living members' knowledge
+ *   heat       rows of gangs x targets, the heat a gang would draw there
+ *   density    a near-square grid with one cell per gang, agents / alive
+ *
+ * Histogram rows are normalised to their fullest bin so every row shows
+ * its shape. With more gangs than LOD_MAX_ROWS, neighbouring gangs share
+ * a row.
+ */
+
+#define LOD_HIST_BINS 16
+#define LOD_MAX_ROWS 1024
+#define LOD_MEMBER_THRESHOLD 10000  // Members at which the viewer switches to aggregates
+
+enum { LOD_SUSPICION, LOD_KNOWLEDGE, LOD_HEAT, LOD_DENSITY, LOD_NUM_VIEWS };
+
+typedef struct {
+    int width;
+    int height;
+    float *values;      // [height][width], 0..1
+    uint32_t *pixels;   // Same cells as RGBA8, ready for a texture
+} LodImage;
+
+typedef struct {
+    int num_gangs;
+    int max_gang_size;
+    int num_targets;
+    int rows;           // Rows of the histogram and heat views
+    int gangs_per_row;
+    LodImage images[LOD_NUM_VIEWS];
+    float *scratch;     // One row's member values
+    int *bins;          // Their bin indices
+} LodViews;
+
+/**
+ * Allocate the views for a game of this shape
+ *
+ * @return 0 on success, -1 on error
+ */
+int lod_init(LodViews *lod, int num_gangs, int max_gang_size, int num_targets);
+
+/**
+ * Recompute every view from a copy of the gangs and their members
+ *
+ * @param suspicion_max Top of the suspicion histogram (the threshold)
+ */
+void lod_compute(LodViews *lod, const Gang *gangs, Member *const *gang_members,
+                 const TargetCatalog *catalog, float suspicion_max);
+
+void lod_free(LodViews *lod);
+
+static inline int lod_wanted(int num_gangs, int max_gang_size) {
+    return num_gangs * max_gang_size >= LOD_MEMBER_THRESHOLD;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // VIEWER_LOD_H
@@ -4,73 +4,82 @@
 
 #include "game.h"
 #include <fcntl.h>
+#include <spawn.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <sys/stat.h>
 #include "config.h"
 #include "unistd.h"
 
 #include "random.h"
 
+extern char **environ;
 
-#define MAX_PATH 128
-int game_init(Game *game, pid_t *processes, Config *cfg) {
+int game_init(const ShmPtrs *shm, pid_t *processes, Config *cfg, int headless) {
+    Game *game = shm->shared_game;
 
-    game->elapsed_time = 0;
-    game->num_thwarted_plans = 0;
-    game->num_successfull_plans = 0;
-    game->num_executed_agents = 0;
+    // A restored game carries on with the counters it was saved with
+    if (!game->checkpoint.restored) {
+        game->elapsed_time = 0;
+        game->num_thwarted_plans = 0;
+        game->num_successfull_plans = 0;
+        game->num_executed_agents = 0;
+    }
 
     // Note: Gang pointers are now handled in shared_mem_utils.c through ShmPtrs
 
+    // Police departments and gangs check in at the barrier; the viewer is
+    // read-only and doesn't hold up the game
+    if (startup_barrier_init(&game->startup, cfg->police_departments + (int)shm->directory->num_active) == -1) {
+        exit(EXIT_FAILURE);
+    }
+
     char *binary_paths[] = {
         POLICE_EXECUTABLE,
         GANG_EXECUTABLE,
         GRAPHICS_EXECUTABLE
     };
 
-    // police process (first in array)
-    processes[0] = start_process(binary_paths[0], cfg, -1);
+    // police departments (first in array), each sharing out the gangs
+    for (int d = 0; d < cfg->police_departments; d++) {
+        processes[d] = start_process(binary_paths[0], d);
+    }
     
-    // gang processes
-    for(int i = 0; i < cfg->num_gangs; i++) {
-        processes[i+1] = start_process(binary_paths[1], cfg, i);
-
+    // gang processes, one per active slot (a restored game may have gaps)
+    for(int i = 0; i < cfg->max_gangs; i++) {
+        if (gang_slot_active(shm->directory, i)) {
+            processes[cfg->police_departments + i] = start_process(binary_paths[1], i);
+        }
     }
 
-    // graphics process (at the end of the processes array)
-    processes[1 + cfg->num_gangs] = start_process(binary_paths[2], cfg, -1);
+    // graphics process (after the gang slots in the processes array)
+    if (!headless) {
+        processes[cfg->police_departments + cfg->max_gangs] = start_process(binary_paths[2], -1);
+    }
 
     return 0;
 }
-
     
 
 
-pid_t start_process(const char *binary, Config *cfg, int id) {
-    pid_t pid = fork();
-    if (pid == -1) {
-        perror("fork");
-        exit(EXIT_FAILURE);
-    }
-
-    if (pid == 0) {
-        // Now pass two arguments: shared memory fd and GUI pid.
-        // Convert fd to string
-
-        // serialize config to a string
-        char config_buffer[MAX_PATH];
-        char id_buffer[10];
-        snprintf(id_buffer, sizeof(id_buffer), "%d", id);
-        serialize_config(cfg, config_buffer);
-
-
-        if (execl(binary, binary, config_buffer, id_buffer, NULL) == -1) {
+// posix_spawn doesn't copy the parent's page tables the way fork does, so
+// launching a hundred gangs costs little more than launching one
+pid_t start_process(const char *binary, int id) {
+    // Children read the config from shared memory, so only the ID is passed
+    char id_buffer[12];
+    snprintf(id_buffer, sizeof(id_buffer), "%d", id);
+    char *argv[] = {(char *)binary, id_buffer, NULL};
+    return start_process_argv(argv);
+}
 
-            printf("%s\n", binary);
-            perror("execl failed");
-            exit(EXIT_FAILURE);
-        }
+// Helpers that take options of their own (the recorder) get a full argv
+pid_t start_process_argv(char *const argv[]) {
+    pid_t pid;
+    int err = posix_spawn(&pid, argv[0], NULL, NULL, argv, environ);
+    if (err != 0) {
+        fprintf(stderr, "posix_spawn %s failed: %s\n", argv[0], strerror(err));
+        exit(EXIT_FAILURE);
     }
     return pid;
 }
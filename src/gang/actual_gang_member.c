@@ -1,5 +1,7 @@
+#include <errno.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <time.h>
 #include <unistd.h> // For sleep()
 #include "actual_gang_member.h"
 #include "gang.h" // For Member struct
@@ -8,11 +10,29 @@
 #include "target_selection.h"
 #include "secret_agent_utils.h" // For secret agent functionality
 #include "message.h" // For message handling
+#include "random.h"
 
 extern ShmPtrs shm_ptrs;
 extern int highest_rank_member_id;
 extern volatile int should_terminate; // Flag for clean termination
-extern int police_msgq_id; // Message queue for police communication
+
+// True while the gang's main thread is parked for a checkpoint
+static int gang_parking(const CheckpointControl *checkpoint, const Gang *gang) {
+    return checkpoint_requested(checkpoint) && __atomic_load_n(&gang->parking, __ATOMIC_ACQUIRE);
+}
+
+// Sleep for seconds, or until the gang's main thread parks for a checkpoint
+static void member_nap(const CheckpointControl *checkpoint, Gang *gang, int seconds) {
+    struct timespec deadline;
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    deadline.tv_sec += seconds;
+
+    pthread_mutex_lock(&gang->gang_mutex);
+    while (!gang_parking(checkpoint, gang) && !should_terminate &&
+           pthread_cond_timedwait(&gang->plan_execute_cond, &gang->gang_mutex, &deadline) != ETIMEDOUT) {
+    }
+    pthread_mutex_unlock(&gang->gang_mutex);
+}
 
 void* actual_gang_member_thread_function(void* arg) {
     printf("Gang member thread started\n");
@@ -21,11 +41,19 @@ void* actual_gang_member_thread_function(void* arg) {
     Member *member = thread_args->member;
     Config *config = thread_args->config;
     Gang *gang = &shm_ptrs.gangs[member->gang_id];
+    CheckpointControl *checkpoint = &shm_ptrs.shared_game->checkpoint;
+    int restored = gang->restored && !thread_args->recruited;
+    if (restored) {
+        random_load_thread(&member->rng);
+    } else {
+        random_seed_thread(member->gang_id, member->member_id);
+    }
     printf("Gang member %d in gang %d started\n", member->member_id, member->gang_id);
     fflush(stdout);
     
     // Initialize secret agent attributes if this member is an agent
-    if (member->agent_id >= 0) {
+    // (a restored member already has them, as well as the gang's target)
+    if (member->agent_id >= 0 && !restored) {
         secret_agent_init(&shm_ptrs, member);
         printf("Gang %d, Member %d: Initialized as secret agent with ID %d\n", 
                member->gang_id, member->member_id, member->agent_id);
@@ -33,19 +61,20 @@ void* actual_gang_member_thread_function(void* arg) {
     }
     
     // Check if this is the highest-ranked member in the gang
-    if (member->member_id == highest_rank_member_id) {
+    if (member->member_id == highest_rank_member_id && !restored) {
         printf("Gang %d: Member %d is the highest-ranked member (rank %d) - selecting target\n",
                member->gang_id, member->member_id, member->rank);
         fflush(stdout);
         
         // Let the highest-ranked member select a target
-        TargetType selected_target = select_target(shm_ptrs.shared_game, gang, shm_ptrs.gang_members[member->gang_id], highest_rank_member_id);
+        int selected_target = select_target(shm_ptrs.catalog, gang, shm_members(&shm_ptrs, member->gang_id), highest_rank_member_id);
         
         // Set preparation parameters based on the selected target
         set_preparation_parameters(gang, selected_target, NULL); // We'll need to pass config later
         
         // Reset all members' preparation levels
-        reset_preparation_levels(gang, shm_ptrs.gang_members[member->gang_id]);
+        reset_preparation_levels(gang, shm_members(&shm_ptrs, member->gang_id));
+        gang_touch(gang);
         
         printf("Gang %d: Target selected by highest-ranked member, type: %d, prep time: %d, prep level: %d\n",
                member->gang_id, gang->target_type, gang->prep_time, gang->prep_level);
@@ -56,19 +85,33 @@ void* actual_gang_member_thread_function(void* arg) {
            member->gang_id, member->member_id);
     fflush(stdout);
     
+    // A member restored in the middle of preparing carries on with it
+    int resume_preparation = restored && member->preparing;
+
     // Regular member behavior - loop for multiple plans
     while (!should_terminate) {
-        // Wait for new plan to start
+        // Park for a checkpoint once the gang's main thread has
+        if (gang_parking(checkpoint, gang)) {
+            checkpoint_park(checkpoint, &member->rng);
+            continue;
+        }
+
+        // Wait for new plan to start; the main thread wakes us when it does,
+        // and when it parks for a checkpoint
         pthread_mutex_lock(&gang->gang_mutex);
-        while (!gang->plan_in_progress && gang->members_ready == 0 && !should_terminate) {
+        if (!gang->plan_in_progress && gang->members_ready == 0) {
             printf("Gang %d, Member %d: Waiting for new plan to start\n", 
                    member->gang_id, member->member_id);
             fflush(stdout);
-            pthread_mutex_unlock(&gang->gang_mutex);
-            sleep(1);
-            pthread_mutex_lock(&gang->gang_mutex);
+        }
+        while (!gang->plan_in_progress && gang->members_ready == 0 && !should_terminate &&
+               !gang_parking(checkpoint, gang)) {
+            pthread_cond_wait(&gang->plan_execute_cond, &gang->gang_mutex);
         }
         pthread_mutex_unlock(&gang->gang_mutex);
+        if (gang_parking(checkpoint, gang)) {
+            continue;
+        }
         
         // Check termination flag before starting new plan
         if (should_terminate) {
@@ -79,23 +122,29 @@ void* actual_gang_member_thread_function(void* arg) {
         }
         
         // Reset member's preparation for new plan
-        member->prep_contribution = 0;
+        if (resume_preparation) {
+            resume_preparation = 0;
+        } else {
+            member->prep_contribution = 0;
+        }
+        gang_touch(gang);
         printf("Gang %d, Member %d: Starting preparation for new plan\n", 
                member->gang_id, member->member_id);
         fflush(stdout);
         
         // Preparation phase for this plan
+        member->preparing = true;
         while (1) {
             // Secret agent specific activities during preparation
             if (member->agent_id >= 0) {
                 // Secret agents gather information by asking other gang members
                 // Randomly select another gang member to ask about the plan
-                if (gang->num_alive_members > 1 && rand() % 4 == 0) { // 25% chance per iteration
-                    int target_member_id = rand() % gang->max_member_count;
+                if (gang->num_alive_members > 1 && random_int(0, 3) == 0) { // 25% chance per iteration
+                    int target_member_id = random_int(0, gang->max_member_count - 1);
                     if (target_member_id != member->member_id && 
-                        shm_ptrs.gang_members[member->gang_id][target_member_id].is_alive) {
+                        shm_members(&shm_ptrs, member->gang_id)[target_member_id].is_alive) {
                         
-                        Member* target_member = &shm_ptrs.gang_members[member->gang_id][target_member_id];
+                        Member* target_member = &shm_members(&shm_ptrs, member->gang_id)[target_member_id];
                         
                         printf("Gang %d, Agent %d: Asking member %d for information\n",
                                member->gang_id, member->member_id, target_member_id);
@@ -110,33 +159,34 @@ void* actual_gang_member_thread_function(void* arg) {
                         
                         printf("Gang %d, Agent %d: Information gathering complete, knowledge: %.2f, suspicion: %.2f\n",
                                member->gang_id, member->member_id, 
-                               shm_ptrs.gang_members[member->gang_id][member->member_id].knowledge,
-                               shm_ptrs.gang_members[member->gang_id][member->member_id].suspicion);
+                               shm_members(&shm_ptrs, member->gang_id)[member->member_id].knowledge,
+                               shm_members(&shm_ptrs, member->gang_id)[member->member_id].suspicion);
                         fflush(stdout);
                     }
                 }
                 
-                // Handle police communication for secret agents
+                // Secret agents leave their latest knowledge for the police
                 if (member->agent_id >= 0) {
-                    // Handle police requests for knowledge reporting
-                    secret_agent_handle_police_requests(member, shm_ptrs.shared_game, police_msgq_id, 
-                                                       member->gang_id, gang, *config);
-                    
-                    // Send periodic communication to police
-                    secret_agent_periodic_communication(&shm_ptrs, member, shm_ptrs.shared_game, 
-                                                       police_msgq_id, member->gang_id, gang, *config);
+                    secret_agent_periodic_communication(&shm_ptrs, member, shm_ptrs.shared_game, gang, *config);
                 }
             }
             
             // Simulate member contributing to preparation
-            member->prep_contribution += rand() % 10;
+            member->prep_contribution += random_int(0, 9);
+            gang_touch(gang);
             
             printf("Gang %d, Member %d: Preparation contribution now %d\n", 
                    member->gang_id, member->member_id, member->prep_contribution);
             fflush(stdout);
             
             // Sleep for a random time (1-3 seconds)
-            sleep(rand() % 3 + 1);
+            member_nap(checkpoint, gang, random_int(1, 3));
+
+            // The main thread parks between plans or while it waits for the
+            // preparation; either way the member can park here and carry on
+            if (gang_parking(checkpoint, gang)) {
+                checkpoint_park(checkpoint, &member->rng);
+            }
             
             // Check if preparation is complete
             if (member->prep_contribution >= gang->prep_level) {
@@ -156,6 +206,7 @@ void* actual_gang_member_thread_function(void* arg) {
                 
                 // Increment ready members count
                 gang->members_ready++;
+                gang_touch(gang);
                 printf("Gang %d: Member %d is ready. %d/%d members ready\n", 
                        gang->gang_id, member->member_id, gang->members_ready, gang->num_alive_members);
                 fflush(stdout);
@@ -175,8 +226,18 @@ void* actual_gang_member_thread_function(void* arg) {
                            gang->gang_id, member->member_id);
                     fflush(stdout);
                     
-                    // Wait for plan execution result from main thread
-                    pthread_cond_wait(&gang->plan_execute_cond, &gang->gang_mutex);
+                    // Wait for plan execution result from main thread. The
+                    // main thread can park for a checkpoint before the last
+                    // members are ready; the member parks here, still ready.
+                    while (gang->plan_success == 0) {
+                        if (gang_parking(checkpoint, gang)) {
+                            pthread_mutex_unlock(&gang->gang_mutex);
+                            checkpoint_park(checkpoint, &member->rng);
+                            pthread_mutex_lock(&gang->gang_mutex);
+                            continue;
+                        }
+                        pthread_cond_wait(&gang->plan_execute_cond, &gang->gang_mutex);
+                    }
                 }
                 
                 // React to plan success or failure
@@ -187,6 +248,7 @@ void* actual_gang_member_thread_function(void* arg) {
                     // Gain extra rank for successful plan completion
                     member->rank += 2;
                     update_member_xp(member);
+                    gang_touch(gang);
                     printf("Gang %d: Member %d gained 2 ranks for successful plan! Now has Rank %d (XP: %d)\n",
                            gang->gang_id, member->member_id, member->rank, member->XP);
                     fflush(stdout);
@@ -220,11 +282,13 @@ void* actual_gang_member_thread_function(void* arg) {
             }
         }
         
+        member->preparing = false;
+
         // Short rest between plans
         printf("Gang %d, Member %d: Resting before next plan\n", 
                member->gang_id, member->member_id);
         fflush(stdout);
-        sleep(1);
+        member_nap(checkpoint, gang, 1);
     }
     
     return NULL; // Return properly
@@ -4,6 +4,7 @@
 
 #include <stdlib.h>
 #include <stdio.h>
+#include <time.h>
 #include <sys/mman.h>
 #include <signal.h>
 #include <pthread.h>
@@ -20,6 +21,8 @@
 #include "random.h"  // For random number generation
 #include "message.h"  // For message queue communication
 #include "secret_agent_utils.h"  // For secret agent functions
+#include "journal.h"
+#include "timer_wheel.h"
 
 Game *shared_game = NULL;
 ShmPtrs shm_ptrs;
@@ -29,39 +32,124 @@ int highest_rank_member_id = -1;
 volatile int should_terminate = 0; // Flag for clean termination
 int police_msgq_id = -1; // Message queue for police communication
 static int global_agent_id_counter = 0; // Global counter for unique agent IDs
+static TimerWheel gang_timers;   // The gang's timers, in game time units
+static TimerNode spread_timer;   // Next information spreading session
 
 void cleanup();
 void handle_sigint(int signum);
 void handle_police_handshake(int gang_id, const Config* config);
+void init_gang_members(int gang_id, const Config *config);
+static void init_members(int gang_id, int first, int last, const Config *config);
+static void start_member_threads(int first, int last, ThreadArgs *thread_args, Config *config, int recruited);
+static void recruit_members(int gang_id, int wanted, Config *config, ThreadArgs *thread_args);
+
+// How often the main thread looks for a checkpoint request while it waits
+#define CHECKPOINT_POLL_MS 100
+
+// Park the main thread for a checkpoint; the members follow as they come to
+// their own park points, woken if they wait on the gang
+static void park_gang(void) {
+    pthread_mutex_lock(&gang->gang_mutex);
+    __atomic_store_n(&gang->parking, 1, __ATOMIC_RELEASE);
+    pthread_cond_broadcast(&gang->plan_execute_cond);
+    pthread_mutex_unlock(&gang->gang_mutex);
+    checkpoint_park(&shared_game->checkpoint, &gang->rng);
+    __atomic_store_n(&gang->parking, 0, __ATOMIC_RELEASE);
+}
+
+// Rest between plans, cut short by a checkpoint request
+static void gang_nap(int seconds) {
+    for (int slept = 0; slept < seconds * 1000 && !should_terminate &&
+                        !checkpoint_requested(&shared_game->checkpoint); slept += CHECKPOINT_POLL_MS) {
+        usleep(CHECKPOINT_POLL_MS * 1000);
+    }
+}
+
+// Time the next information spreading session from the last one
+static void arm_information_spreading(void) {
+    int due = gang->last_info_spread_time + gang->info_spread_interval;
+    timer_arm(&gang_timers, &spread_timer, due > (int)gang_timers.now ? (uint64_t)(due - (int)gang_timers.now) : 0);
+}
+
+// Spread at the end of the plan the session fell due in; arg is that time
+static void information_spreading_due(TimerNode *timer, void *arg) {
+    (void)timer;
+    int current_time = *(const int *)arg;
+    spread_information_in_gang(gang, members, current_time, highest_rank_member_id);
+    arm_information_spreading();
+}
+
+// Members per initialization chunk. Each chunk draws from its own stream, so
+// the result doesn't depend on how many threads share the work.
+#define MEMBER_INIT_CHUNK 4096
+
+// Set up means and standard deviations for attributes
+static const float attribute_means[NUM_ATTRIBUTES] = {
+    0.5f,  // ATTR_SMARTNESS - centered around 0.5
+    0.5f,  // ATTR_STEALTH - centered around 0.5
+    0.5f,  // ATTR_STRENGTH - centered around 0.5
+    0.4f,  // ATTR_TECH_SKILLS - slightly lower mean
+    0.6f,  // ATTR_BRAVERY - slightly higher mean
+    0.5f,  // ATTR_NEGOTIATION - centered around 0.5
+    0.5f   // ATTR_NETWORKING - centered around 0.5
+};
+
+static const float attribute_stddevs[NUM_ATTRIBUTES] = {
+    0.15f,  // ATTR_SMARTNESS
+    0.15f,  // ATTR_STEALTH
+    0.15f,  // ATTR_STRENGTH
+    0.20f,  // ATTR_TECH_SKILLS - more variance
+    0.15f,  // ATTR_BRAVERY
+    0.15f,  // ATTR_NEGOTIATION
+    0.15f   // ATTR_NETWORKING
+};
+
+// Define correlation matrix between attributes
+// For example, smartness correlates with tech skills, strength with bravery, etc.
+static const float attribute_correlation[NUM_ATTRIBUTES][NUM_ATTRIBUTES] = {
+    // SMARTNESS  STEALTH    STRENGTH   TECH       BRAVERY    NEGOTIATION NETWORKING
+    {  0.2f,      0.0f,      0.0f,      0.0f,      0.0f,      0.0f,      0.0f  }, // SMARTNESS
+    {  0.1f,      0.2f,      0.0f,      0.0f,      0.0f,      0.0f,      0.0f  }, // STEALTH
+    {  0.0f,      0.0f,      0.2f,      0.0f,      0.0f,      0.0f,      0.0f  }, // STRENGTH
+    {  0.15f,     0.1f,      0.0f,      0.2f,      0.0f,      0.0f,      0.0f  }, // TECH_SKILLS
+    {  0.0f,      0.0f,      0.15f,     0.0f,      0.2f,      0.0f,      0.0f  }, // BRAVERY
+    {  0.1f,      0.0f,      0.0f,      0.0f,      0.0f,      0.2f,      0.0f  }, // NEGOTIATION
+    {  0.1f,      0.0f,      0.0f,      0.0f,      0.1f,      0.15f,     0.2f  }  // NETWORKING
+};
+
+typedef struct {
+    int gang_id;
+    int first_chunk;
+    int chunk_step;
+    const Config *config;
+} MemberInitArgs;
 
 int main(int argc, char *argv[]) {
+    uint64_t exec_ns = startup_now_ns();
     printf("Gang process starting...\n");
     fflush(stdout);
 
-    if(argc != 3) {
-        fprintf(stderr, "Usage: %s <serialized_config> <gang_id>\n", argv[0]);
+    if(argc != 2) {
+        fprintf(stderr, "Usage: %s <gang_id>\n", argv[0]);
         exit(EXIT_FAILURE);
     }
-    
-    // Load configuration from serialized string
-    Config config;
-
-    // Deserialize the config from the provided string
-    deserialize_config(argv[1], &config);
-
-    int gang_id = atoi(argv[2]);
-
-
 
+    int gang_id = atoi(argv[1]);
 
+    // Gang process is a user of shared memory, not the owner; the config
+    // comes from the block main published there
+    Config config;
+    shared_game = setup_shared_memory_user(&config, &shm_ptrs);
+    uint64_t attach_ns = startup_now_ns();
 
-    // validate gang ID - check against actual number of gangs, not max possible
-    if (gang_id < 0 || gang_id >= config.num_gangs) {
-        fprintf(stderr, "Invalid gang ID: %d (num_gangs: %d, max_gangs: %d)\n", gang_id, config.num_gangs, config.max_gangs);
+    // validate gang ID - main spawns a gang only on a slot it made active
+    if (!gang_slot_active(shm_ptrs.directory, gang_id)) {
+        fprintf(stderr, "Invalid gang ID: %d (not an active slot, max_gangs: %d)\n", gang_id, config.max_gangs);
         exit(EXIT_FAILURE);
     }
     
-    printf("Gang %d: Validation passed (num_gangs: %d, max_gangs: %d)\n", gang_id, config.num_gangs, config.max_gangs);
+    printf("Gang %d: Validation passed (%u gangs running, max_gangs: %d)\n",
+           gang_id, shm_ptrs.directory->num_active, config.max_gangs);
     fflush(stdout);
 
     atexit(cleanup);
@@ -73,15 +161,13 @@ int main(int argc, char *argv[]) {
         exit(EXIT_FAILURE);
     }
 
-    // Initialize random number generator for this process
-    init_random();
+    // Initialize random number generator for this process; the gang's main
+    // thread uses the (gang, -1) stream, member threads seed their own
+    init_random_seeded(config.random_seed, RANDOM_PROC_GANG);
+    random_seed_thread(gang_id, -1);
     printf("Gang %d: Random number generator initialized\n", gang_id);
     fflush(stdout);
 
-    // Gang process is a user of shared memory, not the owner
-    shared_game = setup_shared_memory_user(&config, &shm_ptrs);
-    shm_ptrs.shared_game = shared_game;
-
     // Print the base address of shared memory for debugging
     printf("Gang %d: Shared memory mapped at %p\n", gang_id, (void*)shared_game);
     fflush(stdout);
@@ -89,8 +175,13 @@ int main(int argc, char *argv[]) {
     // Assign gang struct using ShmPtrs
     gang = &shm_ptrs.gangs[gang_id];
     
-    // Set up local pointer to this gang's members
-    members = shm_ptrs.gang_members[gang_id];
+    // Set up local pointer to this gang's members; only this gang's segment
+    // is mapped, at its limit, so the pointer holds while the gang grows
+    if (shm_map_gang(&shm_ptrs, gang_id) == -1) {
+        fprintf(stderr, "Gang %d: Failed to map the member segment\n", gang_id);
+        exit(EXIT_FAILURE);
+    }
+    members = shm_members(&shm_ptrs, gang_id);
     
     printf("Gang %d: Gang struct at %p, Members array at %p\n", 
            gang_id, (void*)gang, (void*)members);
@@ -99,161 +190,145 @@ int main(int argc, char *argv[]) {
     // Update gang_id in shared memory
     gang->gang_id = gang_id;
     gang->pid = getpid();
+    startup_mark(&shared_game->startup, &gang->startup, STARTUP_EXEC, exec_ns);
+    startup_mark(&shared_game->startup, &gang->startup, STARTUP_ATTACH, attach_ns);
 
-    // Set up message queue for police communication
-    police_msgq_id = create_message_queue(POLICE_GANG_KEY);
+    // A restored gang already has its members; it picks up where it was parked
+    int restored = gang->restored;
+    if (restored) {
+        random_load_thread(&gang->rng);
+    }
+
+    // Main created the gang's queue with the slot; the police and the agents
+    // talk to this gang only on it
+    police_msgq_id = gang->msgq_id;
     if (police_msgq_id == -1) {
-        fprintf(stderr, "Gang %d: Failed to create/access message queue\n", gang_id);
+        fprintf(stderr, "Gang %d: No message queue was created for the gang\n", gang_id);
         exit(EXIT_FAILURE);
     }
     printf("Gang %d: Message queue initialized (ID: %d)\n", gang_id, police_msgq_id);
     fflush(stdout);
+    if (journal_attach(&shared_game->journal_seq, &shared_game->elapsed_time) == -1) {
+        exit(EXIT_FAILURE);
+    }
+    startup_mark(&shared_game->startup, &gang->startup, STARTUP_IPC, startup_now_ns());
 
     // Initialize synchronization primitives
     pthread_mutex_init(&gang->gang_mutex, NULL);
     pthread_cond_init(&gang->prep_complete_cond, NULL); // once all members are ready
     pthread_cond_init(&gang->plan_execute_cond, NULL); // gang main thread computes success rate
     
-    // Initialize plan status variables
-    gang->members_ready = 0;
-    gang->plan_success = 0; // 0 = not determined
-    gang->plan_in_progress = 1; // Start with first plan in progress
-    gang->current_success_rate = 0.0f; // Initialize success rate
+    // Initialize plan status variables (a restored gang keeps the state of
+    // the plan boundary it was parked at)
+    if (!restored) {
+        gang->members_ready = 0;
+        gang->plan_success = 0; // 0 = not determined
+        gang->plan_in_progress = 1; // Start with first plan in progress
+        gang->current_success_rate = 0.0f; // Initialize success rate
+    }
 
 
     printf("Gang %d process started...\n", gang_id);
     fflush(stdout);
 
-    printf("gang 0 member count %d\n", shm_ptrs.gangs[0].max_member_count);
-    fflush(stdout);
-    
-    printf("Gang %d: About to initialize %d members\n", gang_id, gang->max_member_count);
-    fflush(stdout);
-    
-    // Initialize gang members
-    for(int i = 0; i < gang->max_member_count; i++) {
-        printf("Gang %d: Initializing member %d basic properties\n", gang_id, i);
+    if (restored) {
+        // Agent IDs continue after the highest one handed out before the checkpoint
+        highest_rank_member_id = gang->leader_id;
+        for (int i = 0; i < gang->max_member_count; i++) {
+            if (members[i].agent_id + 1 > global_agent_id_counter) {
+                global_agent_id_counter = members[i].agent_id + 1;
+            }
+        }
+        printf("Gang %d: Restored %d members (%d alive, %d agents)\n",
+               gang_id, gang->max_member_count, gang->num_alive_members, gang->num_agents);
         fflush(stdout);
-        
-        members[i].gang_id = gang_id;
-        members[i].member_id = i;
-        // Randomly assign rank first (0 to num_ranks-1)
-        members[i].rank = rand() % config.num_ranks;
-        // Calculate XP from rank using the formula: XP = rank^2
-        members[i].XP = calculate_xp_from_rank(members[i].rank);
-        members[i].prep_contribution = 0;
-        members[i].agent_id = -1;
-        members[i].knowledge = 0.0f;
-        members[i].suspicion = 0.0f;
-        members[i].faithfulness = 0.0f;
-        members[i].is_alive = true;
-        
-        printf("Gang %d, Member %d: Rank=%d, XP=%d\n", gang_id, i, members[i].rank, members[i].XP);
+    } else {
+        printf("Gang %d: About to initialize %d members\n", gang_id, gang->max_member_count);
         fflush(stdout);
 
-        // Set up means and standard deviations for attributes
-        float means[NUM_ATTRIBUTES] = {
-            0.5f,  // ATTR_SMARTNESS - centered around 0.5
-            0.5f,  // ATTR_STEALTH - centered around 0.5
-            0.5f,  // ATTR_STRENGTH - centered around 0.5
-            0.4f,  // ATTR_TECH_SKILLS - slightly lower mean
-            0.6f,  // ATTR_BRAVERY - slightly higher mean
-            0.5f,  // ATTR_NEGOTIATION - centered around 0.5
-            0.5f   // ATTR_NETWORKING - centered around 0.5
-        };
-        
-        float stddevs[NUM_ATTRIBUTES] = {
-            0.15f,  // ATTR_SMARTNESS
-            0.15f,  // ATTR_STEALTH
-            0.15f,  // ATTR_STRENGTH
-            0.20f,  // ATTR_TECH_SKILLS - more variance
-            0.15f,  // ATTR_BRAVERY
-            0.15f,  // ATTR_NEGOTIATION
-            0.15f   // ATTR_NETWORKING
-        };
-        
-        // Define correlation matrix between attributes
-        // For example, smartness correlates with tech skills, strength with bravery, etc.
-        float correlation_matrix[NUM_ATTRIBUTES][NUM_ATTRIBUTES] = {
-            // SMARTNESS  STEALTH    STRENGTH   TECH       BRAVERY    NEGOTIATION NETWORKING
-            {  0.2f,      0.0f,      0.0f,      0.0f,      0.0f,      0.0f,      0.0f  }, // SMARTNESS
-            {  0.1f,      0.2f,      0.0f,      0.0f,      0.0f,      0.0f,      0.0f  }, // STEALTH
-            {  0.0f,      0.0f,      0.2f,      0.0f,      0.0f,      0.0f,      0.0f  }, // STRENGTH
-            {  0.15f,     0.1f,      0.0f,      0.2f,      0.0f,      0.0f,      0.0f  }, // TECH_SKILLS
-            {  0.0f,      0.0f,      0.15f,     0.0f,      0.2f,      0.0f,      0.0f  }, // BRAVERY
-            {  0.1f,      0.0f,      0.0f,      0.0f,      0.0f,      0.2f,      0.0f  }, // NEGOTIATION
-            {  0.1f,      0.0f,      0.0f,      0.0f,      0.1f,      0.15f,     0.2f  }  // NETWORKING
-        };
-        
-        // Generate attributes using multivariate Gaussian distribution
-        printf("Gang %d: Generating correlated attributes for member %d\n", gang_id, i);
-        fflush(stdout);
-        generate_multivariate_attributes(members[i].attributes, means, stddevs, correlation_matrix);
-        
-        // Initialize member knowledge for information spreading
-        initialize_member_knowledge(&members[i], members[i].rank, config.num_ranks - 1);
-        
-        printf("Gang %d: Member %d initialized successfully\n", gang_id, i);
-        fflush(stdout);
-    }
-    
-    // Initialize gang-level information spreading parameters
-    gang->last_info_spread_time = 0;
-    gang->info_spread_interval = random_int(3, 8); // Initial random interval
-    gang->leader_misinformation_chance = random_float(0.05f, 0.20f); // 5-20% chance of misinformation
-    
-    printf("Gang %d: Information spreading initialized - interval: %d, leader misinformation chance: %.2f\n",
-           gang_id, gang->info_spread_interval, gang->leader_misinformation_chance);
-    fflush(stdout);
-    
-    // Find the member with the highest rank - but don't select target here
-    // Target selection will happen in the highest-ranked member's thread
-    highest_rank_member_id = find_highest_ranked_member(gang, members);
-    if (highest_rank_member_id >= 0) {
-        printf("Gang %d highest ranked member is member %d with rank %d\n", 
-            gang_id, highest_rank_member_id, members[highest_rank_member_id].rank);
-        fflush(stdout);
-        
-        // make the highest ranked member have the highest rank
-        members[highest_rank_member_id].rank = config.num_ranks - 1;
-        
-        printf("Gang %d: Updated highest ranked member %d to rank %d\n", 
-            gang_id, highest_rank_member_id, members[highest_rank_member_id].rank);
+        init_gang_members(gang_id, &config);
+
+        printf("Gang %d: %d members initialized\n", gang_id, gang->max_member_count);
         fflush(stdout);
-    } else {
-        printf("Gang %d has no members to select a target\n", gang_id);
+
+        // Initialize gang-level information spreading parameters
+        gang->last_info_spread_time = 0;
+        gang->info_spread_interval = random_int(3, 8); // Initial random interval
+        gang->leader_misinformation_chance = random_float(0.05f, 0.20f); // 5-20% chance of misinformation
+
+        printf("Gang %d: Information spreading initialized - interval: %d, leader misinformation chance: %.2f\n",
+               gang_id, gang->info_spread_interval, gang->leader_misinformation_chance);
         fflush(stdout);
-    }
 
-    // Create threads for all gang members
-    ThreadArgs* thread_args = malloc(gang->max_member_count * sizeof(ThreadArgs));
-    for(int i = 0; i < gang->max_member_count; i++) {
-        // Set up thread arguments with both member and config
-        thread_args[i].member = &members[i];
-        thread_args[i].config = &config;
-        
-        // Create thread for each member
-        int ret;
-        pthread_t thread_id;
-        
-        printf("Creating gang member thread %d\n", i);
-        ret = pthread_create(&thread_id, NULL, actual_gang_member_thread_function, &thread_args[i]);
-        
-        members[i].thread = thread_id;
+        // Find the member with the highest rank - but don't select target here
+        // Target selection will happen in the highest-ranked member's thread
+        highest_rank_member_id = find_highest_ranked_member(gang, members);
+        if (highest_rank_member_id >= 0) {
+            printf("Gang %d highest ranked member is member %d with rank %d\n", 
+                gang_id, highest_rank_member_id, members[highest_rank_member_id].rank);
+            fflush(stdout);
 
-        if (ret != 0) {
-            fprintf(stderr, "Failed to create thread: %d\n", ret);
+            // make the highest ranked member have the highest rank
+            members[highest_rank_member_id].rank = config.num_ranks - 1;
+
+            printf("Gang %d: Updated highest ranked member %d to rank %d\n", 
+                gang_id, highest_rank_member_id, members[highest_rank_member_id].rank);
+            fflush(stdout);
+        } else {
+            printf("Gang %d has no members to select a target\n", gang_id);
+            fflush(stdout);
         }
-        fflush(stdout); // Make sure we see the debug output
+        gang->leader_id = highest_rank_member_id;
     }
+    startup_mark(&shared_game->startup, &gang->startup, STARTUP_INIT, startup_now_ns());
+
+    // Members start planning only once police and all other gangs are up
+    startup_arrive_and_wait(&shared_game->startup, &gang->startup);
+
+    // The main thread and every member thread park for checkpoints
+    gang->parking = 0;
+    gang->checkpoint_threads = 1 + gang->max_member_count;
+    checkpoint_register(&shared_game->checkpoint, gang->checkpoint_threads);
+
+    // Create threads for all gang members; recruits get theirs later
+    ThreadArgs* thread_args = malloc(config.gang_size_limit * sizeof(ThreadArgs));
+    start_member_threads(0, gang->max_member_count, thread_args, &config, 0);
+    printf("Gang %d: Created %d member threads\n", gang_id, gang->max_member_count);
+    fflush(stdout);
+
+    // Between plans the gang's timers are turned to the game time
+    int current_time = shared_game->elapsed_time;
+    timer_wheel_init(&gang_timers, (uint64_t)current_time);
+    timer_init(&spread_timer, information_spreading_due, &current_time);
+    arm_information_spreading();
 
 
 
     // Main gang loop - execute multiple plans
     printf("Gang %d: Starting main gang loop for multiple plans\n", gang_id);
     fflush(stdout);
-    
+
+    int plan = gang->num_successful_plans + gang->num_thwarted_plans;
     while (!should_terminate) {
+        // Between plans the gang can be parked for a checkpoint; the members
+        // park too as they come back from the last plan
+        if (checkpoint_requested(&shared_game->checkpoint)) {
+            park_gang();
+        }
+
+        // Between plans is a safe point to pick up a reloaded config
+        if (config_refresh(&shared_game->config_block, &config, &shm_ptrs.config_generation)) {
+            printf("Gang %d: Config reloaded (generation %u)\n", gang_id, shm_ptrs.config_generation);
+            fflush(stdout);
+        }
+
+        // ...and to leave when main retires the gang
+        if (__atomic_load_n(&gang->retiring, __ATOMIC_ACQUIRE)) {
+            printf("Gang %d: Retired by main, leaving after %d plans\n", gang_id, plan);
+            fflush(stdout);
+            exit(0);
+        }
+
         // Handle police handshake messages for agent planting
         handle_police_handshake(gang_id, &config);
         // Reset for next plan
@@ -265,8 +340,11 @@ int main(int argc, char *argv[]) {
         
         // Reset preparation levels for new plan
         reset_preparation_levels(gang, members);
+        gang_touch(gang);
         printf("Gang %d: Starting new plan preparation\n", gang_id);
         fflush(stdout);
+        // Wake the members waiting for it
+        pthread_cond_broadcast(&gang->plan_execute_cond);
         pthread_mutex_unlock(&gang->gang_mutex);
         
         // Main thread waits for preparation and determines plan success
@@ -276,18 +354,35 @@ int main(int argc, char *argv[]) {
         // Use condition variable to wait for all members to be ready
         pthread_mutex_lock(&gang->gang_mutex);
         
-        // Wait until all members are ready
+        // Wait until all members are ready. A checkpoint doesn't wait for
+        // the preparation: the main thread parks here, and the members where
+        // they are (a restored gang starts the plan over).
+        int reported_ready = -1;
         while (gang->members_ready < gang->num_alive_members) {
-            printf("Gang %d: Main thread waiting for members to complete preparation (%d/%d ready)\n", 
-                   gang_id, gang->members_ready, gang->num_alive_members);
-            fflush(stdout);
-            
-            // Wait for the condition that all members are ready
-            // This releases the mutex while waiting and reacquires it when signaled
-            pthread_cond_wait(&gang->prep_complete_cond, &gang->gang_mutex);
-            
-            // When pthread_cond_wait returns, we own the mutex again
-            // The loop will check the condition again
+            if (gang->members_ready != reported_ready) {
+                reported_ready = gang->members_ready;
+                printf("Gang %d: Main thread waiting for members to complete preparation (%d/%d ready)\n", 
+                       gang_id, gang->members_ready, gang->num_alive_members);
+                fflush(stdout);
+            }
+
+            if (checkpoint_requested(&shared_game->checkpoint)) {
+                pthread_mutex_unlock(&gang->gang_mutex);
+                park_gang();
+                pthread_mutex_lock(&gang->gang_mutex);
+                continue;
+            }
+
+            // Wait for the condition that all members are ready, looking
+            // for a checkpoint request now and then
+            struct timespec poll;
+            clock_gettime(CLOCK_REALTIME, &poll);
+            poll.tv_nsec += CHECKPOINT_POLL_MS * 1000000L;
+            if (poll.tv_nsec >= 1000000000L) {
+                poll.tv_sec++;
+                poll.tv_nsec -= 1000000000L;
+            }
+            pthread_cond_timedwait(&gang->prep_complete_cond, &gang->gang_mutex, &poll);
         }
         
         // At this point we have the mutex locked and all members are ready
@@ -298,6 +393,20 @@ int main(int argc, char *argv[]) {
         // All members are ready, calculate if the plan succeeds
         printf("Gang %d: Main thread detected all members ready - calculating success rate\n", gang_id);
         fflush(stdout);
+
+        // What the members left behind is the outcome of the thread
+        // interleaving; with the stream it determines the rest of the boundary
+        JournalPlan journal_plan;
+        if (journal_enabled()) {
+            journal_plan.plan = plan;
+            journal_plan.config_generation = shm_ptrs.config_generation;
+            random_save_thread(&journal_plan.rng);
+            journal_plan.gang = *gang;
+            journal_append(JOURNAL_PLAN, gang_id, &journal_plan, sizeof(journal_plan),
+                           members, gang->max_member_count * sizeof(Member));
+        }
+        JournalPlanOutcome outcome = {plan, 0, 0.0f, 0};
+        int alive_before = gang->num_alive_members;
         
         // Calculate and store the success rate for GUI display
         gang->current_success_rate = calculate_success_rate(gang, members, gang->target_type, &config);
@@ -306,6 +415,8 @@ int main(int argc, char *argv[]) {
         
         // Calculate if the plan succeeds
         gang->plan_success = determine_plan_success(gang, members, gang->target_type, &config) ? 1 : -1;
+        outcome.success = gang->plan_success;
+        outcome.success_rate = gang->current_success_rate;
         
         printf("Gang %d: Plan %s! Main thread signaling all members\n", 
                gang_id, gang->plan_success == 1 ? "SUCCEEDED" : "FAILED");
@@ -323,7 +434,9 @@ int main(int argc, char *argv[]) {
             LOCK_GAME_STATS();
             shm_ptrs.shared_game->num_successfull_plans++;
             int total_successful = shm_ptrs.shared_game->num_successfull_plans;
+            journal_append(JOURNAL_PLAN_OUTCOME, gang_id, &outcome, sizeof(outcome), NULL, 0);
             UNLOCK_GAME_STATS();
+            notify_game_changed();
             
             printf("Gang %d: Successful plan completed! Total successful plans: %d/%d\n", 
                    gang_id, total_successful, config.max_successful_plans);
@@ -338,7 +451,9 @@ int main(int argc, char *argv[]) {
             LOCK_GAME_STATS();
             shm_ptrs.shared_game->num_thwarted_plans++;
             int total_thwarted = shm_ptrs.shared_game->num_thwarted_plans;
+            journal_append(JOURNAL_PLAN_OUTCOME, gang_id, &outcome, sizeof(outcome), NULL, 0);
             UNLOCK_GAME_STATS();
+            notify_game_changed();
             
             printf("Gang %d: Plan thwarted! Total thwarted plans: %d/%d\n", 
                    gang_id, total_thwarted, config.max_thwarted_plans);
@@ -348,6 +463,14 @@ int main(int argc, char *argv[]) {
             fflush(stdout);
             conduct_internal_investigation(config, &shm_ptrs, gang_id);
         }
+
+        if (journal_enabled()) {
+            JournalPlanCheck check = {plan, alive_before - gang->num_alive_members,
+                                      journal_hash_gang(gang, members)};
+            journal_append(JOURNAL_PLAN_CHECK, gang_id, &check, sizeof(check), NULL, 0);
+        }
+        plan++;
+        gang_touch(gang);
         
         // Signal all waiting members about the plan execution result
         pthread_cond_broadcast(&gang->plan_execute_cond);
@@ -356,15 +479,21 @@ int main(int argc, char *argv[]) {
         // The success rate will be reset only when starting a new plan
         pthread_mutex_unlock(&gang->gang_mutex);
 
-        // Trigger information spreading after plan execution
-        int current_time = shared_game->elapsed_time; // Use game time or implement time tracking
+        // Trigger information spreading after plan execution, if it is due
+        current_time = shared_game->elapsed_time;
         printf("Gang %d: Triggering information spreading at time %d\n", gang_id, current_time);
         fflush(stdout);
         
-        spread_information_in_gang(gang, members, current_time, highest_rank_member_id);
+        timer_wheel_advance(&gang_timers, (uint64_t)current_time);
+        gang_touch(gang);
+
+        // Success draws new blood
+        if (outcome.success == 1 && config.recruits_per_success > 0) {
+            recruit_members(gang_id, config.recruits_per_success, &config, thread_args);
+        }
         
         // Short delay before next plan
-        sleep(2);
+        gang_nap(2);
         
         printf("Gang %d: Planning next operation...\n", gang_id);
         fflush(stdout);
@@ -383,26 +512,34 @@ int main(int argc, char *argv[]) {
 
 void handle_police_handshake(int gang_id, const Config* config) {
     Message msg;
-    long gang_msgtype = get_gang_msgtype(gang->max_member_count, gang_id);
+    long gang_msgtype = route_to(&shared_game->routing, ENDPOINT_GANG, gang_id);
     
     // Check for handshake messages from police (non-blocking)
     if (receive_message_nonblocking(police_msgq_id, &msg, gang_msgtype) == 0) {
+        journal_message(gang_id, &msg);
         if (msg.mode == MSG_HANDSHAKE) {
             int police_id = msg.MessageContent.police_id;
             printf("Gang %d: Received handshake from police %d\n", gang_id, police_id);
             fflush(stdout);
             
-            // Find an available member to convert to agent
+            // Find an available member to convert to agent; the agent needs
+            // a free mailbox to report through
+            AgentMailbox *mailboxes = police_mailboxes(&shm_ptrs.police, config->max_agents_per_gang, gang_id);
+            int mailbox = agent_mailbox_find(mailboxes, config->max_agents_per_gang, AGENT_MAILBOX_FREE);
             int new_agent_id = -1;
-            for (int i = 0; i < gang->max_member_count; i++) {
+            int turned = -1;
+            for (int i = 0; i < gang->max_member_count && mailbox != -1; i++) {
                 if (members[i].is_alive && members[i].agent_id == -1) {
                     // Convert this member to an agent with globally unique ID
                     new_agent_id = __sync_fetch_and_add(&global_agent_id_counter, 1); // Thread-safe increment
+                    agent_mailbox_claim(&mailboxes[mailbox], new_agent_id);
                     members[i].agent_id = new_agent_id;
                     gang->num_agents++;
+                    turned = i;
                     
                     // Initialize secret agent attributes
                     secret_agent_init(&shm_ptrs, &members[i]);
+                    gang_touch(gang);
                     
                     printf("Gang %d: Member %d converted to secret agent with unique ID %d for police %d\n", 
                            gang_id, i, new_agent_id, police_id);
@@ -413,11 +550,13 @@ void handle_police_handshake(int gang_id, const Config* config) {
             
             // Send response back to police
             Message response;
-            response.mtype = get_police_msgtype(gang->max_member_count, config->num_gangs, police_id);
+            response.mtype = route_to(&shared_game->routing, ENDPOINT_OFFICER, police_id);
             response.mode = MSG_HANDSHAKE;
             response.MessageContent.agent_id = new_agent_id;
             
-            if (send_message(police_msgq_id, &response) == 0) {
+            if (route_send(&shared_game->routing, police_msgq_id, &response) == 0) {
+                gang_touch(gang);
+                gang_alert(gang);  // Wakes the officer waiting for the answer
                 printf("Gang %d: Sent handshake response to police %d with agent_id %d\n", 
                        gang_id, police_id, new_agent_id);
                 fflush(stdout);
@@ -425,6 +564,13 @@ void handle_police_handshake(int gang_id, const Config* config) {
                 printf("Gang %d: Failed to send handshake response to police %d\n", 
                        gang_id, police_id);
                 fflush(stdout);
+                // An agent the police never hear of would hold its mailbox for nothing
+                if (turned != -1) {
+                    members[turned].agent_id = -1;
+                    gang->num_agents--;
+                    agent_mailbox_clear(&mailboxes[mailbox]);
+                    gang_touch(gang);
+                }
             }
         }
     }
@@ -444,20 +590,140 @@ void cleanup() {
 
     printf("cleaning up gang\n");
     cleanup_semaphores();
+    journal_close();
     
-    // Close message queue (but don't delete it - police process manages it)
-    if (police_msgq_id != -1) {
-        printf("Gang: Closing message queue\n");
-        // Note: We don't delete the queue here as it's shared with police
+    // The queue is left to main, which removes it when it retires the slot
+    detach_shared_memory(&shm_ptrs);
+    shared_game = NULL;
+}
+
+// Initialize members [first, last) from the calling thread's stream
+static void init_members(int gang_id, int first, int last, const Config *config) {
+    for (int i = first; i < last; i++) {
+        members[i].gang_id = gang_id;
+        members[i].member_id = i;
+        // Randomly assign rank first (0 to num_ranks-1)
+        members[i].rank = random_int(0, config->num_ranks - 1);
+        // Calculate XP from rank using the formula: XP = rank^2
+        members[i].XP = calculate_xp_from_rank(members[i].rank);
+        members[i].prep_contribution = 0;
+        members[i].agent_id = -1;
+        members[i].knowledge = 0.0f;
+        members[i].suspicion = 0.0f;
+        members[i].faithfulness = 0.0f;
+        members[i].is_alive = true;
     }
-    
-    if (shared_game != NULL && shared_game != MAP_FAILED) {
-        if (munmap(shared_game, sizeof(Game)) == -1) {
-            perror("munmap failed");
+
+    // Generate attributes using multivariate Gaussian distribution
+    generate_multivariate_attributes_batch(members[first].attributes, sizeof(Member), last - first,
+                                           attribute_means, attribute_stddevs, attribute_correlation);
+
+    // Attributes added in config.json are independent of the built-in ones
+    for (int i = first; i < last; i++) {
+        for (int a = NUM_ATTRIBUTES; a < config->num_attributes; a++) {
+            members[i].attributes[a] = fminf(fmaxf(random_normal(0.5f, 0.15f), 0.0f), 1.0f);
         }
     }
+
+    // Initialize member knowledge for information spreading
+    for (int i = first; i < last; i++) {
+        initialize_member_knowledge(&members[i], members[i].rank, config->num_ranks - 1);
+    }
 }
 
-void gang_init() {
+// Initialize every chunk assigned to this worker
+static void *member_init_worker(void *arg) {
+    MemberInitArgs *args = (MemberInitArgs *)arg;
+    int count = gang->max_member_count;
+    int num_chunks = (count + MEMBER_INIT_CHUNK - 1) / MEMBER_INIT_CHUNK;
 
+    RandomStream stream;
+    random_bind_stream(&stream);
+
+    for (int c = args->first_chunk; c < num_chunks; c += args->chunk_step) {
+        random_stream_seed(&stream, random_master_seed(), RANDOM_PROC_GANG_INIT, args->gang_id, c);
+
+        int first = c * MEMBER_INIT_CHUNK;
+        int last = first + MEMBER_INIT_CHUNK < count ? first + MEMBER_INIT_CHUNK : count;
+        init_members(args->gang_id, first, last, args->config);
+    }
+
+    random_bind_stream(NULL);
+    return NULL;
+}
+
+// Start a thread for each member in [first, last)
+static void start_member_threads(int first, int last, ThreadArgs *thread_args, Config *config, int recruited) {
+    for (int i = first; i < last; i++) {
+        // Set up thread arguments with both member and config
+        thread_args[i].member = &members[i];
+        thread_args[i].config = config;
+        thread_args[i].recruited = recruited;
+
+        // Create thread for each member
+        pthread_t thread_id;
+        int ret = pthread_create(&thread_id, NULL, actual_gang_member_thread_function, &thread_args[i]);
+        members[i].thread = thread_id;
+
+        if (ret != 0) {
+            fprintf(stderr, "Failed to create thread: %d\n", ret);
+        }
+    }
+}
+
+// Take on new members between plans. The segment grows first (doubling, up
+// to the limit, so growth is rare), then the members are set up, and only
+// then does the count that tells everyone else about them go up.
+static void recruit_members(int gang_id, int wanted, Config *config, ThreadArgs *thread_args) {
+    int first = gang->max_member_count;
+    int last = first + wanted < config->gang_size_limit ? first + wanted : config->gang_size_limit;
+    if (last <= first) {
+        return;
+    }
+    int room = shm_grow_gang(&shm_ptrs, gang_id, last > 2 * first ? last : 2 * first);
+    if (room < last) {
+        fprintf(stderr, "Gang %d: No room to recruit %d members\n", gang_id, last - first);
+        return;
+    }
+
+    pthread_mutex_lock(&gang->gang_mutex);
+    init_members(gang_id, first, last, config);
+    gang->num_alive_members += last - first;
+    gang->checkpoint_threads += last - first;
+    checkpoint_register(&shared_game->checkpoint, last - first);
+    __atomic_store_n(&gang->max_member_count, last, __ATOMIC_RELEASE);
+    gang_touch(gang);
+    pthread_mutex_unlock(&gang->gang_mutex);
+
+    start_member_threads(first, last, thread_args, config, 1);
+    printf("Gang %d: Recruited %d members (%d now, room for %d of %d)\n",
+           gang_id, last - first, last, room, config->gang_size_limit);
+    fflush(stdout);
+}
+
+// Initialize all members of this gang. Large gangs are split into chunks and
+// spread over the available cores.
+void init_gang_members(int gang_id, const Config *config) {
+    int num_chunks = (gang->max_member_count + MEMBER_INIT_CHUNK - 1) / MEMBER_INIT_CHUNK;
+    long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    int num_workers = num_chunks < cores ? num_chunks : (int)cores;
+    if (num_workers < 1) num_workers = 1;
+
+    MemberInitArgs args[num_workers];
+    pthread_t workers[num_workers];
+    for (int w = 0; w < num_workers; w++) {
+        args[w] = (MemberInitArgs){gang_id, w, num_workers, config};
+    }
+
+    // The calling thread does the first share itself
+    for (int w = 1; w < num_workers; w++) {
+        if (pthread_create(&workers[w], NULL, member_init_worker, &args[w]) != 0) {
+            perror("Gang: Failed to create member init thread");
+            exit(EXIT_FAILURE);
+        }
+    }
+    member_init_worker(&args[0]);
+    for (int w = 1; w < num_workers; w++) {
+        pthread_join(workers[w], NULL);
+    }
 }
\ No newline at end of file
@@ -24,9 +24,6 @@ void initialize_member_knowledge(Member* member, int rank, int max_rank) {
         member->received_info[i].source_rank = -1;
         member->received_info[i].timestamp = 0;
     }
-    
-    printf("Gang %d, Member %d: Initialized knowledge %.2f (rank %d/%d)\n", 
-           member->gang_id, member->member_id, member->knowledge, rank, max_rank);
 }
 
 // Calculate base knowledge level based on rank
@@ -47,13 +44,9 @@ float calculate_base_knowledge_by_rank(int rank, int max_rank) {
     return base_knowledge;
 }
 
-// Main information spreading function
+// Main information spreading function; the gang's timer calls it once
+// info_spread_interval has passed since the last session
 void spread_information_in_gang(Gang* gang, Member* members, int current_time, int leader_id) {
-    // Check if it's time to spread information
-    if (current_time - gang->last_info_spread_time < gang->info_spread_interval) {
-        return; // Not time yet
-    }
-    
     printf("Gang %d: Information spreading session at time %d\n", gang->gang_id, current_time);
     
     // Leader spreads information to subordinates
@@ -10,6 +10,9 @@
 #include "gang.h"
 #include "shared_mem_utils.h"
 #include "message.h"
+#include "random.h"
+#include "journal.h"
+#include "police.h"
 #include <unistd.h>
 #include <time.h>
 
@@ -18,18 +21,18 @@ extern int police_msgq_id;
 
 void secret_agent_init(ShmPtrs* shm_ptrs, Member* member) {
     // Find the actual member in shared memory
-    Member* shared_member = &shm_ptrs->gang_members[member->gang_id][member->member_id];
+    Member* shared_member = &shm_members(shm_ptrs, member->gang_id)[member->member_id];
     // Initialize attributes in shared memory
     shared_member->knowledge = 0.0f;
     shared_member->suspicion = 0.0f;
-    shared_member->faithfulness = (float)rand() / RAND_MAX;
-    shared_member->discretion = 1.0f + ((float)rand() / RAND_MAX);
-    shared_member->shrewdness = 1.0f + ((float)rand() / RAND_MAX);
+    shared_member->faithfulness = random_float(0.0f, 1.0f);
+    shared_member->discretion = 1.0f + random_float(0.0f, 1.0f);
+    shared_member->shrewdness = 1.0f + random_float(0.0f, 1.0f);
     shared_member->askers_count = 0;
 }
 
 void secret_agent_record_asker(ShmPtrs* shm_ptrs,Config config, Member* agent, int asker_id) {
-  Member* shared_agent = &shm_ptrs->gang_members[agent->gang_id][agent->member_id];
+  Member* shared_agent = &shm_members(shm_ptrs, agent->gang_id)[agent->member_id];
     if (shared_agent->askers_count < config.max_askers) {
         for (int i = 0;i<shared_agent->askers_count;i++) {
             if (shared_agent->askers[i] == asker_id) {
@@ -41,8 +44,8 @@ void secret_agent_record_asker(ShmPtrs* shm_ptrs,Config config, Member* agent, i
 }
 
 void secret_agent_ask_member(ShmPtrs* shm_ptrs,Member* agent,Member *target) {
-    Member* shared_agent = &shm_ptrs->gang_members[agent->gang_id][agent->member_id];
-    Member* shared_target = &shm_ptrs->gang_members[target->gang_id][target->member_id];
+    Member* shared_agent = &shm_members(shm_ptrs, agent->gang_id)[agent->member_id];
+    Member* shared_target = &shm_members(shm_ptrs, target->gang_id)[target->member_id];
 
     if (shared_target->agent_id > 0) {
         float knowledge_change = shared_agent->shrewdness * (shared_target->knowledge - 0.5f);
@@ -55,9 +58,9 @@ void secret_agent_ask_member(ShmPtrs* shm_ptrs,Member* agent,Member *target) {
             Gang* gang = &shm_ptrs->gangs[shared_target->gang_id];
             int max_rank = 0;
             for (int i = 0; i < gang->max_member_count; i++) {
-                if (shm_ptrs->gang_members[gang->gang_id][i].is_alive)
-                    if (shm_ptrs->gang_members[gang->gang_id][i].rank > max_rank) {
-                        max_rank = shm_ptrs->gang_members[gang->gang_id][i].rank;
+                if (shm_members(shm_ptrs, gang->gang_id)[i].is_alive)
+                    if (shm_members(shm_ptrs, gang->gang_id)[i].rank > max_rank) {
+                        max_rank = shm_members(shm_ptrs, gang->gang_id)[i].rank;
                     }
             }
 
@@ -81,15 +84,25 @@ void secret_agent_ask_member(ShmPtrs* shm_ptrs,Member* agent,Member *target) {
 
     }
 
+// The agent's slot of the gang's mailboxes; NULL if it was given none
+static AgentMailbox *agent_mailbox(ShmPtrs* shm_ptrs, const Member* agent, Config config) {
+    if (shm_ptrs->police.mailboxes == NULL) {
+        return NULL;  // no police tables, as in ocf-replay
+    }
+    AgentMailbox *row = police_mailboxes(&shm_ptrs->police, config.max_agents_per_gang, agent->gang_id);
+    int slot = agent_mailbox_find(row, config.max_agents_per_gang, agent->agent_id);
+    return slot == -1 ? NULL : &row[slot];
+}
+
 void conduct_internal_investigation(Config config, ShmPtrs* shm_ptrs, int gang_id) {
     Gang *gang = &shm_ptrs->gangs[gang_id];;
     int max_rank = -1;
     int investigator_idx = -1;
 
     for (int i = 0; i < gang->max_member_count; i++) {
-        if (shm_ptrs->gang_members[gang->gang_id][i].is_alive)
-            if (shm_ptrs->gang_members[gang->gang_id][i].rank > max_rank) {
-                max_rank = shm_ptrs->gang_members[gang->gang_id][i].rank;
+        if (shm_members(shm_ptrs, gang->gang_id)[i].is_alive)
+            if (shm_members(shm_ptrs, gang->gang_id)[i].rank > max_rank) {
+                max_rank = shm_members(shm_ptrs, gang->gang_id)[i].rank;
                 investigator_idx = i;
             }
     }
@@ -98,11 +111,11 @@ void conduct_internal_investigation(Config config, ShmPtrs* shm_ptrs, int gang_i
         return;
     }
 
-    Member* investigator = &shm_ptrs->gang_members[gang->gang_id][investigator_idx];
+    Member* investigator = &shm_members(shm_ptrs, gang->gang_id)[investigator_idx];
 
     for (int gidx =0;gidx<gang->max_member_count;gidx++) {
-        if (shm_ptrs->gang_members[gang->gang_id][gidx].is_alive) {
-            Member *g = &shm_ptrs->gang_members[gang->gang_id][gidx];
+        if (shm_members(shm_ptrs, gang->gang_id)[gidx].is_alive) {
+            Member *g = &shm_members(shm_ptrs, gang->gang_id)[gidx];
             if (g->agent_id>0) {
                 float suspicion_increase = investigator->shrewdness*g->suspicion;
                 g->suspicion += suspicion_increase;
@@ -112,7 +125,7 @@ void conduct_internal_investigation(Config config, ShmPtrs* shm_ptrs, int gang_i
             for (int j = 0;j<g->askers_count;j++) {
                 int asker_id = g->askers[j];
                 for (int k = 0;k<gang->max_member_count;k++) {
-                    Member *agent_candidate = &shm_ptrs->gang_members[gang->gang_id][k];
+                    Member *agent_candidate = &shm_members(shm_ptrs, gang->gang_id)[k];
                     if (agent_candidate->member_id == asker_id) {
                         float suspicion_increase = investigator->shrewdness * (1.0f - g->suspicion);
                         agent_candidate->suspicion += suspicion_increase;
@@ -128,104 +141,73 @@ void conduct_internal_investigation(Config config, ShmPtrs* shm_ptrs, int gang_i
 
     // Execute agents with high suspicion and notify police
     for (int i = 0; i < gang->max_member_count; i++) {
-        if (shm_ptrs->gang_members[gang->gang_id][i].is_alive) {
-            Member *m = &shm_ptrs->gang_members[gang->gang_id][i];
+        if (shm_members(shm_ptrs, gang->gang_id)[i].is_alive) {
+            Member *m = &shm_members(shm_ptrs, gang->gang_id)[i];
             if (m->agent_id >= 0 && m->suspicion > config.suspicion_threshold) {
                 // Execute the agent
                 m->is_alive = false;
                 gang->num_alive_members--;
                 gang->num_agents--;
                 shm_ptrs->shared_game->num_executed_agents++;
+                notify_game_changed();
+                AgentMailbox *box = agent_mailbox(shm_ptrs, m, config);
+                if (box != NULL) {
+                    agent_mailbox_clear(box);
+                }
                 
                 printf("Gang %d: Executed agent %d (suspicion: %.2f > threshold: %.2f)\n",
                        gang->gang_id, m->agent_id, m->suspicion, config.suspicion_threshold);
                 fflush(stdout);
                 
-                // Notify police about agent death (assuming police_id matches gang_id for simplicity)
-                // In a real implementation, you might need to track which police planted this agent
-                int police_id = gang->gang_id; // Simple mapping for now
+                // The officer of the gang's slot planted every agent in it
                 extern int police_msgq_id;
-                notify_police_agent_death(police_msgq_id, gang->gang_id, m->agent_id, police_id, gang, config);
+                notify_police_agent_death(police_msgq_id, &shm_ptrs->shared_game->routing, gang->gang_id,
+                                          m->agent_id, gang);
             }
         }
     }
+    gang_touch(gang);
 
 }
 
-void police_request_agent_knowledge(int police_msgid, Game* shared_game, int8_t gang_id, int8_t agent_id, Config config,Gang* gang) {
-    Message msg;
-    msg.mtype = get_agent_msgtype(gang->max_member_count, gang_id, agent_id);
-    msg.mode = 2; // request knowledge
-    send_message(police_msgid, &msg);
-}
-
-void agent_report_knowledge(Member* agent, Game* shared_game, int police_msgid, int police_id,Gang* gang,Config config) {
-    Message msg;
-    msg.mtype = get_police_msgtype(gang->max_member_count, config.max_gangs, police_id);
-    msg.mode = 3; // report knowledge
-    msg.MessageContent.knowledge = agent->knowledge;
-    send_message(police_msgid, &msg);
-}
-
-void secret_agent_handle_police_requests(Member* agent, Game* shared_game, int police_msgid, int police_id, Gang* gang, Config config) {
-    Message msg;
-    long agent_msgtype = get_agent_msgtype(gang->max_member_count, agent->gang_id, agent->member_id);
-    
-    // Check for police requests (non-blocking)
-    if (receive_message_nonblocking(police_msgid, &msg, agent_msgtype) == 0) {
-        if (msg.mode == MSG_POLICE_REQUEST) { // police requests knowledge
-            printf("Gang %d, Agent %d: Received police request for knowledge\n", 
-                   agent->gang_id, agent->member_id);
-            fflush(stdout);
-            agent_report_knowledge(agent, shared_game, police_msgid, police_id, gang, config);
-        }
-    }
-}
-
-void secret_agent_periodic_communication(ShmPtrs* shm_ptrs, Member* agent, Game* shared_game, int police_msgid, int police_id, Gang* gang, Config config) {
+void secret_agent_periodic_communication(ShmPtrs* shm_ptrs, Member* agent, Game* shared_game, Gang* gang, Config config) {
     // Get agent from shared memory
-    Member* shared_agent = &shm_ptrs->gang_members[agent->gang_id][agent->member_id];
+    Member* shared_agent = &shm_members(shm_ptrs, agent->gang_id)[agent->member_id];
+    AgentMailbox *box = agent_mailbox(shm_ptrs, agent, config);
+    if (box == NULL) {
+        return;
+    }
     
     // Check if knowledge is above threshold for immediate reporting
+    uint32_t raised_us = 0;
     if (shared_agent->knowledge > config.knowledge_threshold) {
         printf("Gang %d, Agent %d: Knowledge %.2f above threshold %.2f - reporting gang involvement\n",
                agent->gang_id, agent->member_id, shared_agent->knowledge, config.knowledge_threshold);
         fflush(stdout);
-        
-        Message msg;
-        msg.mtype = get_police_msgtype(gang->max_member_count, config.num_gangs, police_id);
-        msg.mode = MSG_POLICE_REPORT;
-        msg.MessageContent.knowledge = shared_agent->knowledge;
-        
-        if (send_message(police_msgid, &msg) == 0) {
-            printf("Gang %d, Agent %d: Successfully reported high knowledge to police\n",
-                   agent->gang_id, agent->member_id);
-            fflush(stdout);
-        }
-    } else {
-        // Periodic report of current knowledge level (lower priority)
-        printf("Gang %d, Agent %d: Sending periodic knowledge report %.2f to police\n",
-               agent->gang_id, agent->member_id, shared_agent->knowledge);
-        fflush(stdout);
-        
-        Message msg;
-        msg.mtype = get_police_msgtype(gang->max_member_count, config.num_gangs, police_id);
-        msg.mode = MSG_POLICE_REPORT;
-        msg.MessageContent.knowledge = shared_agent->knowledge;
-        
-        send_message(police_msgid, &msg);
+        raised_us = agent_mailbox_now_us();
+    }
+
+    // Only the latest report matters to the police; it replaces the one
+    // they haven't read yet, if any
+    agent_mailbox_post(box, shared_agent->knowledge, shared_game->elapsed_time, raised_us);
+    if (raised_us != 0) {
+        gang_alert(gang);  // Don't wait for the officer's rounds
     }
 }
 
-void notify_police_agent_death(int police_msgid, int gang_id, int agent_id, int police_id, Gang* gang, Config config) {
+void notify_police_agent_death(int police_msgid, RoutingTable* routing, int gang_id, int agent_id, Gang* gang) {
+    if (police_msgid == -1) {
+        return;  // no queue, as in ocf-replay
+    }
     Message msg;
-    msg.mtype = get_police_msgtype(gang->max_member_count, config.num_gangs, police_id);
+    msg.mtype = route_to(routing, ENDPOINT_OFFICER, gang_id);
     msg.mode = MSG_AGENT_DEATH;
     msg.MessageContent.agent_id = agent_id;
     
-    if (send_message(police_msgid, &msg) == 0) {
+    if (route_send(routing, police_msgid, &msg) == 0) {
+        gang_alert(gang);
         printf("Gang %d: Notified police %d about death of agent %d\n", 
-               gang_id, police_id, agent_id);
+               gang_id, gang_id, agent_id);
         fflush(stdout);
     }
 }
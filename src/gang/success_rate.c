@@ -6,10 +6,10 @@
 #include "random.h"
 #include "target_selection.h"
 
-extern Game *shared_game;
+extern ShmPtrs shm_ptrs;
 
 // Calculate success rate based on the formula
-float calculate_success_rate(Gang *gang, Member *members, TargetType target_type, Config *config) {
+float calculate_success_rate(Gang *gang, Member *members, int target_type, Config *config) {
     if (gang == NULL || members == NULL || config == NULL) {
         return 0.0f;
     }
@@ -29,9 +29,7 @@ float calculate_success_rate(Gang *gang, Member *members, TargetType target_type
         }
 
         // calculate attribute factor
-        float dot_product = calculate_dot_product(members[i].attributes, 
-                                                  shared_game->targets[target_type].weights, 
-                                                  NUM_ATTRIBUTES);
+        float dot_product = catalog_score(shm_ptrs.catalog, target_type, members[i].attributes);
         
 
         // calculate rank factor
@@ -60,7 +58,7 @@ float calculate_success_rate(Gang *gang, Member *members, TargetType target_type
 }
 
 // Determine if a plan succeeds based on success rate
-bool determine_plan_success(Gang *gang, Member *members, TargetType target_type, Config *config) {
+bool determine_plan_success(Gang *gang, Member *members, int target_type, Config *config) {
     float success_rate = calculate_success_rate(gang, members, target_type, config);
     
     // Generate a random number from 0 to 100
@@ -1,8 +1,8 @@
 #include <stdio.h>
 #include <stdlib.h>
-#include <time.h>
 #include "target_selection.h"
 #include "config.h"
+#include "random.h"
 
 // Calculate dot product between two vectors of attributes
 float calculate_dot_product(const float *attributes, const double *weights, int size) {
@@ -42,62 +42,29 @@ int find_highest_ranked_member(Gang *gang, Member *members) {
 
 
 
-TargetType select_target(Game *game, Gang *gang, Member *members, int highest_rank_member_id) {
-    if (game == NULL || gang == NULL || members == NULL || highest_rank_member_id < 0 || highest_rank_member_id >= gang->max_member_count) {
-        // Default to bank robbery if something's wrong
-        return TARGET_BANK_ROBBERY;
+int select_target(TargetCatalog *catalog, Gang *gang, Member *members, int highest_rank_member_id) {
+    if (catalog == NULL || gang == NULL || members == NULL || highest_rank_member_id < 0 || highest_rank_member_id >= gang->max_member_count) {
+        // Default to the first target if something's wrong
+        return 0;
     }
 
     // Get the highest-ranked member
     Member *leader = &members[highest_rank_member_id];
-    
-    // Initialize random seed
-    srand(time(NULL) + gang->gang_id);
-    
-    // Calculate weighted preferences based on member attributes
-    
-    float heat;
-    float min_heat = 0.0f;
-    TargetType selected_targets[NUM_TARGETS];
-    TargetType selected_target;
-
-    // Calculate minimum heat for all targets
-    for (int t = 0; t < NUM_TARGETS; t++) {
-        // Calculate score based on how well the leader's attributes match the target requirements
-        heat = game->targets[t].heat * gang->heat[t];
-        if(min_heat > heat) {
-            min_heat = heat;
-        }
-    }
 
-    // Select the targets with the minimum heat
-    int num_selected = 0;
-    for (int t = 0; t < NUM_TARGETS; t++) {
-        if (game->targets[t].heat * gang->heat[t] == min_heat) {
-            selected_targets[t] = (TargetType)t;
-            num_selected++;
-        }
-    }
-
-    // choose a random target from the selected ones
-    if (num_selected > 0) {
-        int random_index = rand() % num_selected;
-        selected_target = selected_targets[random_index];
-    } else {
-        selected_target = TARGET_BANK_ROBBERY; // Fallback
-    }
+    // Coolest targets first, then the best fit for the leader's attributes
+    int selected_target = catalog_select_target(catalog, gang->gang_id, leader->attributes);
+    float heat = catalog_target_heat(catalog)[selected_target] *
+                 catalog_gang_heat(catalog, gang->gang_id)[selected_target];
 
-
-    
     printf("Gang %d leader (member %d) selected target: %s (heat: %.2f)\n", 
             gang->gang_id, highest_rank_member_id,
-            game->targets[selected_target].name, min_heat);
+            catalog_target_name(catalog, selected_target), heat);
     fflush(stdout);
     
     return selected_target;
 }
 
-void set_preparation_parameters(Gang *gang, TargetType target_type, Config *config) {
+void set_preparation_parameters(Gang *gang, int target_type, Config *config) {
     if (gang == NULL) return;
     
     // Store the target type
@@ -105,15 +72,16 @@ void set_preparation_parameters(Gang *gang, TargetType target_type, Config *conf
     
     // Set preparation time based on target complexity and some randomness
     // More complex targets require more preparation time
-    int base_prep_time = 10 + (target_type * 5); // Base time increases with target complexity
-    int random_factor = rand() % 10;  // Random factor 0-9
+    // Catalogs can be long, so complexity cycles through the built-in range
+    int base_prep_time = 10 + (target_type % NUM_TARGETS) * 5; // Base time increases with target complexity
+    int random_factor = random_int(0, 9);  // Random factor 0-9
     
     gang->prep_time = base_prep_time + random_factor;
     
     // Set required preparation level based on target complexity
     // More complex targets require higher preparation levels
     int base_prep_level = 50; // Base level increases with complexity
-    random_factor = rand() % 5;  // Random factor 0-4
+    random_factor = random_int(0, 4);  // Random factor 0-4
 
     gang->prep_level = base_prep_level + random_factor;
     
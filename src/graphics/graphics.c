@@ -1,8 +1,11 @@
 /********************************************************************
  * graphics.c  –  viewer for the “Bakery/OCF” simulation (2025-05-12)
  *   ▸ reads shared-memory segment read-only (no semaphores needed)
- *   ▸ copies whole block each frame and rebuilds pointers
- *   ▸ renders with raylib 5.x
+ *   ▸ a background thread copies it into a private snapshot at
+ *     viewer_snapshot_hz, re-copying only gangs whose version changed
+ *   ▸ or, with --connect, keeps the snapshot from main's state stream
+ *     instead of mapping shared memory at all
+ *   ▸ renders with raylib 5.x from the snapshot
  *******************************************************************/
 #include "raylib.h"
 #include "config.h"
@@ -11,13 +14,18 @@
 #include "police.h"
 #include "shared_mem_utils.h"
 
+#include <pthread.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <sys/mman.h>
+#include <time.h>
 #include <unistd.h>
 
 #include "random.h"
 #include "semaphores_utils.h"
+#include "viewer_lod.h"
+#include "state_stream.h"
 
 /*──────────────────────── window/layout ────────────────────────*/
 #define WIN_W 1300
@@ -39,7 +47,7 @@ static Rectangle R_GAN = {NEW_GAN_X, 0,    NEW_GAN_W, WIN_H-150};
 
 /* gang-card constants */
 #define CARD_W_UPDATED 300.f     // Updated card width
-#define BASE_CARD_H 220.f        /* header + margins for gang info (increased for XP/rank data) */
+#define BASE_CARD_H 238.f        /* header + margins for gang info (increased for XP/rank data) */
 static float hScroll = 0.f;
 static float vScroll = 0.f;
 
@@ -54,25 +62,297 @@ static float vScroll = 0.f;
 
 
 /*──────────────────────── assets ───────────────────────────────*/
-static Texture2D texGang, texAgent, texPolice;
-
-static Texture2D mustLoad(const char *path){
-    Texture2D t = LoadTexture(path);
-    if(!t.id){
+/* The icons share one atlas texture so consecutive icon and card draws
+ * don't switch textures (each switch flushes raylib's batch). */
+enum { ICON_GANG, ICON_AGENT, ICON_POLICE, NUM_ICONS };
+#define ICON_CELL 64
+static Texture2D texAtlas;
+static Rectangle iconRect[NUM_ICONS];
+
+static Image mustLoad(const char *path){
+    Image img = LoadImage(path);
+    if(!img.data){
         TraceLog(LOG_FATAL,"cannot load %s (cwd=%s)",path,getcwd(NULL,0));
         exit(1);
     }
-    return t;
+    return img;
+}
+
+static void load_atlas(void){
+    static const char *paths[NUM_ICONS] = {
+        ASSETS_PATH"gang.png", ASSETS_PATH"agent.png", ASSETS_PATH"police.png"
+    };
+    Image atlas = GenImageColor(ICON_CELL*NUM_ICONS, ICON_CELL, BLANK);
+    for(int i=0;i<NUM_ICONS;i++){
+        Image icon = mustLoad(paths[i]);
+        iconRect[i] = (Rectangle){(float)(i*ICON_CELL), 0, ICON_CELL, ICON_CELL};
+        ImageDraw(&atlas, icon, (Rectangle){0,0,(float)icon.width,(float)icon.height}, iconRect[i], WHITE);
+        UnloadImage(icon);
+    }
+    texAtlas = LoadTextureFromImage(atlas);
+    SetTextureFilter(texAtlas, TEXTURE_FILTER_BILINEAR);
+    UnloadImage(atlas);
+}
+
+static void draw_icon(int icon, float x, float y, float size){
+    DrawTexturePro(texAtlas, iconRect[icon], (Rectangle){x, y, size, size}, (Vector2){0,0}, 0.0f, WHITE);
 }
 
 /*──────────────────────── shared-memory snapshot helpers ───────*/
 Game *shared_game;
 
+#define DEFAULT_SNAPSHOT_HZ 10
+#define SNAPSHOT_IDLE_MS 250  /* longest the snapshot thread sleeps before it checks for stop */
+#define SNAPSHOT_RETRIES 3     /* copies of a gang that changed under us */
+
+/* Private copy the frames are drawn from. The snapshot thread fills it,
+ * the render loop reads it; both hold `lock` while touching it. */
+typedef struct {
+    pthread_mutex_t lock;
+    Game game;                 /* counters and police table sizes */
+    void *police;              /* police tables, laid out like the live block */
+    size_t police_size;
+    Gang *gangs;
+    Member **gang_members;
+    uint32_t *versions;        /* gang version each copy was taken at */
+    int *leaders;              /* highest-ranked living member, per copy */
+    int num_gangs;
+    int max_gang_size;
+    int max_agents;            /* agents per officer in the police tables */
+    const TargetCatalog *catalog;  /* immutable, read in place */
+
+    /* scratch for copying one gang outside the lock */
+    Gang gang_copy;
+    Member *member_copy;
+
+    int hz;                    /* set by the render loop on a config reload */
+    volatile int stop;
+    uint64_t snapshots;
+    uint64_t gangs_rebuilt;
+
+    /* aggregate views, computed by the snapshot thread while lod_on */
+    int lod_on;
+    float suspicion_max;
+    LodViews lod;              /* owned by the snapshot thread */
+    uint32_t *lod_pixels[LOD_NUM_VIEWS];  /* last finished set, under lock */
+    uint64_t lod_generation;
+} ViewerSnapshot;
+
+static ViewerSnapshot view;
+
+static int find_leader(const Gang *gang, const Member *members){
+    int leader = -1, best = -999;
+    for (int i = 0; i < gang->max_member_count; i++) {
+        if (members[i].is_alive && members[i].rank > best) {
+            best = members[i].rank;
+            leader = i;
+        }
+    }
+    return leader;
+}
+
+/* Copy one gang and its members; a version that moved during the copy
+ * means a writer was busy, so try again. Returns the version copied. */
+static uint32_t copy_gang(const ShmPtrs *live, int g){
+    const Gang *src = &live->gangs[g];
+    uint32_t version = gang_version(src);
+    if (shm_members(live, g) == NULL) {
+        /* slot not running (or retired since): an empty gang */
+        memset(&view.gang_copy, 0, sizeof(Gang));
+        memset(view.member_copy, 0, (size_t)view.max_gang_size * sizeof(Member));
+        return version;
+    }
+    int count = shm_member_count(live, g);
+    if (count > view.max_gang_size) count = view.max_gang_size;
+    memset(&view.member_copy[count], 0, (size_t)(view.max_gang_size - count) * sizeof(Member));
+    for (int attempt = 0; attempt < SNAPSHOT_RETRIES; attempt++) {
+        memcpy(&view.gang_copy, src, sizeof(Gang));
+        memcpy(view.member_copy, shm_members(live, g), (size_t)count * sizeof(Member));
+        uint32_t after = gang_version(src);
+        if (after == version) break;
+        version = after;
+    }
+    return version;
+}
+
+static void publish_lod(int changed);
+
+static void take_snapshot(ShmPtrs *live, int first){
+    size_t members_size = (size_t)view.max_gang_size * sizeof(Member);
+    int changed = 0;
+
+    /* gangs spawned, retired or grown since the last one are remapped;
+     * a slot whose mapping changed is copied again whatever its version */
+    if (shm_refresh_gangs(live)) first = 1;
+
+    pthread_mutex_lock(&view.lock);
+    memcpy(&view.game, live->shared_game, sizeof(Game));
+    memcpy(view.police, live->police.officers, view.police_size);
+    pthread_mutex_unlock(&view.lock);
+
+    for (int g = 0; g < view.num_gangs; g++) {
+        if (!first && gang_version(&live->gangs[g]) == view.versions[g]) continue;
+
+        uint32_t version = copy_gang(live, g);
+        int leader = find_leader(&view.gang_copy, view.member_copy);
+
+        pthread_mutex_lock(&view.lock);
+        view.gangs[g] = view.gang_copy;
+        memcpy(view.gang_members[g], view.member_copy, members_size);
+        view.versions[g] = version;
+        view.leaders[g] = leader;
+        pthread_mutex_unlock(&view.lock);
+        view.gangs_rebuilt++;
+        changed = 1;
+    }
+    view.snapshots++;
+    publish_lod(changed);
+}
+
+/* The private copy is only written by the snapshot (or stream) thread, so
+ * the reductions read it without the lock and only the finished images
+ * are published */
+static void publish_lod(int changed){
+    if (__atomic_load_n(&view.lod_on, __ATOMIC_RELAXED) && (changed || !view.lod_generation)) {
+        lod_compute(&view.lod, view.gangs, view.gang_members, view.catalog, view.suspicion_max);
+        pthread_mutex_lock(&view.lock);
+        for (int v = 0; v < LOD_NUM_VIEWS; v++) {
+            const LodImage *image = &view.lod.images[v];
+            memcpy(view.lod_pixels[v], image->pixels, (size_t)image->width * image->height * sizeof(uint32_t));
+        }
+        view.lod_generation++;
+        pthread_mutex_unlock(&view.lock);
+    }
+}
+
+static void *snapshot_thread(void *arg){
+    ShmPtrs *live = arg;
+    uint32_t *changes = &live->shared_game->notify.any;
+    struct timespec next;
+    clock_gettime(CLOCK_MONOTONIC, &next);
+    uint32_t seen = notify_generation(changes);
+    take_snapshot(live, 1);
+    while (!view.stop) {
+        /* nothing to copy until a writer bumps the board... */
+        if (!notify_wait(changes, seen, SNAPSHOT_IDLE_MS)) continue;
+
+        /* ...and no more than hz copies a second however often they do */
+        int hz = __atomic_load_n(&view.hz, __ATOMIC_RELAXED);
+        long period_ns = 1000000000L / (hz > 0 ? hz : DEFAULT_SNAPSHOT_HZ);
+        struct timespec now;
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        next.tv_nsec += period_ns;
+        while (next.tv_nsec >= 1000000000L) {
+            next.tv_nsec -= 1000000000L;
+            next.tv_sec++;
+        }
+        if (next.tv_sec < now.tv_sec || (next.tv_sec == now.tv_sec && next.tv_nsec < now.tv_nsec)) {
+            next = now;  /* idle for a while: no catching up */
+        }
+        clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next, NULL);
+        seen = notify_generation(changes);
+        take_snapshot(live, 0);
+    }
+    return NULL;
+}
+
+/* Remote mode: apply main's delta frames to the private copy */
+static void *stream_thread(void *arg){
+    StreamClient *client = arg;
+    while (!view.stop) {
+        int r = stream_next(client, 200);
+        if (r == 0) continue;
+        pthread_mutex_lock(&view.lock);
+        if (r == 1 && stream_apply(client, &view.game, view.gangs, view.gang_members, view.versions) == 0) {
+            memcpy(view.police, client->police, view.police_size);
+            for (int i = 0; i < client->num_changed; i++) {
+                int g = client->changed[i];
+                view.leaders[g] = find_leader(&view.gangs[g], view.gang_members[g]);
+            }
+            r = 0;
+        }
+        pthread_mutex_unlock(&view.lock);
+        if (r != 0) {
+            printf("VIEWER: the game stream ended\n");
+            fflush(stdout);
+            break;
+        }
+        view.gangs_rebuilt += (uint64_t)client->num_changed;
+        view.snapshots++;
+        publish_lod(1);
+    }
+    return NULL;
+}
+
+static void snapshot_init(const Config *cfg, const TargetCatalog *catalog){
+    /* one copy per gang slot, each big enough for a gang at its limit */
+    int n = cfg->max_gangs;
+    view.num_gangs = n;
+    view.max_gang_size = cfg->gang_size_limit;
+    view.max_agents = cfg->max_agents_per_gang;
+    view.catalog = catalog;
+    view.hz = cfg->viewer_snapshot_hz;
+    view.gangs = calloc((size_t)n, sizeof(Gang));
+    view.gang_members = calloc((size_t)n, sizeof(Member *));
+    view.versions = calloc((size_t)n, sizeof(uint32_t));
+    view.leaders = calloc((size_t)n, sizeof(int));
+    view.member_copy = calloc((size_t)cfg->gang_size_limit, sizeof(Member));
+    view.police_size = police_tables_size(n, cfg->max_agents_per_gang);
+    view.police = calloc(1, view.police_size + 1);
+    if (!view.gangs || !view.gang_members || !view.versions || !view.leaders || !view.member_copy ||
+        !view.police) {
+        fprintf(stderr, "Failed to allocate the viewer snapshot\n");
+        exit(EXIT_FAILURE);
+    }
+    for (int g = 0; g < n; g++) {
+        view.gang_members[g] = calloc((size_t)cfg->gang_size_limit, sizeof(Member));
+        if (!view.gang_members[g]) {
+            fprintf(stderr, "Failed to allocate the viewer snapshot\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    view.suspicion_max = cfg->suspicion_threshold;
+    view.lod_on = lod_wanted(cfg->num_gangs, cfg->max_gang_size);
+    if (lod_init(&view.lod, n, cfg->gang_size_limit, catalog->num_targets) == -1) {
+        exit(EXIT_FAILURE);
+    }
+    for (int v = 0; v < LOD_NUM_VIEWS; v++) {
+        const LodImage *image = &view.lod.images[v];
+        view.lod_pixels[v] = calloc((size_t)image->width * image->height, sizeof(uint32_t));
+        if (!view.lod_pixels[v]) {
+            fprintf(stderr, "Failed to allocate the viewer snapshot\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    pthread_mutex_init(&view.lock, NULL);
+}
+
+static void snapshot_free(void){
+    for (int g = 0; g < view.num_gangs; g++) free(view.gang_members[g]);
+    free(view.gang_members);
+    free(view.gangs);
+    free(view.versions);
+    free(view.leaders);
+    free(view.member_copy);
+    free(view.police);
+    for (int v = 0; v < LOD_NUM_VIEWS; v++) free(view.lod_pixels[v]);
+    lod_free(&view.lod);
+    pthread_mutex_destroy(&view.lock);
+}
+
+/* Pointers into the private copy, shaped like the live mapping */
+static ShmPtrs snapshot_ptrs(void){
+    ShmPtrs p = {0};
+    p.shared_game = &view.game;
+    p.gangs = view.gangs;
+    p.catalog = (TargetCatalog *)view.catalog;
+    p.police = police_tables_at(view.police, view.num_gangs, view.max_agents);
+    return p;
+}
+
 /*──────────────────────── tiny helpers ─────────────────────────*/
-static const char *target_name(TargetType t){
-    static const char* n[]={"Bank","Jewelry","Drugs","Art",
-                            "Kidnap","Blackmail","Arms"};
-    return (t<NUM_TARGETS)? n[t] : "U";
+static const char *target_name(const TargetCatalog *catalog,int t){
+    return (catalog && t>=0 && t<catalog->num_targets)? catalog_target_name(catalog,t) : "U";
 }
 static void panel(Rectangle r,const char *title){
     DrawRectangleLinesEx(r,2,GRAY);
@@ -86,9 +366,8 @@ static void draw_member(float cx, float cy, const Member *m) {
     float member_draw_start_x = cx - icon_half_size;
     float member_draw_start_y = cy - icon_half_size;
 
-    // Icon: Use texAgent if member is an agent, otherwise texGang
-    Texture2D current_member_tex = (m->agent_id >= 0) ? texAgent : texGang;
-    DrawTextureEx(current_member_tex, (Vector2){member_draw_start_x, member_draw_start_y}, 0.0f, MEMBER_ICON_SIZE / current_member_tex.width, WHITE);
+    // Icon: agent icon if member is an agent, otherwise gang icon
+    draw_icon(m->agent_id >= 0 ? ICON_AGENT : ICON_GANG, member_draw_start_x, member_draw_start_y, MEMBER_ICON_SIZE);
 
     // Info below icon
     float current_info_y = member_draw_start_y + MEMBER_ICON_SIZE + 8; // More space below icon
@@ -207,7 +486,8 @@ static void box_police(Rectangle r, ShmPtrs snap)
         DrawText("No Game struct!",(int)r.x+PAD,(int)r.y+40,18,RED);
         return;
     }
-    const PoliceForce *pf = &g->police_force;
+    const PoliceTables *pf = &snap.police;
+    int num_officers = g->police.num_officers;
     int icon = 32; // Smaller icon for more space
     int y = (int)r.y + 40;
     
@@ -218,7 +498,7 @@ static void box_police(Rectangle r, ShmPtrs snap)
     
     // Calculate total active agents
     int total_active_agents = 0;
-    for (int i = 0; i < pf->num_officers; ++i) {
+    for (int i = 0; i < num_officers; ++i) {
         total_active_agents += pf->officers[i].num_agents;
     }
     DrawText(TextFormat("Active Agents: %d", total_active_agents), (int)r.x+PAD+10, y, 14, BLUE); y += 18;
@@ -226,7 +506,7 @@ static void box_police(Rectangle r, ShmPtrs snap)
     // Arrested Gangs
     DrawText("Arrested Gangs:",(int)r.x+PAD, y, 16, DARKBLUE); y += 18;
     bool has_arrests = false;
-    for (int i = 0; i < MAX_GANGS_POLICE; ++i) {
+    for (int i = 0; i < num_officers; ++i) {
         if (pf->arrested_gangs[i] > 0) {
             Color arrest_color = (pf->arrested_gangs[i] > 10) ? RED : ORANGE;
             DrawText(TextFormat("Gang %d: %ds (Officer %d)", i, pf->arrested_gangs[i], i), 
@@ -242,16 +522,18 @@ static void box_police(Rectangle r, ShmPtrs snap)
     
     // Officers
     DrawText("Officers:",(int)r.x+PAD, y, 16, DARKBLUE); y += 18;
-    for (int i = 0; i < pf->num_officers && y < (int)(r.y + r.height - 80); ++i) {
+    for (int i = 0; i < num_officers && y < (int)(r.y + r.height - 80); ++i) {
         PoliceOfficer *po = &pf->officers[i];
+        const AgentInfo *agents = police_agents(pf, g->police.max_agents, i);
         Color c = po->is_active ? DARKGREEN : GRAY;
         
         // Draw smaller police icon
-        DrawTextureEx(texPolice, (Vector2){r.x+PAD, (float)y}, 0.0f, (float)icon/(float)texPolice.width, WHITE);
+        draw_icon(ICON_POLICE, r.x+PAD, (float)y, (float)icon);
         float text_x = r.x+PAD+(float)icon+6.0f;
         
         // Officer basic info
-        DrawText(TextFormat("ID:%d Gang:%d", po->police_id, po->gang_id_monitoring), (int)text_x, y, 13, c); y += 14;
+        DrawText(TextFormat("ID:%d Gang:%d Dept:%d", po->police_id, po->gang_id_monitoring, po->department),
+                 (int)text_x, y, 13, c); y += 14;
         
         // Knowledge with color coding
         Color knowledge_color = (po->knowledge_level > 0.8f) ? DARKGREEN : 
@@ -264,10 +546,10 @@ static void box_police(Rectangle r, ShmPtrs snap)
             
             // Show active agent knowledge levels
             for (int j = 0; j < po->num_agents && j < 3; ++j) { // Show max 3 agents to save space
-                if (po->agents[j].is_active) {
-                    Color agent_color = (po->agents[j].knowledge_level > 0.8f) ? DARKGREEN : 
-                                       (po->agents[j].knowledge_level > 0.5f) ? ORANGE : RED;
-                    DrawText(TextFormat("  Agent%d: %.2f", po->agents[j].agent_id, po->agents[j].knowledge_level), 
+                if (agents[j].is_active) {
+                    Color agent_color = (agents[j].knowledge_level > 0.8f) ? DARKGREEN : 
+                                       (agents[j].knowledge_level > 0.5f) ? ORANGE : RED;
+                    DrawText(TextFormat("  Agent%d: %.2f", agents[j].agent_id, agents[j].knowledge_level), 
                             (int)text_x, y, 11, agent_color); 
                     y += 12;
                 }
@@ -291,237 +573,355 @@ static void box_police(Rectangle r, ShmPtrs snap)
 /*──────────────────────── gangs panel ──────────────────────────*/
 static int collect_active(const Config*cfg,int *out, ShmPtrs snap){
     int n=0;
-    for(int i=0;i<cfg->num_gangs;i++){
+    for(int i=0;i<cfg->max_gangs;i++){
         const Gang* g=&snap.gangs[i];
         if(g->num_alive_members > 0 || g->plan_in_progress || g->num_agents > 0) out[n++]=i;
     }
     return n;
 }
 
-static void box_gangs(Rectangle r,const Config *cfg, ShmPtrs snap){
-    panel(r,"Gangs");
+#define MEMBERS_PER_CARD_ROW 4
+#define CARDS_PER_PANEL_ROW  2
+#define CARD_GAP_X 24.f
+#define CARD_GAP_Y 24.f
+#define MAX_VISIBLE_CARDS 64   /* a screenful is well under this */
 
-    hScroll+= (float)(IsKeyDown(KEY_RIGHT)-IsKeyDown(KEY_LEFT))*12.f;
-    if(hScroll<0) hScroll=0;
-    // Ensure hScroll doesn't scroll too far right (content width needs to be known)
-    // This part is omitted for brevity but would be needed for robust horizontal scrolling limits.
+static float card_height(int alive_members){
+    int rows = (alive_members + MEMBERS_PER_CARD_ROW - 1) / MEMBERS_PER_CARD_ROW;
+    return BASE_CARD_H + (float)rows * MEMBER_GRID_CELL_HEIGHT;
+}
 
-    vScroll-= GetMouseWheelMove()*40.f;
-    if(vScroll<0) vScroll=0;
-    // Vertical scroll limit also needs total content height, calculated later.
+/* Draw one gang card with its top-left corner at (x, y) */
+static void draw_card(float x, float y, float h, int gang_idx, const Gang *gang,
+                      const Member *members, int leader, int arrest, const TargetCatalog *catalog){
+    int alive = gang->num_alive_members;
+    DrawRectangle((int)x,(int)y,(int)(CARD_W_UPDATED-12),(int)(h-10),(Color){235,240,255,255});
+    DrawRectangleLines((int)x,(int)y,(int)(CARD_W_UPDATED-12),(int)(h-10),(Color){120,120,180,255});
+
+    float tx = x + 14;
+    float ty = y + 12;
+    DrawText(TextFormat("Gang %d | %s",gang_idx,target_name(catalog,gang->target_type)),
+             (int)tx,(int)ty,20,(Color){30,30,120,255}); ty+=28;
+
+    const char* state_text = "Preparing";
+    Color state_color = BLACK;
+    if (arrest > 0) {
+        state_text = "ARRESTED";
+        state_color = RED;
+    } else if (gang->plan_in_progress) {
+        state_text = "Executing";
+        state_color = ORANGE;
+    } else if (alive > 0 && gang->members_ready == alive) {
+        state_text = "Ready";
+        state_color = DARKGREEN;
+    }
+    DrawText(TextFormat("State  : %s",state_text),(int)tx,(int)ty,14,state_color); ty+=18;
+
+    // Show current success rate if it's available (whether plan is in progress or not)
+    if (gang->current_success_rate > 0.0f) {
+        Color rate_color = (gang->current_success_rate > 70.0f) ? DARKGREEN :
+                           (gang->current_success_rate > 40.0f) ? ORANGE : RED;
+        DrawText(TextFormat("Success Rate: %.1f%%", gang->current_success_rate),(int)tx,(int)ty,14,rate_color);
+        ty+=18;
+    }
+    if (arrest > 0) {
+        DrawText(TextFormat("Release: %ds",arrest),(int)tx,(int)ty,14,RED); ty+=18;
+    }
+    DrawText(TextFormat("Ready  : %d/%d",gang->members_ready, alive),(int)tx,(int)ty,14,BLACK); ty+=18;
+    DrawText(TextFormat("Success: %d",gang->num_successful_plans),(int)tx,(int)ty,14,(Color){30,120,30,255}); ty+=18;
+    DrawText(TextFormat("Thwart : %d",gang->num_thwarted_plans),(int)tx,(int)ty,14,(Color){120,30,30,255}); ty+=18;
+    DrawText(TextFormat("Agents : %d",gang->num_agents),(int)tx,(int)ty,14,(Color){30,30,120,255}); ty+=18;
+    DrawText(TextFormat("Queue  : %u (peak %u)",gang->queue_depth,gang->queue_peak),(int)tx,(int)ty,14,GRAY); ty+=22;
+
+    /* draw members; the leader was found when the gang was copied */
+    int drawn = 0;
+    for (int m = 0; m < gang->max_member_count; m++) {
+        if (!members[m].is_alive) continue;
+        float cx = tx + (drawn % MEMBERS_PER_CARD_ROW) * MEMBER_GRID_CELL_WIDTH + (MEMBER_GRID_CELL_WIDTH / 2.0f) - (PAD/2.0f);
+        float cy = ty + (drawn / MEMBERS_PER_CARD_ROW) * MEMBER_GRID_CELL_HEIGHT + (MEMBER_GRID_CELL_HEIGHT / 2.0f);
+        if (m == leader) {
+            int w = MeasureText("Leader", 12);
+            DrawText("Leader", (int)(cx - (MEMBER_ICON_SIZE/2.0f) - w - 2), (int)(cy - 6), 12, (Color){0,0,200,255});
+        }
+        draw_member(cx, cy, &members[m]);
+        drawn++;
+    }
+}
 
-    int idx[cfg->num_gangs];
-    int total_active_gangs = collect_active(cfg,idx, snap);
+/*──────────────── card cache ────────────────
+ * Visible cards are rendered once into a render texture and redrawn only
+ * when the gang's snapshot version or arrest timer changes. Only a few
+ * cards fit on screen, so a small pool of textures is recycled LRU. */
+#define CARD_CACHE_SLOTS 24
+#define CARD_TEX_MAX_H   4096
+
+typedef struct {
+    int gang;                 /* -1 when free */
+    uint32_t version;
+    int arrest;
+    float height;
+    uint64_t last_used;
+    RenderTexture2D rt;
+} CardSlot;
+
+static CardSlot card_slots[CARD_CACHE_SLOTS];
+static int card_tex_h;        /* tallest card this run can have */
+static uint64_t frame_no;
+static uint64_t cards_rendered;
+
+static void card_cache_init(const Config *cfg){
+    float h = card_height(cfg->gang_size_limit);
+    card_tex_h = h > CARD_TEX_MAX_H ? 0 : (int)h;   /* 0: draw directly */
+    for (int i = 0; i < CARD_CACHE_SLOTS; i++) card_slots[i].gang = -1;
+}
 
-    int members_per_row_on_card = 4;
-    int gangs_per_row_in_panel = 2;
-    float card_gap_x = 24.f, card_gap_y = 24.f;
+static void card_cache_free(void){
+    for (int i = 0; i < CARD_CACHE_SLOTS; i++)
+        if (card_slots[i].rt.id) UnloadRenderTexture(card_slots[i].rt);
+}
 
-    Rectangle view_scissor_area ={r.x+1,r.y+70,r.width-2,r.height-71};
-    BeginScissorMode((int)view_scissor_area.x,(int)view_scissor_area.y,(int)view_scissor_area.width,(int)view_scissor_area.height);
+/* Find or claim the slot of a gang; a claimed slot is always stale */
+static CardSlot *card_slot(int gang){
+    CardSlot *victim = &card_slots[0];
+    for (int i = 0; i < CARD_CACHE_SLOTS; i++) {
+        if (card_slots[i].gang == gang) return &card_slots[i];
+        if (card_slots[i].last_used < victim->last_used) victim = &card_slots[i];
+    }
+    if (!victim->rt.id) {
+        victim->rt = LoadRenderTexture((int)CARD_W_UPDATED, card_tex_h);
+        SetTextureFilter(victim->rt.texture, TEXTURE_FILTER_POINT);
+    }
+    victim->gang = gang;
+    victim->height = -1.0f;
+    return victim;
+}
 
-    float current_panel_row_y_start = r.y + 70.0f - vScroll; // Start Y for the first row of cards in the panel
-    float max_height_this_panel_row = 0.0f;
-    float total_content_height = 0; // For vertical scrollbar limit
+/* Bring the cached card of a visible gang up to date */
+static CardSlot *card_refresh(int g, float h, int arrest, ShmPtrs snap){
+    CardSlot *slot = card_slot(g);
+    slot->last_used = frame_no;
+    if (slot->height == h && slot->version == view.versions[g] && slot->arrest == arrest) return slot;
+
+    BeginTextureMode(slot->rt);
+      ClearBackground(BLANK);
+      /* texture y grows down from the top, the card is drawn at the top */
+      draw_card(0.f, 0.f, h, g, &snap.gangs[g], view.gang_members[g], view.leaders[g], arrest, snap.catalog);
+    EndTextureMode();
+    slot->version = view.versions[g];
+    slot->arrest = arrest;
+    slot->height = h;
+    cards_rendered++;
+    return slot;
+}
 
-    for(int k=0; k < total_active_gangs; k++){
-        int gang_array_idx = idx[k];
-        const Gang* current_gang = &snap.gangs[gang_array_idx];
-        int alive_members_count = current_gang->num_alive_members;
-        
-        int num_member_rows_on_card = (alive_members_count + members_per_row_on_card - 1) / members_per_row_on_card;
-        float card_actual_height = BASE_CARD_H + ((float)num_member_rows_on_card * MEMBER_GRID_CELL_HEIGHT); // Cast to float
+static void box_gangs(Rectangle r,const Config *cfg, ShmPtrs snap){
+    panel(r,"Gangs");
+    frame_no++;
 
-        int panel_col_idx = k % gangs_per_row_in_panel;
+    hScroll+= (float)(IsKeyDown(KEY_RIGHT)-IsKeyDown(KEY_LEFT))*12.f;
+    if(hScroll<0) hScroll=0;
+    vScroll-= GetMouseWheelMove()*40.f;
+    if(vScroll<0) vScroll=0;
 
-        if (panel_col_idx == 0 && k > 0) { // Starting a new row in the panel
-            current_panel_row_y_start += max_height_this_panel_row + card_gap_y;
-            total_content_height = current_panel_row_y_start - (r.y + 70.0f - vScroll); // Update content height based on new row start
-            max_height_this_panel_row = 0.0f; // Reset for the new row
+    int idx[cfg->max_gangs];
+    int total_active_gangs = collect_active(cfg,idx, snap);
+    const int *arrested = snap.police.arrested_gangs;
+
+    Rectangle view_area ={r.x+1,r.y+70,r.width-2,r.height-71};
+    float top = r.y + 70.0f - vScroll;
+
+    /* Layout needs only the alive counts; cards outside the view are
+     * skipped before anything is drawn or rendered */
+    typedef struct { int gang; float x, y, h; } PlacedCard;
+    PlacedCard visible[MAX_VISIBLE_CARDS];
+    int num_visible = 0;
+    float row_y = top;
+    for (int k = 0; k < total_active_gangs; k += CARDS_PER_PANEL_ROW) {
+        float row_h = 0.f;
+        for (int c = 0; c < CARDS_PER_PANEL_ROW && k + c < total_active_gangs; c++) {
+            float h = card_height(snap.gangs[idx[k + c]].num_alive_members);
+            if (h > row_h) row_h = h;
         }
-
-        max_height_this_panel_row = (card_actual_height > max_height_this_panel_row) ? card_actual_height : max_height_this_panel_row;
-        if (k == total_active_gangs -1 || (k+1) % gangs_per_row_in_panel == 0) { // Last card overall or last card in a row
-             if (panel_col_idx == 0 && k == 0) { // First card, first row
-                total_content_height = max_height_this_panel_row;
-            } else if ((k+1) % gangs_per_row_in_panel == 0) { // End of a full row
-                // total_content_height is already updated when a new row starts.
-                // For the very last row (which might not be full), update based on its max height.
+        if (row_y + row_h >= view_area.y && row_y <= view_area.y + view_area.height) {
+            for (int c = 0; c < CARDS_PER_PANEL_ROW && k + c < total_active_gangs; c++) {
+                float x = r.x + PAD + (float)c * (CARD_W_UPDATED + CARD_GAP_X) - hScroll;
+                if (x + CARD_W_UPDATED < view_area.x || x > view_area.x + view_area.width) continue;
+                if (num_visible < MAX_VISIBLE_CARDS) {
+                    int g = idx[k + c];
+                    visible[num_visible++] = (PlacedCard){g, x, row_y, card_height(snap.gangs[g].num_alive_members)};
+                }
             }
-             if (k == total_active_gangs - 1 && total_active_gangs > 0) { // If it's the very last card
-                 // Ensure total_content_height reflects the end of this last card's row
-                 // If this is the first row (k < gangs_per_row_in_panel)
-                 if (total_active_gangs <= gangs_per_row_in_panel) {
-                     total_content_height = max_height_this_panel_row;
-                 } else {
-                     // If it's not the first row, total_content_height was updated at the start of this row.
-                     // We need to add the height of this current row.
-                     // This logic is getting complex. A simpler way:
-                     // total_content_height = (current_panel_row_y_start + max_height_this_panel_row) - (r.y + 70.0f - vScroll);
-                     // This should be calculated after the loop for the final content height.
-                 }
-             }
         }
+        row_y += row_h + CARD_GAP_Y;
+    }
+    float total_content_height = total_active_gangs > 0 ? row_y - CARD_GAP_Y - top : 0.f;
 
+    /* render stale cards before the scissor: texture mode resets the viewport */
+    CardSlot *slots[MAX_VISIBLE_CARDS];
+    for (int i = 0; i < num_visible; i++) {
+        int g = visible[i].gang;
+        slots[i] = card_tex_h ? card_refresh(g, visible[i].h, arrested[g], snap) : NULL;
+    }
 
-        float current_card_x = (float)(r.x + PAD) + (float)panel_col_idx * (CARD_W_UPDATED + card_gap_x) - hScroll; // Cast to float
-        float current_card_y = current_panel_row_y_start;
-                                                                                            
-        // Culling: Skip drawing if card is entirely out of view
-        if(current_card_y + card_actual_height < view_scissor_area.y) continue; 
-        if(current_card_y > view_scissor_area.y + view_scissor_area.height) {
-            // If this card is already below the viewport, subsequent cards in this column or row will also be.
-            // If we are laying out row by row, we can break.
-            // If it's the first card in a new row that's below, then all subsequent rows are also below.
-            if (panel_col_idx == 0) break; 
-            // else, other cards in this row might still be visible if horizontal scrolling is wide.
-            // However, with vertical scrolling, if the top of the row is below, all of it is.
-            // So, `break` is likely fine if `current_panel_row_y_start` itself is already too low.
+    BeginScissorMode((int)view_area.x,(int)view_area.y,(int)view_area.width,(int)view_area.height);
+    for (int i = 0; i < num_visible; i++) {
+        const PlacedCard *pc = &visible[i];
+        if (slots[i]) {
+            /* render textures are stored bottom-up */
+            Rectangle src = {0, (float)card_tex_h - pc->h, CARD_W_UPDATED, -pc->h};
+            DrawTextureRec(slots[i]->rt.texture, src, (Vector2){pc->x, pc->y}, WHITE);
+        } else {
+            int g = pc->gang;
+            draw_card(pc->x, pc->y, pc->h, g, &snap.gangs[g], view.gang_members[g], view.leaders[g],
+                      arrested[g], snap.catalog);
         }
+    }
 
+    // Vertical scrollbar logic (optional, if content overflows)
+    if (total_content_height > view_area.height) {
+        float track_h = view_area.height;
+        float thumb_h = (view_area.height / total_content_height) * track_h;
+        if (thumb_h < 20) thumb_h = 20; // Min thumb height
+        if (vScroll > total_content_height - view_area.height) vScroll = total_content_height - view_area.height;
+        float thumb_y = view_area.y + (vScroll / (total_content_height - view_area.height)) * (track_h - thumb_h);
+
+        DrawRectangle((int)(view_area.x + view_area.width - 8), (int)view_area.y, 6, (int)track_h, LIGHTGRAY);
+        DrawRectangle((int)(view_area.x + view_area.width - 8), (int)thumb_y, 6, (int)thumb_h, DARKGRAY);
+    } else {
+        vScroll = 0; // No scroll needed if content fits
+    }
 
-        DrawRectangle((int)current_card_x,(int)current_card_y,(int)(CARD_W_UPDATED-12),(int)(card_actual_height-10),
-                      (Color){235,240,255,255});
-        DrawRectangleLines((int)current_card_x,(int)current_card_y,(int)(CARD_W_UPDATED-12),(int)(card_actual_height-10),
-                           (Color){120,120,180,255});
-
-        float text_start_x_in_card = current_card_x + 14;
-        float text_start_y_in_card = current_card_y + 12;
-        DrawText(TextFormat("Gang %d | %s",gang_array_idx,target_name(current_gang->target_type)),
-                 (int)text_start_x_in_card,(int)text_start_y_in_card,20,(Color){30,30,120,255}); text_start_y_in_card+=28;
-
-        const char* gang_state_text = "Preparing";
-        Color gang_state_color = BLACK;
-        
-        // Check if gang is arrested
-        if (snap.shared_game && snap.shared_game->police_force.arrested_gangs[gang_array_idx] > 0) {
-            gang_state_text = "ARRESTED";
-            gang_state_color = RED;
-        } else if (current_gang->plan_in_progress) {
-            gang_state_text = "Executing";
-            gang_state_color = ORANGE;
-        } else if (alive_members_count > 0 && current_gang->members_ready == alive_members_count) {
-            gang_state_text = "Ready";
-            gang_state_color = DARKGREEN;
-        } else if (alive_members_count == 0 && !current_gang->plan_in_progress) {
-            gang_state_text = "Preparing"; // Or "Idle"
-            gang_state_color = BLACK;
-        }
+    EndScissorMode();
+}
 
-        DrawText(TextFormat("State  : %s",gang_state_text),(int)text_start_x_in_card,(int)text_start_y_in_card,14,gang_state_color); text_start_y_in_card+=18;
-        
-        // Show current success rate if it's available (whether plan is in progress or not)
-        if (current_gang->current_success_rate > 0.0f) {
-            Color success_rate_color = (current_gang->current_success_rate > 70.0f) ? DARKGREEN :
-                                      (current_gang->current_success_rate > 40.0f) ? ORANGE : RED;
-            DrawText(TextFormat("Success Rate: %.1f%%", current_gang->current_success_rate),
-                     (int)text_start_x_in_card,(int)text_start_y_in_card,14,success_rate_color); 
-            text_start_y_in_card+=18;
-        }
-        
-        // Show arrest time if gang is arrested
-        if (snap.shared_game && snap.shared_game->police_force.arrested_gangs[gang_array_idx] > 0) {
-            DrawText(TextFormat("Release: %ds",snap.shared_game->police_force.arrested_gangs[gang_array_idx]),
-                     (int)text_start_x_in_card,(int)text_start_y_in_card,14,RED); text_start_y_in_card+=18;
-        }
-        DrawText(TextFormat("Ready  : %d/%d",current_gang->members_ready, alive_members_count),
-                 (int)text_start_x_in_card,(int)text_start_y_in_card,14,BLACK); text_start_y_in_card+=18;
-        DrawText(TextFormat("Success: %d",current_gang->num_successful_plans),
-                 (int)text_start_x_in_card,(int)text_start_y_in_card,14,(Color){30,120,30,255}); text_start_y_in_card+=18;
-        DrawText(TextFormat("Thwart : %d",current_gang->num_thwarted_plans),
-                 (int)text_start_x_in_card,(int)text_start_y_in_card,14,(Color){120,30,30,255}); text_start_y_in_card+=18;
-        DrawText(TextFormat("Agents : %d",current_gang->num_agents),
-                 (int)text_start_x_in_card,(int)text_start_y_in_card,14,(Color){30,30,120,255}); text_start_y_in_card+=22; 
-
-        /* draw members */
-        const Member *member_array_for_gang = snap.gang_members[gang_array_idx];
-        int leader_member_idx = -1;
-        int highest_rank_found = -999;
-        for (int m_scan = 0; m_scan < current_gang->max_member_count; m_scan++) {
-            if (member_array_for_gang[m_scan].is_alive && member_array_for_gang[m_scan].rank > highest_rank_found) {
-                highest_rank_found = member_array_for_gang[m_scan].rank;
-                leader_member_idx = m_scan;
-            }
-        }
+/*──────────────────────── aggregate views ──────────────────────*/
+static Texture2D texLod[LOD_NUM_VIEWS];
+static uint64_t lod_seen;
 
-        float member_grid_y_offset_in_card = text_start_y_in_card; 
-        int drawn_member_visual_count = 0;
-        for (int m_loop_idx = 0; m_loop_idx < current_gang->max_member_count; m_loop_idx++) {
-            if (member_array_for_gang[m_loop_idx].is_alive) {
-                float member_center_x = text_start_x_in_card + (drawn_member_visual_count % members_per_row_on_card) * MEMBER_GRID_CELL_WIDTH + (MEMBER_GRID_CELL_WIDTH / 2.0f) - (PAD/2.0f);
-                float member_center_y = member_grid_y_offset_in_card + (drawn_member_visual_count / members_per_row_on_card) * MEMBER_GRID_CELL_HEIGHT + (MEMBER_GRID_CELL_HEIGHT / 2.0f);
-                if (m_loop_idx == leader_member_idx) {
-                    char leader_label[] = "Leader";
-                    int leader_text_width = MeasureText(leader_label, 12);
-                    DrawText(leader_label, (int)(member_center_x - (MEMBER_ICON_SIZE/2.0f) - leader_text_width - 2) , (int)(member_center_y - 6), 12, (Color){0,0,200,255});
-                }
-                draw_member(member_center_x, member_center_y, &member_array_for_gang[m_loop_idx]);
-                drawn_member_visual_count++;
-            }
-        }
-    }
-    // After the loop, calculate the final total_content_height for the scrollbar
-    if (total_active_gangs > 0) {
-        total_content_height = (current_panel_row_y_start + max_height_this_panel_row) - (r.y + 70.0f - vScroll) + vScroll;
-    } else {
-        total_content_height = 0;
+static void lod_textures_init(void){
+    for (int v = 0; v < LOD_NUM_VIEWS; v++) {
+        const LodImage *image = &view.lod.images[v];
+        Image img = {view.lod_pixels[v], image->width, image->height, 1, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8};
+        texLod[v] = LoadTextureFromImage(img);
+        SetTextureFilter(texLod[v], TEXTURE_FILTER_POINT);
     }
-    
-    // Vertical scrollbar logic (optional, if content overflows)
-    if (total_content_height > view_scissor_area.height) {
-        float scrollbar_track_height = view_scissor_area.height;
-        float scrollbar_thumb_height = (view_scissor_area.height / total_content_height) * scrollbar_track_height;
-        if (scrollbar_thumb_height < 20) scrollbar_thumb_height = 20; // Min thumb height
+}
 
-        float scrollbar_y_pos = view_scissor_area.y + (vScroll / (total_content_height - view_scissor_area.height)) * (scrollbar_track_height - scrollbar_thumb_height);
-        if (vScroll == 0) scrollbar_y_pos = view_scissor_area.y;
-        if (vScroll >= total_content_height - view_scissor_area.height) scrollbar_y_pos = view_scissor_area.y + scrollbar_track_height - scrollbar_thumb_height;
+static void lod_textures_free(void){
+    for (int v = 0; v < LOD_NUM_VIEWS; v++) UnloadTexture(texLod[v]);
+}
 
+static void lod_quad(Rectangle r, int v, const char *title, const char *x_label, const char *y_label){
+    DrawText(title, (int)r.x, (int)r.y, 14, DARKBLUE);
+    Rectangle area = {r.x, r.y + 18, r.width, r.height - 34};
+    const LodImage *image = &view.lod.images[v];
+    DrawTexturePro(texLod[v], (Rectangle){0, 0, (float)image->width, (float)image->height}, area,
+                   (Vector2){0, 0}, 0.0f, WHITE);
+    DrawRectangleLinesEx(area, 1, GRAY);
+    DrawText(TextFormat("%s  |  %s", x_label, y_label), (int)r.x, (int)(area.y + area.height + 3), 10, DARKGRAY);
+}
 
-        DrawRectangle((int)(view_scissor_area.x + view_scissor_area.width - 8), (int)view_scissor_area.y, 6, (int)scrollbar_track_height, LIGHTGRAY);
-        DrawRectangle((int)(view_scissor_area.x + view_scissor_area.width - 8), (int)scrollbar_y_pos, 6, (int)scrollbar_thumb_height, DARKGRAY);
-        
-        // Clamp vScroll
-        if (vScroll > total_content_height - view_scissor_area.height && total_content_height > view_scissor_area.height) {
-            vScroll = total_content_height - view_scissor_area.height;
-        }
-    } else {
-        vScroll = 0; // No scroll needed if content fits
+/* Gangs panel for populations too large for member cards: four textured
+ * quads the snapshot thread keeps up to date */
+static void box_aggregates(Rectangle r, const Config *cfg){
+    panel(r, TextFormat("Gangs (aggregate: %d gangs x up to %d members, TAB for cards)",
+                        cfg->max_gangs, cfg->gang_size_limit));
+    if (view.lod_generation != lod_seen) {
+        for (int v = 0; v < LOD_NUM_VIEWS; v++) UpdateTexture(texLod[v], view.lod_pixels[v]);
+        lod_seen = view.lod_generation;
     }
 
-
-    EndScissorMode();
+    float x = r.x + PAD, y = r.y + 40;
+    float w = (r.width - 3 * PAD) / 2, h = (r.height - 50 - PAD) / 2;
+    const char *rows = view.lod.gangs_per_row > 1 ? TextFormat("rows: %d gangs each", view.lod.gangs_per_row)
+                                                  : "rows: gangs";
+    lod_quad((Rectangle){x, y, w, h}, LOD_SUSPICION, "Agent suspicion", "0 .. threshold", rows);
+    lod_quad((Rectangle){x + w + PAD, y, w, h}, LOD_KNOWLEDGE, "Member knowledge", "0 .. 1", rows);
+    lod_quad((Rectangle){x, y + h + PAD, w, h}, LOD_HEAT, "Heat by target", "columns: targets", rows);
+    lod_quad((Rectangle){x + w + PAD, y + h + PAD, w, h}, LOD_DENSITY, "Agent density", "agents / alive",
+             "one cell per gang");
 }
 
 /*───────────────────────── main ───────────────────────────────*/
 int main(int argc, char *argv[]){
     Config cfg;
-    ShmPtrs snap;          /* rebuilt every frame */
-
-    if (argc < 2) {
-        fprintf(stderr, "graphics viewer: Missing serialized config argument\n");
+    ShmPtrs live = {0};    /* the mapping; only the snapshot thread reads it */
+    StreamClient client = {.fd = -1};
+    const char *connect_address = NULL;
+
+    if (argc == 3 && strcmp(argv[1], "--connect") == 0) {
+        connect_address = argv[2];
+    } else if (argc != 1) {
+        fprintf(stderr, "Usage: %s [--connect ADDRESS]\n"
+                        "  --connect ADDRESS  follow main --stream (socket path or :PORT)\n"
+                        "                     instead of mapping shared memory\n", argv[0]);
         return 1;
     }
-    deserialize_config(argv[1], &cfg);
 
-    shared_game = setup_shared_memory_user(&cfg, &snap);
+    if (connect_address != NULL) {
+        /* config and catalog arrive in the stream's hello */
+        if (stream_connect(&client, connect_address) == -1) {
+            return 1;
+        }
+        cfg = client.config;
+        snapshot_init(&cfg, client.catalog);
+    } else {
+        /* config comes from the block main published in shared memory */
+        shared_game = setup_shared_memory_user(&cfg, &live);
+        snapshot_init(&cfg, live.catalog);
+    }
 
-    InitWindow(WIN_W,WIN_H,"Bakery Gang Viewer (read-only)");
-    texGang   = mustLoad(ASSETS_PATH"gang.png");
-    texAgent  = mustLoad(ASSETS_PATH"agent.png");
-    texPolice = mustLoad(ASSETS_PATH"police.png");
+    ShmPtrs snap = snapshot_ptrs();
+    pthread_t snapshot_tid;
+    if (pthread_create(&snapshot_tid, NULL, connect_address ? stream_thread : snapshot_thread,
+                       connect_address ? (void *)&client : (void *)&live) != 0) {
+        perror("pthread_create snapshot");
+        exit(EXIT_FAILURE);
+    }
+
+    InitWindow(WIN_W,WIN_H,connect_address ? "Bakery Gang Viewer (remote)" : "Bakery Gang Viewer (read-only)");
+    load_atlas();
+    card_cache_init(&cfg);
+    lod_textures_init();
     SetTargetFPS(60);
     while(!WindowShouldClose()){
+        /* frame boundary: pick up a reloaded config */
+        if (connect_address) {
+            /* the streamed game header carries main's config block */
+            pthread_mutex_lock(&view.lock);
+            config_refresh(&view.game.config_block,&cfg,&live.config_generation);
+            pthread_mutex_unlock(&view.lock);
+        } else if (config_refresh(&shared_game->config_block,&cfg,&live.config_generation)) {
+            __atomic_store_n(&view.hz, cfg.viewer_snapshot_hz, __ATOMIC_RELAXED);
+        }
+        /* aggregates switch on by themselves for large games; TAB flips */
+        if (IsKeyPressed(KEY_TAB))
+            __atomic_store_n(&view.lod_on, !view.lod_on, __ATOMIC_RELAXED);
         BeginDrawing();
           ClearBackground(COL_BG);
+          pthread_mutex_lock(&view.lock);
           box_police(R_POL, snap);
           box_game  (R_GME,&cfg, snap);
-          box_gangs (R_GAN,&cfg, snap);
+          if (view.lod_on && view.lod_generation) box_aggregates(R_GAN,&cfg);
+          else                                    box_gangs (R_GAN,&cfg, snap);
+          pthread_mutex_unlock(&view.lock);
         EndDrawing();
     }
-    UnloadTexture(texGang);
-    UnloadTexture(texAgent);
-    UnloadTexture(texPolice);
+    view.stop = 1;
+    pthread_join(snapshot_tid, NULL);
+    printf("VIEWER: %llu snapshots, %llu gang copies rebuilt, %llu cards rendered in %llu frames\n",
+           (unsigned long long)view.snapshots, (unsigned long long)view.gangs_rebuilt,
+           (unsigned long long)cards_rendered, (unsigned long long)frame_no);
+    if (connect_address) {
+        printf("VIEWER: %llu bytes received\n", (unsigned long long)client.bytes_read);
+        fflush(stdout);
+        stream_close(&client);
+    }
+    fflush(stdout);
+    snapshot_free();
+    card_cache_free();
+    lod_textures_free();
+    UnloadTexture(texAtlas);
     CloseWindow();
     return 0;
 }
@@ -0,0 +1,186 @@
+#include "viewer_lod.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// 256-step ramp from background grey through orange to dark red
+static uint32_t ramp[256];
+
+static uint32_t rgba(int r, int g, int b) {
+    // Bytes R, G, B, A in memory, which is what raylib's RGBA8 expects
+    return (uint32_t)r | (uint32_t)g << 8 | (uint32_t)b << 16 | 0xFFu << 24;
+}
+
+static void build_ramp(void) {
+    for (int i = 0; i < 256; i++) {
+        float t = i / 255.0f;
+        if (t < 0.5f) {
+            float u = t * 2.0f;
+            ramp[i] = rgba((int)(245 + u * (255 - 245)), (int)(245 - u * (245 - 160)), (int)(245 - u * 245));
+        } else {
+            float u = (t - 0.5f) * 2.0f;
+            ramp[i] = rgba((int)(255 - u * (255 - 140)), (int)(160 - u * 160), 0);
+        }
+    }
+}
+
+static int image_init(LodImage *image, int width, int height) {
+    image->width = width;
+    image->height = height;
+    image->values = calloc((size_t)width * height, sizeof(float));
+    image->pixels = calloc((size_t)width * height, sizeof(uint32_t));
+    return image->values && image->pixels ? 0 : -1;
+}
+
+int lod_init(LodViews *lod, int num_gangs, int max_gang_size, int num_targets) {
+    memset(lod, 0, sizeof(*lod));
+    if (ramp[255] == 0) {
+        build_ramp();
+    }
+
+    lod->num_gangs = num_gangs;
+    lod->max_gang_size = max_gang_size;
+    lod->num_targets = num_targets > 0 ? num_targets : 1;
+    lod->gangs_per_row = (num_gangs + LOD_MAX_ROWS - 1) / LOD_MAX_ROWS;
+    if (lod->gangs_per_row < 1) lod->gangs_per_row = 1;
+    lod->rows = (num_gangs + lod->gangs_per_row - 1) / lod->gangs_per_row;
+    if (lod->rows < 1) lod->rows = 1;
+
+    int grid = (int)ceil(sqrt((double)num_gangs));
+    if (grid < 1) grid = 1;
+    int grid_rows = (num_gangs + grid - 1) / grid;
+    if (grid_rows < 1) grid_rows = 1;
+
+    size_t row_members = (size_t)lod->gangs_per_row * max_gang_size;
+    lod->scratch = malloc(row_members * sizeof(float));
+    lod->bins = malloc(row_members * sizeof(int));
+    if (image_init(&lod->images[LOD_SUSPICION], LOD_HIST_BINS, lod->rows) == -1 ||
+        image_init(&lod->images[LOD_KNOWLEDGE], LOD_HIST_BINS, lod->rows) == -1 ||
+        image_init(&lod->images[LOD_HEAT], lod->num_targets, lod->rows) == -1 ||
+        image_init(&lod->images[LOD_DENSITY], grid, grid_rows) == -1 ||
+        lod->scratch == NULL || lod->bins == NULL) {
+        fprintf(stderr, "Failed to allocate the aggregate views\n");
+        lod_free(lod);
+        return -1;
+    }
+    return 0;
+}
+
+void lod_free(LodViews *lod) {
+    for (int v = 0; v < LOD_NUM_VIEWS; v++) {
+        free(lod->images[v].values);
+        free(lod->images[v].pixels);
+    }
+    free(lod->scratch);
+    free(lod->bins);
+    memset(lod, 0, sizeof(*lod));
+}
+
+// Bin n values into one histogram row and normalise it to its fullest bin.
+// The bin index pass has no branches or dependencies between iterations,
+// so the compiler vectorises it; only the counting stays scalar.
+static void histogram_row(float *row, const float *values, int *bins, int n, float scale) {
+    for (int i = 0; i < n; i++) {
+        int b = (int)(values[i] * scale);
+        b = b < 0 ? 0 : b;
+        bins[i] = b > LOD_HIST_BINS - 1 ? LOD_HIST_BINS - 1 : b;
+    }
+    int counts[LOD_HIST_BINS] = {0};
+    for (int i = 0; i < n; i++) {
+        counts[bins[i]]++;
+    }
+    int fullest = 0;
+    for (int b = 0; b < LOD_HIST_BINS; b++) {
+        fullest = counts[b] > fullest ? counts[b] : fullest;
+    }
+    float inv = fullest > 0 ? 1.0f / fullest : 0.0f;
+    for (int b = 0; b < LOD_HIST_BINS; b++) {
+        row[b] = counts[b] * inv;
+    }
+}
+
+static void to_pixels(LodImage *image) {
+    size_t cells = (size_t)image->width * image->height;
+    for (size_t i = 0; i < cells; i++) {
+        float v = image->values[i];
+        v = v < 0.0f ? 0.0f : v > 1.0f ? 1.0f : v;
+        image->pixels[i] = ramp[(int)(v * 255.0f)];
+    }
+}
+
+void lod_compute(LodViews *lod, const Gang *gangs, Member *const *gang_members,
+                 const TargetCatalog *catalog, float suspicion_max) {
+    float suspicion_scale = LOD_HIST_BINS / (suspicion_max > 0.0f ? suspicion_max : 1.0f);
+    LodImage *suspicion = &lod->images[LOD_SUSPICION];
+    LodImage *knowledge = &lod->images[LOD_KNOWLEDGE];
+    LodImage *heat = &lod->images[LOD_HEAT];
+    LodImage *density = &lod->images[LOD_DENSITY];
+
+    for (int row = 0; row < lod->rows; row++) {
+        int first = row * lod->gangs_per_row;
+        int last = first + lod->gangs_per_row;
+        if (last > lod->num_gangs) last = lod->num_gangs;
+
+        // Gather the row's members into a flat array, then reduce it
+        int n = 0;
+        for (int g = first; g < last; g++) {
+            const Member *members = gang_members[g];
+            for (int m = 0; m < gangs[g].max_member_count && m < lod->max_gang_size; m++) {
+                if (members[m].is_alive && members[m].agent_id >= 0) {
+                    lod->scratch[n++] = members[m].suspicion;
+                }
+            }
+        }
+        histogram_row(&suspicion->values[row * LOD_HIST_BINS], lod->scratch, lod->bins, n, suspicion_scale);
+
+        n = 0;
+        for (int g = first; g < last; g++) {
+            const Member *members = gang_members[g];
+            for (int m = 0; m < gangs[g].max_member_count && m < lod->max_gang_size; m++) {
+                if (members[m].is_alive) {
+                    lod->scratch[n++] = members[m].knowledge;
+                }
+            }
+        }
+        histogram_row(&knowledge->values[row * LOD_HIST_BINS], lod->scratch, lod->bins, n, (float)LOD_HIST_BINS);
+
+        // Heat: per target, the largest of the row's gangs
+        float *heat_row = &heat->values[row * heat->width];
+        for (int t = 0; t < heat->width; t++) heat_row[t] = 0.0f;
+        if (catalog != NULL && catalog->num_targets == heat->width) {
+            const float *target_heat = catalog_target_heat(catalog);
+            for (int g = first; g < last; g++) {
+                const float *gang_heat = catalog_gang_heat(catalog, g);
+                for (int t = 0; t < heat->width; t++) {
+                    float h = target_heat[t] * gang_heat[t];
+                    heat_row[t] = h > heat_row[t] ? h : heat_row[t];
+                }
+            }
+        }
+    }
+
+    // Heat has no natural top, so scale the matrix to its hottest cell
+    size_t heat_cells = (size_t)heat->width * heat->height;
+    float hottest = 0.0f;
+    for (size_t i = 0; i < heat_cells; i++) {
+        hottest = heat->values[i] > hottest ? heat->values[i] : hottest;
+    }
+    if (hottest > 0.0f) {
+        float inv = 1.0f / hottest;
+        for (size_t i = 0; i < heat_cells; i++) {
+            heat->values[i] *= inv;
+        }
+    }
+
+    size_t density_cells = (size_t)density->width * density->height;
+    for (size_t i = 0; i < density_cells; i++) {
+        int g = (int)i;
+        density->values[i] = g < lod->num_gangs && gangs[g].num_alive_members > 0
+            ? (float)gangs[g].num_agents / gangs[g].num_alive_members : 0.0f;
+    }
+
+    for (int v = 0; v < LOD_NUM_VIEWS; v++) {
+        to_pixels(&lod->images[v]);
+    }
+}
@@ -4,6 +4,37 @@
 #include "json/json-config.h"
 #include "gang.h"
 
+#include <stdlib.h>
+#include "target_catalog.h"
+
+// Built-in names, in enum order
+static const char *builtin_target_names[NUM_TARGETS] = {
+    "bank_robbery",
+    "jewelry_shop_robbery",
+    "drug_trafficking",
+    "art_theft",
+    "kidnapping",
+    "blackmail",
+    "arms_trafficking"
+};
+
+static const char *builtin_attribute_names[NUM_ATTRIBUTES] = {
+    "smartness",
+    "stealth",
+    "strength",
+    "tech_skills",
+    "bravery",
+    "negotiation",
+    "networking"
+};
+
+static int find_name(const char *const names[], int count, const char *name) {
+    for (int i = 0; i < count; i++) {
+        if (strcmp(names[i], name) == 0) return i;
+    }
+    return -1;
+}
+
 /**
  * Maps a crime name from JSON to the corresponding TargetType enum
  *
@@ -11,15 +42,7 @@
  * @return Corresponding TargetType enum value, or -1 if not found
  */
 TargetType get_target_type_from_name(const char* name) {
-    if (strcmp(name, "bank_robbery") == 0) return TARGET_BANK_ROBBERY;
-    if (strcmp(name, "jewelry_shop_robbery") == 0) return TARGET_JEWELRY_ROBBERY;
-    if (strcmp(name, "drug_trafficking") == 0) return TARGET_DRUG_TRAFFICKING;
-    if (strcmp(name, "art_theft") == 0) return TARGET_ART_THEFT;
-    if (strcmp(name, "kidnapping") == 0) return TARGET_KIDNAPPING;
-    if (strcmp(name, "blackmail") == 0) return TARGET_BLACKMAIL;
-    if (strcmp(name, "arms_trafficking") == 0) return TARGET_ARMS_TRAFFICKING;
-    
-    return -1; // Unknown target type
+    return find_name(builtin_target_names, NUM_TARGETS, name);
 }
 
 /**
@@ -29,15 +52,7 @@ TargetType get_target_type_from_name(const char* name) {
  * @return Corresponding AttributeType enum value, or -1 if not found
  */
 AttributeType get_attribute_type_from_name(const char* name) {
-    if (strcmp(name, "smartness") == 0) return ATTR_SMARTNESS;
-    if (strcmp(name, "stealth") == 0) return ATTR_STEALTH;
-    if (strcmp(name, "strength") == 0) return ATTR_STRENGTH;
-    if (strcmp(name, "tech_skills") == 0) return ATTR_TECH_SKILLS;
-    if (strcmp(name, "bravery") == 0) return ATTR_BRAVERY;
-    if (strcmp(name, "negotiation") == 0) return ATTR_NEGOTIATION;
-    if (strcmp(name, "networking") == 0) return ATTR_NETWORKING;
-    
-    return -1; // Unknown attribute type
+    return find_name(builtin_attribute_names, NUM_ATTRIBUTES, name);
 }
 
 /**
@@ -109,6 +124,130 @@ int load_targets_from_json(const char* filename, Target targets[]) {
     return targets_loaded;
 }
 
+// Index of an attribute in the catalog, registering new names as they appear
+static int catalog_attribute_index(TargetCatalog *catalog, const char *name) {
+    for (int a = 0; a < catalog->num_attributes; a++) {
+        if (strcmp(catalog_attribute_name(catalog, a), name) == 0) return a;
+    }
+    return -1;
+}
+
+/**
+ * Loads the target catalog from the JSON configuration file
+ *
+ * Targets may appear under any name. Attribute names other than the built-in
+ * ones are appended after them, up to MAX_ATTRIBUTES. Each target may carry an
+ * optional "heat" entry (how pursued it is, default 1.0).
+ *
+ * @param filename Path to JSON configuration file
+ * @param num_gangs Number of gangs to reserve heat rows for
+ * @return Heap-allocated catalog (release with free), or NULL on failure
+ */
+TargetCatalog *load_target_catalog_from_json(const char* filename, int num_gangs) {
+    json_object *targets_obj;
+
+    json_object *root_obj = json_object_from_file(filename);
+    if (!root_obj) {
+        fprintf(stderr, "Error parsing JSON file: %s\n", filename);
+        return NULL;
+    }
+
+    if (!json_object_object_get_ex(root_obj, "targets", &targets_obj)) {
+        fprintf(stderr, "Error: No 'targets' object found in JSON file\n");
+        json_object_put(root_obj);
+        return NULL;
+    }
+
+    // First pass: count targets and collect the attribute names
+    char attr_names[MAX_ATTRIBUTES][CATALOG_NAME_LEN];
+    int num_attributes = NUM_ATTRIBUTES;
+    int num_targets = 0;
+    for (int a = 0; a < NUM_ATTRIBUTES; a++) {
+        snprintf(attr_names[a], CATALOG_NAME_LEN, "%s", builtin_attribute_names[a]);
+    }
+
+    json_object_object_foreach(targets_obj, target_name, target_obj) {
+        num_targets++;
+        json_object_object_foreach(target_obj, attr_name, attr_value) {
+            (void)attr_value;
+            if (strcmp(attr_name, "heat") == 0) continue;
+
+            // Cut short, two names sharing a prefix would become one attribute
+            if (strlen(attr_name) >= CATALOG_NAME_LEN) {
+                fprintf(stderr, "Error: Attribute name '%s' for target '%s' is longer than %d characters\n",
+                        attr_name, target_name, CATALOG_NAME_LEN - 1);
+                json_object_put(root_obj);
+                return NULL;
+            }
+
+            int known = 0;
+            for (int a = 0; a < num_attributes && !known; a++) {
+                known = strcmp(attr_names[a], attr_name) == 0;
+            }
+            if (known) continue;
+
+            if (num_attributes == MAX_ATTRIBUTES) {
+                fprintf(stderr, "Warning: Too many attributes, ignoring '%s' for target '%s'\n",
+                        attr_name, target_name);
+                continue;
+            }
+            snprintf(attr_names[num_attributes++], CATALOG_NAME_LEN, "%s", attr_name);
+        }
+    }
+
+    if (num_targets == 0) {
+        fprintf(stderr, "Error: No targets defined in JSON file\n");
+        json_object_put(root_obj);
+        return NULL;
+    }
+
+    size_t size = target_catalog_size(num_targets, num_attributes, num_gangs);
+    TargetCatalog *catalog = aligned_alloc(CATALOG_ALIGN, size);
+    if (!catalog) {
+        fprintf(stderr, "Error: Failed to allocate target catalog\n");
+        json_object_put(root_obj);
+        return NULL;
+    }
+    target_catalog_init(catalog, num_targets, num_attributes, num_gangs);
+    for (int a = 0; a < num_attributes; a++) {
+        memcpy(catalog_attribute_name(catalog, a), attr_names[a], CATALOG_NAME_LEN);
+    }
+
+    // Second pass: fill in names, weights and heat
+    float *target_heat = catalog_target_heat(catalog);
+    int t = 0;
+    json_object_object_foreach(targets_obj, name, obj) {
+        snprintf(catalog_target_name(catalog, t), CATALOG_NAME_LEN, "%s", name);
+        target_heat[t] = 1.0f;
+
+        float *weights = catalog_weights(catalog, t);
+        json_object_object_foreach(obj, key, value) {
+            if (strcmp(key, "heat") == 0) {
+                target_heat[t] = (float)json_object_get_double(value);
+                continue;
+            }
+            int a = catalog_attribute_index(catalog, key);
+            if (a >= 0) {
+                weights[a] = (float)json_object_get_double(value);
+            }
+        }
+        t++;
+    }
+
+    // Every gang starts with a neutral heat of 1 on every target
+    for (int g = 0; g < num_gangs; g++) {
+        float *gang_heat = catalog_gang_heat(catalog, g);
+        for (int i = 0; i < num_targets; i++) {
+            gang_heat[i] = 1.0f;
+        }
+    }
+
+    json_object_put(root_obj);
+
+    printf("Successfully loaded %d targets with %d attributes from JSON\n", num_targets, num_attributes);
+    return catalog;
+}
+
 /**
  * Validates that target weights sum to approximately 1.0
  *
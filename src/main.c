@@ -1,6 +1,15 @@
+#include <errno.h>
+#include <getopt.h>
+#include <libgen.h>
+#include <limits.h>
+#include <poll.h>
 #include <signal.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <sys/inotify.h>
+#include <sys/wait.h>
+#include <time.h>
 #include <unistd.h>
 #include "config.h"
 #include "json/json-config.h"
@@ -8,6 +17,10 @@
 #include "shared_mem_utils.h"
 #include "semaphores_utils.h"
 #include "random.h"
+#include "instance.h"
+#include "message.h"
+#include "journal.h"
+#include "state_stream.h"
 
 
 /* globals from your original code --------------------------- */
@@ -17,17 +30,127 @@ pid_t  *processes          = NULL;  // Dynamic allocation based on number of gan
 int    num_processes       = 0;
 Config config;
 
+// Command line options (ocf-sweep runs headless with a time limit)
+static const char *config_path = CONFIG_PATH;
+static const char *result_path = NULL;
+static int headless = 0;
+static int max_time = 0;       // Game seconds before the run is cut off (0 = no limit)
+static const char *checkpoint_path = "ocf.ckpt";
+static const char *restore_path = NULL;
+static int checkpoint_interval = 0;  // Game seconds between automatic checkpoints (0 = only on SIGUSR1)
+static volatile sig_atomic_t checkpoint_pending = 0;
+static const char *journal_path = NULL;
+static const char *record_path = NULL;
+static int record_hz = 10;
+static const char *stream_address = NULL;
+
+// Threads normally park within a member's nap (3 s); one that doesn't is
+// stuck, and the game shouldn't stand still waiting for it
+#define CHECKPOINT_TIMEOUT_MS 5000
+
+// Children that haven't checked in by then are left behind
+#define STARTUP_TIMEOUT_MS 30000
+
+// A retired gang leaves at its next plan boundary, or is killed after this
+#define GANG_RETIRE_TIMEOUT_MS 30000
+
+// Longest the supervisor sleeps without a change to the game header
+#define SUPERVISOR_WAIT_MS 1000
+static double startup_ms = 0.0;
+static uint64_t *retire_deadline_ns;  // Per gang slot; 0 while it isn't retiring
+
 /* ----------------------------------------------------------- */
 void handle_alarm(int signum)
 {
     shared_game->elapsed_time++;   /* original work            */
+    notify_game_changed();         /* the clock is in the header */
     alarm(1);                      /* re‑arm                   */
 }
 
 void cleanup_resources(void);
 void handle_kill(int);
+int watch_config_file(const char *path);
+void handle_config_events(int watch_fd, const char *path);
+void write_result(const char *path, int status);
+void wait_for_startup(void);
+int start_new_game(const char *seed_option);
+int restore_checkpoint(const char *path);
+void take_checkpoint(const char *path);
+int start_journal(const char *path);
+void journal_counters(int type);
+void start_recorder(void);
+void resize_gangs(void);
+void reap_retired_gangs(void);
+int *gang_queue_ids(void);
+void sample_gang_queues(void);
+void print_gang_queues(void);
+void print_alert_latency(void);
+
+void handle_checkpoint_signal(int signum) {
+    checkpoint_pending = 1;
+}
+
+static void usage(const char *prog) {
+    fprintf(stderr,
+            "Usage: %s [--config FILE] [--seed N] [--headless] [--max-time SECONDS] [--result FILE]\n"
+            "          [--checkpoint FILE] [--checkpoint-interval SECONDS] [--restore FILE]\n"
+            "          [--journal FILE] [--record FILE] [--record-hz N] [--stream ADDRESS]\n"
+            "  --config FILE      configuration file (default %s)\n"
+            "  --seed N           master random seed, overrides random_seed in the config\n"
+            "  --headless         don't start the viewer\n"
+            "  --max-time SECONDS stop the game after this many game seconds\n"
+            "  --result FILE      write the final counters to FILE as key=value lines\n"
+            "  --checkpoint FILE  where SIGUSR1 writes a checkpoint (default ocf.ckpt)\n"
+            "  --checkpoint-interval SECONDS\n"
+            "                     also checkpoint every SECONDS game seconds\n"
+            "  --restore FILE     resume the game saved in a checkpoint file\n"
+            "  --journal FILE     record every nondeterministic input for ocf-replay\n"
+            "  --record FILE      sample the game into a time-series file (ocf-recorder)\n"
+            "  --record-hz N      samples per second for --record (default 10)\n"
+            "  --stream ADDRESS   serve state deltas to remote viewers on a Unix socket\n"
+            "                     path, or on 127.0.0.1 with :PORT (graphics --connect)\n",
+            prog, CONFIG_PATH);
+}
 
 int main(int argc,char *argv[]) {
+    static const struct option long_options[] = {
+        {"config",   required_argument, NULL, 'c'},
+        {"seed",     required_argument, NULL, 's'},
+        {"headless", no_argument,       NULL, 'H'},
+        {"max-time", required_argument, NULL, 't'},
+        {"result",   required_argument, NULL, 'r'},
+        {"checkpoint", required_argument, NULL, 'k'},
+        {"checkpoint-interval", required_argument, NULL, 'i'},
+        {"restore",  required_argument, NULL, 'R'},
+        {"journal",  required_argument, NULL, 'j'},
+        {"record",   required_argument, NULL, 'o'},
+        {"record-hz", required_argument, NULL, 'z'},
+        {"stream",   required_argument, NULL, 'S'},
+        {"help",     no_argument,       NULL, 'h'},
+        {NULL, 0, NULL, 0}
+    };
+    const char *seed_option = NULL;
+    int opt;
+    while ((opt = getopt_long(argc, argv, "c:s:Ht:r:k:i:R:j:o:z:S:h", long_options, NULL)) != -1) {
+        switch (opt) {
+            case 'c': config_path = optarg; break;
+            case 's': seed_option = optarg; break;
+            case 'H': headless = 1; break;
+            case 't': max_time = atoi(optarg); break;
+            case 'r': result_path = optarg; break;
+            case 'k': checkpoint_path = optarg; break;
+            case 'i': checkpoint_interval = atoi(optarg); break;
+            case 'R': restore_path = optarg; break;
+            case 'j': journal_path = optarg; break;
+            case 'o': record_path = optarg; break;
+            case 'z': record_hz = atoi(optarg); break;
+            case 'S': stream_address = optarg; break;
+            default:
+                usage(argv[0]);
+                return opt == 'h' ? 0 : 1;
+        }
+    }
+
     printf("********** Bakery Simulation **********\n\n");
     fflush(stdout);
 
@@ -41,56 +164,658 @@ int main(int argc,char *argv[]) {
         return 1;
     }
     
-    // Initialize random number generator
-    init_random();
-    
+    if (restore_path != NULL) {
+        if (restore_checkpoint(restore_path) == -1) {
+            return 1;
+        }
+    } else if (start_new_game(seed_option) == -1) {
+        return 1;
+    }
+    if (journal_path != NULL && start_journal(journal_path) == -1) {
+        return 1;
+    }
+
+    // Allocate memory for process IDs (a police process per department + a
+    // gang process per slot + 1 graphics + 1 recorder)
+    num_processes = config.police_departments + config.max_gangs + 2;
+    processes = calloc(num_processes, sizeof(pid_t));
+    retire_deadline_ns = calloc(config.max_gangs, sizeof(uint64_t));
+    if (processes == NULL || retire_deadline_ns == NULL) {
+        fprintf(stderr, "Failed to allocate memory for process array\n");
+        return 1;
+    }
+
+    signal(SIGALRM,handle_alarm);
+    signal(SIGINT ,handle_kill);
+    signal(SIGUSR1,handle_checkpoint_signal);
+
+    game_init(&shm_ptrs, processes, &config, headless);
+    wait_for_startup();
+    start_recorder();
+    if (stream_address != NULL &&
+        stream_publisher_start(stream_address, &shm_ptrs, &config, config.viewer_snapshot_hz) == -1) {
+        return 1;
+    }
+    alarm(1);               /* start 1‑second timer */
+
+    // Watch config.txt so parameter changes reach the running processes
+    int config_watch_fd = watch_config_file(config_path);
+
+    printf("Send SIGUSR1 to %d to checkpoint into %s\n", (int)getpid(), checkpoint_path);
+    fflush(stdout);
+    int next_checkpoint = shared_game->elapsed_time + checkpoint_interval;
+    int journaled_time = shared_game->elapsed_time;
+
+    int status = 0;
+    uint32_t seen = notify_generation(&shared_game->notify.game);
+    while (check_game_conditions(shared_game, &config)) {
+        if (shared_game->elapsed_time != journaled_time) {
+            journaled_time = shared_game->elapsed_time;
+            journal_counters(JOURNAL_TICK);
+            sample_gang_queues();
+        }
+        if (checkpoint_interval > 0 && shared_game->elapsed_time >= next_checkpoint) {
+            checkpoint_pending = 1;
+            next_checkpoint = shared_game->elapsed_time + checkpoint_interval;
+        }
+        if (checkpoint_pending) {
+            checkpoint_pending = 0;
+            take_checkpoint(checkpoint_path);
+        }
+        if (max_time > 0 && shared_game->elapsed_time >= max_time) {
+            printf("GAME OVER: Time limit reached (%d s)\n", max_time);
+            fflush(stdout);
+            status = 1;
+            break;
+        }
+        reap_retired_gangs();
+        if (config_watch_fd != -1) {
+            handle_config_events(config_watch_fd, config_path);
+        }
+
+        // Sleep until a counter or the clock moves; signals (the clock
+        // itself, a checkpoint request) cut it short too
+        notify_wait(&shared_game->notify.game, seen, SUPERVISOR_WAIT_MS);
+        seen = notify_generation(&shared_game->notify.game);
+    }
+
+    journal_counters(JOURNAL_END);
+    print_gang_queues();
+    print_alert_latency();
+    if (result_path != NULL) {
+        write_result(result_path, status);
+    }
+
+    return 0;  /* cleanup_resources is run automatically */
+}
+
+/* ---- game setup ------------------------------------------- */
+
+// Load the config and the target catalog and lay out a fresh game
+int start_new_game(const char *seed_option) {
     // Load config first
-    if (load_config(CONFIG_PATH, &config) == -1) {
+    if (load_config(config_path, &config) == -1) {
         printf("Config file failed\n"); 
-        return 1;
+        return -1;
+    }
+    if (seed_option != NULL) {
+        config.random_seed = (unsigned int)strtoul(seed_option, NULL, 10);
     }
 
+    // Initialize random number generator. The resolved seed is handed to every
+    // child process, so re-running with random_seed=<seed> reproduces the run.
+    if (config.random_seed == 0) {
+        init_random();
+        config.random_seed = (unsigned int)random_u64() | 1u;
+    }
+    init_random_seeded(config.random_seed, RANDOM_PROC_MAIN);
+    printf("Random seed: %u\n", config.random_seed);
+
 
     // randomize the number of gangs based on the user-defined range
     config.num_gangs = random_int(config.min_gangs, config.max_gangs);
 
     printf("Number of gangs: %d\n", config.num_gangs);
 
-    // Allocate memory for process IDs (1 police + num_gangs gang processes + 1 graphics)
-    num_processes = 1 + config.num_gangs + 1;
-    processes = malloc(num_processes * sizeof(pid_t));
-    if (processes == NULL) {
-        fprintf(stderr, "Failed to allocate memory for process array\n");
-        return 1;
+    // Gangs grow up to the limit by recruiting; it sizes their segments
+    if (config.gang_size_limit == 0) {
+        config.gang_size_limit = config.max_gang_size;
+    }
+    if (config.police_departments == 0) {
+        config.police_departments = 1;
     }
 
+    // Load the target catalog first: its shape is part of the shared memory
+    // layout, with heat rows for every gang slot
+    TargetCatalog *catalog = load_target_catalog_from_json(JSON_PATH, config.max_gangs);
+    if (catalog == NULL) {
+        printf("Json file failed");
+        return -1;
+    }
+    config.num_targets = catalog->num_targets;
+    config.num_attributes = catalog->num_attributes;
+
     // Main process is the owner of shared memory
     shared_game = setup_shared_memory_owner(&config, &shm_ptrs);
-    shm_ptrs.shared_game = shared_game;
-    
-    // Load targets AFTER initializing shared memory
-    if (load_targets_from_json(JSON_PATH, shared_game->targets) == -1) {
-        printf("Json file failed");
-        return 1;
+
+    if (target_catalog_copy(shm_ptrs.catalog, catalog) == -1) {
+        return -1;
     }
+    free(catalog);
 
-    signal(SIGALRM,handle_alarm);
-    signal(SIGINT ,handle_kill);
+    return checkpoint_control_init(&shared_game->checkpoint, 0, 0);
+}
 
-    game_init(shared_game, processes, &config);
-    alarm(1);               /* start 1‑second timer */
+// Resume the game saved in a checkpoint: the segment is copied back as it
+// was and the pending messages are queued again before any child starts
+int restore_checkpoint(const char *path) {
+    CheckpointImage image;
+    if (checkpoint_open(&image, path, sizeof(Game), sizeof(Gang), sizeof(Member)) == -1) {
+        return -1;
+    }
+
+    // The whole config, including num_gangs and the seed, comes from the saved block
+    const ShmArena *saved = (const ShmArena *)image.shm;
+    if (shm_arena_check(saved, image.header->shm_size) == -1 ||
+        shm_arena_check_region(saved, SHM_REGION_GAME, sizeof(Game)) == -1) {
+        fprintf(stderr, "Checkpoint %s has no valid shared memory arena\n", path);
+        checkpoint_close(&image);
+        return -1;
+    }
+    uint32_t generation;
+    if (config_block_read(&((const Game *)shm_arena_region(saved, SHM_REGION_GAME))->config_block,
+                          &config, &generation) == -1) {
+        fprintf(stderr, "Checkpoint %s has no valid config\n", path);
+        checkpoint_close(&image);
+        return -1;
+    }
+    init_random_seeded(config.random_seed, RANDOM_PROC_MAIN);
 
-    /* empty polling loop – stays as before */
-    while (check_game_conditions(shared_game, &config)){ /* nothing */ }
+    shared_game = setup_shared_memory_owner(&config, &shm_ptrs);
+    if (shm_ptrs.size != image.header->shm_size) {
+        fprintf(stderr, "Checkpoint %s holds %llu bytes of state, the layout needs %zu\n",
+                path, (unsigned long long)image.header->shm_size, shm_ptrs.size);
+        checkpoint_close(&image);
+        return -1;
+    }
+    // The saved arena replaces the fresh one whole, gang directory included;
+    // the gangs the fresh one spawned make way for the saved ones
+    for (int slot = 0; slot < config.max_gangs; slot++) {
+        shm_retire_gang(&shm_ptrs, slot);
+    }
+    memcpy(shm_ptrs.arena, image.shm, shm_ptrs.size);
+    shared_game = shm_ptrs.shared_game = shm_arena_region(shm_ptrs.arena, SHM_REGION_GAME);
+    shm_ptrs.gangs = shm_arena_region(shm_ptrs.arena, SHM_REGION_GANGS);
+    shm_ptrs.catalog = shm_arena_region(shm_ptrs.arena, SHM_REGION_CATALOG);
+    shm_ptrs.directory = shm_arena_region(shm_ptrs.arena, SHM_REGION_DIRECTORY);
+    shm_ptrs.police = police_tables_at(shm_arena_region(shm_ptrs.arena, SHM_REGION_POLICE),
+                                       config.max_gangs, config.max_agents_per_gang);
+    shm_ptrs.config_generation = generation;
 
-    return 0;  /* cleanup_resources is run automatically */
+    if (image.header->segment_count != (uint32_t)config.max_gangs) {
+        fprintf(stderr, "Checkpoint %s holds %u gang segments, the layout has %d slots\n",
+                path, image.header->segment_count, config.max_gangs);
+        checkpoint_close(&image);
+        return -1;
+    }
+    for (int slot = 0; slot < config.max_gangs; slot++) {
+        if (!gang_slot_active(shm_ptrs.directory, slot)) {
+            shm_ptrs.gangs[slot].msgq_id = -1;  // Saved by the old run, if anything
+            continue;
+        }
+        size_t size;
+        const void *members = checkpoint_segment(&image, (uint32_t)slot, &size);
+        if (shm_restore_gang(&shm_ptrs, &config, slot, members, size) == -1) {
+            checkpoint_close(&image);
+            return -1;
+        }
+    }
+
+    // The departments that held the officers are gone: every row waits to be
+    // claimed again. Report times are wall-clock, so they move forward by the
+    // time the game spent saved.
+    time_t shift = time(NULL) - (time_t)image.header->wall_time;
+    for (int i = 0; i < config.max_gangs; i++) {
+        PoliceOfficer *officer = &shm_ptrs.police.officers[i];
+        AgentInfo *agents = police_agents(&shm_ptrs.police, config.max_agents_per_gang, i);
+        officer->department = -1;
+        for (int j = 0; j < officer->num_agents; j++) {
+            agents[j].last_report_time += shift;
+        }
+    }
+
+    int *msgq_ids = gang_queue_ids();
+    if (msgq_ids == NULL || checkpoint_requeue(&image, msgq_ids, (uint32_t)config.max_gangs) == -1) {
+        fprintf(stderr, "Failed to restore the pending messages\n");
+        free(msgq_ids);
+        checkpoint_close(&image);
+        return -1;
+    }
+    free(msgq_ids);
+
+    printf("Restored %s: seed %u, %u gangs, game time %d s, %u queued messages\n",
+           path, config.random_seed, shm_ptrs.directory->num_active, shared_game->elapsed_time,
+           image.header->message_count);
+    fflush(stdout);
+
+    int result = checkpoint_control_init(&shared_game->checkpoint, 1, image.header->wall_time);
+    checkpoint_close(&image);
+    return result;
+}
+
+/* ---- event journal ---------------------------------------- */
+
+// Open the journal before any child starts and record what the run starts
+// from: the seed, the config, the catalog and the counters
+int start_journal(const char *path) {
+    if (journal_create(path, &shared_game->journal_seq, &shared_game->elapsed_time) == -1) {
+        return -1;
+    }
+    JournalRun run = {0};
+    run.random_seed = config.random_seed;
+    run.config_generation = shm_ptrs.config_generation;
+    run.num_successful_plans = shared_game->num_successfull_plans;
+    run.num_thwarted_plans = shared_game->num_thwarted_plans;
+    run.num_executed_agents = shared_game->num_executed_agents;
+    run.elapsed_time = shared_game->elapsed_time;
+    run.config = config;
+    if (journal_append(JOURNAL_RUN, JOURNAL_SOURCE_MAIN, &run, sizeof(run),
+                       shm_ptrs.catalog, shm_ptrs.catalog->total_size) == -1) {
+        return -1;
+    }
+    printf("Journal: recording into %s\n", path);
+    fflush(stdout);
+    return 0;
+}
+
+// Record the game counters; taken under the stats lock so every outcome and
+// arrest journaled before it is counted in it and none after
+void journal_counters(int type) {
+    if (!journal_enabled()) {
+        return;
+    }
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    JournalTick tick = {0};
+    tick.monotonic_ns = (uint64_t)now.tv_sec * 1000000000ull + (uint64_t)now.tv_nsec;
+
+    LOCK_GAME_STATS();
+    tick.num_successful_plans = shared_game->num_successfull_plans;
+    tick.num_thwarted_plans = shared_game->num_thwarted_plans;
+    tick.num_executed_agents = shared_game->num_executed_agents;
+    tick.hash = journal_hash_counters(shared_game->elapsed_time, tick.num_successful_plans,
+                                      tick.num_thwarted_plans);
+    journal_append(type, JOURNAL_SOURCE_MAIN, &tick, sizeof(tick), NULL, 0);
+    UNLOCK_GAME_STATS();
+}
+
+/* ---- time-series recorder -------------------------------- */
+
+// The recorder attaches like the viewer and takes the last process slot
+void start_recorder(void) {
+    if (record_path == NULL) {
+        return;
+    }
+    char hz[12];
+    snprintf(hz, sizeof(hz), "%d", record_hz);
+    char *argv[] = {RECORDER_EXECUTABLE, "--hz", hz, (char *)record_path, NULL};
+    processes[num_processes - 1] = start_process_argv(argv);
+}
+
+/* ---- checkpoints ------------------------------------------ */
+
+// Park every thread, save the state and carry on. The clock is stopped
+// meanwhile: elapsed_time is part of the state.
+void take_checkpoint(const char *path) {
+    alarm(0);
+    uint64_t start_ns = startup_now_ns();
+
+    // The officers sleep on their gangs' priority lanes and the departments
+    // on the board; wake them to see the request
+    checkpoint_request(&shared_game->checkpoint);
+    for (int slot = 0; slot < config.max_gangs; slot++) {
+        if (gang_slot_active(shm_ptrs.directory, slot)) {
+            gang_alert(&shm_ptrs.gangs[slot]);
+        }
+    }
+    notify_game_changed();
+
+    if (checkpoint_quiesce(&shared_game->checkpoint, CHECKPOINT_TIMEOUT_MS) == 0) {
+        uint64_t parked_ns = startup_now_ns();
+        int *msgq_ids = gang_queue_ids();
+
+        // Every gang is parked, so the directory holds still; each active
+        // slot's segment is saved at the capacity it has now
+        shm_refresh_gangs(&shm_ptrs);
+        CheckpointSegment *segments = calloc((size_t)config.max_gangs, sizeof(CheckpointSegment));
+        long size = -1;
+        if (segments != NULL && msgq_ids != NULL) {
+            for (int slot = 0; slot < config.max_gangs; slot++) {
+                if (gang_slot_active(shm_ptrs.directory, slot) && shm_members(&shm_ptrs, slot) != NULL) {
+                    segments[slot].data = shm_members(&shm_ptrs, slot);
+                    segments[slot].size = (size_t)shm_ptrs.mappings[slot].capacity * sizeof(Member);
+                }
+            }
+            size = checkpoint_write(path, shm_ptrs.arena, shm_ptrs.size, segments, (uint32_t)config.max_gangs,
+                                    sizeof(Game), sizeof(Gang), sizeof(Member),
+                                    msgq_ids, (uint32_t)config.max_gangs);
+        }
+        free(segments);
+        free(msgq_ids);
+        if (size != -1) {
+            printf("Checkpoint: wrote %s at game time %d s, %ld bytes (quiesce %.1f ms, write %.1f ms)\n",
+                   path, shared_game->elapsed_time, size,
+                   (parked_ns - start_ns) / 1e6, (startup_now_ns() - parked_ns) / 1e6);
+        }
+    } else {
+        fprintf(stderr, "Checkpoint: not every thread parked within %d ms, nothing written\n",
+                CHECKPOINT_TIMEOUT_MS);
+    }
+    fflush(stdout);
+
+    checkpoint_resume(&shared_game->checkpoint);
+    alarm(1);
+}
+
+/* ---- startup barrier -------------------------------------- */
+
+// Hold the game clock until police and every gang are up, then report how
+// long each process spent in each startup phase
+void wait_for_startup(void) {
+    StartupBarrier *barrier = &shared_game->startup;
+    int ready = startup_wait_all(barrier, STARTUP_TIMEOUT_MS);
+    if (ready < barrier->expected) {
+        fprintf(stderr, "Startup: only %d of %d processes ready after %d ms, starting anyway\n",
+                ready, barrier->expected, STARTUP_TIMEOUT_MS);
+    }
+    startup_release(barrier);
+    startup_ms = (barrier->release_ns - barrier->launch_ns) / 1e6;
+
+    startup_print("police", &barrier->police);
+    char label[16];
+    for (int i = 0; i < config.max_gangs; i++) {
+        if (!gang_slot_active(shm_ptrs.directory, i)) {
+            continue;
+        }
+        snprintf(label, sizeof(label), "gang %d", i);
+        startup_print(label, &shm_ptrs.gangs[i].startup);
+    }
+    printf("STARTUP: %d/%d processes ready in %.2f ms\n", ready, barrier->expected, startup_ms);
+    fflush(stdout);
+}
+
+/* ---- config hot-reload ------------------------------------ */
+
+// Watch the directory rather than the file: editors often save by writing a
+// new file and renaming it over the old one, which drops a watch on the file
+int watch_config_file(const char *path) {
+    char dir[PATH_MAX];
+    snprintf(dir, sizeof(dir), "%s", path);
+
+    int fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (fd == -1) {
+        perror("inotify_init1 failed, config reload disabled");
+        return -1;
+    }
+    if (inotify_add_watch(fd, dirname(dir), IN_CLOSE_WRITE | IN_MOVED_TO) == -1) {
+        perror("inotify_add_watch failed, config reload disabled");
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+// Publish valid changes to the config file, if there are any; the
+// supervisor loop comes by at least every clock tick
+void handle_config_events(int watch_fd, const char *path) {
+    struct pollfd pfd = { .fd = watch_fd, .events = POLLIN };
+    if (poll(&pfd, 1, 0) <= 0) {
+        return;  // nothing new, or interrupted by the clock signal
+    }
+
+    char name[PATH_MAX];
+    snprintf(name, sizeof(name), "%s", path);
+    const char *file_name = basename(name);
+
+    char buf[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+    int changed = 0;
+    ssize_t len;
+    while ((len = read(watch_fd, buf, sizeof(buf))) > 0) {
+        for (char *p = buf; p < buf + len; ) {
+            struct inotify_event *event = (struct inotify_event *)p;
+            if (event->len > 0 && strcmp(event->name, file_name) == 0) {
+                changed = 1;
+            }
+            p += sizeof(struct inotify_event) + event->len;
+        }
+    }
+    if (len == -1 && errno != EAGAIN) {
+        perror("read inotify events");
+    }
+    if (!changed) {
+        return;
+    }
+
+    Config reloaded;
+    if (load_config(path, &reloaded) == -1) {
+        fprintf(stderr, "Config reload rejected, keeping the current values\n");
+        return;
+    }
+
+    config_apply_reloadable(&config, &reloaded);
+    config_block_publish(&shared_game->config_block, &config);
+    notify_game_changed();
+    JournalConfig reload = {config_block_generation(&shared_game->config_block), config};
+    journal_append(JOURNAL_CONFIG, JOURNAL_SOURCE_MAIN, &reload, sizeof(reload), NULL, 0);
+    printf("Config reloaded (generation %u)\n", reload.generation);
+    fflush(stdout);
+
+    resize_gangs();
+}
+
+/* ---- gang population -------------------------------------- */
+
+// Free the slot of a gang that left (or was killed). Its threads are taken
+// off the checkpoint roll only now that the process is gone.
+static void release_gang(int slot) {
+    Gang *gang = &shm_ptrs.gangs[slot];
+    processes[config.police_departments + slot] = 0;
+    retire_deadline_ns[slot] = 0;
+    checkpoint_unregister(&shared_game->checkpoint, gang->checkpoint_threads);
+    shm_retire_gang(&shm_ptrs, slot);
+    printf("Gang %d retired (%u gangs running)\n", slot, shm_ptrs.directory->num_active);
+    fflush(stdout);
+}
+
+// Release the retiring gangs that have left; kill the ones that overstayed.
+// Slots freed here may be what a grown active_gangs was waiting for.
+void reap_retired_gangs(void) {
+    int released = 0;
+    for (int slot = 0; slot < config.max_gangs; slot++) {
+        if (retire_deadline_ns[slot] == 0) {
+            continue;
+        }
+        pid_t pid = processes[config.police_departments + slot];
+        if (pid > 0 && waitpid(pid, NULL, WNOHANG) == 0) {
+            if (startup_now_ns() < retire_deadline_ns[slot]) {
+                continue;
+            }
+            fprintf(stderr, "Gang %d didn't leave within %d ms, killing it\n", slot, GANG_RETIRE_TIMEOUT_MS);
+            kill(pid, SIGKILL);
+            waitpid(pid, NULL, 0);
+        }
+        release_gang(slot);
+        released = 1;
+    }
+    if (released) {
+        resize_gangs();
+    }
+}
+
+// Spawn or retire gangs until as many run as the config asks for. New gangs
+// take the lowest free slots; the highest slots are retired first. A retired
+// gang is only asked to leave at its next plan boundary and keeps its slot
+// until reap_retired_gangs sees it gone.
+void resize_gangs(void) {
+    GangDirectory *directory = shm_ptrs.directory;
+    int wanted = config.active_gangs > 0 ? config.active_gangs : config.num_gangs;
+
+    int staying = 0;
+    for (int slot = 0; slot < config.max_gangs; slot++) {
+        staying += gang_slot_active(directory, slot) && retire_deadline_ns[slot] == 0;
+    }
+    for (int slot = 0; slot < config.max_gangs && staying < wanted; slot++) {
+        if (gang_slot_active(directory, slot)) {
+            continue;
+        }
+        if (shm_spawn_gang(&shm_ptrs, &config, slot) == -1) {
+            fprintf(stderr, "Failed to spawn a gang on slot %d\n", slot);
+            return;
+        }
+        processes[config.police_departments + slot] = start_process(GANG_EXECUTABLE, slot);
+        staying++;
+        printf("Gang %d spawned (%u gangs running)\n", slot, directory->num_active);
+        fflush(stdout);
+    }
+    for (int slot = config.max_gangs - 1; slot >= 0 && staying > wanted; slot--) {
+        if (gang_slot_active(directory, slot) && retire_deadline_ns[slot] == 0) {
+            __atomic_store_n(&shm_ptrs.gangs[slot].retiring, 1, __ATOMIC_RELEASE);
+            retire_deadline_ns[slot] = startup_now_ns() + (uint64_t)GANG_RETIRE_TIMEOUT_MS * 1000000ull;
+            staying--;
+            printf("Gang %d asked to retire\n", slot);
+            fflush(stdout);
+        }
+    }
+}
+
+/* ---- gang queues ------------------------------------------ */
+
+// Queue of every gang slot, -1 where no gang runs; NULL if it can't be
+// allocated
+int *gang_queue_ids(void) {
+    int *msgq_ids = malloc((size_t)config.max_gangs * sizeof(int));
+    if (msgq_ids == NULL) {
+        perror("Error allocating the queue table");
+        return NULL;
+    }
+    for (int slot = 0; slot < config.max_gangs; slot++) {
+        msgq_ids[slot] = gang_slot_active(shm_ptrs.directory, slot) ? shm_ptrs.gangs[slot].msgq_id : -1;
+    }
+    return msgq_ids;
+}
+
+// Publish how much is waiting on each gang's queue, once a game second
+void sample_gang_queues(void) {
+    int changed = 0;
+    for (int slot = 0; slot < config.max_gangs; slot++) {
+        Gang *gang = &shm_ptrs.gangs[slot];
+        uint32_t messages, bytes;
+        if (!gang_slot_active(shm_ptrs.directory, slot) || gang->msgq_id == -1 ||
+            message_queue_depth(gang->msgq_id, &messages, &bytes) == -1) {
+            continue;
+        }
+        changed |= messages != gang->queue_depth;
+        gang->queue_depth = messages;
+        gang->queue_bytes = bytes;
+        if (messages > gang->queue_peak) {
+            gang->queue_peak = messages;
+        }
+    }
+    if (changed) {
+        notify_changed();
+    }
+}
+
+void print_gang_queues(void) {
+    for (int slot = 0; slot < config.max_gangs; slot++) {
+        const Gang *gang = &shm_ptrs.gangs[slot];
+        if (gang_slot_active(shm_ptrs.directory, slot)) {
+            printf("Gang %d queue: %u messages (%u bytes) waiting, peak %u\n",
+                   slot, gang->queue_depth, gang->queue_bytes, gang->queue_peak);
+        }
+    }
+    printf("Queues: %u messages undeliverable, %u withdrawn unread\n",
+           shared_game->routing.undeliverable, shared_game->routing.withdrawn);
+    fflush(stdout);
+}
+
+// How long urgent agent reports took to reach an evaluation of their gang
+void print_alert_latency(void) {
+    const PoliceSummary *police = &shared_game->police;
+    if (police->alerts_handled == 0) {
+        printf("Police: no urgent agent reports acted on\n");
+    } else {
+        printf("Police: %u urgent agent reports acted on, %.3f ms after they were raised on average, "
+               "%.3f ms at most\n", police->alerts_handled,
+               police->alert_latency_total_us / 1000.0 / police->alerts_handled,
+               police->alert_latency_max_us / 1000.0);
+    }
+    fflush(stdout);
+}
+
+// Final counters for ocf-sweep; written to a temporary name and renamed so a
+// reader never sees a partial file
+void write_result(const char *path, int status) {
+    char tmp_path[PATH_MAX];
+    snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", path);
+
+    FILE *file = fopen(tmp_path, "w");
+    if (!file) {
+        perror("Error opening result file");
+        return;
+    }
+    fprintf(file, "status=%d\n", status);
+    fprintf(file, "random_seed=%u\n", config.random_seed);
+    fprintf(file, "num_gangs=%d\n", config.num_gangs);
+    fprintf(file, "elapsed_time=%d\n", shared_game->elapsed_time);
+    fprintf(file, "num_successful_plans=%d\n", shared_game->num_successfull_plans);
+    fprintf(file, "num_thwarted_plans=%d\n", shared_game->num_thwarted_plans);
+    fprintf(file, "num_executed_agents=%d\n", shared_game->num_executed_agents);
+    fprintf(file, "startup_ms=%.3f\n", startup_ms);
+    fprintf(file, "undeliverable_messages=%u\n", shared_game->routing.undeliverable);
+    fprintf(file, "withdrawn_messages=%u\n", shared_game->routing.withdrawn);
+    fprintf(file, "alerts_handled=%u\n", shared_game->police.alerts_handled);
+    fprintf(file, "alert_latency_avg_ms=%.3f\n", shared_game->police.alerts_handled > 0 ?
+            shared_game->police.alert_latency_total_us / 1000.0 / shared_game->police.alerts_handled : 0.0);
+    fprintf(file, "alert_latency_max_ms=%.3f\n", shared_game->police.alert_latency_max_us / 1000.0);
+    fclose(file);
+
+    if (rename(tmp_path, path) == -1) {
+        perror("Error renaming result file");
+    }
+}
+
+// Give the children a moment to exit on SIGINT, then kill what's left so a
+// sweep never leaves processes behind
+static void reap_children(void) {
+    for (int tries = 0; tries < 20; tries++) {
+        int alive = 0;
+        for (int i = 0; i < num_processes; i++) {
+            if (processes[i] > 0) {
+                if (waitpid(processes[i], NULL, WNOHANG) == 0) {
+                    alive++;
+                } else {
+                    processes[i] = 0;
+                }
+            }
+        }
+        if (alive == 0) return;
+        usleep(100000);
+    }
+    for (int i = 0; i < num_processes; i++) {
+        if (processes[i] > 0) {
+            kill(processes[i], SIGKILL);
+            waitpid(processes[i], NULL, 0);
+        }
+    }
 }
 
 /* ---- unchanged cleanup / signal handlers ------------------ */
 void cleanup_resources() {
     printf("Cleaning up resources...\n"); fflush(stdout);
+    alarm(0);   // the clock handler touches shared memory, which is about to go
 
-    // Terminate all child processes (police + all gangs)
+    // Terminate all child processes (police departments + all gangs)
     for(int i = 0; i < num_processes; i++) {
         if (processes[i] > 0) {
             printf("Terminating process %d (PID: %d)\n", i, processes[i]);
@@ -98,20 +823,23 @@ void cleanup_resources() {
             kill(processes[i], SIGINT);
         }
     }
-    
+
     // Free the processes array
     if (processes != NULL) {
+        reap_children();
         free(processes);
         processes = NULL;
     }
     
-    cleanup_shared_memory(shared_game);
+    journal_close();
+    stream_publisher_stop();
+    cleanup_shared_memory(&shm_ptrs);
+    shared_game = NULL;
     cleanup_semaphores();
     
     // Unlink semaphores (only main process should do this)
-    sem_unlink(GAME_STATS_SEM_NAME);
-    sem_unlink(GANG_STATS_SEM_NAME);
-    
+    unlink_semaphores();
+
     printf("Cleanup complete\n");
 }
 void handle_kill(int signum) {
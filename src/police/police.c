@@ -16,100 +16,221 @@
 
 #include "random.h"
 #include "semaphores_utils.h"
+#include "journal.h"
 
 PoliceForce police_force;
 Game *shared_game = NULL;
 ShmPtrs shm_ptrs;
 Config config;
+static uint32_t directory_generation;  // Directory generation the officers follow
 
 void cleanup();
 void handle_sigint(int signum);
 
-void init_police_force(Config *config) {
-    printf("POLICE: Initializing police force with %d officers\n", config->num_gangs);
+// An officer's row of the private agents table
+static AgentInfo *agents_of(const PoliceOfficer *officer) {
+    return police_force.agents + (size_t)officer->police_id * (size_t)police_force.max_agents;
+}
+
+static void clear_agent(AgentInfo *agent) {
+    agent->agent_id = -1;
+    agent->knowledge_level = 0.0f;
+    agent->is_active = false;
+    agent->last_report_time = 0;
+    agent->report_seen = 0;
+}
+
+// Departments on the ring: the ones on duty, or every one started
+static int departments_on_duty(const Config *cfg) {
+    return cfg->active_departments > 0 ? cfg->active_departments : cfg->police_departments;
+}
+
+void init_police_force(Config *config, int department) {
+    // A row per gang slot; the department only works the ones in its shard
+    int num_officers = config->max_gangs;
+    printf("POLICE: Department %d of %d initializing, %d gang slots, %d agents each\n",
+           department, config->police_departments, num_officers, config->max_agents_per_gang);
 
     // Initialize police force structure
-    police_force.num_officers = config->num_gangs;
+    police_force.num_officers = num_officers;
+    police_force.max_agents = config->max_agents_per_gang;
+    police_force.department = department;
     police_force.shutdown_requested = false;
+    if (police_ring_build(&police_force.ring, departments_on_duty(config)) == -1) {
+        exit(EXIT_FAILURE);
+    }
 
-    // Initialize message queue
-    police_force.msgq_id = create_message_queue(MSG_QUEUE_KEY);
-    if (police_force.msgq_id == -1) {
-        fprintf(stderr, "POLICE: Failed to create message queue\n");
+    // Private tables laid out like the shared ones, so publishing is a copy
+    police_force.block = calloc(1, police_tables_size(num_officers, police_force.max_agents) + 1);
+    if (police_force.block == NULL) {
+        fprintf(stderr, "POLICE: Failed to allocate the police tables\n");
         exit(EXIT_FAILURE);
     }
+    PoliceTables tables = police_tables_at(police_force.block, num_officers, police_force.max_agents);
+    police_force.officers = tables.officers;
+    police_force.agents = tables.agents;
+    // Every department keeps the arrests in the one shared table
+    police_force.arrested_gangs = shm_ptrs.police.arrested_gangs;
 
     // Initialize mutexes
     pthread_mutex_init(&police_force.police_mutex, NULL);
     pthread_mutex_init(&police_force.arrest_mutex, NULL);
 
-    // Initialize arrested gangs array (0 = not arrested)
-    memset(police_force.arrested_gangs, 0, sizeof(int) * config->num_gangs);
-
-    // Initialize each police officer
-    for (int i = 0; i < config->num_gangs; i++) {
+    // Initialize each police officer; sync_officers claims the ones of the shard
+    int shard = 0;
+    for (int i = 0; i < num_officers; i++) {
         PoliceOfficer *officer = &police_force.officers[i];
         officer->police_id = i;
         officer->gang_id_monitoring = i;  // Officer i monitors gang i
-        officer->is_active = true;
+        officer->is_active = false;       // Until sync_officers starts it
+        officer->running = false;
+        officer->restored = false;
+        officer->held = false;
+        officer->department = -1;
+        officer->incarnation = 0;
         officer->num_agents = 0;
         officer->knowledge_level = 0.0f;
-        officer->msgq_id = police_force.msgq_id;
+        officer->msgq_id = -1;  // The gang's queue, taken when the officer starts
 
         // Initialize officer mutex
         pthread_mutex_init(&officer->officer_mutex, NULL);
 
         // Initialize agent info array
-        for (int j = 0; j < config->max_agents_per_gang; j++) {
-            officer->agents[j].agent_id = -1;
-            officer->agents[j].knowledge_level = 0.0f;
-            officer->agents[j].is_active = false;
-            officer->agents[j].last_report_time = 0;
+        for (int j = 0; j < police_force.max_agents; j++) {
+            clear_agent(&agents_of(officer)[j]);
         }
+        shard += police_ring_owner(&police_force.ring, i) == department;
+    }
 
-        printf("POLICE: Officer %d assigned to monitor gang %d\n", i, i);
+    printf("POLICE: Department %d initialized, %d of %d gang slots in its shard\n",
+           department, shard, num_officers);
+}
+
+// Copy an officer's row out to the shared tables; called with the game
+// stats lock held
+static void publish_officer(const PoliceOfficer *local_officer) {
+    int i = local_officer->police_id;
+    PoliceOfficer *shared_officer = &shm_ptrs.police.officers[i];
+
+    shared_officer->police_id = local_officer->police_id;
+    shared_officer->gang_id_monitoring = local_officer->gang_id_monitoring;
+    shared_officer->is_active = local_officer->is_active;
+    shared_officer->incarnation = local_officer->incarnation;
+    shared_officer->num_agents = local_officer->num_agents;
+    shared_officer->knowledge_level = local_officer->knowledge_level;
+    shared_officer->msgq_id = local_officer->msgq_id;
+    shared_officer->rng = local_officer->rng;
+
+    // Copy agent information; unused slots are kept cleared privately
+    memcpy(police_agents(&shm_ptrs.police, police_force.max_agents, i), agents_of(local_officer),
+           (size_t)police_force.max_agents * sizeof(AgentInfo));
+}
+
+// Take an officer's row over from the shared tables if no department holds
+// it. A row that was handed off, or restored from a checkpoint, goes on
+// where it was left.
+static bool claim_officer(PoliceOfficer *officer) {
+    int i = officer->police_id;
+    PoliceOfficer *shared_officer = &shm_ptrs.police.officers[i];
+    int none = -1;
+    bool claimed = false;
+
+    LOCK_GAME_STATS();
+    if (__atomic_compare_exchange_n(&shared_officer->department, &none, police_force.department,
+                                    false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+        const AgentInfo *saved_agents = police_agents(&shm_ptrs.police, police_force.max_agents, i);
+        officer->incarnation = shared_officer->incarnation;
+        officer->restored = shared_officer->incarnation != 0;
+        officer->num_agents = shared_officer->num_agents;
+        officer->knowledge_level = shared_officer->knowledge_level;
+        officer->rng = shared_officer->rng;
+        memcpy(agents_of(officer), saved_agents, (size_t)police_force.max_agents * sizeof(AgentInfo));
+        officer->department = police_force.department;
+        officer->held = true;
+        claimed = true;
     }
+    UNLOCK_GAME_STATS();
+    return claimed;
+}
 
-    printf("POLICE: Police force initialized successfully\n");
-    
-    // Initial sync to shared memory
+// Leave a stopped officer's row in the shared tables for the department that
+// takes the gang over
+static void release_officer(PoliceOfficer *officer) {
+    LOCK_GAME_STATS();
+    publish_officer(officer);
+    officer->held = false;
+    officer->department = -1;
+    __atomic_store_n(&shm_ptrs.police.officers[officer->police_id].department, -1, __ATOMIC_RELEASE);
+    UNLOCK_GAME_STATS();
+}
+
+// Save this thread's stream, publish the police state and wait out the
+// checkpoint. Every police thread publishes on the way in, so the last one
+// to park leaves a copy in which nothing is still moving.
+static void park_police_thread(RandomStream *rng) {
+    if (rng != NULL) {
+        random_save_thread(rng);
+    }
     sync_police_data_to_shared_memory();
+    checkpoint_park(&shared_game->checkpoint, NULL);
 }
 
 int main(int argc, char *argv[]) {
+    uint64_t exec_ns = startup_now_ns();
     atexit(cleanup);
 
     printf("Police process starting...\n");
     fflush(stdout);
 
-    if(argc != 3) {
-        fprintf(stderr, "Usage: %s <serialized_config> <id>\n", argv[0]);
+    if(argc != 2) {
+        fprintf(stderr, "Usage: %s <id>\n", argv[0]);
         exit(EXIT_FAILURE);
     }
-    
-    // Load configuration from serialized string
-    deserialize_config(argv[1], &config);
 
-    int police_department_id = atoi(argv[2]);
-    printf("Police Department %d starting with %d gangs to monitor\n",
-           police_department_id, config.num_gangs);
+    // Police process is a user of shared memory, not the owner; the config
+    // comes from the block main published there
+    shared_game = setup_shared_memory_user(&config, &shm_ptrs);
+    StartupBarrier *startup = &shared_game->startup;
+
+    int police_department_id = atoi(argv[1]);
+    if (police_department_id < 0 || police_department_id >= config.police_departments) {
+        fprintf(stderr, "Police department %d is not one of the %d started\n",
+                police_department_id, config.police_departments);
+        exit(EXIT_FAILURE);
+    }
+    printf("Police Department %d starting with %d gang slots to share out\n",
+           police_department_id, config.max_gangs);
     fflush(stdout);
 
+    // Department 0 stamps the police startup timings; the others only arrive
+    StartupTimes own_times = {0};
+    StartupTimes *times = police_department_id == 0 ? &startup->police : &own_times;
+    startup_mark(startup, times, STARTUP_EXEC, exec_ns);
+    startup_mark(startup, times, STARTUP_ATTACH, startup_now_ns());
+
     signal(SIGINT, handle_sigint);
+    init_random_seeded(config.random_seed, RANDOM_PROC_POLICE);
+
     // Initialize semaphores for this process
     if (init_semaphores() != 0) {
         fprintf(stderr, "Police: Failed to initialize semaphores\n");
         exit(EXIT_FAILURE);
     }
 
-    // Police process is a user of shared memory, not the owner
-    shared_game = setup_shared_memory_user(&config, &shm_ptrs);
+    if (journal_attach(&shared_game->journal_seq, &shared_game->elapsed_time) == -1) {
+        exit(EXIT_FAILURE);
+    }
+    startup_mark(startup, times, STARTUP_IPC, startup_now_ns());
 
-    init_police_force(&config);
+    init_police_force(&config, police_department_id);
+    startup_mark(startup, times, STARTUP_INIT, startup_now_ns());
 
     printf("Police Department: Initialized successfully\n");
     fflush(stdout);
 
+    // Wait for the gangs so officers don't start on half-initialized ones
+    startup_arrive_and_wait(startup, times);
+
     start_police_operations();
 
     printf("Police department shutting down\n");
@@ -117,24 +238,236 @@ int main(int argc, char *argv[]) {
     return 0;
 }
 
+// The department's rounds: pick up a reloaded config, and follow gangs main
+// spawned or retired and officers handed over; a claim the last holder
+// hasn't let go of yet is tried again on the next round
+static void department_duty(TimerNode *timer, void *arg) {
+    TimerWheel *wheel = arg;
+    if (config_refresh(&shared_game->config_block, &config, &shm_ptrs.config_generation)) {
+        printf("POLICE: Config reloaded (generation %u)\n", shm_ptrs.config_generation);
+        fflush(stdout);
+        // A new number of departments on duty redraws the shards
+        if (departments_on_duty(&config) != police_force.ring.num_departments &&
+            police_ring_build(&police_force.ring, departments_on_duty(&config)) == 0) {
+            printf("POLICE: Department %d now one of %d on duty\n",
+                   police_force.department, police_force.ring.num_departments);
+            fflush(stdout);
+        }
+    }
+    directory_generation = gang_directory_generation(shm_ptrs.directory);
+    sync_officers();
+    timer_arm(wheel, timer, PATROL_INTERVAL_MS);
+}
+
 void start_police_operations(void) {
     printf("POLICE: Starting police operations\n");
 
-    // Start officer threads
+    // The main thread parks for checkpoints; officer threads register as
+    // they are started
+    checkpoint_register(&shared_game->checkpoint, 1);
+
+    // Start officer threads for the gangs running now
+    directory_generation = gang_directory_generation(shm_ptrs.directory);
+    sync_officers();
+
+    // The main thread's rounds; the officers time themselves
+    TimerWheel wheel;
+    TimerNode duty;
+    timer_wheel_init(&wheel, timer_now_ms());
+    timer_init(&duty, department_duty, &wheel);
+    timer_arm(&wheel, &duty, PATROL_INTERVAL_MS);
+
+    // New gangs, retired ones and reloaded configs are seen as soon as main
+    // publishes them; the rounds still come by to retry claims
+    NotifySubscription changes;
+    if (notify_subscribe(&changes, &shared_game->notify.game, 3) == -1) {
+        exit(EXIT_FAILURE);
+    }
+    notify_watch(&changes, &shm_ptrs.directory->generation);
+    notify_watch(&changes, &shared_game->config_block.generation);
+    notify_watch(&changes, (const uint32_t *)&shared_game->checkpoint.requested);
+
+    while (!police_force.shutdown_requested) {
+        if (checkpoint_requested(&shared_game->checkpoint)) {
+            park_police_thread(NULL);
+        }
+        int wait_ms = (int)timer_wheel_timeout(&wheel, PATROL_INTERVAL_MS);
+        if (notify_wait_any(&changes, wait_ms, NULL) > 0) {
+            department_duty(&duty, &wheel);
+        }
+        timer_wheel_advance(&wheel, timer_now_ms());
+    }
+    notify_unsubscribe(&changes);
+}
+
+// Bring the officers in line with the directory and the ring: stop the ones
+// whose gang was retired or replaced or left this department's shard, hand
+// the rows of the shard's leavers over, and claim and start one for every
+// gang of the shard that has none. An officer of a new incarnation of a slot
+// starts from scratch: the agents it had were in the old gang.
+//
+// Every leaver is told to stop before any is waited for, so the handoff takes
+// as long as the slowest officer, not all of them in turn.
+void sync_officers(void) {
+    int changed = 0;
     for (int i = 0; i < police_force.num_officers; i++) {
         PoliceOfficer *officer = &police_force.officers[i];
+        int active = gang_slot_active(shm_ptrs.directory, officer->gang_id_monitoring);
+        uint32_t incarnation = __atomic_load_n(&shm_ptrs.directory->slots[officer->gang_id_monitoring].incarnation,
+                                               __ATOMIC_ACQUIRE);
+        bool ours = police_ring_owner(&police_force.ring, i) == police_force.department;
+
+        if (officer->running && (!active || incarnation != officer->incarnation || !ours)) {
+            // Wake it if it sleeps on the priority lane
+            __atomic_store_n(&officer->is_active, false, __ATOMIC_RELEASE);
+            gang_alert(&shm_ptrs.gangs[officer->gang_id_monitoring]);
+        }
+    }
+
+    for (int i = 0; i < police_force.num_officers; i++) {
+        PoliceOfficer *officer = &police_force.officers[i];
+        int active = gang_slot_active(shm_ptrs.directory, officer->gang_id_monitoring);
+        uint32_t incarnation = __atomic_load_n(&shm_ptrs.directory->slots[officer->gang_id_monitoring].incarnation,
+                                               __ATOMIC_ACQUIRE);
+        int owner = police_ring_owner(&police_force.ring, i);
+        bool ours = owner == police_force.department;
+
+        // Running but no longer active: told to stop above
+        if (officer->running && !__atomic_load_n(&officer->is_active, __ATOMIC_ACQUIRE)) {
+            pthread_join(officer->thread, NULL);
+            officer->running = false;
+            checkpoint_unregister(&shared_game->checkpoint, 1);
+            printf("POLICE: Officer %d stopped, gang %d %s\n", i, officer->gang_id_monitoring,
+                   ours ? "is gone" : "left the shard");
+            changed = 1;
+        }
+        if (officer->held && !ours) {
+            release_officer(officer);
+            printf("POLICE: Department %d handed gang %d over to department %d\n",
+                   police_force.department, i, owner);
+            changed = 1;
+        }
+        if (!ours || !active || officer->running) {
+            continue;
+        }
+        if (!officer->held) {
+            if (!claim_officer(officer)) {
+                continue;  // The department that had it hasn't let go yet
+            }
+            printf("POLICE: Department %d took over gang %d\n", police_force.department, i);
+            changed = 1;
+        }
+
+        if (incarnation != officer->incarnation) {
+            officer->incarnation = incarnation;
+            officer->restored = false;
+            officer->num_agents = 0;
+            officer->knowledge_level = 0.0f;
+            for (int j = 0; j < police_force.max_agents; j++) {
+                clear_agent(&agents_of(officer)[j]);
+            }
+            pthread_mutex_lock(&police_force.arrest_mutex);
+            police_force.arrested_gangs[officer->gang_id_monitoring] = 0;
+            pthread_mutex_unlock(&police_force.arrest_mutex);
+        }
+
+        // Each gang has its own queue; main made it before the slot went active
+        officer->msgq_id = __atomic_load_n(&shm_ptrs.gangs[officer->gang_id_monitoring].msgq_id, __ATOMIC_ACQUIRE);
+        officer->is_active = true;
+        checkpoint_register(&shared_game->checkpoint, 1);
         if (pthread_create(&officer->thread, NULL, police_officer_thread, officer) != 0) {
             perror("POLICE: Failed to create officer thread");
             exit(EXIT_FAILURE);
         }
+        officer->running = true;
         printf("POLICE: Started thread for officer %d\n", i);
+        changed = 1;
+    }
+    if (changed) {
+        fflush(stdout);
+        sync_police_data_to_shared_memory();
     }
+}
 
-    // Start arrest timer processing in main thread
-    while (!police_force.shutdown_requested) {
-        process_arrest_timers(&police_force);
-        sleep(1);  // Check every second
+static bool gang_arrested(const PoliceOfficer *officer) {
+    pthread_mutex_lock(&police_force.arrest_mutex);
+    bool arrested = police_force.arrested_gangs[officer->gang_id_monitoring] > 0;
+    pthread_mutex_unlock(&police_force.arrest_mutex);
+    return arrested;
+}
+
+// The officer's rounds
+static void officer_patrol(TimerNode *timer, void *arg) {
+    PoliceOfficer *officer = arg;
+
+    if (!gang_arrested(officer)) {
+        // Try to plant agents if we have fewer than maximum and within attempt limits
+        if (officer->num_agents < config.max_agents_per_gang &&
+            random_int(0, 99) < 40) { // 40% chance to try planting agent (increased from 20%)
+            attempt_plant_agent_handshake(officer, &config);
+        }
+
+        // Communicate with existing agents
+        communicate_with_agents(officer);
+
+        // Take action based on intelligence
+        take_police_action(officer, &shm_ptrs);
+    } else {
+        printf("POLICE: Officer %d - Gang %d is currently arrested\n",
+               officer->police_id, officer->gang_id_monitoring);
+    }
+
+    // Sync police data to shared memory for graphics interface
+    sync_police_data_to_shared_memory();
+    timer_arm(&officer->timers->wheel, timer, PATROL_INTERVAL_MS);
+}
+
+// A time unit of the gang's sentence has been served
+static void arrest_tick(TimerNode *timer, void *arg) {
+    PoliceOfficer *officer = arg;
+    int gang_id = officer->gang_id_monitoring;
+    bool released = false;
+
+    pthread_mutex_lock(&police_force.arrest_mutex);
+    if (police_force.arrested_gangs[gang_id] > 0) {
+        police_force.arrested_gangs[gang_id]--;
+        if (police_force.arrested_gangs[gang_id] == 0) {
+            // Gang is being released
+            JournalRelease release = {gang_id, 0};
+            journal_append(JOURNAL_RELEASE, JOURNAL_SOURCE_POLICE, &release, sizeof(release), NULL, 0);
+            released = true;
+        } else {
+            timer_arm(&officer->timers->wheel, timer, ARREST_TICK_MS);
+        }
+    }
+    pthread_mutex_unlock(&police_force.arrest_mutex);
+
+    if (released) {
+        handle_gang_release(officer);
+    }
+}
+
+// An agent has been quiet for REPORT_TIMEOUT_MS: look at its mailbox out
+// of turn, and again after as long if it still says nothing
+static void report_timeout(TimerNode *timer, void *arg) {
+    PoliceOfficer *officer = arg;
+    int agent_index = (int)(timer - officer->timers->reports);
+    if (agent_index < officer->num_agents && agents_of(officer)[agent_index].is_active &&
+        !collect_agent_report(officer, agent_index, false)) {
+        printf("POLICE: Officer %d has had no report from agent %d for %d s\n", officer->police_id,
+               agents_of(officer)[agent_index].agent_id, REPORT_TIMEOUT_MS / 1000);
+        timer_arm(&officer->timers->wheel, timer, REPORT_TIMEOUT_MS);
+    }
+}
+
+// Start an agent's report timeout over from the time of its last report
+static void arm_report_timeout(PoliceOfficer *officer, int agent_index) {
+    time_t silent = time(NULL) - agents_of(officer)[agent_index].last_report_time;
+    uint64_t delay = REPORT_TIMEOUT_MS;
+    if (silent > 0) {
+        delay = (uint64_t)silent * 1000 >= REPORT_TIMEOUT_MS ? 0 : REPORT_TIMEOUT_MS - (uint64_t)silent * 1000;
     }
+    timer_arm(&officer->timers->wheel, &officer->timers->reports[agent_index], delay);
 }
 
 void* police_officer_thread(void* arg) {
@@ -142,97 +475,195 @@ void* police_officer_thread(void* arg) {
     printf("POLICE: Officer %d thread started, monitoring gang %d\n",
            officer->police_id, officer->gang_id_monitoring);
 
-    // Initialize random seed for this thread
-    srand(time(NULL) + officer->police_id);
-
-    while (officer->is_active && !police_force.shutdown_requested) {
-        // Check if gang is arrested
-        pthread_mutex_lock(&police_force.arrest_mutex);
-        bool gang_arrested = (police_force.arrested_gangs[officer->gang_id_monitoring] > 0);
-        pthread_mutex_unlock(&police_force.arrest_mutex);
-
-        if (!gang_arrested) {
-            // Try to plant agents if we have fewer than maximum and within attempt limits
-            if (officer->num_agents < config.max_agents_per_gang &&
-                (rand() % 100) < 40) { // 40% chance to try planting agent (increased from 20%)
-                attempt_plant_agent_handshake(officer, &config);
-            }
+    // Each officer draws from its own stream derived from the master seed,
+    // or carries on with the one saved in a checkpoint
+    if (officer->restored) {
+        random_load_thread(&officer->rng);
+    } else {
+        random_seed_thread(officer->gang_id_monitoring, -1);
+    }
 
-            // Communicate with existing agents
-            communicate_with_agents(officer);
+    // Timers pick up where the row is: rounds right away, a sentence still
+    // being served, and the agents' silences so far
+    OfficerTimers timers;
+    timers.reports = malloc((size_t)police_force.max_agents * sizeof(TimerNode));
+    if (timers.reports == NULL) {
+        perror("POLICE: Failed to allocate officer timers");
+        exit(EXIT_FAILURE);
+    }
+    timer_wheel_init(&timers.wheel, timer_now_ms());
+    timer_init(&timers.patrol, officer_patrol, officer);
+    timer_init(&timers.arrest, arrest_tick, officer);
+    for (int i = 0; i < police_force.max_agents; i++) {
+        timer_init(&timers.reports[i], report_timeout, officer);
+    }
+    officer->timers = &timers;
 
-            // Take action based on intelligence
-            take_police_action(officer, &shm_ptrs);
-        } else {
-            printf("POLICE: Officer %d - Gang %d is currently arrested\n",
-                   officer->police_id, officer->gang_id_monitoring);
+    timer_arm(&timers.wheel, &timers.patrol, 0);
+    pthread_mutex_lock(&police_force.arrest_mutex);
+    if (police_force.arrested_gangs[officer->gang_id_monitoring] > 0) {
+        timer_arm(&timers.wheel, &timers.arrest, ARREST_TICK_MS);
+    }
+    pthread_mutex_unlock(&police_force.arrest_mutex);
+    for (int i = 0; i < officer->num_agents; i++) {
+        if (agents_of(officer)[i].is_active) {
+            arm_report_timeout(officer, i);
         }
+    }
 
-        sleep(1);  // Check every 2 seconds
-        
-        // Sync police data to shared memory for graphics interface
-        sync_police_data_to_shared_memory();
+    // Between timers the officer sleeps on the gang's priority lane, and
+    // drains it before anything else when it wakes
+    Gang *gang = &shm_ptrs.gangs[officer->gang_id_monitoring];
+    while (__atomic_load_n(&officer->is_active, __ATOMIC_ACQUIRE) && !police_force.shutdown_requested) {
+        if (checkpoint_requested(&shared_game->checkpoint)) {
+            park_police_thread(&officer->rng);
+        }
+        uint32_t seen = notify_generation(&gang->alerts);
+        drain_priority_lane(officer, NULL);
+        notify_wait(&gang->alerts, seen, (int)timer_wheel_timeout(&timers.wheel, PATROL_INTERVAL_MS));
+        timer_wheel_advance(&timers.wheel, timer_now_ms());
     }
 
+    officer->timers = NULL;
+    free(timers.reports);
+
+    // Whoever takes the officer over next carries on with this stream
+    random_save_thread(&officer->rng);
     printf("POLICE: Officer %d thread terminating\n", officer->police_id);
     return NULL;
 }
 
-void communicate_with_agents(PoliceOfficer* officer) {
-    Message msg;
-    
-    // Check for messages from agents and gang (agent death notifications)
-    for (int i = 0; i < officer->num_agents; i++) {
-        if (!officer->agents[i].is_active) continue;
-        
-        long agent_msg_type = get_agent_msgtype(config.max_agents_per_gang,
-                                               (int8_t)officer->gang_id_monitoring, 
-                                               (int8_t)officer->agents[i].agent_id);
-        
-        // Try to receive message (non-blocking)
-        if (receive_message_nonblocking(officer->msgq_id, &msg, agent_msg_type) == 0) {
-            process_agent_message(officer, &msg);
-        }
-        
-        // Request info from agents that haven't reported recently
-        time_t current_time = time(NULL);
-        if (current_time - officer->agents[i].last_report_time > 10) // 10 seconds timeout
-        {
-            request_information_from_agent(officer, i);
-        }
+// Take on an agent the gang turned for the officer
+//
+// Returns false if the officer has no room for it
+static bool adopt_agent(PoliceOfficer *officer, int agent_id) {
+    if (officer->num_agents >= police_force.max_agents) {
+        return false;
     }
-    
-    // Check for agent death notifications from gang
-    long police_msg_type = get_police_msgtype(config.max_agents_per_gang, config.num_gangs, (int8_t)officer->police_id);
-    if (receive_message_nonblocking(officer->msgq_id, &msg, police_msg_type) == 0) {
+    AgentInfo *agent = &agents_of(officer)[officer->num_agents];
+    agent->agent_id = agent_id;
+    agent->knowledge_level = 0.0f;
+    agent->is_active = true;
+    agent->last_report_time = time(NULL);
+    agent->report_seen = 0;
+    timer_arm(&officer->timers->wheel, &officer->timers->reports[officer->num_agents], REPORT_TIMEOUT_MS);
+    officer->num_agents++;
+
+    // Sync the updated agent data to shared memory
+    sync_police_data_to_shared_memory();
+    return true;
+}
+
+// The priority lane: what the gang rang its alerts for. Death notices and
+// handshake replies, the only messages of the officer's type, go first, so an
+// agent that died is never asked about; then the urgent reports, unless the
+// gang is serving a sentence already (those are dropped, see
+// collect_agent_report).
+//
+// Returns true if handshake_reply was given and one came. A reply that comes
+// after its wait still names an agent the gang turned, so it is taken on
+// all the same
+bool drain_priority_lane(PoliceOfficer* officer, Message* handshake_reply) {
+    long police_msg_type = route_to(&shared_game->routing, ENDPOINT_OFFICER, officer->police_id);
+    bool replied = false;
+    Message msg;
+    while (!replied && receive_message_nonblocking(officer->msgq_id, &msg, police_msg_type) == 0) {
+        journal_message(JOURNAL_SOURCE_POLICE, &msg);
         if (msg.mode == MSG_AGENT_DEATH) {
             handle_agent_death_notification(officer, &msg);
-        } else if (msg.mode == MSG_POLICE_REPORT) {
-            process_agent_message(officer, &msg);
+        } else if (msg.mode == MSG_HANDSHAKE && handshake_reply != NULL) {
+            *handshake_reply = msg;
+            replied = true;
+        } else if (msg.mode == MSG_HANDSHAKE && msg.MessageContent.agent_id >= 0) {
+            if (adopt_agent(officer, msg.MessageContent.agent_id)) {
+                printf("POLICE: Officer %d took on agent %d from a late handshake reply\n",
+                       officer->police_id, msg.MessageContent.agent_id);
+            } else {
+                route_undeliverable(&shared_game->routing, &msg, "officer has no room for the agent");
+            }
         }
     }
+
+    if (!gang_arrested(officer)) {
+        for (int i = 0; i < officer->num_agents; i++) {
+            if (agents_of(officer)[i].is_active) {
+                collect_agent_report(officer, i, true);
+            }
+        }
+    }
+    return replied;
 }
 
-void process_agent_message(PoliceOfficer* officer, Message* msg) {
-    if (msg->mode != MSG_POLICE_REPORT)
-        return;
-    
-    float knowledge = msg->MessageContent.knowledge;
-    
-    // Find the agent that sent this message
-    AgentInfo *agent = NULL;
+void communicate_with_agents(PoliceOfficer* officer) {
+    AgentInfo *agents = agents_of(officer);
+
+    drain_priority_lane(officer, NULL);
+
+    // The agents' latest routine reports are in their mailboxes
     for (int i = 0; i < officer->num_agents; i++) {
-        if (officer->agents[i].is_active) {
-            // In a real implementation, you'd match by agent_id from the message type
-            agent = &officer->agents[i];
-            break;
+        if (agents[i].is_active) {
+            collect_agent_report(officer, i, false);
         }
     }
-    
-    if (!agent) return;
-    
+}
+
+// Copy an agent's report out of its mailbox if the officer hasn't seen it
+static bool read_agent_report(const PoliceOfficer *officer, const AgentInfo *agent, AgentReport *report) {
+    AgentMailbox *row = police_mailboxes(&shm_ptrs.police, police_force.max_agents, officer->gang_id_monitoring);
+    int slot = agent_mailbox_find(row, police_force.max_agents, agent->agent_id);
+    return slot != -1 && agent_mailbox_read(&row[slot], report) == 0 &&
+           report->agent_id == agent->agent_id && report->sequence != agent->report_seen;
+}
+
+// Read an agent's mailbox and act on the report in it if it is new (and
+// urgent, with urgent_only; a routine one is left for the rounds)
+//
+// An urgent report raised while the gang serves a sentence is dropped: by
+// the release it is stale, and acting on it then would only measure the
+// sentence as the alert's latency. The agent's next report says what it
+// knows by then.
+//
+// Returns true if there was one
+bool collect_agent_report(PoliceOfficer* officer, int agent_index, bool urgent_only) {
+    AgentInfo *agent = &agents_of(officer)[agent_index];
+    AgentReport report;
+    if (!read_agent_report(officer, agent, &report) || (urgent_only && report.raised_us == 0)) {
+        return false;
+    }
+    agent->report_seen = report.sequence;
+    if (report.game_time < 0) {
+        return false;  // Given to the agent, nothing reported yet
+    }
+    if (report.raised_us != 0 && gang_arrested(officer)) {
+        return false;
+    }
+    process_agent_report(officer, agent_index, report.knowledge, report.raised_us);
+    return true;
+}
+
+// Add how long an urgent report took from the agent to the evaluation to
+// the totals in the game header
+static void record_alert_latency(PoliceOfficer *officer, const AgentInfo *agent, uint32_t raised_us) {
+    uint32_t latency_us = agent_mailbox_now_us() - raised_us;
+    printf("POLICE: Officer %d acting on agent %d's alert %.3f ms after it was raised\n",
+           officer->police_id, agent->agent_id, latency_us / 1000.0);
+
+    PoliceSummary *summary = &shared_game->police;
+    __atomic_fetch_add(&summary->alerts_handled, 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&summary->alert_latency_total_us, latency_us, __ATOMIC_RELAXED);
+    uint32_t max = __atomic_load_n(&summary->alert_latency_max_us, __ATOMIC_RELAXED);
+    while (latency_us > max &&
+           !__atomic_compare_exchange_n(&summary->alert_latency_max_us, &max, latency_us, false,
+                                        __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+    }
+}
+
+void process_agent_report(PoliceOfficer* officer, int agent_index, float knowledge, uint32_t raised_us) {
+    AgentInfo *agent = &agents_of(officer)[agent_index];
+
     agent->knowledge_level = knowledge;
     agent->last_report_time = time(NULL);
+    timer_arm(&officer->timers->wheel, &officer->timers->reports[agent_index], REPORT_TIMEOUT_MS);
     
     printf("POLICE: Officer %d received report from agent %d, knowledge: %.3f\n",
            officer->police_id, agent->agent_id, knowledge);
@@ -245,26 +676,6 @@ void process_agent_message(PoliceOfficer* officer, Message* msg) {
         // Periodic knowledge update - update officer's knowledge slightly
         officer->knowledge_level += 0.05f;
         if (officer->knowledge_level > 1.0f) officer->knowledge_level = 1.0f;
-        
-        // Check if all agents have knowledge below threshold
-        bool all_below_threshold = true;
-        for (int i = 0; i < officer->num_agents; i++) {
-            if (officer->agents[i].is_active && 
-                officer->agents[i].knowledge_level >= config.knowledge_threshold) {
-                all_below_threshold = false;
-                break;
-            }
-        }
-        
-        if (all_below_threshold && officer->num_agents > 1) {
-            // Request info from another agent
-            for (int i = 0; i < officer->num_agents; i++) {
-                if (officer->agents[i].is_active && &officer->agents[i] != agent) {
-                    request_information_from_agent(officer, i);
-                    break;
-                }
-            }
-        }
     } else {
         // Knowledge above threshold - gang involvement in criminal activities
         officer->knowledge_level += 0.3f;
@@ -274,11 +685,15 @@ void process_agent_message(PoliceOfficer* officer, Message* msg) {
                officer->police_id);
         
         // Evaluate imprisonment
+        if (raised_us != 0) {
+            record_alert_latency(officer, agent, raised_us);
+        }
         evaluate_imprisonment_probability(officer);
     }
 }
 
 void evaluate_imprisonment_probability(PoliceOfficer* officer) {
+    AgentInfo *agents = agents_of(officer);
     // Calculate imprisonment probability based on multiple factors
     float base_probability = 0.1f; // 10% base chance
     
@@ -292,8 +707,8 @@ void evaluate_imprisonment_probability(PoliceOfficer* officer) {
     float avg_agent_knowledge = 0.0f;
     int active_agents = 0;
     for (int i = 0; i < officer->num_agents; i++) {
-        if (officer->agents[i].is_active) {
-            avg_agent_knowledge += officer->agents[i].knowledge_level;
+        if (agents[i].is_active) {
+            avg_agent_knowledge += agents[i].knowledge_level;
             active_agents++;
         }
     }
@@ -326,7 +741,9 @@ void imprison_gang(PoliceOfficer* officer) {
     
     pthread_mutex_lock(&police_force.arrest_mutex);
     police_force.arrested_gangs[officer->gang_id_monitoring] = random_int(config.min_prison_period, config.max_prison_period); // 7-20 time units
+    JournalArrest arrest = {officer->gang_id_monitoring, police_force.arrested_gangs[officer->gang_id_monitoring]};
     pthread_mutex_unlock(&police_force.arrest_mutex);
+    timer_arm(&officer->timers->wheel, &officer->timers->arrest, ARREST_TICK_MS);
     
     // Mark plan as failed in shared memory
     // Gang *gang = &shm_ptrs.gangs[officer->gang_id_monitoring];
@@ -335,7 +752,10 @@ void imprison_gang(PoliceOfficer* officer) {
     // gang->plan_in_progress = 0;
     LOCK_GAME_STATS();
     shm_ptrs.shared_game->num_thwarted_plans++;
+    // Journaled under the lock so the sequence number orders it with the tick
+    journal_append(JOURNAL_ARREST, JOURNAL_SOURCE_POLICE, &arrest, sizeof(arrest), NULL, 0);
     UNLOCK_GAME_STATS();
+    notify_game_changed();
     // pthread_mutex_unlock(&gang->gang_mutex);
     
     printf("POLICE: Gang %d imprisoned for %d time units\n", 
@@ -355,32 +775,19 @@ void handle_gang_release(PoliceOfficer* officer) {
 
     printf("POLICE: Gang %d has been released from prison\n", gang_id);
 
-    // Reset gang state in shared memory
-    Gang *gang = &shm_ptrs.gangs[officer->gang_id_monitoring];
-    pthread_mutex_lock(&gang->gang_mutex);
-    gang->plan_in_progress = 0;
-    gang->plan_success = 0;
-    gang->members_ready = 0;
-    pthread_mutex_unlock(&gang->gang_mutex);
-}
-
-void process_arrest_timers(PoliceForce* force) {
-    pthread_mutex_lock(&force->arrest_mutex);
-
-    for (int gang_id = 0; gang_id < force->num_officers; gang_id++) {
-        if (force->arrested_gangs[gang_id] > 0) {
-            force->arrested_gangs[gang_id]--;
-
-            if (force->arrested_gangs[gang_id] == 0) {
-                // Gang is being released
-                pthread_mutex_unlock(&force->arrest_mutex);
-                handle_gang_release(&force->officers[gang_id]);
-                pthread_mutex_lock(&force->arrest_mutex);
-            }
+    // Drop the alerts raised during the sentence (see collect_agent_report)
+    for (int i = 0; i < officer->num_agents; i++) {
+        AgentInfo *agent = &agents_of(officer)[i];
+        AgentReport report;
+        if (agent->is_active && read_agent_report(officer, agent, &report) && report.raised_us != 0) {
+            agent->report_seen = report.sequence;
         }
     }
 
-    pthread_mutex_unlock(&force->arrest_mutex);
+    // The plan state belongs to the gang's main thread, which starts every
+    // plan over itself; resetting members_ready here would strand the
+    // members already waiting for the outcome
+    gang_touch(&shm_ptrs.gangs[gang_id]);
 }
 
 void shutdown_police_force(void) {
@@ -392,8 +799,9 @@ void shutdown_police_force(void) {
     // Wait for all officer threads to finish
     for (int i = 0; i < police_force.num_officers; i++) {
         PoliceOfficer *officer = &police_force.officers[i];
-        if (officer->is_active) {
+        if (officer->running) {
             pthread_join(officer->thread, NULL);
+            officer->running = false;
         }
 
         // Cleanup officer resources
@@ -403,6 +811,10 @@ void shutdown_police_force(void) {
     // Cleanup main resources
     pthread_mutex_destroy(&police_force.police_mutex);
     pthread_mutex_destroy(&police_force.arrest_mutex);
+    free(police_force.block);
+    police_force.block = NULL;
+    police_force.num_officers = 0;
+    police_ring_free(&police_force.ring);
 }
 
 void handle_sigint(int signum) {
@@ -416,24 +828,23 @@ void cleanup() {
 
     shutdown_police_force();
     cleanup_semaphores();
+    journal_close();
 
-    if (police_force.msgq_id != -1) {
-        delete_message_queue(police_force.msgq_id);
-    }
-
-    if (shared_game != NULL && shared_game != MAP_FAILED) {
-        if (munmap(shared_game, sizeof(Game)) == -1) {
-            perror("munmap failed");
-        }
-    }
+    // The message queue outlives any one department; main removes it
+    detach_shared_memory(&shm_ptrs);
+    shared_game = NULL;
 }
 
 bool attempt_plant_agent_handshake(PoliceOfficer* officer, Config* config) {
-    if (officer->num_agents >= config->max_agents_per_gang) {
+    if (officer->num_agents >= police_force.max_agents) {
         return false;
     }
 
     for (int attempt = 0; attempt < MAX_PLANT_ATTEMPTS; attempt++) {
+        if (!__atomic_load_n(&officer->is_active, __ATOMIC_ACQUIRE)) {
+            return false;  // Stopped by its department
+        }
+
         // Check success rate probability
         float random_value = random_float(0, 1);
         if (random_value > config->agent_success_rate) {
@@ -444,53 +855,63 @@ bool attempt_plant_agent_handshake(PoliceOfficer* officer, Config* config) {
 
         // Send handshake message to gang
         Message handshake_msg;
-        handshake_msg.mtype = get_gang_msgtype(config->max_agents_per_gang, (int8_t)officer->gang_id_monitoring);
+        handshake_msg.mtype = route_to(&shared_game->routing, ENDPOINT_GANG, officer->gang_id_monitoring);
         handshake_msg.mode = MSG_HANDSHAKE;
         handshake_msg.MessageContent.police_id = officer->police_id;
 
         printf("POLICE: Officer %d attempting handshake with gang %d (attempt %d/%d)\n",
                officer->police_id, officer->gang_id_monitoring, attempt + 1, MAX_PLANT_ATTEMPTS);
 
-        if (send_message(officer->msgq_id, &handshake_msg) == 0) {
+        if (route_send(&shared_game->routing, officer->msgq_id, &handshake_msg) == 0) {
             // Wait for response from gang
             Message response;
-            long response_type = get_police_msgtype(config->max_agents_per_gang, police_force.num_officers, (int8_t)officer->police_id);
             
-            // Set timeout for response (e.g., 5 seconds)
-            struct timespec timeout_start;
-            clock_gettime(CLOCK_REALTIME, &timeout_start);
+            // The reply comes through the priority lane, so sleep on it
+            // rather than polling the queue; what else rings it meanwhile
+            // (deaths, urgent reports) is handled while waiting
+            Gang *gang = &shm_ptrs.gangs[officer->gang_id_monitoring];
+            uint64_t deadline = timer_now_ms() + HANDSHAKE_TIMEOUT_MS;
             
             bool received_response = false;
-            for (int timeout_check = 0; timeout_check < 20; timeout_check++) { // 2 seconds total (reduced from 5)
-                if (receive_message_nonblocking(officer->msgq_id, &response, response_type) == 0) {
+            bool giving_up = false;
+            for (;;) {
+                uint32_t seen = notify_generation(&gang->alerts);
+                if (drain_priority_lane(officer, &response)) {
                     received_response = true;
                     break;
                 }
-                usleep(100000); // 100ms
+                uint64_t now = timer_now_ms();
+                giving_up = checkpoint_requested(&shared_game->checkpoint) ||
+                            !__atomic_load_n(&officer->is_active, __ATOMIC_ACQUIRE);
+                if (now >= deadline || giving_up) {
+                    break;
+                }
+                notify_wait(&gang->alerts, seen, (int)(deadline - now));
             }
             
+            if (received_response && response.MessageContent.agent_id < 0) {
+                printf("POLICE: Officer %d - gang %d had nobody to turn\n",
+                       officer->police_id, officer->gang_id_monitoring);
+                return false;
+            }
             if (received_response) {
                 // Gang responded with agent_id
                 int new_agent_id = response.MessageContent.agent_id;
-
-                // Add agent to officer's list
-                AgentInfo *agent = &officer->agents[officer->num_agents];
-                agent->agent_id = new_agent_id;
-                agent->knowledge_level = 0.0f;
-                agent->is_active = true;
-                agent->last_report_time = time(NULL);
-                officer->num_agents++;
+                adopt_agent(officer, new_agent_id);
 
                 printf("POLICE: Officer %d successfully planted agent %d in gang %d\n", officer->police_id,
                        new_agent_id, officer->gang_id_monitoring);
-                       
-                // Sync the updated agent data to shared memory
-                sync_police_data_to_shared_memory();
                 return true;
             }
 
+            // The gang only looks for handshakes between plans; one it
+            // hasn't taken yet is taken back rather than left to pile up
             printf("POLICE: Officer %d handshake timeout with gang %d (attempt %d/%d)\n", officer->police_id,
                    officer->gang_id_monitoring, attempt + 1, MAX_PLANT_ATTEMPTS);
+            route_withdraw(&shared_game->routing, officer->msgq_id, handshake_msg.mtype);
+            if (giving_up) {
+                return false;  // Park, or stop for the department
+            }
         } else {
             printf("POLICE: Officer %d failed to send handshake to gang %d (attempt %d/%d)\n",
                    officer->police_id, officer->gang_id_monitoring, attempt + 1, MAX_PLANT_ATTEMPTS);
@@ -503,6 +924,7 @@ bool attempt_plant_agent_handshake(PoliceOfficer* officer, Config* config) {
 }
 
 void handle_agent_death_notification(PoliceOfficer* officer, Message* msg) {
+    AgentInfo *agents = agents_of(officer);
     int dead_agent_id = msg->MessageContent.agent_id;
     
     printf("POLICE: Officer %d received death notification for agent %d\n",
@@ -510,9 +932,9 @@ void handle_agent_death_notification(PoliceOfficer* officer, Message* msg) {
     
     // Find and deactivate the agent
     for (int i = 0; i < officer->num_agents; i++) {
-        if (officer->agents[i].agent_id == dead_agent_id && officer->agents[i].is_active) {
-            officer->agents[i].is_active = false;
-            officer->agents[i].knowledge_level = 0.0f;
+        if (agents[i].agent_id == dead_agent_id && agents[i].is_active) {
+            agents[i].is_active = false;
+            agents[i].knowledge_level = 0.0f;
             
             printf("POLICE: Officer %d marked agent %d as inactive (dead)\n",
                    officer->police_id, dead_agent_id);
@@ -520,43 +942,24 @@ void handle_agent_death_notification(PoliceOfficer* officer, Message* msg) {
             // Sync the updated agent data to shared memory
             sync_police_data_to_shared_memory();
             
-            // Compact the agents array to remove inactive agents
+            // Compact the agents array to remove inactive agents; the
+            // report timeouts move along with them
+            timer_cancel(&officer->timers->wheel, &officer->timers->reports[i]);
             for (int j = i; j < officer->num_agents - 1; j++) {
-                officer->agents[j] = officer->agents[j + 1];
+                agents[j] = agents[j + 1];
+                timer_move(&officer->timers->wheel, &officer->timers->reports[j],
+                           &officer->timers->reports[j + 1]);
             }
             officer->num_agents--;
             
             // Clear the last slot
-            officer->agents[officer->num_agents].agent_id = -1;
-            officer->agents[officer->num_agents].knowledge_level = 0.0f;
-            officer->agents[officer->num_agents].is_active = false;
-            officer->agents[officer->num_agents].last_report_time = 0;
+            clear_agent(&agents[officer->num_agents]);
             
             break;
         }
     }
 }
 
-void request_information_from_agent(PoliceOfficer* officer, int agent_index) {
-    if (agent_index >= officer->num_agents || !officer->agents[agent_index].is_active) {
-        return;
-    }
-    
-    Message request;
-    request.mtype = get_agent_msgtype(config.max_agents_per_gang,
-                                     (int8_t)officer->gang_id_monitoring, 
-                                     (int8_t)officer->agents[agent_index].agent_id);
-    request.mode = MSG_POLICE_REQUEST;
-    
-    if (send_message(officer->msgq_id, &request) == 0) {
-        printf("POLICE: Officer %d requested information from agent %d\n",
-               officer->police_id, officer->agents[agent_index].agent_id);
-    } else {
-        printf("POLICE: Officer %d failed to request information from agent %d\n",
-               officer->police_id, officer->agents[agent_index].agent_id);
-    }
-}
-
 void sync_police_data_to_shared_memory(void) {
     if (shared_game == NULL) return;
     
@@ -564,39 +967,16 @@ void sync_police_data_to_shared_memory(void) {
     LOCK_GAME_STATS();
     
     // Copy police force data to shared memory
-    shared_game->police_force.num_officers = police_force.num_officers;
-    shared_game->police_force.shutdown_requested = police_force.shutdown_requested;
-    shared_game->police_force.msgq_id = police_force.msgq_id;
-    
-    // Copy arrested gangs array
-    memcpy(shared_game->police_force.arrested_gangs, police_force.arrested_gangs, 
-           sizeof(int) * police_force.num_officers);
-    
-    // Copy officer data
+    shared_game->police.num_officers = police_force.num_officers;
+    shared_game->police.max_agents = police_force.max_agents;
+
+    // Only this department's officers; the arrests are shared already
     for (int i = 0; i < police_force.num_officers; i++) {
-        PoliceOfficer *local_officer = &police_force.officers[i];
-        PoliceOfficer *shared_officer = &shared_game->police_force.officers[i];
-        
-        shared_officer->police_id = local_officer->police_id;
-        shared_officer->gang_id_monitoring = local_officer->gang_id_monitoring;
-        shared_officer->is_active = local_officer->is_active;
-        shared_officer->num_agents = local_officer->num_agents;
-        shared_officer->knowledge_level = local_officer->knowledge_level;
-        shared_officer->msgq_id = local_officer->msgq_id;
-        
-        // Copy agent information
-        for (int j = 0; j < local_officer->num_agents; j++) {
-            shared_officer->agents[j] = local_officer->agents[j];
-        }
-        
-        // Clear unused agent slots
-        for (int j = local_officer->num_agents; j < MAX_AGENTS_PER_GANG; j++) {
-            shared_officer->agents[j].agent_id = -1;
-            shared_officer->agents[j].knowledge_level = 0.0f;
-            shared_officer->agents[j].is_active = false;
-            shared_officer->agents[j].last_report_time = 0;
+        if (police_force.officers[i].held) {
+            publish_officer(&police_force.officers[i]);
         }
     }
     
     UNLOCK_GAME_STATS();
+    notify_changed();
 }
\ No newline at end of file
@@ -0,0 +1,283 @@
+// ocf-recorder: sample the running game into a time-series file, or export
+// a recorded table as CSV.
+//
+//   ocf-recorder [--hz N] [--chunk SAMPLES] OUTPUT
+//       attach to the game of this instance (main --record starts it) and
+//       sample the game counters, every gang and every officer N times a
+//       second until SIGINT
+//
+//   ocf-recorder --csv FILE [--table NAME]
+//       print a table (default gangs) as CSV, one row per sample and entity
+//
+// The recorder only reads shared memory, like the viewer: it never takes the
+// game's locks, so a sample can mix values from either side of an update.
+
+#include <getopt.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <time.h>
+#include "config.h"
+#include "game.h"
+#include "shared_mem_utils.h"
+#include "target_catalog.h"
+#include "timeseries.h"
+
+#define DEFAULT_HZ 10
+#define DEFAULT_CHUNK_SAMPLES 128
+
+enum { TABLE_GAME, TABLE_GANGS, TABLE_POLICE, NUM_TABLES };
+
+static const ColumnDesc game_columns[] = {
+    {"elapsed_time", COLUMN_INT32},
+    {"num_successful_plans", COLUMN_INT32},
+    {"num_thwarted_plans", COLUMN_INT32},
+    {"num_executed_agents", COLUMN_INT32},
+    {"arrested_gangs", COLUMN_INT32},
+};
+
+static const ColumnDesc gang_columns[] = {
+    {"notoriety", COLUMN_FLOAT32},
+    {"heat", COLUMN_FLOAT32},
+    {"success_rate", COLUMN_FLOAT32},
+    {"alive_members", COLUMN_INT32},
+    {"agents", COLUMN_INT32},
+    {"successful_plans", COLUMN_INT32},
+    {"thwarted_plans", COLUMN_INT32},
+    {"target", COLUMN_INT32},
+    {"prison_time", COLUMN_INT32},
+    {"queue_depth", COLUMN_INT32},
+};
+
+static const ColumnDesc police_columns[] = {
+    {"knowledge", COLUMN_FLOAT32},
+    {"agents", COLUMN_INT32},
+    {"active", COLUMN_INT32},
+};
+
+#define COUNT(array) ((int)(sizeof(array) / sizeof((array)[0])))
+
+static volatile sig_atomic_t stop_requested = 0;
+
+static void handle_stop(int signum) {
+    stop_requested = 1;
+}
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static double cpu_seconds(void) {
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_utime.tv_sec + usage.ru_stime.tv_sec +
+           (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1e6;
+}
+
+// Take one sample of the game, every gang and every officer
+static void take_sample(TimeSeriesWriter *writer, const ShmPtrs *shm, int num_gangs) {
+    const Game *game = shm->shared_game;
+    const PoliceTables *police = &shm->police;
+    const TargetCatalog *catalog = shm->catalog;
+    const float *target_heat = catalog_target_heat(catalog);
+    int num_officers = num_gangs;
+
+    int arrested = 0;
+    for (int i = 0; i < num_officers; i++) {
+        arrested += police->arrested_gangs[i] > 0;
+    }
+    ColumnValue game_row[COUNT(game_columns)];
+    game_row[0].i = game->elapsed_time;
+    game_row[1].i = game->num_successfull_plans;
+    game_row[2].i = game->num_thwarted_plans;
+    game_row[3].i = game->num_executed_agents;
+    game_row[4].i = arrested;
+    timeseries_put(writer, TABLE_GAME, 0, game_row);
+
+    for (int g = 0; g < num_gangs; g++) {
+        // A slot with no gang running records as an empty gang
+        static const Gang no_gang;
+        const Gang *gang = gang_slot_active(shm->directory, g) ? &shm->gangs[g] : &no_gang;
+        int target = gang->target_type;
+        float heat = 0.0f;
+        if (target >= 0 && target < catalog->num_targets) {
+            heat = target_heat[target] * catalog_gang_heat(catalog, g)[target];
+        }
+        ColumnValue row[COUNT(gang_columns)];
+        row[0].f = gang->notoriety;
+        row[1].f = heat;
+        row[2].f = gang->current_success_rate;
+        row[3].i = gang->num_alive_members;
+        row[4].i = gang->num_agents;
+        row[5].i = gang->num_successful_plans;
+        row[6].i = gang->num_thwarted_plans;
+        row[7].i = target;
+        row[8].i = police->arrested_gangs[g];
+        row[9].i = (int32_t)gang->queue_depth;
+        timeseries_put(writer, TABLE_GANGS, g, row);
+    }
+
+    for (int i = 0; i < num_officers; i++) {
+        const PoliceOfficer *officer = &police->officers[i];
+        ColumnValue row[COUNT(police_columns)];
+        row[0].f = officer->knowledge_level;
+        row[1].i = officer->num_agents;
+        row[2].i = officer->is_active;
+        timeseries_put(writer, TABLE_POLICE, i, row);
+    }
+}
+
+static int record(const char *path, int hz, int chunk_samples) {
+    Config config;
+    ShmPtrs shm;
+    setup_shared_memory_user(&config, &shm);
+    // One column set per gang slot, so gangs spawned later have theirs
+    int num_gangs = config.max_gangs;
+    int num_officers = num_gangs;  // One officer per slot
+
+    TimeSeriesTableDesc tables[NUM_TABLES] = {
+        {"game", game_columns, COUNT(game_columns), 1},
+        {"gangs", gang_columns, COUNT(gang_columns), num_gangs},
+        {"police", police_columns, COUNT(police_columns), num_officers},
+    };
+    TimeSeriesWriter writer;
+    if (timeseries_open(&writer, path, tables, NUM_TABLES, chunk_samples) == -1) {
+        return 1;
+    }
+
+    printf("RECORDER: sampling %d gang slots at %d Hz into %s\n", num_gangs, hz, path);
+    fflush(stdout);
+
+    uint64_t period_ns = 1000000000ull / hz;
+    uint64_t start_ns = now_ns();
+    uint64_t next_ns = start_ns;
+    uint64_t samples = 0;
+    uint64_t skipped = 0;
+    while (!stop_requested) {
+        take_sample(&writer, &shm, num_gangs);
+        if (timeseries_commit(&writer, (uint32_t)((now_ns() - start_ns) / 1000000)) == -1) {
+            break;
+        }
+        samples++;
+
+        // Keep to the grid; samples that are already late are dropped
+        next_ns += period_ns;
+        uint64_t now = now_ns();
+        if (now > next_ns) {
+            uint64_t behind = (now - next_ns) / period_ns + 1;
+            skipped += behind;
+            next_ns += behind * period_ns;
+        }
+        struct timespec wake = {(time_t)(next_ns / 1000000000ull), (long)(next_ns % 1000000000ull)};
+        clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &wake, NULL);
+    }
+
+    timeseries_flush(&writer);
+    unsigned long long bytes = (unsigned long long)writer.bytes_written;
+    timeseries_close(&writer);
+    double wall = (now_ns() - start_ns) / 1e9;
+    double cpu = cpu_seconds();
+    printf("RECORDER: %llu samples (%llu skipped) in %.1f s, %llu bytes, %.2f%% CPU\n",
+           (unsigned long long)samples, (unsigned long long)skipped, wall,
+           bytes, wall > 0 ? 100.0 * cpu / wall : 0.0);
+    fflush(stdout);
+    detach_shared_memory(&shm);
+    return 0;
+}
+
+static int export_csv(const char *path, const char *table_name) {
+    TimeSeriesReader reader;
+    if (timeseries_reader_open(&reader, path) == -1) {
+        fprintf(stderr, "Can't read %s\n", path);
+        return 1;
+    }
+    int table_index = timeseries_find_table(&reader, table_name);
+    if (table_index == -1) {
+        fprintf(stderr, "%s has no table %s\n", path, table_name);
+        timeseries_reader_close(&reader);
+        return 1;
+    }
+
+    const TimeSeriesTable *table = &reader.tables[table_index];
+    printf("sample,time_ms,entity");
+    for (int c = 0; c < table->num_columns; c++) {
+        printf(",%s", table->columns[c].name);
+    }
+    printf("\n");
+
+    while (timeseries_reader_next(&reader) > 0) {
+        if (reader.table != table_index) {
+            continue;
+        }
+        for (int s = 0; s < reader.samples; s++) {
+            for (int e = 0; e < table->num_entities; e++) {
+                printf("%llu,%u,%d", (unsigned long long)(reader.first_sample + s), reader.times[s], e);
+                for (int c = 0; c < table->num_columns; c++) {
+                    ColumnValue value = timeseries_value(&reader, c, e, s);
+                    switch (table->columns[c].type) {
+                        case COLUMN_FLOAT32: printf(",%g", value.f); break;
+                        case COLUMN_UINT32:  printf(",%u", value.u); break;
+                        default:             printf(",%d", value.i); break;
+                    }
+                }
+                printf("\n");
+            }
+        }
+    }
+    timeseries_reader_close(&reader);
+    return 0;
+}
+
+static void usage(const char *prog) {
+    fprintf(stderr,
+            "Usage: %s [--hz N] [--chunk SAMPLES] OUTPUT\n"
+            "       %s --csv FILE [--table NAME]\n"
+            "  --hz N           samples per second (default %d)\n"
+            "  --chunk SAMPLES  samples per compressed chunk (default %d)\n"
+            "  --csv FILE       export a recorded table as CSV\n"
+            "  --table NAME     game, gangs or police (default gangs)\n",
+            prog, prog, DEFAULT_HZ, DEFAULT_CHUNK_SAMPLES);
+}
+
+int main(int argc, char *argv[]) {
+    static const struct option long_options[] = {
+        {"hz",    required_argument, NULL, 'z'},
+        {"chunk", required_argument, NULL, 'n'},
+        {"csv",   required_argument, NULL, 'x'},
+        {"table", required_argument, NULL, 'T'},
+        {"help",  no_argument,       NULL, 'h'},
+        {NULL, 0, NULL, 0}
+    };
+    int hz = DEFAULT_HZ;
+    int chunk_samples = DEFAULT_CHUNK_SAMPLES;
+    const char *csv_path = NULL;
+    const char *table_name = "gangs";
+    int opt;
+    while ((opt = getopt_long(argc, argv, "z:n:x:T:h", long_options, NULL)) != -1) {
+        switch (opt) {
+            case 'z': hz = atoi(optarg); break;
+            case 'n': chunk_samples = atoi(optarg); break;
+            case 'x': csv_path = optarg; break;
+            case 'T': table_name = optarg; break;
+            default:
+                usage(argv[0]);
+                return opt == 'h' ? 0 : 1;
+        }
+    }
+
+    if (csv_path != NULL) {
+        return export_csv(csv_path, table_name);
+    }
+    if (optind != argc - 1 || hz <= 0 || chunk_samples <= 0) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    signal(SIGINT, handle_stop);
+    signal(SIGTERM, handle_stop);
+    return record(argv[optind], hz, chunk_samples);
+}
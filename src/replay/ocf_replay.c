@@ -0,0 +1,406 @@
+// ocf-replay: re-execute a run from its event journal (main --journal FILE)
+// in one process, as fast as the CPU allows, and check it against the run.
+//
+// The police and the member threads are not re-run: their decisions reach the
+// journal as inputs (arrests, releases, message arrivals, and the member
+// state each gang found at a plan boundary). What is re-run is everything the
+// gangs derive from those inputs at a boundary: the success rate, the outcome
+// draw from the gang's stream, the counters and the internal investigation.
+// Each boundary is checked against the state hash the gang recorded, and the
+// game counters rebuilt from the replayed outcomes are checked against every
+// tick the original run journaled.
+//
+// Exit status is 0 when every check matched, 1 otherwise.
+
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "config.h"
+#include "game.h"
+#include "journal.h"
+#include "random.h"
+#include "secret_agent_utils.h"
+#include "success_rate.h"
+
+// The gang code reaches these through extern declarations
+ShmPtrs shm_ptrs;
+int police_msgq_id = -1;
+
+#define MAX_CONFIG_VERSIONS 256
+
+typedef struct {
+    uint32_t generation;
+    Config config;
+} ConfigVersion;
+
+// Result of the last re-executed boundary of a gang, matched against the
+// outcome and check records that follow it
+typedef struct {
+    int plan;
+    int success;
+    float success_rate;
+    int executed;
+    uint64_t hash;
+    int pending;
+} ReplayedPlan;
+
+typedef struct {
+    long plans;
+    long outcome_mismatches;
+    long check_mismatches;
+    long ticks;
+    long tick_mismatches;
+    long messages;
+    long arrival_gaps;
+    long arrests;
+    long releases;
+    long reloads;
+    long unmatched;         // outcome or check without its plan record
+} ReplayStats;
+
+static FILE *report;
+static Game game;
+static ConfigVersion versions[MAX_CONFIG_VERSIONS];
+static int num_versions = 0;
+static int num_gangs = 0;        // Gang slots of the run
+static int member_capacity;      // Members each gang has room for
+static ReplayedPlan *replayed;
+static uint32_t *next_arrival;   // per source (police, then gangs)
+static ReplayStats stats;
+
+static double now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6;
+}
+
+static void add_config(uint32_t generation, const Config *config) {
+    if (num_versions == MAX_CONFIG_VERSIONS) {
+        memmove(versions, versions + 1, (MAX_CONFIG_VERSIONS - 1) * sizeof(ConfigVersion));
+        num_versions--;
+    }
+    versions[num_versions].generation = generation;
+    versions[num_versions].config = *config;
+    num_versions++;
+}
+
+// Config a gang was running with: the newest publish it had picked up
+static Config *config_for(uint32_t generation) {
+    for (int i = num_versions - 1; i >= 0; i--) {
+        if (versions[i].generation <= generation) {
+            return &versions[i].config;
+        }
+    }
+    return &versions[0].config;
+}
+
+static int valid_gang(const JournalRecord *record) {
+    return record->source >= 0 && record->source < num_gangs;
+}
+
+static int start_run(const JournalRecord *record) {
+    const JournalRun *run = journal_body(record);
+    const TargetCatalog *catalog = (const TargetCatalog *)(run + 1);
+    if (journal_body_size(record) < sizeof(*run) + sizeof(TargetCatalog) ||
+        journal_body_size(record) < sizeof(*run) + catalog->total_size) {
+        fprintf(stderr, "Journal run record is truncated\n");
+        return -1;
+    }
+
+    num_gangs = run->config.max_gangs;
+    add_config(run->config_generation, &run->config);
+    init_random_seeded(run->random_seed, RANDOM_PROC_GANG);
+
+    shm_ptrs.catalog = aligned_alloc(CATALOG_ALIGN, (catalog->total_size + CATALOG_ALIGN - 1) & ~(size_t)(CATALOG_ALIGN - 1));
+    shm_ptrs.gangs = calloc(num_gangs, sizeof(Gang));
+    replayed = calloc(num_gangs, sizeof(ReplayedPlan));
+    next_arrival = calloc(num_gangs + 1, sizeof(uint32_t));
+
+    // Each slot gets a private array as big as the gang could grow, found
+    // through a mapping table like the game's, so the gang code resolves
+    // members the same way
+    member_capacity = run->config.gang_size_limit;
+    shm_ptrs.mappings = calloc(num_gangs, sizeof(GangMapping));
+    if (shm_ptrs.catalog == NULL || shm_ptrs.gangs == NULL || shm_ptrs.mappings == NULL ||
+        replayed == NULL || next_arrival == NULL) {
+        fprintf(stderr, "Failed to allocate replay state\n");
+        return -1;
+    }
+    for (int g = 0; g < num_gangs; g++) {
+        shm_ptrs.mappings[g].members = calloc((size_t)member_capacity, sizeof(Member));
+        shm_ptrs.mappings[g].capacity = (uint32_t)member_capacity;
+        if (shm_ptrs.mappings[g].members == NULL) {
+            fprintf(stderr, "Failed to allocate replay state\n");
+            return -1;
+        }
+    }
+    memcpy(shm_ptrs.catalog, catalog, catalog->total_size);
+
+    shm_ptrs.shared_game = &game;
+    game.num_successfull_plans = run->num_successful_plans;
+    game.num_thwarted_plans = run->num_thwarted_plans;
+    game.num_executed_agents = run->num_executed_agents;
+    game.elapsed_time = run->elapsed_time;
+
+    fprintf(report, "REPLAY: seed %u, %d gang slots, starting at game time %d s\n",
+            run->random_seed, num_gangs, run->elapsed_time);
+    return 0;
+}
+
+// Re-execute one plan boundary from the state the gang journaled before it
+static void replay_plan(const JournalRecord *record) {
+    const JournalPlan *plan = journal_body(record);
+    const Member *saved = (const Member *)(plan + 1);
+    int gang_id = record->source;
+    int count = plan->gang.max_member_count;
+    if (journal_body_size(record) < sizeof(*plan) + (size_t)count * sizeof(Member)) {
+        fprintf(report, "REPLAY: gang %d plan %d: truncated record\n", gang_id, plan->plan);
+        stats.check_mismatches++;
+        return;
+    }
+
+    if (count < 0 || count > member_capacity) {
+        fprintf(report, "REPLAY: gang %d plan %d: %d members, the run allows %d\n",
+                gang_id, plan->plan, count, member_capacity);
+        stats.check_mismatches++;
+        return;
+    }
+
+    Gang *gang = &shm_ptrs.gangs[gang_id];
+    *gang = plan->gang;
+    Member *members = shm_members(&shm_ptrs, gang_id);
+    memcpy(members, saved, count * sizeof(Member));
+    Config *config = config_for(plan->config_generation);
+    random_load_thread(&plan->rng);
+
+    // Same steps as the gang's main loop
+    int alive_before = gang->num_alive_members;
+    gang->current_success_rate = calculate_success_rate(gang, members, gang->target_type, config);
+    gang->plan_success = determine_plan_success(gang, members, gang->target_type, config) ? 1 : -1;
+    if (gang->plan_success == 1) {
+        gang->num_successful_plans++;
+        gang->notoriety += 0.1f;
+    } else {
+        gang->num_thwarted_plans++;
+        conduct_internal_investigation(*config, &shm_ptrs, gang_id);
+    }
+
+    replayed[gang_id] = (ReplayedPlan){plan->plan, gang->plan_success, gang->current_success_rate,
+                                       alive_before - gang->num_alive_members,
+                                       journal_hash_gang(gang, members), 1};
+    stats.plans++;
+}
+
+static void check_outcome(const JournalRecord *record) {
+    const JournalPlanOutcome *outcome = journal_body(record);
+    ReplayedPlan *plan = &replayed[record->source];
+    if (!plan->pending || plan->plan != outcome->plan) {
+        stats.unmatched++;
+        return;
+    }
+
+    // Counters follow the replayed outcome, so the tick checks cover it
+    if (plan->success == 1) {
+        game.num_successfull_plans++;
+    } else {
+        game.num_thwarted_plans++;
+    }
+    if (plan->success != outcome->success || plan->success_rate != outcome->success_rate) {
+        fprintf(report, "REPLAY: gang %d plan %d: journal %s at %.2f%%, replay %s at %.2f%%\n",
+                record->source, outcome->plan,
+                outcome->success == 1 ? "succeeded" : "failed", outcome->success_rate,
+                plan->success == 1 ? "succeeded" : "failed", plan->success_rate);
+        stats.outcome_mismatches++;
+    }
+}
+
+static void check_plan_state(const JournalRecord *record) {
+    const JournalPlanCheck *check = journal_body(record);
+    ReplayedPlan *plan = &replayed[record->source];
+    if (!plan->pending || plan->plan != check->plan) {
+        stats.unmatched++;
+        return;
+    }
+    plan->pending = 0;
+    game.num_executed_agents += plan->executed;
+    if (plan->hash != check->hash || plan->executed != check->executed_agents) {
+        fprintf(report, "REPLAY: gang %d plan %d: state after the boundary differs "
+                "(%d agents executed, replay %d)\n",
+                record->source, check->plan, check->executed_agents, plan->executed);
+        stats.check_mismatches++;
+    }
+}
+
+static void check_tick(const JournalRecord *record) {
+    const JournalTick *tick = journal_body(record);
+    game.elapsed_time = record->tick;
+    stats.ticks++;
+    uint64_t hash = journal_hash_counters(record->tick, game.num_successfull_plans, game.num_thwarted_plans);
+    if (hash != tick->hash) {
+        fprintf(report, "REPLAY: game time %d s: journal %d successful / %d thwarted, replay %d / %d\n",
+                record->tick, tick->num_successful_plans, tick->num_thwarted_plans,
+                game.num_successfull_plans, game.num_thwarted_plans);
+        stats.tick_mismatches++;
+    }
+}
+
+// Arrival numbers are per process; a gap means records went missing
+static void check_message(const JournalRecord *record) {
+    const JournalMessage *message = journal_body(record);
+    int slot = record->source == JOURNAL_SOURCE_POLICE ? 0 : record->source + 1;
+    if (slot < 0 || slot > num_gangs) {
+        return;
+    }
+    stats.messages++;
+    if (message->arrival != next_arrival[slot]) {
+        stats.arrival_gaps++;
+    }
+    next_arrival[slot] = message->arrival + 1;
+}
+
+static void usage(const char *prog) {
+    fprintf(stderr,
+            "Usage: %s [--verbose] JOURNAL\n"
+            "  --verbose  keep the gang code's own output\n",
+            prog);
+}
+
+int main(int argc, char *argv[]) {
+    static const struct option long_options[] = {
+        {"verbose", no_argument, NULL, 'v'},
+        {"help",    no_argument, NULL, 'h'},
+        {NULL, 0, NULL, 0}
+    };
+    int verbose = 0;
+    int opt;
+    while ((opt = getopt_long(argc, argv, "vh", long_options, NULL)) != -1) {
+        switch (opt) {
+            case 'v': verbose = 1; break;
+            default:
+                usage(argv[0]);
+                return opt == 'h' ? 0 : 1;
+        }
+    }
+    if (optind != argc - 1) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    // The gang code prints every step; keep the report and drop the rest
+    report = fdopen(dup(STDOUT_FILENO), "w");
+    if (report == NULL) {
+        perror("fdopen report");
+        return 1;
+    }
+    if (!verbose && freopen("/dev/null", "w", stdout) == NULL) {
+        perror("freopen /dev/null");
+        return 1;
+    }
+
+    double start_ms = now_ms();
+    JournalReader reader;
+    if (journal_read(&reader, argv[optind]) == -1) {
+        return 1;
+    }
+    double loaded_ms = now_ms();
+    if (reader.count == 0 || reader.records[0]->type != JOURNAL_RUN) {
+        fprintf(stderr, "%s doesn't start with a run record\n", argv[optind]);
+        journal_reader_close(&reader);
+        return 1;
+    }
+
+    int first_tick = -1;
+    int last_tick = 0;
+    uint64_t first_ns = 0;
+    uint64_t last_ns = 0;
+    const JournalTick *end = NULL;
+    size_t i = 0;
+    // The END record holds the counters the run reported; what the police
+    // still logs while shutting down comes after it and isn't counted
+    for (; i < reader.count && end == NULL; i++) {
+        const JournalRecord *record = reader.records[i];
+        switch (record->type) {
+            case JOURNAL_RUN:
+                if (i == 0 && start_run(record) == -1) {
+                    journal_reader_close(&reader);
+                    return 1;
+                }
+                break;
+            case JOURNAL_CONFIG: {
+                const JournalConfig *reload = journal_body(record);
+                add_config(reload->generation, &reload->config);
+                stats.reloads++;
+                break;
+            }
+            case JOURNAL_TICK:
+            case JOURNAL_END: {
+                const JournalTick *tick = journal_body(record);
+                check_tick(record);
+                if (first_tick < 0) {
+                    first_tick = record->tick;
+                    first_ns = tick->monotonic_ns;
+                }
+                last_tick = record->tick;
+                last_ns = tick->monotonic_ns;
+                if (record->type == JOURNAL_END) end = tick;
+                break;
+            }
+            case JOURNAL_MESSAGE:
+                check_message(record);
+                break;
+            case JOURNAL_PLAN:
+                if (valid_gang(record)) replay_plan(record);
+                break;
+            case JOURNAL_PLAN_OUTCOME:
+                if (valid_gang(record)) check_outcome(record);
+                break;
+            case JOURNAL_PLAN_CHECK:
+                if (valid_gang(record)) check_plan_state(record);
+                break;
+            case JOURNAL_ARREST:
+                game.num_thwarted_plans++;
+                stats.arrests++;
+                break;
+            case JOURNAL_RELEASE:
+                stats.releases++;
+                break;
+            default:
+                break;
+        }
+    }
+    double done_ms = now_ms();
+
+    long mismatches = stats.outcome_mismatches + stats.check_mismatches + stats.tick_mismatches;
+    fprintf(report, "REPLAY: %zu records", reader.count);
+    if (reader.dropped_bytes > 0) {
+        fprintf(report, " (%zu bytes of a cut-off record dropped)", reader.dropped_bytes);
+    }
+    fprintf(report, ", game time %d..%d s", first_tick < 0 ? 0 : first_tick, last_tick);
+    if (i < reader.count) {
+        fprintf(report, ", %zu after the end not replayed", reader.count - i);
+    }
+    fprintf(report, "\n");
+    fprintf(report, "REPLAY: %ld plans re-executed, %ld outcome and %ld state mismatches, %ld unmatched\n",
+            stats.plans, stats.outcome_mismatches, stats.check_mismatches, stats.unmatched);
+    fprintf(report, "REPLAY: %ld ticks checked, %ld mismatches; %ld arrests, %ld releases, %ld config reloads\n",
+            stats.ticks, stats.tick_mismatches, stats.arrests, stats.releases, stats.reloads);
+    fprintf(report, "REPLAY: %ld message arrivals, %ld gaps\n", stats.messages, stats.arrival_gaps);
+    if (end != NULL) {
+        fprintf(report, "REPLAY: final %d successful / %d thwarted, %d agents executed (journal %d)\n",
+                game.num_successfull_plans, game.num_thwarted_plans, game.num_executed_agents,
+                end->num_executed_agents);
+    }
+    double original_ms = (last_ns - first_ns) / 1e6;
+    double replay_ms = done_ms - start_ms;
+    fprintf(report, "REPLAY: %.1f s of the original run replayed in %.1f ms (load %.1f ms, %.0fx real time)\n",
+            original_ms / 1000.0, replay_ms, loaded_ms - start_ms,
+            replay_ms > 0 ? original_ms / replay_ms : 0.0);
+    fprintf(report, "REPLAY: %s\n", mismatches == 0 ? "OK" : "DIVERGED");
+    fclose(report);
+
+    journal_reader_close(&reader);
+    return mismatches == 0 ? 0 : 1;
+}
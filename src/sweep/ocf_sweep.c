@@ -0,0 +1,743 @@
+// ocf-sweep: run the simulation headless over a grid or random sample of
+// config parameters, several games at a time, and collect the outcomes in a
+// columnar table (one row per parameter point and seed) plus a per-point
+// summary. Rerunning the same spec with the same output resumes the sweep.
+//
+// Spec file (key=value, '#' comments):
+//
+//   base=config.txt            config every run starts from
+//   output=sweep.ocfs          results table (summary goes to <output>.summary)
+//   mode=grid                  grid | random
+//   samples=1000               points drawn in random mode
+//   seeds=3                    runs per point, each with its own master seed
+//   seed=1                     seed for point sampling and run seeds
+//   jobs=0                     concurrent games (0 = one per core)
+//   max_time=120               game seconds before a run is cut off
+//
+//   difficulty_level=0,2,4,6   a list of values
+//   agent_success_rate=0.3:0.7:0.1
+//                              lo:hi:step (grid), lo:hi (random, uniform)
+//
+// Any other key is taken as a config.txt parameter to vary.
+
+#include <errno.h>
+#include <getopt.h>
+#include <limits.h>
+#include <math.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "columnar.h"
+#include "config.h"
+#include "instance.h"
+#include "random.h"
+
+#define MAX_SWEEP_PARAMS 16
+#define MAX_PARAM_VALUES 256
+#define MAX_JOBS 63
+#define SWEEP_CHUNK_ROWS 64
+#define SWEEP_FLUSH_SECONDS 30
+
+// Run status column values (0 and 1 come from main's result file)
+#define RUN_FINISHED 0      // a game-over condition was reached
+#define RUN_TIMED_OUT 1     // max_time reached first
+#define RUN_CRASHED 2       // main exited without a result
+#define RUN_INVALID 3       // the point's config failed validation
+
+typedef struct {
+    char name[COLUMN_NAME_LEN];
+    int is_range;
+    double lo, hi, step;
+    int integer;            // all numbers in the spec were integers
+    int num_values;
+    double values[MAX_PARAM_VALUES];
+} SweepParam;
+
+typedef struct {
+    char base[PATH_MAX];
+    char output[PATH_MAX];
+    int random_mode;
+    int samples;
+    int seeds;
+    int jobs;
+    int max_time;
+    unsigned int seed;
+    int num_params;
+    SweepParam params[MAX_SWEEP_PARAMS];
+} SweepSpec;
+
+typedef struct {
+    pid_t pid;
+    long run;
+    double start_ms;
+    char config_path[PATH_MAX];
+    char result_path[PATH_MAX];
+} Slot;
+
+// Columns before the parameters and after them
+static const char *lead_columns[] = {"point", "replica", "seed"};
+static const char *result_columns[] = {"status", "num_gangs", "elapsed_time", "num_successful_plans",
+                                       "num_thwarted_plans", "num_executed_agents", "wall_ms"};
+#define NUM_LEAD (int)(sizeof(lead_columns) / sizeof(lead_columns[0]))
+#define NUM_RESULT (int)(sizeof(result_columns) / sizeof(result_columns[0]))
+
+static volatile sig_atomic_t stop_requested = 0;
+
+static void handle_stop(int signum) {
+    (void)signum;
+    stop_requested = 1;
+}
+
+static double now_ms(void) {
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return tv.tv_sec * 1000.0 + tv.tv_usec / 1000.0;
+}
+
+static char *trim(char *s) {
+    while (*s == ' ' || *s == '\t') s++;
+    char *end = s + strlen(s);
+    while (end > s && (end[-1] == ' ' || end[-1] == '\t' || end[-1] == '\n' || end[-1] == '\r')) end--;
+    *end = '\0';
+    return s;
+}
+
+static int parse_param(SweepParam *param, const char *name, char *value, int random_mode) {
+    snprintf(param->name, sizeof(param->name), "%s", name);
+    param->integer = strpbrk(value, ".eE") == NULL;
+
+    if (strchr(value, ':')) {
+        param->is_range = 1;
+        param->step = 0.0;
+        int n = sscanf(value, "%lf:%lf:%lf", &param->lo, &param->hi, &param->step);
+        if (n < 2 || param->hi < param->lo) {
+            fprintf(stderr, "SWEEP: Bad range for %s: %s\n", name, value);
+            return -1;
+        }
+        if (random_mode) {
+            return 0;
+        }
+        if (n < 3 || param->step <= 0.0) {
+            fprintf(stderr, "SWEEP: Grid range for %s needs a positive step\n", name);
+            return -1;
+        }
+        // Expand the range into values for the grid
+        for (int i = 0; ; i++) {
+            double v = param->lo + i * param->step;
+            if (v > param->hi + param->step * 1e-6) break;
+            if (param->num_values == MAX_PARAM_VALUES) {
+                fprintf(stderr, "SWEEP: Too many values for %s\n", name);
+                return -1;
+            }
+            param->values[param->num_values++] = v;
+        }
+        return 0;
+    }
+
+    for (char *tok = strtok(value, ","); tok; tok = strtok(NULL, ",")) {
+        if (param->num_values == MAX_PARAM_VALUES) {
+            fprintf(stderr, "SWEEP: Too many values for %s\n", name);
+            return -1;
+        }
+        param->values[param->num_values++] = atof(tok);
+    }
+    if (param->num_values == 0) {
+        fprintf(stderr, "SWEEP: No values for %s\n", name);
+        return -1;
+    }
+    return 0;
+}
+
+static int parse_spec(const char *path, SweepSpec *spec) {
+    FILE *file = fopen(path, "r");
+    if (!file) {
+        perror("Error opening sweep spec");
+        return -1;
+    }
+
+    memset(spec, 0, sizeof(*spec));
+    snprintf(spec->base, sizeof(spec->base), "%s", CONFIG_PATH);
+    snprintf(spec->output, sizeof(spec->output), "sweep.ocfs");
+    spec->samples = 100;
+    spec->seeds = 1;
+    spec->seed = 1;
+    spec->max_time = 120;
+
+    // Parameters are parsed after the whole file, once the mode is known
+    char pending_names[MAX_SWEEP_PARAMS][COLUMN_NAME_LEN];
+    char pending_values[MAX_SWEEP_PARAMS][256];
+
+    char line[512];
+    while (fgets(line, sizeof(line), file)) {
+        char *s = trim(line);
+        if (*s == '#' || *s == '\0') continue;
+
+        char *eq = strchr(s, '=');
+        if (!eq) {
+            fprintf(stderr, "SWEEP: Ignoring line without '=': %s\n", s);
+            continue;
+        }
+        *eq = '\0';
+        char *key = trim(s);
+        char *value = trim(eq + 1);
+
+        if (strcmp(key, "base") == 0) snprintf(spec->base, sizeof(spec->base), "%s", value);
+        else if (strcmp(key, "output") == 0) snprintf(spec->output, sizeof(spec->output), "%s", value);
+        else if (strcmp(key, "mode") == 0) spec->random_mode = strcmp(value, "random") == 0;
+        else if (strcmp(key, "samples") == 0) spec->samples = atoi(value);
+        else if (strcmp(key, "seeds") == 0) spec->seeds = atoi(value);
+        else if (strcmp(key, "seed") == 0) spec->seed = (unsigned int)strtoul(value, NULL, 10);
+        else if (strcmp(key, "jobs") == 0) spec->jobs = atoi(value);
+        else if (strcmp(key, "max_time") == 0) spec->max_time = atoi(value);
+        else {
+            if (spec->num_params == MAX_SWEEP_PARAMS) {
+                fprintf(stderr, "SWEEP: Too many parameters (max %d)\n", MAX_SWEEP_PARAMS);
+                fclose(file);
+                return -1;
+            }
+            snprintf(pending_names[spec->num_params], COLUMN_NAME_LEN, "%s", key);
+            snprintf(pending_values[spec->num_params], sizeof(pending_values[0]), "%s", value);
+            spec->num_params++;
+        }
+    }
+    fclose(file);
+
+    for (int p = 0; p < spec->num_params; p++) {
+        if (parse_param(&spec->params[p], pending_names[p], pending_values[p], spec->random_mode) == -1) {
+            return -1;
+        }
+    }
+    if (spec->num_params == 0) {
+        fprintf(stderr, "SWEEP: The spec varies no parameters\n");
+        return -1;
+    }
+    if (spec->seeds < 1) spec->seeds = 1;
+    return 0;
+}
+
+static long count_points(const SweepSpec *spec) {
+    if (spec->random_mode) {
+        return spec->samples;
+    }
+    long points = 1;
+    for (int p = 0; p < spec->num_params; p++) {
+        points *= spec->params[p].num_values;
+    }
+    return points;
+}
+
+// Parameter values of a point. Random points are drawn from a stream keyed by
+// the point index, so a resumed sweep sees exactly the same points.
+static void point_values(const SweepSpec *spec, long point, double *values) {
+    if (!spec->random_mode) {
+        long rest = point;
+        for (int p = spec->num_params - 1; p >= 0; p--) {
+            const SweepParam *param = &spec->params[p];
+            values[p] = param->values[rest % param->num_values];
+            rest /= param->num_values;
+        }
+        return;
+    }
+
+    RandomStream stream;
+    random_stream_seed(&stream, spec->seed, RANDOM_PROC_SWEEP, (int)point, -1);
+    for (int p = 0; p < spec->num_params; p++) {
+        const SweepParam *param = &spec->params[p];
+        double u = (double)(random_stream_next(&stream) >> 11) * 0x1.0p-53;
+        if (!param->is_range) {
+            values[p] = param->values[(int)(u * param->num_values)];
+        } else if (param->integer) {
+            values[p] = param->lo + floor(u * (param->hi - param->lo + 1.0));
+        } else {
+            values[p] = param->lo + u * (param->hi - param->lo);
+        }
+    }
+}
+
+static unsigned int run_seed(const SweepSpec *spec, long point, int replica) {
+    RandomStream stream;
+    random_stream_seed(&stream, spec->seed, RANDOM_PROC_SWEEP, (int)point, replica);
+    return (unsigned int)random_stream_next(&stream) | 1u;
+}
+
+static char *read_file(const char *path) {
+    FILE *file = fopen(path, "r");
+    if (!file) return NULL;
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    char *text = malloc(size + 1);
+    if (text && fread(text, 1, size, file) != (size_t)size) {
+        free(text);
+        text = NULL;
+    }
+    if (text) text[size] = '\0';
+    fclose(file);
+    return text;
+}
+
+// Base config followed by the overrides; load_config applies lines in order,
+// so the later values win
+static int write_run_config(const SweepSpec *spec, const char *base_text, const double *values,
+                            unsigned int seed, const char *path) {
+    FILE *file = fopen(path, "w");
+    if (!file) {
+        perror("Error writing run config");
+        return -1;
+    }
+    fprintf(file, "%s\n# ocf-sweep overrides\n", base_text);
+    for (int p = 0; p < spec->num_params; p++) {
+        if (spec->params[p].integer) {
+            fprintf(file, "%s=%ld\n", spec->params[p].name, lround(values[p]));
+        } else {
+            fprintf(file, "%s=%.6g\n", spec->params[p].name, values[p]);
+        }
+    }
+    fprintf(file, "random_seed=%u\n", seed);
+    fclose(file);
+
+    Config check;
+    return load_config(path, &check);
+}
+
+static int read_result(const char *path, int *result) {
+    FILE *file = fopen(path, "r");
+    if (!file) return -1;
+
+    // result[] follows result_columns, minus wall_ms
+    for (int i = 0; i < NUM_RESULT - 1; i++) result[i] = 0;
+    char key[64];
+    int value;
+    int found = 0;
+    while (fscanf(file, "%63[^=]=%d\n", key, &value) == 2) {
+        for (int i = 0; i < NUM_RESULT - 1; i++) {
+            if (strcmp(key, result_columns[i]) == 0) {
+                result[i] = value;
+                found++;
+            }
+        }
+    }
+    fclose(file);
+    return found > 0 ? 0 : -1;
+}
+
+static int build_columns(const SweepSpec *spec, ColumnDesc *columns) {
+    int n = 0;
+    for (int i = 0; i < NUM_LEAD; i++, n++) {
+        memset(&columns[n], 0, sizeof(ColumnDesc));
+        snprintf(columns[n].name, COLUMN_NAME_LEN, "%s", lead_columns[i]);
+        columns[n].type = strcmp(lead_columns[i], "seed") == 0 ? COLUMN_UINT32 : COLUMN_INT32;
+    }
+    for (int p = 0; p < spec->num_params; p++, n++) {
+        memset(&columns[n], 0, sizeof(ColumnDesc));
+        snprintf(columns[n].name, COLUMN_NAME_LEN, "%s", spec->params[p].name);
+        columns[n].type = COLUMN_FLOAT32;
+    }
+    for (int i = 0; i < NUM_RESULT; i++, n++) {
+        memset(&columns[n], 0, sizeof(ColumnDesc));
+        snprintf(columns[n].name, COLUMN_NAME_LEN, "%s", result_columns[i]);
+        columns[n].type = COLUMN_INT32;
+    }
+    return n;
+}
+
+// Mark the runs an earlier, interrupted sweep already finished
+static long load_done_runs(const SweepSpec *spec, unsigned char *done, long total) {
+    ColumnarReader reader;
+    if (columnar_reader_open(&reader, spec->output) == -1) {
+        return 0;
+    }
+    int point_col = columnar_find_column(reader.columns, reader.num_columns, "point");
+    int replica_col = columnar_find_column(reader.columns, reader.num_columns, "replica");
+    long count = 0;
+    while (point_col >= 0 && replica_col >= 0 && columnar_reader_next(&reader) > 0) {
+        for (int r = 0; r < reader.rows; r++) {
+            long run = (long)columnar_column(&reader, point_col)[r].i * spec->seeds +
+                       columnar_column(&reader, replica_col)[r].i;
+            if (run >= 0 && run < total && !done[run]) {
+                done[run] = 1;
+                count++;
+            }
+        }
+    }
+    columnar_reader_close(&reader);
+    return count;
+}
+
+static pid_t launch_run(const Slot *slot, int instance, int max_time) {
+    pid_t pid = fork();
+    if (pid == -1) {
+        perror("fork");
+        return -1;
+    }
+    if (pid == 0) {
+        char instance_buf[16], time_buf[16];
+        snprintf(instance_buf, sizeof(instance_buf), "%d", instance);
+        snprintf(time_buf, sizeof(time_buf), "%d", max_time);
+        setenv(INSTANCE_ENV, instance_buf, 1);
+
+        // A sweep runs thousands of games; their logs would drown the terminal
+        if (freopen("/dev/null", "w", stdout) == NULL || freopen("/dev/null", "w", stderr) == NULL) {
+            _exit(127);
+        }
+        execl(MAIN_EXECUTABLE, MAIN_EXECUTABLE, "--config", slot->config_path, "--headless",
+              "--result", slot->result_path, "--max-time", time_buf, (char *)NULL);
+        _exit(127);
+    }
+    return pid;
+}
+
+static void append_row(ColumnarWriter *writer, const SweepSpec *spec, long run, unsigned int seed,
+                       const double *values, int status, const int *result, int wall_ms) {
+    ColumnValue row[NUM_LEAD + MAX_SWEEP_PARAMS + NUM_RESULT];
+    int n = 0;
+    row[n++].i = (int32_t)(run / spec->seeds);
+    row[n++].i = (int32_t)(run % spec->seeds);
+    row[n++].u = seed;
+    for (int p = 0; p < spec->num_params; p++) {
+        row[n++].f = (float)values[p];
+    }
+    row[n++].i = status;
+    for (int i = 1; i < NUM_RESULT - 1; i++) {
+        row[n++].i = result ? result[i] : 0;
+    }
+    row[n++].i = wall_ms;
+    columnar_append(writer, row);
+}
+
+typedef struct {
+    int runs;
+    int finished;
+    double elapsed;
+    double successful, successful_sq;
+    double thwarted, thwarted_sq;
+    double executed;
+} PointStats;
+
+// Rebuild the per-point summary from every row in the results table
+static int write_summary(const SweepSpec *spec, long num_points) {
+    PointStats *stats = calloc(num_points, sizeof(PointStats));
+    if (stats == NULL) {
+        fprintf(stderr, "SWEEP: Failed to allocate summary\n");
+        return -1;
+    }
+
+    ColumnarReader reader;
+    if (columnar_reader_open(&reader, spec->output) == -1) {
+        free(stats);
+        return -1;
+    }
+    const ColumnDesc *cols = reader.columns;
+    int n = reader.num_columns;
+    int c_point = columnar_find_column(cols, n, "point");
+    int c_status = columnar_find_column(cols, n, "status");
+    int c_elapsed = columnar_find_column(cols, n, "elapsed_time");
+    int c_success = columnar_find_column(cols, n, "num_successful_plans");
+    int c_thwart = columnar_find_column(cols, n, "num_thwarted_plans");
+    int c_exec = columnar_find_column(cols, n, "num_executed_agents");
+
+    while (columnar_reader_next(&reader) > 0) {
+        for (int r = 0; r < reader.rows; r++) {
+            long point = columnar_column(&reader, c_point)[r].i;
+            int status = columnar_column(&reader, c_status)[r].i;
+            if (point < 0 || point >= num_points || status >= RUN_CRASHED) continue;
+
+            PointStats *s = &stats[point];
+            double success = columnar_column(&reader, c_success)[r].i;
+            double thwart = columnar_column(&reader, c_thwart)[r].i;
+            s->runs++;
+            s->finished += status == RUN_FINISHED;
+            s->elapsed += columnar_column(&reader, c_elapsed)[r].i;
+            s->successful += success;
+            s->successful_sq += success * success;
+            s->thwarted += thwart;
+            s->thwarted_sq += thwart * thwart;
+            s->executed += columnar_column(&reader, c_exec)[r].i;
+        }
+    }
+    columnar_reader_close(&reader);
+
+    static const char *summary_names[] = {"runs", "finished", "mean_elapsed_time", "mean_successful_plans",
+                                          "sd_successful_plans", "mean_thwarted_plans", "sd_thwarted_plans",
+                                          "mean_executed_agents"};
+    const int num_summary = (int)(sizeof(summary_names) / sizeof(summary_names[0]));
+    ColumnDesc columns[1 + MAX_SWEEP_PARAMS + 8];
+    int nc = 0;
+    memset(columns, 0, sizeof(columns));
+    snprintf(columns[nc].name, COLUMN_NAME_LEN, "point");
+    columns[nc++].type = COLUMN_INT32;
+    for (int p = 0; p < spec->num_params; p++) {
+        snprintf(columns[nc].name, COLUMN_NAME_LEN, "%s", spec->params[p].name);
+        columns[nc++].type = COLUMN_FLOAT32;
+    }
+    for (int i = 0; i < num_summary; i++) {
+        snprintf(columns[nc].name, COLUMN_NAME_LEN, "%s", summary_names[i]);
+        columns[nc++].type = i < 2 ? COLUMN_INT32 : COLUMN_FLOAT32;
+    }
+
+    char path[PATH_MAX + 16];
+    snprintf(path, sizeof(path), "%s.summary", spec->output);
+    unlink(path);
+    ColumnarWriter writer;
+    if (columnar_open(&writer, path, columns, nc, 1024) == -1) {
+        free(stats);
+        return -1;
+    }
+
+    double values[MAX_SWEEP_PARAMS];
+    for (long point = 0; point < num_points; point++) {
+        const PointStats *s = &stats[point];
+        double runs = s->runs > 0 ? s->runs : 1;
+        double mean_success = s->successful / runs;
+        double mean_thwart = s->thwarted / runs;
+        point_values(spec, point, values);
+
+        ColumnValue row[1 + MAX_SWEEP_PARAMS + 8];
+        int k = 0;
+        row[k++].i = (int32_t)point;
+        for (int p = 0; p < spec->num_params; p++) row[k++].f = (float)values[p];
+        row[k++].i = s->runs;
+        row[k++].i = s->finished;
+        row[k++].f = (float)(s->elapsed / runs);
+        row[k++].f = (float)mean_success;
+        row[k++].f = (float)sqrt(fmax(s->successful_sq / runs - mean_success * mean_success, 0.0));
+        row[k++].f = (float)mean_thwart;
+        row[k++].f = (float)sqrt(fmax(s->thwarted_sq / runs - mean_thwart * mean_thwart, 0.0));
+        row[k++].f = (float)(s->executed / runs);
+        columnar_append(&writer, row);
+    }
+    free(stats);
+    return columnar_close(&writer);
+}
+
+// Print a table as CSV
+static int dump_table(const char *path) {
+    ColumnarReader reader;
+    if (columnar_reader_open(&reader, path) == -1) {
+        fprintf(stderr, "SWEEP: Cannot read %s\n", path);
+        return 1;
+    }
+    for (int c = 0; c < reader.num_columns; c++) {
+        printf("%s%s", c ? "," : "", reader.columns[c].name);
+    }
+    printf("\n");
+    while (columnar_reader_next(&reader) > 0) {
+        for (int r = 0; r < reader.rows; r++) {
+            for (int c = 0; c < reader.num_columns; c++) {
+                ColumnValue v = columnar_column(&reader, c)[r];
+                if (c) putchar(',');
+                if (reader.columns[c].type == COLUMN_FLOAT32) printf("%g", v.f);
+                else if (reader.columns[c].type == COLUMN_UINT32) printf("%u", v.u);
+                else printf("%d", v.i);
+            }
+            printf("\n");
+        }
+    }
+    columnar_reader_close(&reader);
+    return 0;
+}
+
+static void usage(const char *prog) {
+    fprintf(stderr,
+            "Usage: %s [-o OUTPUT] [-j JOBS] SPEC\n"
+            "       %s --dump TABLE       print a results or summary table as CSV\n",
+            prog, prog);
+}
+
+int main(int argc, char *argv[]) {
+    static const struct option long_options[] = {
+        {"output", required_argument, NULL, 'o'},
+        {"jobs",   required_argument, NULL, 'j'},
+        {"dump",   required_argument, NULL, 'd'},
+        {"help",   no_argument,       NULL, 'h'},
+        {NULL, 0, NULL, 0}
+    };
+    const char *output_option = NULL;
+    int jobs_option = -1;
+    int opt;
+    while ((opt = getopt_long(argc, argv, "o:j:d:h", long_options, NULL)) != -1) {
+        switch (opt) {
+            case 'o': output_option = optarg; break;
+            case 'j': jobs_option = atoi(optarg); break;
+            case 'd': return dump_table(optarg);
+            default:
+                usage(argv[0]);
+                return opt == 'h' ? 0 : 1;
+        }
+    }
+    if (optind != argc - 1) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    SweepSpec spec;
+    if (parse_spec(argv[optind], &spec) == -1) {
+        return 1;
+    }
+    if (output_option) snprintf(spec.output, sizeof(spec.output), "%s", output_option);
+    if (jobs_option >= 0) spec.jobs = jobs_option;
+    if (spec.jobs <= 0) spec.jobs = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    if (spec.jobs > MAX_JOBS) spec.jobs = MAX_JOBS;
+
+    char *base_text = read_file(spec.base);
+    if (base_text == NULL) {
+        fprintf(stderr, "SWEEP: Cannot read base config %s\n", spec.base);
+        return 1;
+    }
+
+    long num_points = count_points(&spec);
+    long total = num_points * spec.seeds;
+    unsigned char *done = calloc(total > 0 ? total : 1, 1);
+    if (done == NULL) {
+        fprintf(stderr, "SWEEP: Failed to allocate run table\n");
+        return 1;
+    }
+
+    ColumnDesc columns[NUM_LEAD + MAX_SWEEP_PARAMS + NUM_RESULT];
+    int num_columns = build_columns(&spec, columns);
+    long already = load_done_runs(&spec, done, total);
+    ColumnarWriter writer;
+    if (columnar_open(&writer, spec.output, columns, num_columns, SWEEP_CHUNK_ROWS) == -1) {
+        fprintf(stderr, "SWEEP: Cannot open %s (different spec?)\n", spec.output);
+        return 1;
+    }
+
+    char work_dir[PATH_MAX];
+    if (snprintf(work_dir, sizeof(work_dir), "%s.work", spec.output) >= (int)sizeof(work_dir)) {
+        fprintf(stderr, "SWEEP: Output path too long: %s\n", spec.output);
+        return 1;
+    }
+    if (mkdir(work_dir, 0755) == -1 && errno != EEXIST) {
+        perror("Error creating work directory");
+        return 1;
+    }
+
+    printf("SWEEP: %ld points x %d seeds = %ld runs, %ld already done, %d jobs\n",
+           num_points, spec.seeds, total, already, spec.jobs);
+    fflush(stdout);
+
+    struct sigaction sa = {0};
+    sa.sa_handler = handle_stop;
+    sigaction(SIGINT, &sa, NULL);
+    sigaction(SIGTERM, &sa, NULL);
+
+    // Instance numbers are unique per slot, and offset by our pid so two
+    // sweeps on one machine don't share IPC names
+    int instance_base = (int)(getpid() % ((MAX_INSTANCE + 1) / (MAX_JOBS + 1) - 1)) * (MAX_JOBS + 1);
+
+    Slot slots[MAX_JOBS];
+    for (int s = 0; s < spec.jobs; s++) {
+        slots[s].pid = 0;
+        if (snprintf(slots[s].config_path, PATH_MAX, "%s/slot%d.cfg", work_dir, s) >= PATH_MAX ||
+            snprintf(slots[s].result_path, PATH_MAX, "%s/slot%d.result", work_dir, s) >= PATH_MAX) {
+            fprintf(stderr, "SWEEP: Work directory path too long: %s\n", work_dir);
+            return 1;
+        }
+    }
+
+    long next = 0, completed = already;
+    int active = 0;
+    double last_flush = now_ms();
+    double values[MAX_SWEEP_PARAMS];
+
+    while (!stop_requested && (next < total || active > 0)) {
+        // Fill the free slots
+        for (int s = 0; s < spec.jobs && next < total && !stop_requested; s++) {
+            if (slots[s].pid != 0) continue;
+            while (next < total && done[next]) next++;
+            if (next == total) break;
+
+            long run = next++;
+            long point = run / spec.seeds;
+            unsigned int seed = run_seed(&spec, point, (int)(run % spec.seeds));
+            point_values(&spec, point, values);
+
+            if (write_run_config(&spec, base_text, values, seed, slots[s].config_path) == -1) {
+                append_row(&writer, &spec, run, seed, values, RUN_INVALID, NULL, 0);
+                completed++;
+                continue;
+            }
+            unlink(slots[s].result_path);
+            slots[s].pid = launch_run(&slots[s], instance_base + s + 1, spec.max_time);
+            if (slots[s].pid == -1) {
+                slots[s].pid = 0;
+                stop_requested = 1;
+                break;
+            }
+            slots[s].run = run;
+            slots[s].start_ms = now_ms();
+            active++;
+        }
+        if (active == 0) continue;
+
+        int wstatus;
+        pid_t pid = wait(&wstatus);
+        if (pid == -1) {
+            if (errno == EINTR) continue;
+            perror("wait");
+            break;
+        }
+
+        for (int s = 0; s < spec.jobs; s++) {
+            if (slots[s].pid != pid) continue;
+
+            long run = slots[s].run;
+            long point = run / spec.seeds;
+            unsigned int seed = run_seed(&spec, point, (int)(run % spec.seeds));
+            point_values(&spec, point, values);
+
+            int result[NUM_RESULT];
+            int status = RUN_CRASHED;
+            if (read_result(slots[s].result_path, result) == 0) {
+                status = result[0];
+            }
+            append_row(&writer, &spec, run, seed, values, status, status == RUN_CRASHED ? NULL : result,
+                       (int)(now_ms() - slots[s].start_ms));
+
+            slots[s].pid = 0;
+            active--;
+            completed++;
+            break;
+        }
+
+        if (now_ms() - last_flush > SWEEP_FLUSH_SECONDS * 1000.0) {
+            columnar_flush(&writer);
+            last_flush = now_ms();
+            printf("SWEEP: %ld/%ld runs done, %d running\n", completed, total, active);
+            fflush(stdout);
+        }
+    }
+
+    if (stop_requested) {
+        // Unfinished runs are not recorded; the next invocation redoes them
+        printf("SWEEP: Interrupted, stopping %d running games\n", active);
+        fflush(stdout);
+        for (int s = 0; s < spec.jobs; s++) {
+            if (slots[s].pid > 0) kill(slots[s].pid, SIGINT);
+        }
+        for (int s = 0; s < spec.jobs; s++) {
+            if (slots[s].pid > 0) waitpid(slots[s].pid, NULL, 0);
+        }
+    }
+
+    columnar_close(&writer);
+    free(base_text);
+    free(done);
+
+    if (stop_requested) {
+        printf("SWEEP: %ld/%ld runs saved in %s; rerun to resume\n", completed, total, spec.output);
+        return 130;
+    }
+
+    if (write_summary(&spec, num_points) == -1) {
+        fprintf(stderr, "SWEEP: Failed to write summary\n");
+        return 1;
+    }
+    printf("SWEEP: Done, %ld runs in %s, summary in %s.summary\n", total, spec.output, spec.output);
+    return 0;
+}
@@ -0,0 +1,69 @@
+#include "agent_mailbox.h"
+#include <sched.h>
+#include <time.h>
+
+#define READ_ATTEMPTS 1000  // A write is a handful of stores; after this many the writer is gone
+
+// Write the slot between two bumps of its sequence; the fields are stored
+// relaxed, the closing bump publishes them
+static void write_slot(AgentMailbox *box, int32_t agent_id, float knowledge, int32_t game_time,
+                       uint32_t raised_us) {
+    uint32_t sequence = __atomic_load_n(&box->sequence, __ATOMIC_RELAXED);
+    __atomic_store_n(&box->sequence, sequence + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+
+    __atomic_store_n(&box->agent_id, agent_id, __ATOMIC_RELAXED);
+    __atomic_store(&box->knowledge, &knowledge, __ATOMIC_RELAXED);
+    __atomic_store_n(&box->game_time, game_time, __ATOMIC_RELAXED);
+    __atomic_store_n(&box->raised_us, raised_us, __ATOMIC_RELAXED);
+
+    __atomic_store_n(&box->sequence, sequence + 2, __ATOMIC_RELEASE);
+}
+
+void agent_mailbox_clear(AgentMailbox *box) {
+    write_slot(box, AGENT_MAILBOX_FREE, 0.0f, -1, 0);
+}
+
+void agent_mailbox_claim(AgentMailbox *box, int32_t agent_id) {
+    write_slot(box, agent_id, 0.0f, -1, 0);
+}
+
+void agent_mailbox_post(AgentMailbox *box, float knowledge, int32_t game_time, uint32_t raised_us) {
+    write_slot(box, __atomic_load_n(&box->agent_id, __ATOMIC_RELAXED), knowledge, game_time, raised_us);
+}
+
+uint32_t agent_mailbox_now_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    uint32_t now = (uint32_t)((uint64_t)ts.tv_sec * 1000000 + (uint64_t)ts.tv_nsec / 1000);
+    return now != 0 ? now : 1;
+}
+
+int agent_mailbox_read(const AgentMailbox *box, AgentReport *report) {
+    for (int attempt = 0; attempt < READ_ATTEMPTS; attempt++) {
+        uint32_t before = __atomic_load_n(&box->sequence, __ATOMIC_ACQUIRE);
+        if (before & 1u) {
+            sched_yield();  // Writer active
+            continue;
+        }
+        report->agent_id = __atomic_load_n(&box->agent_id, __ATOMIC_RELAXED);
+        __atomic_load(&box->knowledge, &report->knowledge, __ATOMIC_RELAXED);
+        report->game_time = __atomic_load_n(&box->game_time, __ATOMIC_RELAXED);
+        report->raised_us = __atomic_load_n(&box->raised_us, __ATOMIC_RELAXED);
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (__atomic_load_n(&box->sequence, __ATOMIC_RELAXED) == before) {
+            report->sequence = before;
+            return 0;
+        }
+    }
+    return -1;
+}
+
+int agent_mailbox_find(const AgentMailbox *row, int num_slots, int32_t agent_id) {
+    for (int i = 0; i < num_slots; i++) {
+        if (__atomic_load_n(&row[i].agent_id, __ATOMIC_ACQUIRE) == agent_id) {
+            return i;
+        }
+    }
+    return -1;
+}
@@ -0,0 +1,351 @@
+#include "checkpoint.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/msg.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+#include "random.h"
+
+static size_t align_up(size_t value) {
+    return (value + CHECKPOINT_ALIGN - 1) & ~(size_t)(CHECKPOINT_ALIGN - 1);
+}
+
+int checkpoint_control_init(CheckpointControl *control, int restored, int64_t saved_wall_time) {
+    pthread_mutexattr_t mutex_attr;
+    pthread_condattr_t cond_attr;
+
+    pthread_mutexattr_init(&mutex_attr);
+    pthread_mutexattr_setpshared(&mutex_attr, PTHREAD_PROCESS_SHARED);
+    pthread_condattr_init(&cond_attr);
+    pthread_condattr_setpshared(&cond_attr, PTHREAD_PROCESS_SHARED);
+    pthread_condattr_setclock(&cond_attr, CLOCK_MONOTONIC);
+
+    int err = pthread_mutex_init(&control->mutex, &mutex_attr);
+    if (err == 0) {
+        err = pthread_cond_init(&control->cond, &cond_attr);
+    }
+    pthread_mutexattr_destroy(&mutex_attr);
+    pthread_condattr_destroy(&cond_attr);
+    if (err != 0) {
+        fprintf(stderr, "Failed to initialize checkpoint control: %s\n", strerror(err));
+        return -1;
+    }
+
+    control->requested = 0;
+    control->registered = 0;
+    control->parked = 0;
+    control->resume_generation = 0;
+    control->restored = restored;
+    control->saved_wall_time = saved_wall_time;
+    return 0;
+}
+
+void checkpoint_register(CheckpointControl *control, int threads) {
+    pthread_mutex_lock(&control->mutex);
+    control->registered += threads;
+    pthread_mutex_unlock(&control->mutex);
+}
+
+void checkpoint_unregister(CheckpointControl *control, int threads) {
+    pthread_mutex_lock(&control->mutex);
+    control->registered -= threads;
+    if (control->registered < 0) {
+        control->registered = 0;
+    }
+    pthread_cond_broadcast(&control->cond);
+    pthread_mutex_unlock(&control->mutex);
+}
+
+void checkpoint_park(CheckpointControl *control, RandomStream *rng) {
+    if (rng != NULL) {
+        random_save_thread(rng);
+    }
+
+    pthread_mutex_lock(&control->mutex);
+    uint32_t generation = control->resume_generation;
+    if (++control->parked == control->registered) {
+        pthread_cond_broadcast(&control->cond);
+    }
+    while (control->resume_generation == generation) {
+        pthread_cond_wait(&control->cond, &control->mutex);
+    }
+    control->parked--;
+    pthread_mutex_unlock(&control->mutex);
+}
+
+void checkpoint_request(CheckpointControl *control) {
+    __atomic_store_n(&control->requested, 1, __ATOMIC_RELEASE);
+}
+
+int checkpoint_quiesce(CheckpointControl *control, int timeout_ms) {
+    struct timespec deadline;
+    clock_gettime(CLOCK_MONOTONIC, &deadline);
+    deadline.tv_sec += timeout_ms / 1000;
+    deadline.tv_nsec += (long)(timeout_ms % 1000) * 1000000L;
+    if (deadline.tv_nsec >= 1000000000L) {
+        deadline.tv_sec++;
+        deadline.tv_nsec -= 1000000000L;
+    }
+
+    pthread_mutex_lock(&control->mutex);
+    __atomic_store_n(&control->requested, 1, __ATOMIC_RELEASE);
+    int result = 0;
+    while (control->parked < control->registered) {
+        if (pthread_cond_timedwait(&control->cond, &control->mutex, &deadline) == ETIMEDOUT) {
+            fprintf(stderr, "Checkpoint: %d of %d threads parked before the timeout\n",
+                    control->parked, control->registered);
+            result = -1;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&control->mutex);
+    return result;
+}
+
+void checkpoint_resume(CheckpointControl *control) {
+    pthread_mutex_lock(&control->mutex);
+    __atomic_store_n(&control->requested, 0, __ATOMIC_RELEASE);
+    control->resume_generation++;
+    pthread_cond_broadcast(&control->cond);
+    pthread_mutex_unlock(&control->mutex);
+}
+
+// Take every message off the queues (each in queue order), tagged with the
+// queue it came from, and put them back
+//
+// Returns 0 on success, -1 if the messages don't fit in memory (what was
+// taken off is put back, the queue it stopped at out of order)
+static int drain_queues(const int *msgq_ids, uint32_t queue_count, CheckpointMessage **out, uint32_t *count) {
+    size_t capacity = 64;
+    CheckpointMessage *messages = malloc(capacity * sizeof(CheckpointMessage));
+    *out = NULL;
+    *count = 0;
+    if (messages == NULL) {
+        perror("Error allocating the checkpoint messages");
+        return -1;
+    }
+
+    for (uint32_t q = 0; q < queue_count; q++) {
+        if (msgq_ids[q] == -1) {
+            continue;
+        }
+        uint32_t first = *count;
+        int full = 0;
+        for (;;) {
+            if (*count == capacity) {
+                CheckpointMessage *grown = realloc(messages, capacity * 2 * sizeof(CheckpointMessage));
+                if (grown == NULL) {
+                    full = 1;
+                    break;
+                }
+                messages = grown;
+                capacity *= 2;
+            }
+            if (msgrcv(msgq_ids[q], &messages[*count].message, MESSAGE_SIZE, 0, IPC_NOWAIT) == -1) {
+                break;
+            }
+            messages[*count].queue = q;
+            messages[*count].reserved = 0;
+            ++*count;
+        }
+        for (uint32_t i = first; i < *count; i++) {
+            send_message(msgq_ids[q], &messages[i].message);
+        }
+        if (full) {
+            fprintf(stderr, "Error allocating the checkpoint messages: %u taken off, queue %u left out of order\n",
+                    *count, q);
+            free(messages);
+            *count = 0;
+            return -1;
+        }
+    }
+    *out = messages;
+    return 0;
+}
+
+static int write_all(int fd, const void *data, size_t size, off_t offset) {
+    const char *p = data;
+    while (size > 0) {
+        ssize_t n = pwrite(fd, p, size, offset);
+        if (n == -1) {
+            if (errno == EINTR) continue;
+            return -1;
+        }
+        p += n;
+        offset += n;
+        size -= (size_t)n;
+    }
+    return 0;
+}
+
+long checkpoint_write(const char *path, const void *shm, size_t shm_size,
+                      const CheckpointSegment *segments, uint32_t segment_count,
+                      size_t game_size, size_t gang_size, size_t member_size,
+                      const int *msgq_ids, uint32_t queue_count) {
+    CheckpointBlock *blocks = calloc(segment_count > 0 ? segment_count : 1, sizeof(CheckpointBlock));
+    if (blocks == NULL) {
+        perror("Error allocating the checkpoint segment table");
+        return -1;
+    }
+    uint32_t message_count = 0;
+    CheckpointMessage *messages = NULL;
+    if (queue_count > 0 && drain_queues(msgq_ids, queue_count, &messages, &message_count) == -1) {
+        free(blocks);
+        return -1;
+    }
+
+    CheckpointHeader header = {0};
+    header.magic = CHECKPOINT_MAGIC;
+    header.version = CHECKPOINT_VERSION;
+    header.game_size = (uint32_t)game_size;
+    header.gang_size = (uint32_t)gang_size;
+    header.member_size = (uint32_t)member_size;
+    header.message_count = message_count;
+    header.segment_count = segment_count;
+    header.shm_offset = align_up(sizeof(header));
+    header.shm_size = shm_size;
+    header.segments_offset = align_up(header.shm_offset + shm_size);
+    uint64_t end = header.segments_offset + (uint64_t)segment_count * sizeof(CheckpointBlock);
+    for (uint32_t i = 0; i < segment_count; i++) {
+        if (segments[i].size == 0) {
+            continue;
+        }
+        blocks[i].offset = align_up(end);
+        blocks[i].size = segments[i].size;
+        end = blocks[i].offset + blocks[i].size;
+    }
+    header.messages_offset = align_up(end);
+    header.file_size = header.messages_offset + (uint64_t)message_count * sizeof(CheckpointMessage);
+    header.wall_time = (int64_t)time(NULL);
+
+    // Written under a temporary name and renamed, so a crash never leaves a
+    // half-written checkpoint in place of the previous one
+    char tmp_path[PATH_MAX];
+    snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", path);
+    int fd = open(tmp_path, O_CREAT | O_TRUNC | O_WRONLY, 0644);
+    if (fd == -1) {
+        perror("Error creating checkpoint file");
+        free(messages);
+        free(blocks);
+        return -1;
+    }
+
+    int failed = ftruncate(fd, (off_t)header.file_size) == -1 ||
+                 write_all(fd, &header, sizeof(header), 0) == -1 ||
+                 write_all(fd, shm, shm_size, (off_t)header.shm_offset) == -1 ||
+                 write_all(fd, blocks, segment_count * sizeof(CheckpointBlock), (off_t)header.segments_offset) == -1 ||
+                 write_all(fd, messages, message_count * sizeof(CheckpointMessage), (off_t)header.messages_offset) == -1;
+    for (uint32_t i = 0; i < segment_count && !failed; i++) {
+        failed = write_all(fd, segments[i].data, blocks[i].size, (off_t)blocks[i].offset) == -1;
+    }
+    free(messages);
+    free(blocks);
+    if (failed) {
+        perror("Error writing checkpoint file");
+        close(fd);
+        unlink(tmp_path);
+        return -1;
+    }
+    close(fd);
+
+    if (rename(tmp_path, path) == -1) {
+        perror("Error renaming checkpoint file");
+        unlink(tmp_path);
+        return -1;
+    }
+    return (long)header.file_size;
+}
+
+int checkpoint_open(CheckpointImage *image, const char *path, size_t game_size, size_t gang_size, size_t member_size) {
+    memset(image, 0, sizeof(*image));
+
+    int fd = open(path, O_RDONLY);
+    if (fd == -1) {
+        perror("Error opening checkpoint file");
+        return -1;
+    }
+    struct stat st;
+    if (fstat(fd, &st) == -1 || (size_t)st.st_size < sizeof(CheckpointHeader)) {
+        fprintf(stderr, "Checkpoint file %s is too small\n", path);
+        close(fd);
+        return -1;
+    }
+    void *map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        perror("Error mapping checkpoint file");
+        return -1;
+    }
+    image->map = map;
+    image->map_size = (size_t)st.st_size;
+
+    const CheckpointHeader *header = map;
+    if (header->magic != CHECKPOINT_MAGIC || header->version != CHECKPOINT_VERSION) {
+        fprintf(stderr, "%s is not a checkpoint file\n", path);
+        checkpoint_close(image);
+        return -1;
+    }
+    if (header->game_size != game_size || header->gang_size != gang_size || header->member_size != member_size) {
+        fprintf(stderr, "Checkpoint %s was written by a build with a different state layout\n", path);
+        checkpoint_close(image);
+        return -1;
+    }
+    if (header->file_size > image->map_size ||
+        header->shm_offset + header->shm_size > header->file_size ||
+        header->segments_offset + (uint64_t)header->segment_count * sizeof(CheckpointBlock) > header->file_size ||
+        header->messages_offset + (uint64_t)header->message_count * sizeof(CheckpointMessage) > header->file_size) {
+        fprintf(stderr, "Checkpoint %s is truncated\n", path);
+        checkpoint_close(image);
+        return -1;
+    }
+
+    image->segments = (const CheckpointBlock *)((const char *)map + header->segments_offset);
+    for (uint32_t i = 0; i < header->segment_count; i++) {
+        if (image->segments[i].offset + image->segments[i].size > header->file_size) {
+            fprintf(stderr, "Checkpoint %s is truncated\n", path);
+            checkpoint_close(image);
+            return -1;
+        }
+    }
+
+    image->header = header;
+    image->shm = (const char *)map + header->shm_offset;
+    image->messages = (const CheckpointMessage *)((const char *)map + header->messages_offset);
+    return 0;
+}
+
+void checkpoint_close(CheckpointImage *image) {
+    if (image->map != NULL) {
+        munmap(image->map, image->map_size);
+    }
+    memset(image, 0, sizeof(*image));
+}
+
+const void *checkpoint_segment(const CheckpointImage *image, uint32_t i, size_t *size) {
+    if (i >= image->header->segment_count || image->segments[i].size == 0) {
+        *size = 0;
+        return NULL;
+    }
+    *size = (size_t)image->segments[i].size;
+    return (const char *)image->map + image->segments[i].offset;
+}
+
+int checkpoint_requeue(const CheckpointImage *image, const int *msgq_ids, uint32_t queue_count) {
+    for (uint32_t i = 0; i < image->header->message_count; i++) {
+        uint32_t q = image->messages[i].queue;
+        if (q >= queue_count || msgq_ids[q] == -1) {
+            continue;
+        }
+        Message message = image->messages[i].message;
+        if (send_message(msgq_ids[q], &message) == -1) {
+            return -1;
+        }
+    }
+    return 0;
+}
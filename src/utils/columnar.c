@@ -0,0 +1,220 @@
+#include "columnar.h"
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t num_columns;
+} FileHeader;
+
+typedef struct {
+    uint32_t magic;
+    uint32_t rows;
+} ChunkHeader;
+
+int columnar_find_column(const ColumnDesc *columns, int num_columns, const char *name) {
+    for (int c = 0; c < num_columns; c++) {
+        if (strncmp(columns[c].name, name, COLUMN_NAME_LEN) == 0) return c;
+    }
+    return -1;
+}
+
+// Read the file header and column table; the caller owns *columns
+static int read_header(FILE *file, ColumnDesc **columns, int *num_columns) {
+    FileHeader header;
+    if (fread(&header, sizeof(header), 1, file) != 1 ||
+        header.magic != COLUMNAR_MAGIC || header.version != COLUMNAR_VERSION ||
+        header.num_columns == 0 || header.num_columns > 4096) {
+        return -1;
+    }
+    *columns = malloc(header.num_columns * sizeof(ColumnDesc));
+    if (*columns == NULL) return -1;
+    if (fread(*columns, sizeof(ColumnDesc), header.num_columns, file) != header.num_columns) {
+        free(*columns);
+        *columns = NULL;
+        return -1;
+    }
+    *num_columns = (int)header.num_columns;
+    return 0;
+}
+
+// Position the writer after the last complete chunk of an existing file
+static int resume_file(ColumnarWriter *writer, FILE *file) {
+    ColumnDesc *existing;
+    int existing_count;
+    if (read_header(file, &existing, &existing_count) == -1) {
+        fprintf(stderr, "Columnar file has a bad header\n");
+        return -1;
+    }
+    int same = existing_count == writer->num_columns &&
+               memcmp(existing, writer->columns, existing_count * sizeof(ColumnDesc)) == 0;
+    free(existing);
+    if (!same) {
+        fprintf(stderr, "Columnar file has different columns\n");
+        return -1;
+    }
+
+    struct stat st;
+    if (fstat(fileno(file), &st) == -1) {
+        perror("fstat columnar file");
+        return -1;
+    }
+
+    long pos = ftell(file);
+    ChunkHeader chunk;
+    while (fread(&chunk, sizeof(chunk), 1, file) == 1 && chunk.magic == COLUMNAR_CHUNK_MAGIC) {
+        long end = pos + (long)sizeof(chunk) + (long)chunk.rows * writer->num_columns * (long)sizeof(ColumnValue);
+        if (end > st.st_size) break;
+        pos = end;
+        fseek(file, pos, SEEK_SET);
+    }
+
+    if (pos < st.st_size) {
+        fprintf(stderr, "Columnar file: dropping %ld bytes of a partial chunk\n", (long)st.st_size - pos);
+        fflush(file);
+        if (ftruncate(fileno(file), pos) == -1) {
+            perror("ftruncate columnar file");
+            return -1;
+        }
+    }
+    fseek(file, pos, SEEK_SET);
+    return 0;
+}
+
+int columnar_open(ColumnarWriter *writer, const char *path, const ColumnDesc *columns, int num_columns, int chunk_rows) {
+    memset(writer, 0, sizeof(*writer));
+    writer->num_columns = num_columns;
+    writer->chunk_rows = chunk_rows > 0 ? chunk_rows : 1;
+    writer->columns = calloc(num_columns, sizeof(ColumnDesc));
+    writer->buffer = malloc((size_t)num_columns * writer->chunk_rows * sizeof(ColumnValue));
+    if (writer->columns == NULL || writer->buffer == NULL) {
+        fprintf(stderr, "Failed to allocate columnar writer\n");
+        columnar_close(writer);
+        return -1;
+    }
+    // Copy names through a zeroed table so the header compares byte for byte
+    for (int c = 0; c < num_columns; c++) {
+        strncpy(writer->columns[c].name, columns[c].name, COLUMN_NAME_LEN - 1);
+        writer->columns[c].type = columns[c].type;
+    }
+
+    FILE *file = fopen(path, "r+b");
+    if (file) {
+        writer->file = file;
+        if (resume_file(writer, file) == -1) {
+            columnar_close(writer);
+            return -1;
+        }
+        return 0;
+    }
+
+    file = fopen(path, "w+b");
+    if (!file) {
+        perror("Error creating columnar file");
+        columnar_close(writer);
+        return -1;
+    }
+    writer->file = file;
+
+    FileHeader header = {COLUMNAR_MAGIC, COLUMNAR_VERSION, (uint32_t)num_columns};
+    if (fwrite(&header, sizeof(header), 1, file) != 1 ||
+        fwrite(writer->columns, sizeof(ColumnDesc), num_columns, file) != (size_t)num_columns) {
+        perror("Error writing columnar header");
+        columnar_close(writer);
+        return -1;
+    }
+    return fflush(file) == 0 ? 0 : -1;
+}
+
+int columnar_append(ColumnarWriter *writer, const ColumnValue *row) {
+    for (int c = 0; c < writer->num_columns; c++) {
+        writer->buffer[(size_t)c * writer->chunk_rows + writer->rows] = row[c];
+    }
+    writer->rows++;
+    if (writer->rows == writer->chunk_rows) {
+        return columnar_flush(writer);
+    }
+    return 0;
+}
+
+int columnar_flush(ColumnarWriter *writer) {
+    if (writer->file == NULL) return -1;
+    if (writer->rows > 0) {
+        ChunkHeader chunk = {COLUMNAR_CHUNK_MAGIC, (uint32_t)writer->rows};
+        if (fwrite(&chunk, sizeof(chunk), 1, writer->file) != 1) {
+            perror("Error writing columnar chunk");
+            return -1;
+        }
+        for (int c = 0; c < writer->num_columns; c++) {
+            const ColumnValue *column = writer->buffer + (size_t)c * writer->chunk_rows;
+            if (fwrite(column, sizeof(ColumnValue), writer->rows, writer->file) != (size_t)writer->rows) {
+                perror("Error writing columnar chunk");
+                return -1;
+            }
+        }
+        writer->rows = 0;
+    }
+    return fflush(writer->file) == 0 ? 0 : -1;
+}
+
+int columnar_close(ColumnarWriter *writer) {
+    int result = 0;
+    if (writer->file) {
+        result = columnar_flush(writer);
+        fclose(writer->file);
+    }
+    free(writer->columns);
+    free(writer->buffer);
+    memset(writer, 0, sizeof(*writer));
+    return result;
+}
+
+int columnar_reader_open(ColumnarReader *reader, const char *path) {
+    memset(reader, 0, sizeof(*reader));
+    reader->file = fopen(path, "rb");
+    if (!reader->file) {
+        return -1;
+    }
+    if (read_header(reader->file, &reader->columns, &reader->num_columns) == -1) {
+        fprintf(stderr, "Columnar file %s has a bad header\n", path);
+        columnar_reader_close(reader);
+        return -1;
+    }
+    return 0;
+}
+
+int columnar_reader_next(ColumnarReader *reader) {
+    ChunkHeader chunk;
+    reader->rows = 0;
+    if (fread(&chunk, sizeof(chunk), 1, reader->file) != 1 || chunk.magic != COLUMNAR_CHUNK_MAGIC) {
+        return 0;
+    }
+
+    if ((int)chunk.rows > reader->capacity) {
+        ColumnValue *data = realloc(reader->data, (size_t)reader->num_columns * chunk.rows * sizeof(ColumnValue));
+        if (data == NULL) {
+            fprintf(stderr, "Failed to allocate columnar chunk\n");
+            return 0;
+        }
+        reader->data = data;
+        reader->capacity = (int)chunk.rows;
+    }
+
+    for (int c = 0; c < reader->num_columns; c++) {
+        if (fread(columnar_column(reader, c), sizeof(ColumnValue), chunk.rows, reader->file) != chunk.rows) {
+            return 0;  // partial chunk at the end of the file
+        }
+    }
+    reader->rows = (int)chunk.rows;
+    return reader->rows;
+}
+
+void columnar_reader_close(ColumnarReader *reader) {
+    if (reader->file) fclose(reader->file);
+    free(reader->columns);
+    free(reader->data);
+    memset(reader, 0, sizeof(*reader));
+}
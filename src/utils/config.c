@@ -2,6 +2,7 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
+#include <stddef.h>
 
 // Function to load configuration settings from a specified file
 int load_config(const char *filename, Config *config) {
@@ -37,6 +38,19 @@ int load_config(const char *filename, Config *config) {
     config->min_prison_period = -1;
     config->max_prison_period = -1;
     config->knowledge_threshold = -1;
+    config->random_seed = 0;  // Optional, resolved from the clock when unset
+    config->num_targets = 0;  // Filled in from the target catalog
+    config->num_attributes = 0;
+    config->viewer_snapshot_hz = 10;  // Optional
+    config->shm_huge_pages = SHM_PAGES_DEFAULT;  // Optional
+    config->shm_prefault = 1;  // Optional
+    config->shm_lock = 0;  // Optional
+    config->gang_size_limit = 0;  // Optional
+    config->active_gangs = 0;  // Optional
+    config->recruits_per_success = 0;  // Optional
+    config->police_departments = 0;  // Optional
+    config->active_departments = 0;  // Optional
+    config->gang_queue_bytes = 0;  // Optional
 
     // Buffer to hold each line from the configuration file
     char line[256];
@@ -49,6 +63,12 @@ int load_config(const char *filename, Config *config) {
         float value;
         if (sscanf(line, "%40[^=]=%f", key, &value) == 2) {
 
+            // Seeds need all 32 bits, so don't route them through a float
+            if (strcmp(key, "random_seed") == 0) {
+                config->random_seed = (unsigned int)strtoul(strchr(line, '=') + 1, NULL, 10);
+                continue;
+            }
+
             // Set corresponding config fields based on the key
             if (strcmp(key, "max_thwarted_plans") == 0) config->max_thwarted_plans = (int)value;
             else if (strcmp(key, "max_successful_plans") == 0) config->max_successful_plans = (int)value;
@@ -77,6 +97,16 @@ int load_config(const char *filename, Config *config) {
             else if (strcmp(key, "max_prison_period") == 0) config->max_prison_period = (int)value;
             else if (strcmp(key, "knowledge_threshold") == 0) config->knowledge_threshold = value;
             else if (strcmp(key, "timeout_period") == 0) config->timeout_period = (int)value;
+            else if (strcmp(key, "viewer_snapshot_hz") == 0) config->viewer_snapshot_hz = (int)value;
+            else if (strcmp(key, "shm_huge_pages") == 0) config->shm_huge_pages = (int)value;
+            else if (strcmp(key, "shm_prefault") == 0) config->shm_prefault = (int)value;
+            else if (strcmp(key, "shm_lock") == 0) config->shm_lock = (int)value;
+            else if (strcmp(key, "gang_size_limit") == 0) config->gang_size_limit = (int)value;
+            else if (strcmp(key, "active_gangs") == 0) config->active_gangs = (int)value;
+            else if (strcmp(key, "recruits_per_success") == 0) config->recruits_per_success = (int)value;
+            else if (strcmp(key, "police_departments") == 0) config->police_departments = (int)value;
+            else if (strcmp(key, "active_departments") == 0) config->active_departments = (int)value;
+            else if (strcmp(key, "gang_queue_bytes") == 0) config->gang_queue_bytes = (int)value;
             else {
                 fprintf(stderr, "Unknown key: %s\n", key);
                 fclose(file);
@@ -136,6 +166,17 @@ void print_config(Config *config) {
     printf("min_prison_period: %d\n", config->min_prison_period);
     printf("max_prison_period: %d\n", config->max_prison_period);
     printf("knowledge_threshold: %f\n", config->knowledge_threshold);
+    printf("random_seed: %u\n", config->random_seed);
+    printf("viewer_snapshot_hz: %d\n", config->viewer_snapshot_hz);
+    printf("shm_huge_pages: %d\n", config->shm_huge_pages);
+    printf("shm_prefault: %d\n", config->shm_prefault);
+    printf("shm_lock: %d\n", config->shm_lock);
+    printf("gang_size_limit: %d\n", config->gang_size_limit);
+    printf("active_gangs: %d\n", config->active_gangs);
+    printf("recruits_per_success: %d\n", config->recruits_per_success);
+    printf("police_departments: %d\n", config->police_departments);
+    printf("active_departments: %d\n", config->active_departments);
+    printf("gang_queue_bytes: %d\n", config->gang_queue_bytes);
     fflush(stdout);
 }
 
@@ -151,11 +192,21 @@ int check_parameter_correctness(const Config *config) {
         config->max_askers < 0 ||  // Check max_askers
         config->max_gang_size < 0 || config->difficulty_level < 0 || config->max_difficulty < 0
         || config->timeout_period < 0 || config->min_prison_period < 0 ||
-        config->max_prison_period < 0 || config->knowledge_threshold < 0) {
+        config->max_prison_period < 0 || config->knowledge_threshold < 0 ||
+        config->viewer_snapshot_hz < 0 || config->shm_huge_pages < 0 ||
+        config->shm_prefault < 0 || config->shm_lock < 0 || config->gang_size_limit < 0 ||
+        config->active_gangs < 0 || config->recruits_per_success < 0 ||
+        config->police_departments < 0 || config->active_departments < 0 ||
+        config->gang_queue_bytes < 0) {
         fprintf(stderr, "Integer values must be greater than or equal to 0\n");
         return -1;
     }
 
+    if (config->shm_huge_pages > SHM_PAGES_HUGETLB) {
+        fprintf(stderr, "shm_huge_pages must be 0 (off), 1 (transparent) or 2 (hugetlb)\n");
+        return -1;
+    }
+
     // Check that float parameters are non-negative
     if (config->suspicion_threshold < 0 || config->agent_success_rate < 0 ||
         config->death_probability < 0) {
@@ -174,6 +225,22 @@ int check_parameter_correctness(const Config *config) {
         return -1;
     }
 
+    if (config->gang_size_limit != 0 && config->gang_size_limit < config->max_gang_size) {
+        fprintf(stderr, "gang_size_limit cannot be smaller than max_gang_size\n");
+        return -1;
+    }
+
+    if (config->active_gangs > config->max_gangs) {
+        fprintf(stderr, "active_gangs cannot be greater than max_gangs\n");
+        return -1;
+    }
+
+    int departments = config->police_departments > 0 ? config->police_departments : 1;
+    if (config->active_departments > departments) {
+        fprintf(stderr, "active_departments cannot be greater than police_departments\n");
+        return -1;
+    }
+
     if (config->min_time_prepare > config->max_time_prepare) {
         fprintf(stderr, "min_time_prepare cannot be greater than max_time_prepare\n");
         return -1;
@@ -188,7 +255,7 @@ int check_parameter_correctness(const Config *config) {
 }
 
 void serialize_config(Config *config, char *buffer) {
-    sprintf(buffer, "%d %d %d %d %d %d %d %d %f %f %f %d %d %d %d %d %d %f %d %d %d %d %d %d %d",
+    sprintf(buffer, "%d %d %d %d %d %d %d %d %f %f %f %d %d %d %d %d %d %f %d %d %d %d %d %d %d %u %d %d",
             config->max_thwarted_plans,
             config->max_successful_plans,
             config->max_executed_agents,
@@ -213,12 +280,15 @@ void serialize_config(Config *config, char *buffer) {
             config->max_askers,
             config->timeout_period,
             config->min_prison_period,
-            config->max_prison_period
+            config->max_prison_period,
+            config->random_seed,
+            config->num_targets,
+            config->num_attributes
     );
 }
 
 void deserialize_config(const char *buffer, Config *config) {
-    sscanf(buffer, "%d %d %d %d %d %d %d %d %f %f %f %d %d %d %d %d %d %f %d %d %d %d %d %d %d",
+    sscanf(buffer, "%d %d %d %d %d %d %d %d %f %f %f %d %d %d %d %d %d %f %d %d %d %d %d %d %d %u %d %d",
             &config->max_thwarted_plans,
             &config->max_successful_plans,
             &config->max_executed_agents,
@@ -243,7 +313,115 @@ void deserialize_config(const char *buffer, Config *config) {
             &config->max_askers,
             &config->timeout_period,
             &config->min_prison_period,
-            &config->max_prison_period
+            &config->max_prison_period,
+            &config->random_seed,
+            &config->num_targets,
+            &config->num_attributes
             );
 }
 
+
+uint32_t config_checksum(const Config *config) {
+    const unsigned char *bytes = (const unsigned char *)config;
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < sizeof(Config); i++) {
+        hash ^= bytes[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+void config_block_publish(ConfigBlock *block, const Config *config) {
+    uint32_t generation = __atomic_load_n(&block->generation, __ATOMIC_RELAXED);
+
+    // Odd generation tells readers a write is in progress
+    __atomic_store_n(&block->generation, generation + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+
+    block->magic = CONFIG_BLOCK_MAGIC;
+    block->version = CONFIG_BLOCK_VERSION;
+    block->size = sizeof(Config);
+    memcpy(&block->config, config, sizeof(Config));
+    block->checksum = config_checksum(&block->config);
+
+    __atomic_store_n(&block->generation, generation + 2, __ATOMIC_RELEASE);
+}
+
+uint32_t config_block_generation(const ConfigBlock *block) {
+    return __atomic_load_n(&block->generation, __ATOMIC_ACQUIRE);
+}
+
+int config_block_read(const ConfigBlock *block, Config *config, uint32_t *generation) {
+    uint32_t before, after;
+    ConfigBlock header;
+    do {
+        before = __atomic_load_n(&block->generation, __ATOMIC_ACQUIRE);
+        if (before & 1u) {
+            continue;  // writer active
+        }
+        memcpy(&header, block, offsetof(ConfigBlock, config));
+        memcpy(config, &block->config, sizeof(Config));
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        after = __atomic_load_n(&block->generation, __ATOMIC_RELAXED);
+    } while ((before & 1u) || before != after);
+
+    if (before == 0 || header.magic != CONFIG_BLOCK_MAGIC) {
+        fprintf(stderr, "Config block not published\n");
+        return -1;
+    }
+    if (header.version != CONFIG_BLOCK_VERSION || header.size != sizeof(Config)) {
+        fprintf(stderr, "Config block version mismatch (version %u, size %u)\n",
+                header.version, header.size);
+        return -1;
+    }
+    if (header.checksum != config_checksum(config)) {
+        fprintf(stderr, "Config block checksum mismatch\n");
+        return -1;
+    }
+
+    if (generation) {
+        *generation = before;
+    }
+    return 0;
+}
+
+void config_apply_reloadable(Config *dst, const Config *src) {
+    dst->max_thwarted_plans = src->max_thwarted_plans;
+    dst->max_successful_plans = src->max_successful_plans;
+    dst->max_executed_agents = src->max_executed_agents;
+    dst->suspicion_threshold = src->suspicion_threshold;
+    dst->knowledge_threshold = src->knowledge_threshold;
+    dst->agent_success_rate = src->agent_success_rate;
+    dst->prison_period = src->prison_period;
+    dst->min_time_prepare = src->min_time_prepare;
+    dst->max_time_prepare = src->max_time_prepare;
+    dst->min_level_prepare = src->min_level_prepare;
+    dst->max_level_prepare = src->max_level_prepare;
+    dst->death_probability = src->death_probability;
+    dst->difficulty_level = src->difficulty_level;
+    dst->max_difficulty = src->max_difficulty;
+    dst->timeout_period = src->timeout_period;
+    dst->max_askers = src->max_askers;
+    dst->min_prison_period = src->min_prison_period;
+    dst->max_prison_period = src->max_prison_period;
+    dst->viewer_snapshot_hz = src->viewer_snapshot_hz;
+    dst->active_gangs = src->active_gangs;
+    dst->recruits_per_success = src->recruits_per_success;
+    dst->active_departments = src->active_departments;
+}
+
+int config_refresh(const ConfigBlock *block, Config *config, uint32_t *generation) {
+    // The common case is a single load
+    if (config_block_generation(block) == *generation) {
+        return 0;
+    }
+
+    Config published;
+    uint32_t published_generation;
+    if (config_block_read(block, &published, &published_generation) == -1) {
+        return 0;
+    }
+    config_apply_reloadable(config, &published);
+    *generation = published_generation;
+    return 1;
+}
@@ -0,0 +1,193 @@
+#include "gang_directory.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "instance.h"
+#include "notify.h"
+
+size_t gang_directory_size(int num_slots) {
+    return sizeof(GangDirectory) + (size_t)num_slots * sizeof(GangSlot);
+}
+
+void gang_directory_init(GangDirectory *directory, int num_slots, int limit) {
+    memset(directory, 0, gang_directory_size(num_slots));
+    directory->num_slots = (uint32_t)num_slots;
+    for (int s = 0; s < num_slots; s++) {
+        directory->slots[s].limit = (uint32_t)limit;
+    }
+}
+
+const char *gang_segment_name(int slot, uint32_t incarnation, char *buf, size_t len) {
+    char base[IPC_NAME_LEN];
+    snprintf(base, sizeof(base), "%s_%d_%u", GANG_SEGMENT_PREFIX, slot, incarnation);
+    return instance_ipc_name(base, buf, len);
+}
+
+static void bump_generation(GangDirectory *directory) {
+    __atomic_fetch_add(&directory->generation, 1, __ATOMIC_RELEASE);
+    notify_game_changed();
+}
+
+// Size the object of a slot's incarnation for capacity members
+static int resize_segment(int slot, uint32_t incarnation, int capacity, int flags) {
+    char name[IPC_NAME_LEN];
+    gang_segment_name(slot, incarnation, name, sizeof(name));
+    int fd = shm_open(name, O_RDWR | flags, 0666);
+    if (fd == -1) {
+        fprintf(stderr, "Gang slot %d: shm_open %s failed: %s\n", slot, name, strerror(errno));
+        return -1;
+    }
+    if (ftruncate(fd, (off_t)capacity * (off_t)sizeof(Member)) == -1) {
+        fprintf(stderr, "Gang slot %d: resizing %s to %d members failed: %s\n",
+                slot, name, capacity, strerror(errno));
+        close(fd);
+        return -1;
+    }
+    close(fd);
+    return 0;
+}
+
+int gang_segment_create(GangDirectory *directory, int slot, int capacity, uint32_t incarnation) {
+    if (slot < 0 || (uint32_t)slot >= directory->num_slots) {
+        fprintf(stderr, "Gang slot %d is outside the directory (%u slots)\n", slot, directory->num_slots);
+        return -1;
+    }
+    GangSlot *entry = &directory->slots[slot];
+    if (entry->state == GANG_SLOT_ACTIVE) {
+        fprintf(stderr, "Gang slot %d is already active\n", slot);
+        return -1;
+    }
+    if (capacity < 0 || (uint32_t)capacity > entry->limit) {
+        fprintf(stderr, "Gang slot %d can't hold %d members (limit %u)\n", slot, capacity, entry->limit);
+        return -1;
+    }
+    if (incarnation == 0) {
+        incarnation = entry->incarnation + 1;
+    }
+    // A leftover object of a crashed run with the same name is reused, emptied
+    if (resize_segment(slot, incarnation, 0, O_CREAT | O_TRUNC) == -1 ||
+        resize_segment(slot, incarnation, capacity, 0) == -1) {
+        return -1;
+    }
+
+    entry->incarnation = incarnation;
+    __atomic_store_n(&entry->capacity, (uint32_t)capacity, __ATOMIC_RELEASE);
+    __atomic_store_n(&entry->state, GANG_SLOT_ACTIVE, __ATOMIC_RELEASE);
+    __atomic_fetch_add(&directory->num_active, 1, __ATOMIC_RELAXED);
+    bump_generation(directory);
+    return 0;
+}
+
+int gang_segment_grow(GangDirectory *directory, int slot, int capacity) {
+    if (!gang_slot_active(directory, slot)) {
+        return -1;
+    }
+    GangSlot *entry = &directory->slots[slot];
+    uint32_t current = __atomic_load_n(&entry->capacity, __ATOMIC_ACQUIRE);
+    if (capacity > (int)entry->limit) {
+        capacity = (int)entry->limit;
+    }
+    if (capacity <= (int)current) {
+        return (int)current;
+    }
+    if (resize_segment(slot, entry->incarnation, capacity, 0) == -1) {
+        return -1;
+    }
+    __atomic_store_n(&entry->capacity, (uint32_t)capacity, __ATOMIC_RELEASE);
+    bump_generation(directory);
+    return capacity;
+}
+
+void gang_segment_retire(GangDirectory *directory, int slot) {
+    if (!gang_slot_active(directory, slot)) {
+        return;
+    }
+    GangSlot *entry = &directory->slots[slot];
+    __atomic_store_n(&entry->state, GANG_SLOT_RETIRED, __ATOMIC_RELEASE);
+    __atomic_fetch_sub(&directory->num_active, 1, __ATOMIC_RELAXED);
+    bump_generation(directory);
+
+    char name[IPC_NAME_LEN];
+    shm_unlink(gang_segment_name(slot, entry->incarnation, name, sizeof(name)));
+}
+
+Member *gang_segment_map(const GangDirectory *directory, int slot, uint32_t *incarnation, uint32_t *capacity) {
+    if (!gang_slot_active(directory, slot)) {
+        return NULL;
+    }
+    const GangSlot *entry = &directory->slots[slot];
+    uint32_t mapped = __atomic_load_n(&entry->incarnation, __ATOMIC_ACQUIRE);
+    char name[IPC_NAME_LEN];
+    int fd = shm_open(gang_segment_name(slot, mapped, name, sizeof(name)), O_RDWR, 0666);
+    if (fd == -1) {
+        return NULL;  // Retired since the state was read
+    }
+
+    // The object's own size is its capacity for this incarnation
+    struct stat st;
+    Member *members = MAP_FAILED;
+    if (fstat(fd, &st) == 0) {
+        members = mmap(NULL, (size_t)entry->limit * sizeof(Member), PROT_READ | PROT_WRITE,
+                       MAP_SHARED | MAP_NORESERVE, fd, 0);
+    }
+    close(fd);
+    if (members == MAP_FAILED) {
+        fprintf(stderr, "Gang slot %d: mapping %s failed: %s\n", slot, name, strerror(errno));
+        return NULL;
+    }
+    *incarnation = mapped;
+    *capacity = (uint32_t)((size_t)st.st_size / sizeof(Member));
+    return members;
+}
+
+void gang_segment_unmap(const GangDirectory *directory, int slot, Member *members) {
+    if (members != NULL) {
+        munmap(members, (size_t)directory->slots[slot].limit * sizeof(Member));
+    }
+}
+
+int gang_mappings_refresh(const GangDirectory *directory, GangMapping *mappings, uint32_t *generation) {
+    uint32_t current = gang_directory_generation(directory);
+    if (current == *generation) {
+        return 0;
+    }
+    // Changes made while the slots are scanned show up on the next call
+    *generation = current;
+
+    for (int s = 0; s < (int)directory->num_slots; s++) {
+        const GangSlot *entry = &directory->slots[s];
+        GangMapping *mapping = &mappings[s];
+        int active = gang_slot_active(directory, s);
+        uint32_t incarnation = __atomic_load_n(&entry->incarnation, __ATOMIC_ACQUIRE);
+
+        if (mapping->members != NULL && active && mapping->incarnation == incarnation) {
+            // Same segment: only its capacity can have moved. It counts if
+            // the slot still holds the same incarnation after it was read.
+            uint32_t capacity = __atomic_load_n(&entry->capacity, __ATOMIC_ACQUIRE);
+            if (__atomic_load_n(&entry->incarnation, __ATOMIC_ACQUIRE) == incarnation &&
+                capacity > mapping->capacity) {
+                mapping->capacity = capacity;
+            }
+            continue;
+        }
+        if (mapping->members != NULL) {
+            gang_segment_unmap(directory, s, mapping->members);
+            memset(mapping, 0, sizeof(*mapping));
+        }
+        if (active) {
+            mapping->members = gang_segment_map(directory, s, &mapping->incarnation, &mapping->capacity);
+        }
+    }
+    return 1;
+}
+
+void gang_mappings_release(const GangDirectory *directory, GangMapping *mappings) {
+    for (int s = 0; s < (int)directory->num_slots; s++) {
+        gang_segment_unmap(directory, s, mappings[s].members);
+        memset(&mappings[s], 0, sizeof(mappings[s]));
+    }
+}
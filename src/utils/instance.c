@@ -0,0 +1,32 @@
+#include "instance.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+int instance_id(void) {
+    static int cached = -1;
+    if (cached < 0) {
+        const char *value = getenv(INSTANCE_ENV);
+        int id = value ? atoi(value) : 0;
+        if (id < 0 || id > MAX_INSTANCE) {
+            fprintf(stderr, "Ignoring out of range %s=%s\n", INSTANCE_ENV, value);
+            id = 0;
+        }
+        cached = id;
+    }
+    return cached;
+}
+
+const char *instance_ipc_name(const char *base, char *buf, size_t len) {
+    int id = instance_id();
+    if (id == 0) {
+        snprintf(buf, len, "%s", base);
+    } else {
+        snprintf(buf, len, "%s_%d", base, id);
+    }
+    return buf;
+}
+
+key_t instance_ipc_key(key_t base) {
+    // Instances step through the upper half of the key space
+    return (key_t)((unsigned)base + ((unsigned)instance_id() << 16));
+}
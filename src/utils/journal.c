@@ -0,0 +1,250 @@
+#include "journal.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+static int journal_fd = -1;
+static uint64_t *journal_seq = NULL;
+static const int *journal_clock = NULL;
+static uint32_t journal_arrivals = 0;
+
+int journal_create(const char *path, uint64_t *seq, const int *clock) {
+    int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC | O_APPEND | O_CLOEXEC, 0644);
+    if (fd == -1) {
+        perror("Error creating journal");
+        return -1;
+    }
+
+    JournalFileHeader header = {JOURNAL_MAGIC, JOURNAL_VERSION, sizeof(Config), sizeof(Gang),
+                                sizeof(Member), sizeof(Message)};
+    if (write(fd, &header, sizeof(header)) != (ssize_t)sizeof(header)) {
+        perror("Error writing journal header");
+        close(fd);
+        return -1;
+    }
+
+    // Children find the file through the environment they inherit
+    if (setenv(JOURNAL_ENV, path, 1) == -1) {
+        perror("setenv " JOURNAL_ENV);
+        close(fd);
+        return -1;
+    }
+
+    journal_fd = fd;
+    journal_seq = seq;
+    journal_clock = clock;
+    return 0;
+}
+
+int journal_attach(uint64_t *seq, const int *clock) {
+    const char *path = getenv(JOURNAL_ENV);
+    if (path == NULL || path[0] == '\0') {
+        return 0;
+    }
+    int fd = open(path, O_WRONLY | O_APPEND | O_CLOEXEC);
+    if (fd == -1) {
+        perror("Error opening journal");
+        return -1;
+    }
+    journal_fd = fd;
+    journal_seq = seq;
+    journal_clock = clock;
+    return 0;
+}
+
+int journal_enabled(void) {
+    return journal_fd != -1;
+}
+
+void journal_close(void) {
+    if (journal_fd != -1) {
+        close(journal_fd);
+        journal_fd = -1;
+    }
+}
+
+int journal_append(int type, int source, const void *body, size_t body_size,
+                   const void *extra, size_t extra_size) {
+    if (journal_fd == -1) {
+        return 0;
+    }
+
+    static const char padding[8] = {0};
+    size_t payload = body_size + extra_size;
+    size_t pad = (8 - payload % 8) % 8;
+
+    JournalRecord record = {0};
+    record.size = (uint32_t)(sizeof(record) + payload + pad);
+    record.type = (uint16_t)type;
+    record.source = (int16_t)source;
+    record.seq = __atomic_fetch_add(journal_seq, 1, __ATOMIC_SEQ_CST);
+    record.tick = __atomic_load_n(journal_clock, __ATOMIC_RELAXED);
+
+    struct iovec iov[4] = {
+        {&record, sizeof(record)},
+        {(void *)body, body_size},
+        {(void *)extra, extra_size},
+        {(void *)padding, pad}
+    };
+    ssize_t written = writev(journal_fd, iov, 4);
+    if (written != (ssize_t)record.size) {
+        perror("Error writing journal record");
+        return -1;
+    }
+    return 0;
+}
+
+void journal_message(int source, const Message *message) {
+    if (journal_fd == -1) {
+        return;
+    }
+    JournalMessage body = {0};
+    body.arrival = __atomic_fetch_add(&journal_arrivals, 1, __ATOMIC_RELAXED);
+    body.message = *message;
+    journal_append(JOURNAL_MESSAGE, source, &body, sizeof(body), NULL, 0);
+}
+
+uint64_t journal_hash(uint64_t hash, const void *data, size_t size) {
+    const unsigned char *bytes = data;
+    for (size_t i = 0; i < size; i++) {
+        hash ^= bytes[i];
+        hash *= 0x100000001b3ull;
+    }
+    return hash;
+}
+
+#define HASH_FIELD(hash, field) journal_hash(hash, &(field), sizeof(field))
+
+uint64_t journal_hash_gang(const Gang *gang, const Member *members) {
+    uint64_t hash = JOURNAL_HASH_INIT;
+    hash = HASH_FIELD(hash, gang->plan_success);
+    hash = HASH_FIELD(hash, gang->num_successful_plans);
+    hash = HASH_FIELD(hash, gang->num_thwarted_plans);
+    hash = HASH_FIELD(hash, gang->num_alive_members);
+    hash = HASH_FIELD(hash, gang->num_agents);
+    hash = HASH_FIELD(hash, gang->notoriety);
+    hash = HASH_FIELD(hash, gang->current_success_rate);
+    for (int i = 0; i < gang->max_member_count; i++) {
+        const Member *member = &members[i];
+        hash = HASH_FIELD(hash, member->is_alive);
+        // Dead members' threads keep running, so only the living are stable
+        if (member->is_alive) {
+            hash = HASH_FIELD(hash, member->agent_id);
+            hash = HASH_FIELD(hash, member->suspicion);
+            hash = HASH_FIELD(hash, member->knowledge);
+        }
+    }
+    return hash;
+}
+
+uint64_t journal_hash_counters(int tick, int successful, int thwarted) {
+    uint64_t hash = JOURNAL_HASH_INIT;
+    hash = HASH_FIELD(hash, tick);
+    hash = HASH_FIELD(hash, successful);
+    hash = HASH_FIELD(hash, thwarted);
+    return hash;
+}
+
+static int compare_seq(const void *a, const void *b) {
+    uint64_t x = (*(JournalRecord *const *)a)->seq;
+    uint64_t y = (*(JournalRecord *const *)b)->seq;
+    return (x > y) - (x < y);
+}
+
+int journal_read(JournalReader *reader, const char *path) {
+    memset(reader, 0, sizeof(*reader));
+
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd == -1) {
+        perror("Error opening journal");
+        return -1;
+    }
+    struct stat st;
+    if (fstat(fd, &st) == -1) {
+        perror("fstat journal");
+        close(fd);
+        return -1;
+    }
+
+    // Records are 8-byte multiples after an 8-byte aligned header, so every
+    // body in the buffer is aligned for the structs above
+    reader->size = (size_t)st.st_size;
+    reader->data = aligned_alloc(64, (reader->size + 63) & ~(size_t)63);
+    if (reader->data == NULL && reader->size > 0) {
+        fprintf(stderr, "Failed to allocate %zu bytes for the journal\n", reader->size);
+        close(fd);
+        return -1;
+    }
+    size_t done = 0;
+    while (done < reader->size) {
+        ssize_t n = read(fd, (char *)reader->data + done, reader->size - done);
+        if (n <= 0) {
+            if (n == -1 && errno == EINTR) continue;
+            perror("Error reading journal");
+            close(fd);
+            journal_reader_close(reader);
+            return -1;
+        }
+        done += (size_t)n;
+    }
+    close(fd);
+
+    reader->header = reader->data;
+    const JournalFileHeader *header = reader->header;
+    if (reader->size < sizeof(*header) || header->magic != JOURNAL_MAGIC ||
+        header->version != JOURNAL_VERSION) {
+        fprintf(stderr, "%s is not a journal\n", path);
+        journal_reader_close(reader);
+        return -1;
+    }
+    if (header->config_size != sizeof(Config) || header->gang_size != sizeof(Gang) ||
+        header->member_size != sizeof(Member) || header->message_size != sizeof(Message)) {
+        fprintf(stderr, "Journal %s was written by a build with a different layout\n", path);
+        journal_reader_close(reader);
+        return -1;
+    }
+
+    // Count, then index
+    size_t offset = sizeof(*header);
+    size_t capacity = 0;
+    for (int pass = 0; pass < 2; pass++) {
+        offset = sizeof(*header);
+        reader->count = 0;
+        while (offset + sizeof(JournalRecord) <= reader->size) {
+            JournalRecord *record = (JournalRecord *)((char *)reader->data + offset);
+            if (record->size < sizeof(JournalRecord) || record->size % 8 != 0 ||
+                offset + record->size > reader->size) {
+                break;
+            }
+            if (pass == 1) {
+                reader->records[reader->count] = record;
+            }
+            reader->count++;
+            offset += record->size;
+        }
+        if (pass == 0) {
+            capacity = reader->count;
+            reader->records = malloc((capacity > 0 ? capacity : 1) * sizeof(JournalRecord *));
+            if (reader->records == NULL) {
+                fprintf(stderr, "Failed to allocate the journal index\n");
+                journal_reader_close(reader);
+                return -1;
+            }
+        }
+    }
+    reader->dropped_bytes = reader->size - offset;
+
+    qsort(reader->records, reader->count, sizeof(JournalRecord *), compare_seq);
+    return 0;
+}
+
+void journal_reader_close(JournalReader *reader) {
+    free(reader->records);
+    free(reader->data);
+    memset(reader, 0, sizeof(*reader));
+}
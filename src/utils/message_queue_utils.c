@@ -8,6 +8,7 @@
 #include <sys/msg.h>
 #include <stdio.h>
 #include <errno.h>
+#include <string.h>
 
 int create_message_queue(int key) {
     int msgid = msgget(key, IPC_CREAT | 0666);
@@ -18,6 +19,35 @@ int create_message_queue(int key) {
     return msgid;
 }
 
+int create_private_queue(int max_bytes) {
+    int msgid = msgget(IPC_PRIVATE, IPC_CREAT | 0600);
+    if (msgid == -1) {
+        perror("msgget");
+        return -1;
+    }
+    if (max_bytes > 0) {
+        struct msqid_ds ds;
+        if (msgctl(msgid, IPC_STAT, &ds) == 0) {
+            ds.msg_qbytes = (msglen_t)max_bytes;
+            if (msgctl(msgid, IPC_SET, &ds) == -1) {
+                fprintf(stderr, "Queue %d keeps the default size, %d bytes not allowed: %s\n",
+                        msgid, max_bytes, strerror(errno));
+            }
+        }
+    }
+    return msgid;
+}
+
+int message_queue_depth(int msgid, uint32_t *messages, uint32_t *bytes) {
+    struct msqid_ds ds;
+    if (msgctl(msgid, IPC_STAT, &ds) == -1) {
+        return -1;
+    }
+    *messages = (uint32_t)ds.msg_qnum;
+    *bytes = (uint32_t)ds.__msg_cbytes;
+    return 0;
+}
+
 int send_message(int msgid, Message *message) {
     if (msgsnd(msgid, message, MESSAGE_SIZE, 0) == -1) {
         perror("msgsnd");
@@ -36,7 +66,9 @@ int receive_message(int msgid, Message *message, long mtype) {
 
 int receive_message_nonblocking(int msgid, Message *message, long mtype) {
     if (msgrcv(msgid, message, MESSAGE_SIZE, mtype, IPC_NOWAIT) == -1) {
-        if (errno != ENOMSG) {  // ENOMSG means no message available
+        // ENOMSG means no message available; a retired gang's queue is
+        // removed (EIDRM, EINVAL) before its officer is stopped
+        if (errno != ENOMSG && errno != EIDRM && errno != EINVAL) {
             perror("msgrcv_nonblocking");
         }
         return -1;
@@ -52,15 +84,3 @@ int delete_message_queue(int msgid) {
     return 0;
 }
 
-long get_agent_msgtype(const int MAX_AGENTS, const int8_t gang_id, const int8_t agent_id) {
-    return (MAX_AGENTS + 1) * gang_id + agent_id + 1;
-}
-
-long get_gang_msgtype(const int MAX_AGENTS, const int8_t gang_id) {
-    return MAX_AGENTS * gang_id + MAX_AGENTS + 1;
-}
-
-long get_police_msgtype(const int MAX_AGENTS, const int NUM_GANGS, const int8_t police_id) {
-    return (MAX_AGENTS + 1) * NUM_GANGS + police_id + 1;
-}
-
@@ -0,0 +1,149 @@
+#include "notify.h"
+#include <limits.h>
+#include <linux/futex.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+NotifyBoard *notify_board = NULL;
+
+// Shared futexes: the words are in a segment other processes map too
+static long futex(uint32_t *word, int op, uint32_t value, const struct timespec *timeout) {
+    return syscall(SYS_futex, word, op, value, timeout, NULL, 0);
+}
+
+static uint64_t now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000 + (uint64_t)ts.tv_nsec / 1000000;
+}
+
+void notify_attach(NotifyBoard *board) {
+    notify_board = board;
+}
+
+void notify_bump(uint32_t *word) {
+    uint32_t before = __atomic_fetch_add(word, NOTIFY_STEP, __ATOMIC_RELEASE);
+    if (before & NOTIFY_WAITING) {
+        // Sleepers that come after this set the bit again
+        __atomic_fetch_and(word, ~NOTIFY_WAITING, __ATOMIC_RELAXED);
+        futex(word, FUTEX_WAKE, INT_MAX, NULL);
+    }
+}
+
+void notify_changed(void) {
+    if (notify_board != NULL) {
+        notify_bump(&notify_board->any);
+    }
+}
+
+void notify_game_changed(void) {
+    if (notify_board != NULL) {
+        notify_bump(&notify_board->game);
+        notify_bump(&notify_board->any);
+    }
+}
+
+int notify_wait(uint32_t *word, uint32_t seen, int timeout_ms) {
+    uint32_t current = __atomic_load_n(word, __ATOMIC_ACQUIRE);
+    for (;;) {
+        if ((current & ~NOTIFY_WAITING) != seen) {
+            return 1;
+        }
+        if (timeout_ms == 0) {
+            return 0;
+        }
+        if (current & NOTIFY_WAITING) {
+            break;
+        }
+        if (__atomic_compare_exchange_n(word, &current, current | NOTIFY_WAITING, false,
+                                        __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+            current |= NOTIFY_WAITING;
+            break;
+        }
+    }
+
+    struct timespec timeout;
+    if (timeout_ms > 0) {
+        timeout.tv_sec = timeout_ms / 1000;
+        timeout.tv_nsec = (long)(timeout_ms % 1000) * 1000000L;
+    }
+    // Returns at once if a writer got in between; a timeout, a signal or a
+    // wake-up for a later value all end up in the check below
+    futex(word, FUTEX_WAIT, current, timeout_ms > 0 ? &timeout : NULL);
+    return notify_generation(word) != seen;
+}
+
+int notify_subscribe(NotifySubscription *sub, uint32_t *sleep_on, int max_watched) {
+    sub->sleep_on = sleep_on;
+    sub->num_watched = 0;
+    sub->max_watched = max_watched;
+    sub->watched = calloc((size_t)max_watched, sizeof(*sub->watched));
+    sub->seen = calloc((size_t)max_watched, sizeof(*sub->seen));
+    if (sub->watched == NULL || sub->seen == NULL) {
+        fprintf(stderr, "Failed to allocate a subscription to %d counters\n", max_watched);
+        notify_unsubscribe(sub);
+        return -1;
+    }
+    return 0;
+}
+
+int notify_watch(NotifySubscription *sub, const uint32_t *word) {
+    if (sub->num_watched == sub->max_watched) {
+        return -1;
+    }
+    int index = sub->num_watched++;
+    sub->watched[index] = word;
+    sub->seen[index] = __atomic_load_n(word, __ATOMIC_ACQUIRE);
+    return index;
+}
+
+int notify_wait_any(NotifySubscription *sub, int timeout_ms, int *changed) {
+    uint64_t deadline = timeout_ms > 0 ? now_ms() + (uint64_t)timeout_ms : 0;
+    for (;;) {
+        // Writers bump the word slept on after their own, so a change that
+        // isn't seen here moves it past the value read first
+        uint32_t generation = notify_generation(sub->sleep_on);
+        int moved = 0;
+        for (int i = 0; i < sub->num_watched; i++) {
+            uint32_t value = __atomic_load_n(sub->watched[i], __ATOMIC_ACQUIRE);
+            if (value != sub->seen[i]) {
+                sub->seen[i] = value;
+                if (changed != NULL) {
+                    changed[moved] = i;
+                }
+                moved++;
+            }
+        }
+        if (moved > 0) {
+            return moved;
+        }
+
+        int wait_ms = -1;
+        if (timeout_ms == 0) {
+            return 0;
+        } else if (timeout_ms > 0) {
+            uint64_t now = now_ms();
+            if (now >= deadline) {
+                return 0;
+            }
+            wait_ms = (int)(deadline - now);
+        }
+        if (!notify_wait(sub->sleep_on, generation, wait_ms) &&
+            notify_generation(sub->sleep_on) == generation) {
+            return 0;  // Timed out or a signal came
+        }
+    }
+}
+
+void notify_unsubscribe(NotifySubscription *sub) {
+    free(sub->watched);
+    free(sub->seen);
+    sub->watched = NULL;
+    sub->seen = NULL;
+    sub->num_watched = 0;
+    sub->max_watched = 0;
+}
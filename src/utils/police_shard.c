@@ -0,0 +1,84 @@
+#include "police_shard.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+// Finalizer of splitmix64: spreads neighbouring keys over the whole ring
+static uint64_t ring_hash(uint64_t key) {
+    key += 0x9E3779B97F4A7C15ULL;
+    key = (key ^ (key >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    key = (key ^ (key >> 27)) * 0x94D049BB133111EBULL;
+    return key ^ (key >> 31);
+}
+
+// Gangs and department points are hashed in separate key spaces
+static uint64_t gang_hash(int gang) {
+    return ring_hash((uint64_t)(uint32_t)gang);
+}
+
+static uint64_t point_hash(int department, int point) {
+    return ring_hash((1ULL << 63) | ((uint64_t)(uint32_t)department << 16) | (uint64_t)(uint32_t)point);
+}
+
+static int compare_points(const void *a, const void *b) {
+    const PoliceRingPoint *pa = a;
+    const PoliceRingPoint *pb = b;
+    if (pa->hash != pb->hash) {
+        return pa->hash < pb->hash ? -1 : 1;
+    }
+    return pa->department - pb->department;
+}
+
+int police_ring_build(PoliceRing *ring, int num_departments) {
+    if (num_departments < 0) {
+        num_departments = 0;
+    }
+    int num_points = num_departments * POLICE_RING_POINTS;
+    PoliceRingPoint *points = NULL;
+    if (num_points > 0) {
+        points = malloc((size_t)num_points * sizeof(PoliceRingPoint));
+        if (points == NULL) {
+            fprintf(stderr, "Failed to allocate the ring of %d police departments\n", num_departments);
+            return -1;
+        }
+    }
+    for (int d = 0; d < num_departments; d++) {
+        for (int p = 0; p < POLICE_RING_POINTS; p++) {
+            points[d * POLICE_RING_POINTS + p] = (PoliceRingPoint){point_hash(d, p), d};
+        }
+    }
+    if (num_points > 0) {
+        qsort(points, (size_t)num_points, sizeof(PoliceRingPoint), compare_points);
+    }
+
+    free(ring->points);
+    ring->points = points;
+    ring->num_points = num_points;
+    ring->num_departments = num_departments;
+    return 0;
+}
+
+int police_ring_owner(const PoliceRing *ring, int gang) {
+    if (ring->num_points == 0) {
+        return -1;
+    }
+    // First point at or after the gang's hash, wrapping past the top
+    uint64_t hash = gang_hash(gang);
+    int lo = 0;
+    int hi = ring->num_points;
+    while (lo < hi) {
+        int mid = lo + (hi - lo) / 2;
+        if (ring->points[mid].hash < hash) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return ring->points[lo == ring->num_points ? 0 : lo].department;
+}
+
+void police_ring_free(PoliceRing *ring) {
+    free(ring->points);
+    ring->points = NULL;
+    ring->num_points = 0;
+    ring->num_departments = 0;
+}
@@ -4,39 +4,196 @@
 #include <unistd.h>
 #include <math.h>
 #include <stdio.h>
+#include <pthread.h>
 #include "gang.h"
 
+static uint64_t master_seed = 0;
+static int master_process = RANDOM_PROC_MAIN;
+static int fallback_thread_counter = 0;
+
+static __thread RandomStream thread_stream;
+static __thread RandomStream *bound_stream = NULL;
+static __thread int thread_seeded = 0;
+
+// Ziggurat tables (Marsaglia & Tsang, 128 layers), built once per process
+static uint32_t zig_kn[128];
+static float zig_wn[128];
+static float zig_fn[128];
+static pthread_once_t zig_once = PTHREAD_ONCE_INIT;
+
+static uint64_t splitmix64(uint64_t *x) {
+    uint64_t z = (*x += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+static inline uint64_t rotl(const uint64_t x, int k) {
+    return (x << k) | (x >> (64 - k));
+}
+
+void random_stream_seed(RandomStream *stream, uint64_t seed, int process_id, int gang_id, int member_id) {
+    // Mix each ID into the key so that neighbouring IDs give unrelated streams
+    uint64_t key = seed;
+    key = splitmix64(&key) ^ (uint64_t)(uint32_t)process_id;
+    key = splitmix64(&key) ^ (uint64_t)(uint32_t)gang_id;
+    key = splitmix64(&key) ^ (uint64_t)(uint32_t)member_id;
+
+    for (int i = 0; i < 4; i++) {
+        stream->s[i] = splitmix64(&key);
+    }
+}
+
+uint64_t random_stream_next(RandomStream *stream) {
+    uint64_t *s = stream->s;
+    const uint64_t result = rotl(s[1] * 5, 7) * 9;
+    const uint64_t t = s[1] << 17;
+
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = rotl(s[3], 45);
+
+    return result;
+}
+
 void init_random() {
-    srand(time(NULL) ^ getpid());
+    init_random_seeded((uint64_t)time(NULL) ^ ((uint64_t)getpid() << 32), RANDOM_PROC_MAIN);
+}
+
+void init_random_seeded(uint64_t seed, int process_id) {
+    master_seed = seed;
+    master_process = process_id;
+    random_seed_thread(-1, -1);
+}
+
+uint64_t random_master_seed(void) {
+    return master_seed;
+}
+
+void random_seed_thread(int gang_id, int member_id) {
+    random_stream_seed(&thread_stream, master_seed, master_process, gang_id, member_id);
+    thread_seeded = 1;
+    bound_stream = NULL;
+}
+
+void random_bind_stream(RandomStream *stream) {
+    bound_stream = stream;
+}
+
+static RandomStream *current_stream(void) {
+    if (bound_stream) {
+        return bound_stream;
+    }
+    if (!thread_seeded) {
+        // Threads that never asked for a stream get a distinct one anyway
+        int n = __sync_add_and_fetch(&fallback_thread_counter, 1);
+        random_stream_seed(&thread_stream, master_seed, master_process, -2, n);
+        thread_seeded = 1;
+    }
+    return &thread_stream;
+}
+
+void random_save_thread(RandomStream *out) {
+    *out = *current_stream();
+}
+
+void random_load_thread(const RandomStream *in) {
+    thread_stream = *in;
+    thread_seeded = 1;
+    bound_stream = NULL;
+}
+
+uint64_t random_u64(void) {
+    return random_stream_next(current_stream());
+}
+
+// Uniform double in the open interval (0, 1)
+static inline double uniform_open(RandomStream *stream) {
+    return ((double)(random_stream_next(stream) >> 11) + 0.5) * 0x1.0p-53;
 }
 
 float random_float(float min, float max) {
-    float scale = rand() / (float)RAND_MAX;
+    float scale = (float)(random_stream_next(current_stream()) >> 40) * 0x1.0p-24f;
     return min + scale * (max - min);
 }
 
+int random_int(int min, int max) {
+    if (max <= min) return min;
+    uint64_t range = (uint64_t)((int64_t)max - min) + 1;
+    // Multiply-shift keeps the draw unbiased enough and avoids a division
+    uint64_t r = random_stream_next(current_stream()) >> 32;
+    return min + (int)((r * range) >> 32);
+}
+
+static void zig_setup(void) {
+    const double m1 = 2147483648.0;
+    double dn = 3.442619855899, tn = dn, vn = 9.91256303526217e-3;
+
+    double q = vn / exp(-0.5 * dn * dn);
+    zig_kn[0] = (uint32_t)((dn / q) * m1);
+    zig_kn[1] = 0;
+    zig_wn[0] = (float)(q / m1);
+    zig_wn[127] = (float)(dn / m1);
+    zig_fn[0] = 1.0f;
+    zig_fn[127] = (float)exp(-0.5 * dn * dn);
+
+    for (int i = 126; i >= 1; i--) {
+        dn = sqrt(-2.0 * log(vn / dn + exp(-0.5 * dn * dn)));
+        zig_kn[i + 1] = (uint32_t)((dn / tn) * m1);
+        tn = dn;
+        zig_fn[i] = (float)exp(-0.5 * dn * dn);
+        zig_wn[i] = (float)(dn / m1);
+    }
+}
+
+// Slow path of the ziggurat: wedges and the tail beyond the base strip
+static float zig_fix(RandomStream *stream, int32_t hz, uint32_t iz) {
+    const double r = 3.442620;
+    for (;;) {
+        double x = hz * (double)zig_wn[iz];
+        if (iz == 0) {
+            double y;
+            do {
+                x = -log(uniform_open(stream)) * 0.2904764;
+                y = -log(uniform_open(stream));
+            } while (y + y < x * x);
+            return (float)(hz > 0 ? r + x : -r - x);
+        }
+        if (zig_fn[iz] + uniform_open(stream) * (zig_fn[iz - 1] - zig_fn[iz]) < exp(-0.5 * x * x)) {
+            return (float)x;
+        }
+
+        hz = (int32_t)(random_stream_next(stream) >> 32);
+        iz = hz & 127;
+        if ((uint32_t)llabs(hz) < zig_kn[iz]) {
+            return hz * zig_wn[iz];
+        }
+    }
+}
+
+static inline float zig_sample(RandomStream *stream) {
+    int32_t hz = (int32_t)(random_stream_next(stream) >> 32);
+    uint32_t iz = hz & 127;
+    if ((uint32_t)llabs(hz) < zig_kn[iz]) {
+        return hz * zig_wn[iz];  // fast path, taken ~99% of the time
+    }
+    return zig_fix(stream, hz, iz);
+}
+
 float random_normal(float mean, float stddev) {
-    static int has_spare = 0;
-    static float spare;
-    
-    if (has_spare) {
-        has_spare = 0;
-        return mean + stddev * spare;
+    pthread_once(&zig_once, zig_setup);
+    return mean + stddev * zig_sample(current_stream());
+}
+
+void random_normal_fill(float *out, int n) {
+    pthread_once(&zig_once, zig_setup);
+    RandomStream *stream = current_stream();
+    for (int i = 0; i < n; i++) {
+        out[i] = zig_sample(stream);
     }
-    
-    // keep generating u, v until s is valid
-    float u, v, s;
-    do {
-        u = random_float(-1.0f, 1.0f);
-        v = random_float(-1.0f, 1.0f);
-        s = u * u + v * v;
-    } while (s >= 1.0f || s == 0.0f);
-    
-    s = sqrtf(-2.0f * logf(s) / s);
-    spare = v * s;
-    has_spare = 1;
-    
-    return mean + stddev * u * s;
 }
 
 // Generate correlated attributes using Cholesky decomposition for multivariate normal distribution
@@ -46,7 +203,7 @@ void generate_multivariate_attributes(float* attributes, const float* means, con
     for (int i = 0; i < NUM_ATTRIBUTES; i++) {
         z[i] = random_normal(0.0f, 1.0f);
     }
-    
+
     // Apply correlation using Cholesky decomposition (simplified approach)
     // This is a simplified implementation that assumes correlation_matrix is positive definite
     for (int i = 0; i < NUM_ATTRIBUTES; i++) {
@@ -54,7 +211,7 @@ void generate_multivariate_attributes(float* attributes, const float* means, con
         for (int j = 0; j <= i; j++) {
             attributes[i] += correlation_matrix[i][j] * z[j] * stddevs[i];
         }
-        
+
         // Ensure values are within [0,1] range
         if (attributes[i] < 0.0f) attributes[i] = 0.0f;
         if (attributes[i] > 1.0f) attributes[i] = 1.0f;
@@ -62,6 +219,47 @@ void generate_multivariate_attributes(float* attributes, const float* means, con
 
 }
 
-int random_int(int min, int max) {
-    return min + rand() % (max - min + 1);
+#define ATTR_BATCH_BLOCK 64
+
+void generate_multivariate_attributes_batch(float *out, size_t stride, int n, const float* means, const float* stddevs, const float correlation_matrix[NUM_ATTRIBUTES][NUM_ATTRIBUTES]) {
+    // Fold the standard deviations into the lower-triangular factor once
+    float factor[NUM_ATTRIBUTES][NUM_ATTRIBUTES] = {{0}};
+    for (int i = 0; i < NUM_ATTRIBUTES; i++) {
+        for (int j = 0; j <= i; j++) {
+            factor[i][j] = correlation_matrix[i][j] * stddevs[i];
+        }
+    }
+
+    // Attribute-major scratch blocks so the per-attribute loops run over
+    // contiguous floats
+    float z[NUM_ATTRIBUTES][ATTR_BATCH_BLOCK];
+    float acc[ATTR_BATCH_BLOCK];
+
+    for (int base = 0; base < n; base += ATTR_BATCH_BLOCK) {
+        int count = n - base < ATTR_BATCH_BLOCK ? n - base : ATTR_BATCH_BLOCK;
+
+        for (int j = 0; j < NUM_ATTRIBUTES; j++) {
+            random_normal_fill(z[j], count);
+        }
+
+        for (int i = 0; i < NUM_ATTRIBUTES; i++) {
+            for (int k = 0; k < count; k++) {
+                acc[k] = means[i];
+            }
+            for (int j = 0; j <= i; j++) {
+                const float f = factor[i][j];
+                for (int k = 0; k < count; k++) {
+                    acc[k] += f * z[j][k];
+                }
+            }
+            for (int k = 0; k < count; k++) {
+                acc[k] = fminf(fmaxf(acc[k], 0.0f), 1.0f);
+            }
+
+            char *dst = (char *)out + (size_t)base * stride;
+            for (int k = 0; k < count; k++) {
+                ((float *)(dst + (size_t)k * stride))[i] = acc[k];
+            }
+        }
+    }
 }
@@ -0,0 +1,77 @@
+#include "routing.h"
+#include <errno.h>
+#include <limits.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/msg.h>
+
+static const char *endpoint_names[ENDPOINT_KINDS] = {"gang", "officer"};
+
+int routing_init(RoutingTable *table, int slots) {
+    if (slots < 1 || slots > (INT32_MAX - 1) / ENDPOINT_KINDS) {
+        fprintf(stderr, "Can't address %d gang slots\n", slots);
+        return -1;
+    }
+    table->slots = slots;
+    table->undeliverable = 0;
+    table->withdrawn = 0;
+    // Types start at 1: msgrcv takes 0 for any type
+    for (int kind = 0; kind < ENDPOINT_KINDS; kind++) {
+        table->base[kind] = 1 + (long)kind * slots;
+    }
+    return 0;
+}
+
+int route_resolve(const RoutingTable *table, long mtype, EndpointKind *kind, int *slot) {
+    for (int k = 0; k < ENDPOINT_KINDS; k++) {
+        if (mtype >= table->base[k] && mtype < table->base[k] + table->slots) {
+            *kind = (EndpointKind)k;
+            *slot = (int)(mtype - table->base[k]);
+            return 0;
+        }
+    }
+    return -1;
+}
+
+void route_undeliverable(RoutingTable *table, const Message *message, const char *reason) {
+    __atomic_fetch_add(&table->undeliverable, 1, __ATOMIC_RELAXED);
+
+    EndpointKind kind;
+    int slot;
+    if (route_resolve(table, message->mtype, &kind, &slot) == 0) {
+        printf("ROUTE: Mode %d message for %s %d undeliverable: %s\n", message->mode,
+               endpoint_names[kind], slot, reason);
+    } else {
+        printf("ROUTE: Mode %d message for type %ld undeliverable: no such endpoint\n", message->mode,
+               message->mtype);
+    }
+    fflush(stdout);
+}
+
+int route_send(RoutingTable *table, int msgid, Message *message) {
+    EndpointKind kind;
+    int slot;
+    if (route_resolve(table, message->mtype, &kind, &slot) == -1) {
+        route_undeliverable(table, message, "no such endpoint");
+        return -1;
+    }
+    if (msgsnd(msgid, message, MESSAGE_SIZE, IPC_NOWAIT) == -1) {
+        // A retired gang's queue is removed (EIDRM, EINVAL) while its
+        // officer may still be sending
+        route_undeliverable(table, message, errno == EAGAIN ? "queue full" : strerror(errno));
+        return -1;
+    }
+    return 0;
+}
+
+int route_withdraw(RoutingTable *table, int msgid, long mtype) {
+    Message message;
+    int withdrawn = 0;
+    while (msgrcv(msgid, &message, MESSAGE_SIZE, mtype, IPC_NOWAIT) != -1) {
+        withdrawn++;
+    }
+    if (withdrawn > 0) {
+        __atomic_fetch_add(&table->withdrawn, (uint32_t)withdrawn, __ATOMIC_RELAXED);
+    }
+    return withdrawn;
+}
@@ -4,6 +4,7 @@
 #include <stdlib.h>     /* For exit() and EXIT_FAILURE */
 #include <errno.h>
 #include <unistd.h>
+#include "instance.h"
 
 static sem_t *game_stats_sem = NULL;
 static sem_t *gang_stats_sem = NULL;
@@ -11,14 +12,15 @@ static sem_t *gang_stats_sem = NULL;
 // Initialize semaphores for inter-process synchronization
 int init_semaphores(void) {
     // Create/open semaphore for game statistics (shared across all processes)
-    game_stats_sem = sem_open(GAME_STATS_SEM_NAME, O_CREAT, 0666, 1);
+    char name[IPC_NAME_LEN];
+    game_stats_sem = sem_open(instance_ipc_name(GAME_STATS_SEM_NAME, name, sizeof(name)), O_CREAT, 0666, 1);
     if (game_stats_sem == SEM_FAILED) {
         perror("Failed to create game stats semaphore");
         return -1;
     }
     
     // Create/open semaphore for gang statistics (shared across gang processes)
-    gang_stats_sem = sem_open(GANG_STATS_SEM_NAME, O_CREAT, 0666, 1);
+    gang_stats_sem = sem_open(instance_ipc_name(GANG_STATS_SEM_NAME, name, sizeof(name)), O_CREAT, 0666, 1);
     if (gang_stats_sem == SEM_FAILED) {
         perror("Failed to create gang stats semaphore");
         sem_close(game_stats_sem);
@@ -30,6 +32,13 @@ int init_semaphores(void) {
     return 0;
 }
 
+// Remove the semaphore names (only the main process should do this)
+void unlink_semaphores(void) {
+    char name[IPC_NAME_LEN];
+    sem_unlink(instance_ipc_name(GAME_STATS_SEM_NAME, name, sizeof(name)));
+    sem_unlink(instance_ipc_name(GANG_STATS_SEM_NAME, name, sizeof(name)));
+}
+
 // Cleanup semaphores
 void cleanup_semaphores(void) {
     if (game_stats_sem != NULL && game_stats_sem != SEM_FAILED) {
@@ -1,58 +1,242 @@
 #include "shared_mem_utils.h"
+#include <errno.h>
 #include <fcntl.h>
+#include <linux/memfd.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
 #include <unistd.h>
 #include "gang.h"
 #include "random.h"
+#include "target_catalog.h"
+#include "instance.h"
+#include "gang_directory.h"
+#include "message.h"
 
+#define HUGE_PAGE_SIZE (2u << 20)     // Default hugetlb page size on x86-64
+#define PREFAULT_PAGE 4096
+
+// When the game lives in a hugetlb memfd, the named object only holds this:
+// children reopen the owner's descriptor through /proc
+#define SHM_REDIRECT_MAGIC 0x52444F43u  // "OCDR"
+typedef struct {
+    uint32_t magic;
+    int32_t pid;
+    int32_t fd;
+    uint32_t reserved;
+    uint64_t size;
+} ShmRedirect;
+
+static int game_memfd = -1;   // Owner only, kept open for the children to find
+
+// This process's page options, which the gang segments take as well
+static struct {
+    int huge_pages;
+    int prefault;
+    int lock;
+} page_options;
+
+// The main segment holds the Game, a Gang for every slot the config allows,
+// the catalog and the gang directory; members live in segments of their
+// own. Each allocation is rounded up to a cache line, the header included.
+static size_t shm_capacity(const Config *cfg) {
+    size_t catalog_size = target_catalog_size(cfg->num_targets, cfg->num_attributes, cfg->max_gangs);
+    return shm_arena_header_size() +
+           shm_arena_align(sizeof(Game)) +
+           shm_arena_align(cfg->max_gangs * sizeof(Gang)) +
+           shm_arena_align(catalog_size) +
+           shm_arena_align(gang_directory_size(cfg->max_gangs)) +
+           shm_arena_align(police_tables_size(cfg->max_gangs, cfg->max_agents_per_gang));
+}
+
+// Every process keeps its own table of where it mapped the gangs
+static GangMapping *alloc_mappings(int num_slots) {
+    GangMapping *mappings = calloc(num_slots > 0 ? (size_t)num_slots : 1, sizeof(GangMapping));
+    if (mappings == NULL) {
+        perror("Failed to allocate the gang mappings");
+        exit(EXIT_FAILURE);
+    }
+    return mappings;
+}
+
+// Fault every page of a mapping in now rather than in whichever game thread
+// touches it first
+static void prefault(void *base, size_t size) {
+#ifdef MADV_POPULATE_WRITE
+    if (madvise(base, size, MADV_POPULATE_WRITE) == 0) {
+        return;
+    }
+#endif
+    // Older kernels: a read maps a shared page writable as well
+    volatile const char *bytes = base;
+    for (size_t offset = 0; offset < size; offset += PREFAULT_PAGE) {
+        (void)bytes[offset];
+    }
+}
+
+// kB of this process's mappings in huge pages, from /proc/self/smaps_rollup
+static long huge_page_kb(void) {
+    FILE *file = fopen("/proc/self/smaps_rollup", "r");
+    if (file == NULL) {
+        return -1;
+    }
+    char line[128];
+    long total = 0;
+    while (fgets(line, sizeof(line), file)) {
+        long kb;
+        if (sscanf(line, "ShmemPmdMapped: %ld kB", &kb) == 1 ||
+            sscanf(line, "Shared_Hugetlb: %ld kB", &kb) == 1 ||
+            sscanf(line, "Private_Hugetlb: %ld kB", &kb) == 1) {
+            total += kb;
+        }
+    }
+    fclose(file);
+    return total;
+}
+
+// The kernel's shmem THP policy, the bracketed word in shmem_enabled
+static void shmem_thp_policy(char *policy, size_t len) {
+    snprintf(policy, len, "unknown");
+    FILE *file = fopen("/sys/kernel/mm/transparent_hugepage/shmem_enabled", "r");
+    if (file == NULL) {
+        return;
+    }
+    char line[128];
+    if (fgets(line, sizeof(line), file)) {
+        char *open = strchr(line, '[');
+        char *close = open ? strchr(open, ']') : NULL;
+        if (close != NULL) {
+            *close = '\0';
+            snprintf(policy, len, "%s", open + 1);
+        }
+    }
+    fclose(file);
+}
+
+// Apply the page options every process takes for itself and say what it got
+static void finish_mapping(const char *who, void *base, size_t size, const Config *cfg, const char *backing) {
+    page_options.huge_pages = cfg->shm_huge_pages;
+    page_options.prefault = cfg->shm_prefault;
+    page_options.lock = cfg->shm_lock;
+
+    if (cfg->shm_prefault) {
+        prefault(base, size);
+    }
+    const char *locked = "";
+    if (cfg->shm_lock) {
+        if (mlock(base, size) == 0) {
+            locked = ", locked";
+        } else {
+            fprintf(stderr, "%s: mlock of %zu bytes failed (%s), continuing unlocked\n",
+                    who, size, strerror(errno));
+        }
+    }
+    printf("%s: Shared memory backing: %s, %zu bytes%s%s, %ld kB in huge pages\n",
+           who, backing, size, cfg->shm_prefault ? ", pre-faulted" : "", locked, huge_page_kb());
+    fflush(stdout);
+}
+
+// Try the hugetlb pool. MAP_POPULATE reserves the pages up front, so a short
+// pool fails here instead of with SIGBUS on first touch.
+static void *map_hugetlb(size_t total_size, size_t *mapped_size) {
+    int fd = (int)syscall(SYS_memfd_create, "ocf-game", MFD_HUGETLB);
+    if (fd == -1) {
+        printf("OWNER: hugetlb memfd unavailable (%s), falling back\n", strerror(errno));
+        return NULL;
+    }
+    size_t size = (total_size + HUGE_PAGE_SIZE - 1) & ~(size_t)(HUGE_PAGE_SIZE - 1);
+    void *base = MAP_FAILED;
+    if (ftruncate(fd, size) == 0) {
+        base = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, 0);
+    }
+    if (base == MAP_FAILED) {
+        printf("OWNER: No %zu bytes of hugetlb pages (%s), falling back\n", size, strerror(errno));
+        close(fd);
+        return NULL;
+    }
+    game_memfd = fd;
+    *mapped_size = size;
+    return base;
+}
 
 // Owner function - creates, truncates, and maps shared memory
 Game* setup_shared_memory_owner(Config *cfg, ShmPtrs *shm_ptrs) {
     printf("OWNER: Setting up shared memory...\n");
     fflush(stdout);
     
-    // Allocate shared memory for Game + dynamic arrays
-    size_t game_size = sizeof(Game);
-    size_t gangs_size = cfg->num_gangs * sizeof(Gang);
-    size_t members_size = cfg->num_gangs * cfg->max_gang_size * sizeof(Member);
-    size_t total_size = game_size + gangs_size + members_size;
+    // Allocate shared memory for the arena: Game, gangs, catalog, then members
+    size_t total_size = shm_capacity(cfg);
+    size_t catalog_size = target_catalog_size(cfg->num_targets, cfg->num_attributes, cfg->max_gangs);
+    size_t directory_size = gang_directory_size(cfg->max_gangs);
+    size_t police_size = police_tables_size(cfg->max_gangs, cfg->max_agents_per_gang);
+    size_t mapped_size = total_size;
     
     printf("OWNER: Game struct layout: Game size: %zu, Gang: %zu, Member: %zu\n", 
            sizeof(Game), sizeof(Gang), sizeof(Member));
     fflush(stdout);
     
-    printf("OWNER: Memory sizes - game: %zu, gangs: %zu, members: %zu, total: %zu\n",
-           game_size, gangs_size, members_size, total_size);
-    
     // Create new shared memory segment with O_CREAT flag
-    int shm_fd = shm_open(GAME_SHM_NAME, O_CREAT | O_RDWR, 0666);
+    char shm_name[IPC_NAME_LEN];
+    int shm_fd = shm_open(instance_ipc_name(GAME_SHM_NAME, shm_name, sizeof(shm_name)), O_CREAT | O_RDWR, 0666);
     if (shm_fd == -1) {
         perror("OWNER: shm_open failed");
         exit(EXIT_FAILURE);
     }
     
-    // Truncate to set the size
-    if (ftruncate(shm_fd, total_size) == -1) {
-        perror("OWNER: ftruncate failed");
-        close(shm_fd);
-        exit(EXIT_FAILURE);
+    char backing[96];
+    ShmArena *arena = NULL;
+    if (cfg->shm_huge_pages == SHM_PAGES_HUGETLB) {
+        arena = map_hugetlb(total_size, &mapped_size);
     }
     
-    // Map the shared memory
-    Game *game = mmap(NULL, total_size, PROT_READ | PROT_WRITE, MAP_SHARED, shm_fd, 0);
-    if (game == MAP_FAILED) {
-        perror("OWNER: mmap failed");
-        close(shm_fd);
-        exit(EXIT_FAILURE);
+    if (arena != NULL) {
+        // The named object just points at the memfd
+        ShmRedirect redirect = {SHM_REDIRECT_MAGIC, (int32_t)getpid(), game_memfd, 0, mapped_size};
+        if (ftruncate(shm_fd, sizeof(redirect)) == -1 ||
+            pwrite(shm_fd, &redirect, sizeof(redirect), 0) != (ssize_t)sizeof(redirect)) {
+            perror("OWNER: Failed to publish the hugetlb segment");
+            close(shm_fd);
+            exit(EXIT_FAILURE);
+        }
+        snprintf(backing, sizeof(backing), "hugetlb memfd, %u kB pages", HUGE_PAGE_SIZE / 1024);
+    } else {
+        // Truncate to set the size
+        if (ftruncate(shm_fd, total_size) == -1) {
+            perror("OWNER: ftruncate failed");
+            close(shm_fd);
+            exit(EXIT_FAILURE);
+        }
+
+        // Map the shared memory. Huge page advice has to come before the
+        // first fault, so only plain pages are populated by mmap itself.
+        int populate = cfg->shm_prefault && cfg->shm_huge_pages == SHM_PAGES_DEFAULT ? MAP_POPULATE : 0;
+        arena = mmap(NULL, total_size, PROT_READ | PROT_WRITE, MAP_SHARED | populate, shm_fd, 0);
+        if (arena == MAP_FAILED) {
+            perror("OWNER: mmap failed");
+            close(shm_fd);
+            exit(EXIT_FAILURE);
+        }
+
+        if (cfg->shm_huge_pages != SHM_PAGES_DEFAULT) {
+            char policy[32];
+            shmem_thp_policy(policy, sizeof(policy));
+            if (madvise(arena, total_size, MADV_HUGEPAGE) == -1) {
+                snprintf(backing, sizeof(backing), "shm, 4 kB pages (MADV_HUGEPAGE failed: %s)", strerror(errno));
+            } else {
+                snprintf(backing, sizeof(backing), "shm, transparent huge page advice (shmem_enabled=%s)", policy);
+            }
+        } else {
+            snprintf(backing, sizeof(backing), "shm, 4 kB pages");
+        }
     }
     
     // Close file descriptor as it's no longer needed after mapping
     close(shm_fd);
     
-    printf("OWNER: Shared memory created and mapped successfully at %p\n", (void*)game);
+    printf("OWNER: Shared memory created and mapped successfully at %p\n", (void*)arena);
     fflush(stdout);
     
     // Initialize the memory layout
@@ -60,52 +244,69 @@ Game* setup_shared_memory_owner(Config *cfg, ShmPtrs *shm_ptrs) {
     fflush(stdout);
     
     // CRITICAL: Zero out all shared memory to ensure clean initialization
-    memset(game, 0, total_size);
+    memset(arena, 0, total_size);
     printf("OWNER: Zeroed out %zu bytes of shared memory\n", total_size);
     fflush(stdout);
+    finish_mapping("OWNER", arena, mapped_size, cfg, backing);
+
+    // Allocate the fixed regions; the allocator can't run out here because
+    // the segment was sized for them
+    shm_arena_init(arena, total_size);
+    Game *game = shm_arena_ptr(arena, shm_arena_add_region(arena, SHM_REGION_GAME, 1, sizeof(Game)));
+    shm_ptrs->gangs = shm_arena_ptr(arena, shm_arena_add_region(arena, SHM_REGION_GANGS, cfg->max_gangs, sizeof(Gang)));
+    shm_ptrs->catalog = shm_arena_ptr(arena, shm_arena_add_region(arena, SHM_REGION_CATALOG, catalog_size, 1));
+    shm_ptrs->directory = shm_arena_ptr(arena, shm_arena_add_region(arena, SHM_REGION_DIRECTORY, directory_size, 1));
+    shm_ptrs->police = police_tables_at(shm_arena_ptr(arena, shm_arena_add_region(arena, SHM_REGION_POLICE, police_size, 1)),
+                                        cfg->max_gangs, cfg->max_agents_per_gang);
+    shm_ptrs->mappings = alloc_mappings(cfg->max_gangs);
+    shm_ptrs->directory_generation = 0;
+    shm_ptrs->arena = arena;
+    shm_ptrs->shared_game = game;
+    shm_ptrs->size = total_size;
+    shm_ptrs->mapped_size = mapped_size;
+    notify_attach(&game->notify);
     
     // Initialize Game struct fields
     game->num_successfull_plans = 0;
     game->num_thwarted_plans = 0;
     game->num_executed_agents = 0;
     game->elapsed_time = 0;
-    printf("OWNER: Initialized Game struct counters to 0\n");
-    fflush(stdout);
-    
-    // Set up pointers to dynamic parts
-    shm_ptrs->gangs = (Gang*)((char*)game + sizeof(Game));
-    
-    // Allocate array for gang member pointers
-    shm_ptrs->gang_members = malloc(cfg->num_gangs * sizeof(Member*));
-    if (shm_ptrs->gang_members == NULL) {
-        fprintf(stderr, "OWNER: Failed to allocate gang_members array\n");
+    game->police.num_officers = cfg->max_gangs;
+    game->police.max_agents = cfg->max_agents_per_gang;
+    game->police.num_departments = cfg->police_departments;
+    if (routing_init(&game->routing, cfg->max_gangs) == -1) {
         exit(EXIT_FAILURE);
     }
+    for (int i = 0; i < cfg->max_gangs; i++) {
+        // Free for the department whose shard the gang falls in
+        shm_ptrs->police.officers[i].police_id = i;
+        shm_ptrs->police.officers[i].gang_id_monitoring = i;
+        shm_ptrs->police.officers[i].department = -1;
+        shm_ptrs->gangs[i].msgq_id = -1;
+    }
+    printf("OWNER: Initialized Game struct counters to 0\n");
+    fflush(stdout);
+
+    // Publish the config for the child processes
+    config_block_publish(&game->config_block, cfg);
+    shm_ptrs->config_generation = config_block_generation(&game->config_block);
+    printf("OWNER: Published config (generation %u)\n", config_block_generation(&game->config_block));
+    fflush(stdout);
     
-    // Set up gang member pointers
+    // Every slot may grow to the same limit; the first num_gangs are spawned
+    gang_directory_init(shm_ptrs->directory, cfg->max_gangs, cfg->gang_size_limit);
     for (int i = 0; i < cfg->num_gangs; i++) {
-        // Initialize gang fields (memset already zeroed everything, but be explicit)
-        shm_ptrs->gangs[i].gang_id = i; 
-        shm_ptrs->gangs[i].max_member_count = random_int(cfg->min_gang_size, cfg->max_gang_size);
-        shm_ptrs->gangs[i].num_alive_members = shm_ptrs->gangs[i].max_member_count;
-        shm_ptrs->gangs[i].num_successful_plans = 0;  // Explicitly set to 0
-        shm_ptrs->gangs[i].num_thwarted_plans = 0;    // Explicitly set to 0
-        
-        // Set up local pointer to this gang's members
-        shm_ptrs->gang_members[i] = (Member*)((char*)shm_ptrs->gangs +
-                                       gangs_size + 
-                                       i * cfg->max_gang_size * sizeof(Member));
-        
-        printf("OWNER: Gang %d: %d members, success=%d, thwarted=%d, at offset %ld\n", 
-               i, shm_ptrs->gangs[i].max_member_count,
-               shm_ptrs->gangs[i].num_successful_plans,
-               shm_ptrs->gangs[i].num_thwarted_plans,
-               (char*)shm_ptrs->gang_members[i] - (char*)game);
+        if (shm_spawn_gang(shm_ptrs, cfg, i) == -1) {
+            exit(EXIT_FAILURE);
+        }
     }
 
-    for (int i = 0; i < cfg->num_gangs; i++) {
+    printf("OWNER: Memory sizes - game: %zu, gangs: %zu, catalog: %zu, directory: %zu, police: %zu, used: %llu of %zu\n",
+           sizeof(Game), cfg->max_gangs * sizeof(Gang), catalog_size, directory_size, police_size,
+           (unsigned long long)arena->used, total_size);
 
-    }
+    // Lay out an empty catalog; main copies the loaded targets in afterwards
+    target_catalog_init(shm_ptrs->catalog, cfg->num_targets, cfg->num_attributes, cfg->max_gangs);
     
     printf("OWNER: Shared memory layout initialized\n");
     fflush(stdout);
@@ -113,81 +314,296 @@ Game* setup_shared_memory_owner(Config *cfg, ShmPtrs *shm_ptrs) {
     return game;
 }
 
+// Swap the descriptor of the named object for the owner's hugetlb memfd if
+// that's where the game is
+static int follow_redirect(int shm_fd, struct stat *st, const char **backing) {
+    ShmRedirect redirect;
+    *backing = "shm";
+    if ((size_t)st->st_size != sizeof(redirect) ||
+        pread(shm_fd, &redirect, sizeof(redirect), 0) != (ssize_t)sizeof(redirect) ||
+        redirect.magic != SHM_REDIRECT_MAGIC) {
+        return shm_fd;
+    }
+
+    char path[64];
+    snprintf(path, sizeof(path), "/proc/%d/fd/%d", redirect.pid, redirect.fd);
+    int fd = open(path, O_RDWR);
+    if (fd == -1) {
+        fprintf(stderr, "USER: Can't open the game's hugetlb segment at %s: %s\n", path, strerror(errno));
+        close(shm_fd);
+        exit(EXIT_FAILURE);
+    }
+    close(shm_fd);
+    if (fstat(fd, st) == -1) {
+        perror("USER: fstat failed");
+        close(fd);
+        exit(EXIT_FAILURE);
+    }
+    *backing = "hugetlb memfd";
+    return fd;
+}
+
 // User function - only maps to existing shared memory
 Game* setup_shared_memory_user(Config *cfg, ShmPtrs *shm_ptrs) {
     printf("USER: Connecting to shared memory...\n");
     fflush(stdout);
     
-    // Calculate sizes
-    size_t game_size = sizeof(Game);
-    size_t gangs_size = cfg->num_gangs * sizeof(Gang);
-    size_t members_size = cfg->num_gangs * cfg->max_gang_size * sizeof(Member);
-    size_t total_size = game_size + gangs_size + members_size;
-    
     // Open existing shared memory without O_CREAT flag
-    int shm_fd = shm_open(GAME_SHM_NAME, O_RDWR, 0666);
+    char shm_name[IPC_NAME_LEN];
+    int shm_fd = shm_open(instance_ipc_name(GAME_SHM_NAME, shm_name, sizeof(shm_name)), O_RDWR, 0666);
     if (shm_fd == -1) {
         perror("USER: shm_open failed");
         exit(EXIT_FAILURE);
     }
+
+    // The segment size is only known to the owner, so take it from the object
+    struct stat st;
+    if (fstat(shm_fd, &st) == -1) {
+        perror("USER: fstat failed");
+        close(shm_fd);
+        exit(EXIT_FAILURE);
+    }
+    const char *backing;
+    shm_fd = follow_redirect(shm_fd, &st, &backing);
+    size_t mapped_size = (size_t)st.st_size;
     
     // Map the memory
-    Game *game = mmap(NULL, total_size, PROT_READ | PROT_WRITE, MAP_SHARED, shm_fd, 0);
-    if (game == MAP_FAILED) {
+    ShmArena *arena = mmap(NULL, mapped_size, PROT_READ | PROT_WRITE, MAP_SHARED, shm_fd, 0);
+    if (arena == MAP_FAILED) {
         perror("USER: mmap failed");
         close(shm_fd);
         exit(EXIT_FAILURE);
     }
-
-    shm_ptrs->shared_game = game;
     // Close file descriptor
     close(shm_fd);
-    
-    printf("USER: Successfully connected to shared memory at %p\n", (void*)game);
-    fflush(stdout);
-    
-    // CRITICAL: We must recreate all the pointers in the shared memory structure
-    // because pointers from one process's address space don't make sense in another process
-    
-    printf("USER: Setting up internal pointers in shared memory\n");
-    fflush(stdout);
-    
-    // Set up gangs pointer
-    shm_ptrs->gangs = (Gang*)((char*)game + sizeof(Game));
-    printf("USER: Gangs array at offset %ld, address %p\n", 
-           (char*)shm_ptrs->gangs - (char*)game, (void*)shm_ptrs->gangs);
-    fflush(stdout);
-    
-    // Allocate array for gang member pointers
-    shm_ptrs->gang_members = malloc(cfg->num_gangs * sizeof(Member*));
-    if (shm_ptrs->gang_members == NULL) {
-        fprintf(stderr, "USER: Failed to allocate gang_members array\n");
+
+    // The layout is in the arena header; check it was built by this binary
+    if (shm_arena_check(arena, mapped_size) == -1 ||
+        shm_arena_check_region(arena, SHM_REGION_GAME, sizeof(Game)) == -1 ||
+        shm_arena_check_region(arena, SHM_REGION_GANGS, sizeof(Gang)) == -1 ||
+        shm_arena_check_region(arena, SHM_REGION_CATALOG, 1) == -1 ||
+        shm_arena_check_region(arena, SHM_REGION_DIRECTORY, 1) == -1 ||
+        shm_arena_check_region(arena, SHM_REGION_POLICE, 1) == -1) {
+        fprintf(stderr, "USER: Shared memory layout doesn't match this build\n");
         exit(EXIT_FAILURE);
     }
-    
-    // Set up member pointers for each gang
-    for (int i = 0; i < cfg->num_gangs; i++) {
-        shm_ptrs->gang_members[i] = (Member*)((char*)shm_ptrs->gangs + 
-                                      gangs_size + 
-                                      i * cfg->max_gang_size * sizeof(Member));
-        printf("USER: Gang %d members at offset %ld, address %p\n",
-               i, (char*)shm_ptrs->gang_members[i] - (char*)game, (void*)shm_ptrs->gang_members[i]);
-        fflush(stdout);
+    Game *game = shm_arena_region(arena, SHM_REGION_GAME);
+
+    if (config_block_read(&game->config_block, cfg, &shm_ptrs->config_generation) == -1) {
+        fprintf(stderr, "USER: No valid config in shared memory\n");
+        exit(EXIT_FAILURE);
     }
+    GangDirectory *directory = shm_arena_region(arena, SHM_REGION_DIRECTORY);
+    if (arena->regions[SHM_REGION_GANGS].count != (uint32_t)cfg->max_gangs ||
+        directory->num_slots != (uint32_t)cfg->max_gangs ||
+        arena->regions[SHM_REGION_DIRECTORY].size < gang_directory_size(cfg->max_gangs)) {
+        fprintf(stderr, "USER: Shared memory holds %u gang slots, config says %d\n",
+                arena->regions[SHM_REGION_GANGS].count, cfg->max_gangs);
+        exit(EXIT_FAILURE);
+    }
+    if (arena->regions[SHM_REGION_POLICE].size != police_tables_size(cfg->max_gangs, cfg->max_agents_per_gang)) {
+        fprintf(stderr, "USER: Shared memory police tables hold %llu bytes, config needs %zu\n",
+                (unsigned long long)arena->regions[SHM_REGION_POLICE].size,
+                police_tables_size(cfg->max_gangs, cfg->max_agents_per_gang));
+        exit(EXIT_FAILURE);
+    }
+
+    shm_ptrs->arena = arena;
+    shm_ptrs->size = arena->total_size;
+    shm_ptrs->mapped_size = mapped_size;
+    shm_ptrs->shared_game = game;
+    notify_attach(&game->notify);
+    shm_ptrs->gangs = shm_arena_region(arena, SHM_REGION_GANGS);
+    shm_ptrs->catalog = shm_arena_region(arena, SHM_REGION_CATALOG);
+    shm_ptrs->police = police_tables_at(shm_arena_region(arena, SHM_REGION_POLICE),
+                                        cfg->max_gangs, cfg->max_agents_per_gang);
+    // Gang members are mapped on demand: shm_map_gang or shm_refresh_gangs
+    shm_ptrs->directory = directory;
+    shm_ptrs->mappings = alloc_mappings(cfg->max_gangs);
+    shm_ptrs->directory_generation = 0;
     
-    printf("USER: All internal pointers initialized\n");
+    printf("USER: Successfully connected to shared memory at %p (%zu bytes, %llu used)\n",
+           (void*)arena, mapped_size, (unsigned long long)arena->used);
     fflush(stdout);
+    finish_mapping("USER", arena, mapped_size, cfg, backing);
     
     return game;
 }
 
-void cleanup_shared_memory(Game *shared_game) {
-    if (shared_game != NULL && shared_game != MAP_FAILED) {
-        if (munmap(shared_game, sizeof(Game)) == -1) {
+// Apply the page options to the members a gang mapping gained since it was
+// last settled, as finish_mapping does for the main segment: huge page advice
+// before the first fault (a gang segment is a plain shm object, so hugetlb
+// comes down to the advice), then prefault and mlock. The mapping reaches
+// past the object's end, so only the members that exist are touched.
+static void shm_settle_gang(const GangDirectory *directory, int slot, GangMapping *mapping) {
+    if (mapping->members == NULL || mapping->settled >= mapping->capacity) {
+        return;
+    }
+    if (mapping->settled == 0 && page_options.huge_pages != SHM_PAGES_DEFAULT &&
+        madvise(mapping->members, (size_t)directory->slots[slot].limit * sizeof(Member), MADV_HUGEPAGE) == -1) {
+        fprintf(stderr, "Gang %d: MADV_HUGEPAGE failed (%s), keeping 4 kB pages\n", slot, strerror(errno));
+    }
+
+    // madvise and mlock take whole pages
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    size_t start = (size_t)mapping->settled * sizeof(Member) & ~(page - 1);
+    size_t end = (size_t)mapping->capacity * sizeof(Member);
+    char *base = (char *)mapping->members + start;
+    if (page_options.prefault) {
+        prefault(base, end - start);
+    }
+    if (page_options.lock && mlock(base, end - start) == -1) {
+        fprintf(stderr, "Gang %d: mlock of %zu bytes failed (%s), continuing unlocked\n",
+                slot, end - start, strerror(errno));
+    }
+    mapping->settled = mapping->capacity;
+}
+
+int shm_refresh_gangs(ShmPtrs *shm_ptrs) {
+    if (!gang_mappings_refresh(shm_ptrs->directory, shm_ptrs->mappings, &shm_ptrs->directory_generation)) {
+        return 0;
+    }
+    for (int slot = 0; slot < (int)shm_ptrs->directory->num_slots; slot++) {
+        shm_settle_gang(shm_ptrs->directory, slot, &shm_ptrs->mappings[slot]);
+    }
+    return 1;
+}
+
+int shm_map_gang(ShmPtrs *shm_ptrs, int slot) {
+    GangMapping *mapping = &shm_ptrs->mappings[slot];
+    if (mapping->members == NULL) {
+        mapping->members = gang_segment_map(shm_ptrs->directory, slot, &mapping->incarnation, &mapping->capacity);
+        shm_settle_gang(shm_ptrs->directory, slot, mapping);
+    }
+    return mapping->members != NULL ? 0 : -1;
+}
+
+int shm_spawn_gang(ShmPtrs *shm_ptrs, const Config *cfg, int slot) {
+    // A slot spawned again starts over; nothing of the retired gang carries on
+    Gang *gang = &shm_ptrs->gangs[slot];
+    uint32_t version = gang_version(gang);
+    uint32_t alerts = notify_generation(&gang->alerts);
+    memset(gang, 0, sizeof(*gang));
+    gang->gang_id = slot;
+    gang->version = version + NOTIFY_STEP;
+    gang->alerts = alerts + NOTIFY_STEP;
+    gang->max_member_count = random_int(cfg->min_gang_size, cfg->max_gang_size);
+    gang->num_alive_members = gang->max_member_count;
+
+    // No agent of the retired gang reports on
+    AgentMailbox *mailboxes = police_mailboxes(&shm_ptrs->police, cfg->max_agents_per_gang, slot);
+    for (int i = 0; i < cfg->max_agents_per_gang; i++) {
+        agent_mailbox_clear(&mailboxes[i]);
+    }
+
+    // The queue is in place before the slot turns active and an officer looks
+    gang->msgq_id = create_private_queue(cfg->gang_queue_bytes);
+    if (gang->msgq_id == -1) {
+        return -1;
+    }
+    if (gang_segment_create(shm_ptrs->directory, slot, gang->max_member_count, 0) == -1) {
+        delete_message_queue(gang->msgq_id);
+        gang->msgq_id = -1;
+        return -1;
+    }
+    shm_refresh_gangs(shm_ptrs);
+    printf("OWNER: Gang %d: %d members (room for %u), incarnation %u, queue %d\n",
+           slot, gang->max_member_count, shm_ptrs->directory->slots[slot].limit,
+           shm_ptrs->directory->slots[slot].incarnation, gang->msgq_id);
+    fflush(stdout);
+    return 0;
+}
+
+int shm_restore_gang(ShmPtrs *shm_ptrs, const Config *cfg, int slot, const void *members, size_t size) {
+    GangSlot saved = shm_ptrs->directory->slots[slot];
+    if (size != (size_t)saved.capacity * sizeof(Member)) {
+        fprintf(stderr, "OWNER: Gang %d was saved with %zu bytes of members, its slot holds %u members\n",
+                slot, size, saved.capacity);
+        return -1;
+    }
+    // The saved directory says the slot is active; recreate what it names
+    shm_ptrs->directory->slots[slot].state = GANG_SLOT_FREE;
+    shm_ptrs->directory->num_active--;
+    if (gang_segment_create(shm_ptrs->directory, slot, (int)saved.capacity, saved.incarnation) == -1) {
+        return -1;
+    }
+    if (shm_map_gang(shm_ptrs, slot) == -1) {
+        return -1;
+    }
+    memcpy(shm_members(shm_ptrs, slot), members, size);
+    // The saved queue ID was the old run's; the messages go on a new one
+    Gang *gang = &shm_ptrs->gangs[slot];
+    gang->msgq_id = create_private_queue(cfg->gang_queue_bytes);
+    if (gang->msgq_id == -1) {
+        return -1;
+    }
+    gang->queue_depth = 0;
+    gang->queue_bytes = 0;
+    shm_ptrs->gangs[slot].restored = 1;
+    shm_ptrs->gangs[slot].retiring = 0;  // Main decides again which gangs stay
+    return 0;
+}
+
+// The gang's queue goes with it, along with anything still on it
+static void remove_gang_queue(Gang *gang) {
+    if (gang->msgq_id != -1) {
+        delete_message_queue(gang->msgq_id);
+        gang->msgq_id = -1;
+    }
+    gang->queue_depth = 0;
+    gang->queue_bytes = 0;
+}
+
+void shm_retire_gang(ShmPtrs *shm_ptrs, int slot) {
+    gang_segment_retire(shm_ptrs->directory, slot);
+    remove_gang_queue(&shm_ptrs->gangs[slot]);
+    shm_refresh_gangs(shm_ptrs);
+    gang_touch(&shm_ptrs->gangs[slot]);
+}
+
+int shm_grow_gang(ShmPtrs *shm_ptrs, int slot, int capacity) {
+    int grown = gang_segment_grow(shm_ptrs->directory, slot, capacity);
+    if (grown > 0 && (uint32_t)grown > shm_ptrs->mappings[slot].capacity) {
+        shm_ptrs->mappings[slot].capacity = (uint32_t)grown;
+        shm_settle_gang(shm_ptrs->directory, slot, &shm_ptrs->mappings[slot]);
+    }
+    return grown;
+}
+
+void detach_shared_memory(ShmPtrs *shm_ptrs) {
+    if (shm_ptrs->mappings != NULL) {
+        if (shm_ptrs->directory != NULL) {
+            gang_mappings_release(shm_ptrs->directory, shm_ptrs->mappings);
+        }
+        free(shm_ptrs->mappings);
+        shm_ptrs->mappings = NULL;
+    }
+    if (shm_ptrs->arena != NULL && (void*)shm_ptrs->arena != MAP_FAILED) {
+        if (munmap(shm_ptrs->arena, shm_ptrs->mapped_size) == -1) {
             perror("munmap failed");
         }
     }
-    shm_unlink(GAME_SHM_NAME);
+    notify_attach(NULL);
+    shm_ptrs->arena = NULL;
+    shm_ptrs->shared_game = NULL;
+    shm_ptrs->gangs = NULL;
+    shm_ptrs->catalog = NULL;
+    shm_ptrs->directory = NULL;
 }
 
-
+void cleanup_shared_memory(ShmPtrs *shm_ptrs) {
+    // Remove the segments of the gangs still running before the directory goes
+    if (shm_ptrs->directory != NULL) {
+        for (int s = 0; s < (int)shm_ptrs->directory->num_slots; s++) {
+            gang_segment_retire(shm_ptrs->directory, s);
+            remove_gang_queue(&shm_ptrs->gangs[s]);
+        }
+    }
+    detach_shared_memory(shm_ptrs);
+    if (game_memfd != -1) {
+        close(game_memfd);
+        game_memfd = -1;
+    }
+    char shm_name[IPC_NAME_LEN];
+    shm_unlink(instance_ipc_name(GAME_SHM_NAME, shm_name, sizeof(shm_name)));
+}
@@ -0,0 +1,80 @@
+#include "shm_arena.h"
+#include <stdio.h>
+#include <string.h>
+
+void shm_arena_init(ShmArena *arena, size_t total_size) {
+    memset(arena, 0, sizeof(*arena));
+    arena->magic = SHM_ARENA_MAGIC;
+    arena->version = SHM_ARENA_VERSION;
+    arena->total_size = total_size;
+    arena->used = shm_arena_header_size();
+}
+
+ShmOffset shm_arena_alloc(ShmArena *arena, size_t size) {
+    uint64_t step = shm_arena_align(size > 0 ? size : 1);
+    uint64_t top = __atomic_load_n(&arena->used, __ATOMIC_RELAXED);
+    do {
+        if (top + step > arena->total_size) {
+            return 0;
+        }
+    } while (!__atomic_compare_exchange_n(&arena->used, &top, top + step, 0,
+                                          __ATOMIC_ACQ_REL, __ATOMIC_RELAXED));
+    return top;
+}
+
+ShmOffset shm_arena_add_region(ShmArena *arena, int region, uint32_t count, uint32_t elem_size) {
+    if (region < 0 || region >= SHM_MAX_REGIONS) {
+        return 0;
+    }
+    uint64_t size = (uint64_t)count * elem_size;
+    ShmOffset offset = shm_arena_alloc(arena, size);
+    if (offset == 0) {
+        return 0;
+    }
+    ShmRegion *entry = &arena->regions[region];
+    entry->offset = offset;
+    entry->size = size;
+    entry->count = count;
+    entry->elem_size = elem_size;
+    return offset;
+}
+
+int shm_arena_check(const ShmArena *arena, size_t mapped_size) {
+    if (mapped_size < sizeof(ShmArena)) {
+        fprintf(stderr, "Shared memory too small for an arena header (%zu bytes)\n", mapped_size);
+        return -1;
+    }
+    if (arena->magic != SHM_ARENA_MAGIC || arena->version != SHM_ARENA_VERSION) {
+        fprintf(stderr, "Shared memory has no arena header (magic %08x, version %u)\n",
+                arena->magic, arena->version);
+        return -1;
+    }
+    if (arena->total_size > mapped_size || arena->used > arena->total_size) {
+        fprintf(stderr, "Arena claims %llu bytes (%llu used), %zu mapped\n",
+                (unsigned long long)arena->total_size, (unsigned long long)arena->used, mapped_size);
+        return -1;
+    }
+    for (int r = 0; r < SHM_MAX_REGIONS; r++) {
+        const ShmRegion *entry = &arena->regions[r];
+        if (entry->offset == 0) {
+            continue;
+        }
+        if (entry->offset < shm_arena_header_size() || entry->size > arena->used ||
+            entry->offset > arena->used - entry->size) {
+            fprintf(stderr, "Arena region %d (%llu bytes at %llu) is outside the allocated space\n",
+                    r, (unsigned long long)entry->size, (unsigned long long)entry->offset);
+            return -1;
+        }
+    }
+    return 0;
+}
+
+int shm_arena_check_region(const ShmArena *arena, int region, uint32_t elem_size) {
+    const ShmRegion *entry = &arena->regions[region];
+    if (entry->offset == 0 || entry->elem_size != elem_size) {
+        fprintf(stderr, "Arena region %d holds %u byte elements, expected %u\n",
+                region, entry->elem_size, elem_size);
+        return -1;
+    }
+    return 0;
+}
@@ -0,0 +1,110 @@
+#include "startup.h"
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+const char *const startup_phase_names[NUM_STARTUP_PHASES] = {
+    "exec", "attach", "ipc", "init", "ready"
+};
+
+uint64_t startup_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+int startup_barrier_init(StartupBarrier *barrier, int expected) {
+    pthread_mutexattr_t mutex_attr;
+    pthread_condattr_t cond_attr;
+
+    pthread_mutexattr_init(&mutex_attr);
+    pthread_mutexattr_setpshared(&mutex_attr, PTHREAD_PROCESS_SHARED);
+    pthread_condattr_init(&cond_attr);
+    pthread_condattr_setpshared(&cond_attr, PTHREAD_PROCESS_SHARED);
+    pthread_condattr_setclock(&cond_attr, CLOCK_MONOTONIC);
+
+    int err = pthread_mutex_init(&barrier->mutex, &mutex_attr);
+    if (err == 0) {
+        err = pthread_cond_init(&barrier->cond, &cond_attr);
+    }
+    pthread_mutexattr_destroy(&mutex_attr);
+    pthread_condattr_destroy(&cond_attr);
+    if (err != 0) {
+        fprintf(stderr, "Failed to initialize startup barrier: %s\n", strerror(err));
+        return -1;
+    }
+
+    barrier->expected = expected;
+    barrier->ready = 0;
+    barrier->released = 0;
+    barrier->release_ns = 0;
+    memset(&barrier->police, 0, sizeof(barrier->police));
+    barrier->launch_ns = startup_now_ns();
+    return 0;
+}
+
+void startup_barrier_destroy(StartupBarrier *barrier) {
+    pthread_cond_destroy(&barrier->cond);
+    pthread_mutex_destroy(&barrier->mutex);
+}
+
+void startup_mark(const StartupBarrier *barrier, StartupTimes *times, StartupPhase phase, uint64_t now_ns) {
+    times->phase_ns[phase] = now_ns > barrier->launch_ns ? now_ns - barrier->launch_ns : 1;
+}
+
+void startup_arrive_and_wait(StartupBarrier *barrier, StartupTimes *times) {
+    startup_mark(barrier, times, STARTUP_READY, startup_now_ns());
+    pthread_mutex_lock(&barrier->mutex);
+    // Only the last arrival wakes main; waking everyone each time would just
+    // have the waiting children fight over the mutex
+    if (++barrier->ready == barrier->expected) {
+        pthread_cond_broadcast(&barrier->cond);
+    }
+    while (!barrier->released) {
+        pthread_cond_wait(&barrier->cond, &barrier->mutex);
+    }
+    pthread_mutex_unlock(&barrier->mutex);
+}
+
+int startup_wait_all(StartupBarrier *barrier, int timeout_ms) {
+    struct timespec deadline;
+    clock_gettime(CLOCK_MONOTONIC, &deadline);
+    deadline.tv_sec += timeout_ms / 1000;
+    deadline.tv_nsec += (long)(timeout_ms % 1000) * 1000000L;
+    if (deadline.tv_nsec >= 1000000000L) {
+        deadline.tv_sec++;
+        deadline.tv_nsec -= 1000000000L;
+    }
+
+    pthread_mutex_lock(&barrier->mutex);
+    while (barrier->ready < barrier->expected) {
+        int err = pthread_cond_timedwait(&barrier->cond, &barrier->mutex, &deadline);
+        if (err == ETIMEDOUT) {
+            break;
+        }
+    }
+    int ready = barrier->ready;
+    pthread_mutex_unlock(&barrier->mutex);
+    return ready;
+}
+
+void startup_release(StartupBarrier *barrier) {
+    pthread_mutex_lock(&barrier->mutex);
+    barrier->released = 1;
+    barrier->release_ns = startup_now_ns();
+    pthread_cond_broadcast(&barrier->cond);
+    pthread_mutex_unlock(&barrier->mutex);
+}
+
+void startup_print(const char *label, const StartupTimes *times) {
+    printf("STARTUP: %-10s", label);
+    for (int p = 0; p < NUM_STARTUP_PHASES; p++) {
+        if (times->phase_ns[p] == 0) {
+            printf("  %s       -", startup_phase_names[p]);
+        } else {
+            printf("  %s %7.2f", startup_phase_names[p], times->phase_ns[p] / 1e6);
+        }
+    }
+    printf(" ms\n");
+}
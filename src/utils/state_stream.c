@@ -0,0 +1,723 @@
+#include "state_stream.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <time.h>
+#include <unistd.h>
+#include "police.h"
+
+#define STREAM_RETRIES 3  // Copies of a gang that changed under us
+#define STREAM_DEFAULT_HZ 10
+
+/* ---- addresses ------------------------------------------------ */
+
+static int is_tcp(const char *address) {
+    return address[0] == ':';
+}
+
+static int stream_socket(const char *address, int listening) {
+    int fd;
+    if (is_tcp(address)) {
+        int port = atoi(address + 1);
+        if (port <= 0 || port > 65535) {
+            fprintf(stderr, "Bad stream port in %s\n", address);
+            return -1;
+        }
+        fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (fd == -1) {
+            perror("socket");
+            return -1;
+        }
+        struct sockaddr_in addr = {0};
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons((uint16_t)port);
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        int one = 1;
+        if (listening) {
+            setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+        } else {
+            setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        }
+        int rc = listening ? bind(fd, (struct sockaddr *)&addr, sizeof(addr))
+                           : connect(fd, (struct sockaddr *)&addr, sizeof(addr));
+        if (rc == -1) {
+            perror(listening ? "bind stream" : "connect stream");
+            close(fd);
+            return -1;
+        }
+    } else {
+        struct sockaddr_un addr = {0};
+        if (strlen(address) >= sizeof(addr.sun_path)) {
+            fprintf(stderr, "Stream socket path %s is too long\n", address);
+            return -1;
+        }
+        fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (fd == -1) {
+            perror("socket");
+            return -1;
+        }
+        addr.sun_family = AF_UNIX;
+        strcpy(addr.sun_path, address);
+        if (listening) {
+            unlink(address);
+        }
+        int rc = listening ? bind(fd, (struct sockaddr *)&addr, sizeof(addr))
+                           : connect(fd, (struct sockaddr *)&addr, sizeof(addr));
+        if (rc == -1) {
+            perror(listening ? "bind stream" : "connect stream");
+            close(fd);
+            return -1;
+        }
+    }
+    if (listening && listen(fd, STREAM_MAX_PEERS) == -1) {
+        perror("listen stream");
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+/* ---- publisher ------------------------------------------------ */
+
+// A flat block of state diffed in STREAM_BLOCK pieces
+typedef struct {
+    uint8_t *copy;
+    uint64_t *stamp;     // Frame each block last changed in
+    size_t size;
+    int blocks;
+} StreamBlob;
+
+static int blob_init(StreamBlob *blob, size_t size) {
+    blob->size = size;
+    blob->blocks = (int)((size + STREAM_BLOCK - 1) / STREAM_BLOCK);
+    blob->copy = calloc(1, size);
+    blob->stamp = calloc((size_t)blob->blocks, sizeof(uint64_t));
+    return blob->copy && blob->stamp ? 0 : -1;
+}
+
+static void blob_free(StreamBlob *blob) {
+    free(blob->copy);
+    free(blob->stamp);
+    memset(blob, 0, sizeof(*blob));
+}
+
+static size_t block_size(size_t size, int block) {
+    size_t left = size - (size_t)block * STREAM_BLOCK;
+    return left < STREAM_BLOCK ? left : STREAM_BLOCK;
+}
+
+static int blob_refresh(StreamBlob *blob, const void *live, uint64_t frame) {
+    int changed = 0;
+    for (int b = 0; b < blob->blocks; b++) {
+        size_t offset = (size_t)b * STREAM_BLOCK;
+        size_t size = block_size(blob->size, b);
+        if (blob->stamp[b] == 0 || memcmp(blob->copy + offset, (const uint8_t *)live + offset, size) != 0) {
+            memcpy(blob->copy + offset, (const uint8_t *)live + offset, size);
+            blob->stamp[b] = frame;
+            changed = 1;
+        }
+    }
+    return changed;
+}
+
+// Bytes the blocks changed since a frame take on the wire
+static size_t blob_delta(const StreamBlob *blob, uint64_t since, uint32_t *count) {
+    size_t bytes = 0;
+    *count = 0;
+    for (int b = 0; b < blob->blocks; b++) {
+        if (blob->stamp[b] > since) {
+            (*count)++;
+            bytes += sizeof(uint32_t) + block_size(blob->size, b);
+        }
+    }
+    return bytes;
+}
+
+typedef struct {
+    int fd;              // -1 when free
+    uint64_t acked;      // Frame the viewer holds (0: nothing yet)
+    uint64_t in_flight;  // Frame sent and not acknowledged (0: none)
+    uint8_t *out;
+    size_t out_len;
+    size_t out_off;
+    size_t out_capacity;
+    StreamHeader in;     // ACK being read
+    size_t in_len;
+} StreamPeer;
+
+static struct {
+    int listen_fd;
+    char address[108];
+    pthread_t thread;
+    volatile int stop;
+    const ShmPtrs *shm;
+    Config config;
+    int hz;
+
+    // Published copy of the state and the frame each piece last changed in
+    uint64_t frame;
+    StreamBlob game;
+    StreamBlob catalog;
+    StreamBlob police;
+    Gang *gangs;
+    uint64_t *gang_stamp;
+    Member *members;     // [max_gangs][gang_size_limit]
+    uint64_t *member_stamp;
+    Member *member_copy; // One gang, copied outside the published state
+    GangMapping *mappings;            // The thread's own mappings of the gangs
+    uint32_t directory_generation;
+
+    StreamPeer peers[STREAM_MAX_PEERS];
+    uint64_t frames_sent;
+    uint64_t bytes_sent;
+    int viewers;
+} pub = {.listen_fd = -1};
+
+// Copy whatever changed in shm into the published copy and stamp it
+static void publisher_refresh(void) {
+    const ShmPtrs *shm = pub.shm;
+    int max_size = pub.config.gang_size_limit;
+    uint64_t frame = pub.frame + 1;
+    int changed = 0;
+
+    changed |= blob_refresh(&pub.game, shm->shared_game, frame);
+    changed |= blob_refresh(&pub.catalog, shm->catalog, frame);
+    changed |= blob_refresh(&pub.police, shm->police.officers, frame);  // The police block starts with its officers
+
+    // Main remaps its own table on its own schedule, so this thread follows
+    // the directory with a table of its own; a remapped slot is copied again
+    const GangMapping *mappings = shm->mappings;
+    int remapped = 0;
+    if (shm->directory != NULL) {
+        remapped = gang_mappings_refresh(shm->directory, pub.mappings, &pub.directory_generation);
+        mappings = pub.mappings;
+    }
+
+    for (int g = 0; g < pub.config.max_gangs; g++) {
+        const Gang *live = &shm->gangs[g];
+        if (!remapped && pub.gang_stamp[g] != 0 && gang_version(live) == pub.gangs[g].version) {
+            continue;
+        }
+        Gang gang;
+        uint32_t version = gang_version(live);
+        // Only the members this thread has seen the segment grow to
+        const Member *members = mappings[g].members;
+        int count = __atomic_load_n(&live->max_member_count, __ATOMIC_ACQUIRE);
+        if (members == NULL || count < 0) count = 0;
+        if (count > (int)mappings[g].capacity) count = (int)mappings[g].capacity;
+        if (count > max_size) count = max_size;
+        memset(&pub.member_copy[count], 0, (size_t)(max_size - count) * sizeof(Member));
+        for (int attempt = 0; attempt < STREAM_RETRIES; attempt++) {
+            memcpy(&gang, live, sizeof(Gang));
+            if (count > 0) memcpy(pub.member_copy, members, (size_t)count * sizeof(Member));
+            uint32_t after = gang_version(live);
+            if (after == version) break;
+            version = after;
+        }
+        if (members == NULL) {
+            // A slot with no gang running shows as an empty one
+            memset(&gang, 0, sizeof(Gang));
+        }
+        gang.version = version;
+        pub.gangs[g] = gang;
+        pub.gang_stamp[g] = frame;
+        changed = 1;
+
+        // Only the members that differ are sent again
+        Member *published = &pub.members[(size_t)g * max_size];
+        for (int m = 0; m < max_size; m++) {
+            if (pub.member_stamp[(size_t)g * max_size + m] == 0 ||
+                memcmp(&published[m], &pub.member_copy[m], sizeof(Member)) != 0) {
+                published[m] = pub.member_copy[m];
+                pub.member_stamp[(size_t)g * max_size + m] = frame;
+            }
+        }
+    }
+
+    if (changed) {
+        pub.frame = frame;
+    }
+}
+
+static int peer_reserve(StreamPeer *peer, size_t extra) {
+    if (peer->out_len + extra <= peer->out_capacity) {
+        return 0;
+    }
+    size_t capacity = peer->out_capacity ? peer->out_capacity : 4096;
+    while (capacity < peer->out_len + extra) capacity *= 2;
+    uint8_t *out = realloc(peer->out, capacity);
+    if (out == NULL) {
+        fprintf(stderr, "STREAM: out of memory for a viewer's frame\n");
+        return -1;
+    }
+    peer->out = out;
+    peer->out_capacity = capacity;
+    return 0;
+}
+
+static void peer_put(StreamPeer *peer, const void *data, size_t size) {
+    memcpy(peer->out + peer->out_len, data, size);
+    peer->out_len += size;
+}
+
+static void peer_put_blob(StreamPeer *peer, const StreamBlob *blob, uint64_t since) {
+    for (int b = 0; b < blob->blocks; b++) {
+        if (blob->stamp[b] > since) {
+            uint32_t index = (uint32_t)b;
+            peer_put(peer, &index, sizeof(index));
+            peer_put(peer, blob->copy + (size_t)b * STREAM_BLOCK, block_size(blob->size, b));
+        }
+    }
+}
+
+static int peer_hello(StreamPeer *peer) {
+    size_t catalog_size = pub.shm->catalog->total_size;
+    StreamHello hello = {sizeof(Config), sizeof(Game), sizeof(Gang), sizeof(Member), catalog_size,
+                         pub.police.size};
+    StreamHeader header = {STREAM_MAGIC, STREAM_HELLO, STREAM_VERSION, 0, 0, 0};
+    header.size = (uint32_t)(sizeof(header) + sizeof(hello) + sizeof(Config) + catalog_size);
+    if (peer_reserve(peer, header.size) == -1) return -1;
+    peer_put(peer, &header, sizeof(header));
+    peer_put(peer, &hello, sizeof(hello));
+    peer_put(peer, &pub.config, sizeof(Config));
+    peer_put(peer, pub.shm->catalog, catalog_size);  // Names and shape; heat follows in frames
+    return 0;
+}
+
+// Queue everything stamped after the frame the viewer acknowledged
+static int peer_frame(StreamPeer *peer) {
+    uint64_t since = peer->acked;
+    int max_size = pub.config.gang_size_limit;
+
+    StreamFrame body = {0, 0, 0, 0};
+    size_t size = sizeof(StreamHeader) + sizeof(body);
+    size += blob_delta(&pub.game, since, &body.num_game_blocks);
+    size += blob_delta(&pub.catalog, since, &body.num_catalog_blocks);
+    size += blob_delta(&pub.police, since, &body.num_police_blocks);
+    for (int g = 0; g < pub.config.max_gangs; g++) {
+        if (pub.gang_stamp[g] <= since) continue;
+        body.num_gangs++;
+        size += sizeof(StreamGangRecord) + sizeof(Gang);
+        for (int m = 0; m < max_size; m++) {
+            if (pub.member_stamp[(size_t)g * max_size + m] > since) {
+                size += sizeof(uint32_t) + sizeof(Member);
+            }
+        }
+    }
+
+    StreamHeader header = {STREAM_MAGIC, STREAM_FRAME, STREAM_VERSION, (uint32_t)size, 0, pub.frame};
+    if (peer_reserve(peer, size) == -1) return -1;
+    peer_put(peer, &header, sizeof(header));
+    peer_put(peer, &body, sizeof(body));
+    peer_put_blob(peer, &pub.game, since);
+    peer_put_blob(peer, &pub.catalog, since);
+    peer_put_blob(peer, &pub.police, since);
+    for (int g = 0; g < pub.config.max_gangs; g++) {
+        if (pub.gang_stamp[g] <= since) continue;
+        StreamGangRecord record = {g, pub.gangs[g].version, 0, 0};
+        for (int m = 0; m < max_size; m++) {
+            record.num_members += pub.member_stamp[(size_t)g * max_size + m] > since;
+        }
+        peer_put(peer, &record, sizeof(record));
+        peer_put(peer, &pub.gangs[g], sizeof(Gang));
+        for (int m = 0; m < max_size; m++) {
+            if (pub.member_stamp[(size_t)g * max_size + m] > since) {
+                uint32_t index = (uint32_t)m;
+                peer_put(peer, &index, sizeof(index));
+                peer_put(peer, &pub.members[(size_t)g * max_size + m], sizeof(Member));
+            }
+        }
+    }
+    peer->in_flight = pub.frame;
+    pub.frames_sent++;
+    return 0;
+}
+
+static void peer_drop(StreamPeer *peer) {
+    close(peer->fd);
+    free(peer->out);
+    memset(peer, 0, sizeof(*peer));
+    peer->fd = -1;
+    pub.viewers--;
+    printf("STREAM: viewer disconnected (%d left)\n", pub.viewers);
+    fflush(stdout);
+}
+
+// Write as much of the pending output as the socket takes
+static int peer_flush(StreamPeer *peer) {
+    while (peer->out_off < peer->out_len) {
+        ssize_t n = send(peer->fd, peer->out + peer->out_off, peer->out_len - peer->out_off,
+                         MSG_NOSIGNAL | MSG_DONTWAIT);
+        if (n == -1) {
+            if (errno == EINTR) continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK) return 0;
+            return -1;
+        }
+        peer->out_off += (size_t)n;
+        pub.bytes_sent += (uint64_t)n;
+    }
+    peer->out_len = peer->out_off = 0;
+    return 0;
+}
+
+static int peer_read(StreamPeer *peer) {
+    for (;;) {
+        ssize_t n = recv(peer->fd, (uint8_t *)&peer->in + peer->in_len, sizeof(peer->in) - peer->in_len,
+                         MSG_DONTWAIT);
+        if (n == 0) return -1;
+        if (n == -1) {
+            if (errno == EINTR) continue;
+            return errno == EAGAIN || errno == EWOULDBLOCK ? 0 : -1;
+        }
+        peer->in_len += (size_t)n;
+        if (peer->in_len < sizeof(peer->in)) continue;
+        peer->in_len = 0;
+        if (peer->in.magic != STREAM_MAGIC || peer->in.type != STREAM_ACK) return -1;
+        if (peer->in.frame == peer->in_flight) {
+            peer->acked = peer->in_flight;
+            peer->in_flight = 0;
+        }
+    }
+}
+
+static void peer_accept(void) {
+    int fd = accept(pub.listen_fd, NULL, NULL);
+    if (fd == -1) {
+        if (errno != EINTR && errno != EAGAIN) perror("accept stream");
+        return;
+    }
+    fcntl(fd, F_SETFD, FD_CLOEXEC);
+    for (int i = 0; i < STREAM_MAX_PEERS; i++) {
+        StreamPeer *peer = &pub.peers[i];
+        if (peer->fd != -1) continue;
+        memset(peer, 0, sizeof(*peer));
+        peer->fd = fd;
+        if (peer_hello(peer) == -1) {
+            close(fd);
+            peer->fd = -1;
+            return;
+        }
+        pub.viewers++;
+        printf("STREAM: viewer connected (%d attached)\n", pub.viewers);
+        fflush(stdout);
+        return;
+    }
+    fprintf(stderr, "STREAM: turning a viewer away, %d are attached\n", STREAM_MAX_PEERS);
+    close(fd);
+}
+
+static uint64_t now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000 + (uint64_t)ts.tv_nsec / 1000000;
+}
+
+static void *publisher_thread(void *arg) {
+    (void)arg;
+    // The process's signals (clock, SIGINT) are for the main thread
+    sigset_t all;
+    sigfillset(&all);
+    pthread_sigmask(SIG_BLOCK, &all, NULL);
+
+    uint64_t period = 1000 / (uint64_t)(pub.hz > 0 ? pub.hz : STREAM_DEFAULT_HZ);
+    uint64_t next = now_ms();
+    while (!pub.stop) {
+        uint64_t now = now_ms();
+        if (now >= next) {
+            if (pub.viewers > 0) publisher_refresh();
+            next = now + period;
+        }
+
+        // Cut a frame for every viewer that is idle and behind
+        for (int i = 0; i < STREAM_MAX_PEERS; i++) {
+            StreamPeer *peer = &pub.peers[i];
+            if (peer->fd != -1 && peer->in_flight == 0 && peer->out_len == 0 && pub.frame > peer->acked) {
+                if (peer_frame(peer) == -1) peer_drop(peer);
+            }
+            if (peer->fd != -1 && peer->out_len > 0 && peer_flush(peer) == -1) peer_drop(peer);
+        }
+
+        struct pollfd fds[STREAM_MAX_PEERS + 1];
+        int slots[STREAM_MAX_PEERS + 1];
+        int n = 0;
+        fds[n] = (struct pollfd){pub.listen_fd, POLLIN, 0};
+        slots[n++] = -1;
+        for (int i = 0; i < STREAM_MAX_PEERS; i++) {
+            StreamPeer *peer = &pub.peers[i];
+            if (peer->fd == -1) continue;
+            fds[n] = (struct pollfd){peer->fd, (short)(POLLIN | (peer->out_len > 0 ? POLLOUT : 0)), 0};
+            slots[n++] = i;
+        }
+        now = now_ms();
+        int timeout = next > now ? (int)(next - now) : 0;
+        if (poll(fds, (nfds_t)n, timeout) <= 0) {
+            continue;  // Timeout, or a signal (main's alarm)
+        }
+        for (int k = 0; k < n; k++) {
+            if (fds[k].revents == 0) continue;
+            if (slots[k] == -1) {
+                peer_accept();
+                continue;
+            }
+            StreamPeer *peer = &pub.peers[slots[k]];
+            if ((fds[k].revents & (POLLERR | POLLHUP | POLLNVAL)) ||
+                ((fds[k].revents & POLLIN) && peer_read(peer) == -1) ||
+                ((fds[k].revents & POLLOUT) && peer_flush(peer) == -1)) {
+                peer_drop(peer);
+            }
+        }
+    }
+    return NULL;
+}
+
+int stream_publisher_start(const char *address, const ShmPtrs *shm, const Config *config, int hz) {
+    // Every gang slot is published, each at the size its gang may grow to
+    int n = config->max_gangs;
+    size_t members = (size_t)n * config->gang_size_limit;
+    pub.stop = 0;
+    pub.frame = 0;
+    pub.frames_sent = pub.bytes_sent = 0;
+    pub.viewers = 0;
+    pub.shm = shm;
+    pub.config = *config;
+    pub.hz = hz;
+    pub.gangs = calloc((size_t)n, sizeof(Gang));
+    pub.gang_stamp = calloc((size_t)n, sizeof(uint64_t));
+    pub.members = calloc(members, sizeof(Member));
+    pub.member_stamp = calloc(members, sizeof(uint64_t));
+    pub.member_copy = calloc((size_t)config->gang_size_limit, sizeof(Member));
+    pub.mappings = calloc((size_t)n, sizeof(GangMapping));
+    pub.directory_generation = 0;
+    if (blob_init(&pub.game, sizeof(Game)) == -1 || blob_init(&pub.catalog, shm->catalog->total_size) == -1 ||
+        blob_init(&pub.police, police_tables_size(n, config->max_agents_per_gang)) == -1 ||
+        !pub.gangs || !pub.gang_stamp || !pub.members || !pub.member_stamp || !pub.member_copy ||
+        !pub.mappings) {
+        fprintf(stderr, "Failed to allocate the stream state\n");
+        return -1;
+    }
+    for (int i = 0; i < STREAM_MAX_PEERS; i++) {
+        pub.peers[i].fd = -1;
+    }
+
+    pub.listen_fd = stream_socket(address, 1);
+    if (pub.listen_fd == -1) {
+        return -1;
+    }
+    snprintf(pub.address, sizeof(pub.address), "%s", address);
+    if (pthread_create(&pub.thread, NULL, publisher_thread, NULL) != 0) {
+        perror("pthread_create stream");
+        close(pub.listen_fd);
+        pub.listen_fd = -1;
+        return -1;
+    }
+    printf("STREAM: serving the game on %s\n", address);
+    fflush(stdout);
+    return 0;
+}
+
+void stream_publisher_stop(void) {
+    if (pub.listen_fd == -1) {
+        return;
+    }
+    pub.stop = 1;
+    pthread_join(pub.thread, NULL);
+    for (int i = 0; i < STREAM_MAX_PEERS; i++) {
+        if (pub.peers[i].fd != -1) {
+            close(pub.peers[i].fd);
+            free(pub.peers[i].out);
+        }
+    }
+    close(pub.listen_fd);
+    pub.listen_fd = -1;
+    if (!is_tcp(pub.address)) {
+        unlink(pub.address);
+    }
+    printf("STREAM: %llu frames, %llu bytes sent\n",
+           (unsigned long long)pub.frames_sent, (unsigned long long)pub.bytes_sent);
+    fflush(stdout);
+    blob_free(&pub.game);
+    blob_free(&pub.catalog);
+    blob_free(&pub.police);
+    free(pub.gangs);
+    free(pub.gang_stamp);
+    free(pub.members);
+    free(pub.member_stamp);
+    free(pub.member_copy);
+    if (pub.shm->directory != NULL) {
+        gang_mappings_release(pub.shm->directory, pub.mappings);
+    }
+    free(pub.mappings);
+}
+
+/* ---- viewer side ---------------------------------------------- */
+
+static int read_full(StreamClient *client, void *data, size_t size) {
+    size_t done = 0;
+    while (done < size) {
+        ssize_t n = recv(client->fd, (uint8_t *)data + done, size - done, 0);
+        if (n == 0) return -1;
+        if (n == -1) {
+            if (errno == EINTR) continue;
+            perror("Error reading the stream");
+            return -1;
+        }
+        done += (size_t)n;
+    }
+    client->bytes_read += size;
+    return 0;
+}
+
+// Read one whole message into the buffer
+static int read_message(StreamClient *client, StreamHeader *header) {
+    if (read_full(client, header, sizeof(*header)) == -1) return -1;
+    if (header->magic != STREAM_MAGIC || header->version != STREAM_VERSION || header->size < sizeof(*header)) {
+        fprintf(stderr, "Not a game stream, or a different version\n");
+        return -1;
+    }
+    size_t body = header->size - sizeof(*header);
+    if (body > client->capacity) {
+        uint8_t *buffer = realloc(client->buffer, body);
+        if (buffer == NULL) {
+            fprintf(stderr, "Failed to allocate %zu bytes for a stream frame\n", body);
+            return -1;
+        }
+        client->buffer = buffer;
+        client->capacity = body;
+    }
+    client->length = body;
+    return read_full(client, client->buffer, body);
+}
+
+int stream_connect(StreamClient *client, const char *address) {
+    memset(client, 0, sizeof(*client));
+    client->fd = stream_socket(address, 0);
+    if (client->fd == -1) {
+        return -1;
+    }
+
+    StreamHeader header;
+    if (read_message(client, &header) == -1 || header.type != STREAM_HELLO) {
+        stream_close(client);
+        return -1;
+    }
+    StreamHello hello;
+    memcpy(&hello, client->buffer, sizeof(hello));
+    if (hello.config_size != sizeof(Config) || hello.game_size != sizeof(Game) ||
+        hello.gang_size != sizeof(Gang) || hello.member_size != sizeof(Member)) {
+        fprintf(stderr, "The game on %s was built with a different layout\n", address);
+        stream_close(client);
+        return -1;
+    }
+    memcpy(&client->config, client->buffer + sizeof(hello), sizeof(Config));
+    client->catalog_size = (size_t)hello.catalog_size;
+    client->catalog = malloc(client->catalog_size);
+    client->police_size = (size_t)hello.police_size;
+    client->police = calloc(1, client->police_size + 1);
+    client->changed = malloc((size_t)(client->config.max_gangs > 0 ? client->config.max_gangs : 1) * sizeof(int));
+    if (hello.police_size != police_tables_size(client->config.max_gangs, client->config.max_agents_per_gang)) {
+        fprintf(stderr, "The game on %s sent police tables of an unexpected size\n", address);
+        stream_close(client);
+        return -1;
+    }
+    if (client->catalog == NULL || client->police == NULL || client->changed == NULL) {
+        fprintf(stderr, "Failed to allocate the stream mirror\n");
+        stream_close(client);
+        return -1;
+    }
+    memcpy(client->catalog, client->buffer + sizeof(hello) + sizeof(Config), client->catalog_size);
+    return 0;
+}
+
+int stream_next(StreamClient *client, int timeout_ms) {
+    struct pollfd pfd = {client->fd, POLLIN, 0};
+    int ready = poll(&pfd, 1, timeout_ms);
+    if (ready <= 0) {
+        return ready == -1 && errno != EINTR ? -1 : 0;
+    }
+    StreamHeader header;
+    if (read_message(client, &header) == -1 || header.type != STREAM_FRAME) {
+        return -1;
+    }
+    client->frame = header.frame;
+    return 1;
+}
+
+int stream_apply(StreamClient *client, Game *game, Gang *gangs, Member **gang_members, uint32_t *versions) {
+    const uint8_t *p = client->buffer;
+    const uint8_t *end = p + client->length;
+    int num_gangs = client->config.max_gangs;
+    int max_size = client->config.gang_size_limit;
+    StreamFrame body;
+
+#define TAKE(dst, size) do {                        \
+        if ((size_t)(end - p) < (size_t)(size)) goto malformed; \
+        memcpy((dst), p, (size));                   \
+        p += (size);                                \
+    } while (0)
+
+    TAKE(&body, sizeof(body));
+    uint32_t num_blocks = body.num_game_blocks + body.num_catalog_blocks + body.num_police_blocks;
+    for (uint32_t i = 0; i < num_blocks; i++) {
+        uint8_t *blob = (uint8_t *)game;
+        size_t blob_size = sizeof(Game);
+        if (i >= body.num_game_blocks + body.num_catalog_blocks) {
+            blob = client->police;
+            blob_size = client->police_size;
+        } else if (i >= body.num_game_blocks) {
+            blob = (uint8_t *)client->catalog;
+            blob_size = client->catalog_size;
+        }
+        uint32_t index;
+        TAKE(&index, sizeof(index));
+        if ((size_t)index * STREAM_BLOCK >= blob_size) goto malformed;
+        TAKE(blob + (size_t)index * STREAM_BLOCK, block_size(blob_size, (int)index));
+    }
+    client->num_changed = 0;
+    for (uint32_t i = 0; i < body.num_gangs; i++) {
+        StreamGangRecord record;
+        TAKE(&record, sizeof(record));
+        if (record.gang < 0 || record.gang >= num_gangs) goto malformed;
+        TAKE(&gangs[record.gang], sizeof(Gang));
+        for (uint32_t k = 0; k < record.num_members; k++) {
+            uint32_t index;
+            TAKE(&index, sizeof(index));
+            if (index >= (uint32_t)max_size) goto malformed;
+            TAKE(&gang_members[record.gang][index], sizeof(Member));
+        }
+        if (versions != NULL) versions[record.gang] = record.version;
+        if (client->num_changed < num_gangs) client->changed[client->num_changed++] = record.gang;
+    }
+#undef TAKE
+
+    StreamHeader ack = {STREAM_MAGIC, STREAM_ACK, STREAM_VERSION, sizeof(StreamHeader), 0, client->frame};
+    if (send(client->fd, &ack, sizeof(ack), MSG_NOSIGNAL) != (ssize_t)sizeof(ack)) {
+        perror("Error acknowledging a stream frame");
+        return -1;
+    }
+    return 0;
+
+malformed:
+    fprintf(stderr, "Malformed stream frame %llu\n", (unsigned long long)client->frame);
+    return -1;
+}
+
+void stream_close(StreamClient *client) {
+    if (client->fd != -1) {
+        close(client->fd);
+    }
+    free(client->catalog);
+    free(client->police);
+    free(client->buffer);
+    free(client->changed);
+    memset(client, 0, sizeof(*client));
+    client->fd = -1;
+}
@@ -0,0 +1,122 @@
+#include "target_catalog.h"
+#include <float.h>
+#include <stdio.h>
+#include <string.h>
+#include "random.h"
+
+#define FLOATS_PER_LINE (CATALOG_ALIGN / (int)sizeof(float))
+
+static size_t align_up(size_t value) {
+    return (value + CATALOG_ALIGN - 1) & ~(size_t)(CATALOG_ALIGN - 1);
+}
+
+static int heat_stride_for(int num_targets) {
+    return (num_targets + FLOATS_PER_LINE - 1) / FLOATS_PER_LINE * FLOATS_PER_LINE;
+}
+
+// Fill in the region offsets for a catalog of the given shape
+static void compute_offsets(TargetCatalog *layout, int num_targets, int num_attributes, int num_gangs) {
+    layout->num_targets = num_targets;
+    layout->num_attributes = num_attributes;
+    layout->num_gangs = num_gangs;
+    layout->heat_stride = heat_stride_for(num_targets);
+
+    size_t offset = align_up(sizeof(TargetCatalog));
+    layout->names_offset = offset;
+    offset = align_up(offset + (size_t)num_targets * CATALOG_NAME_LEN);
+    layout->attr_names_offset = offset;
+    offset = align_up(offset + (size_t)MAX_ATTRIBUTES * CATALOG_NAME_LEN);
+    layout->weights_offset = offset;
+    offset = align_up(offset + (size_t)num_targets * MAX_ATTRIBUTES * sizeof(float));
+    layout->target_heat_offset = offset;
+    offset = align_up(offset + (size_t)layout->heat_stride * sizeof(float));
+    layout->gang_heat_offset = offset;
+    offset = align_up(offset + (size_t)num_gangs * layout->heat_stride * sizeof(float));
+    layout->total_size = offset;
+}
+
+size_t target_catalog_size(int num_targets, int num_attributes, int num_gangs) {
+    TargetCatalog layout;
+    compute_offsets(&layout, num_targets, num_attributes, num_gangs);
+    return layout.total_size;
+}
+
+void target_catalog_init(TargetCatalog *catalog, int num_targets, int num_attributes, int num_gangs) {
+    TargetCatalog layout;
+    compute_offsets(&layout, num_targets, num_attributes, num_gangs);
+    memset(catalog, 0, layout.total_size);
+    *catalog = layout;
+}
+
+int target_catalog_copy(TargetCatalog *dst, const TargetCatalog *src) {
+    if (dst->num_targets != src->num_targets || dst->num_attributes != src->num_attributes ||
+        dst->num_gangs != src->num_gangs) {
+        fprintf(stderr, "Target catalog shape mismatch (%d/%d/%d vs %d/%d/%d)\n",
+                dst->num_targets, dst->num_attributes, dst->num_gangs,
+                src->num_targets, src->num_attributes, src->num_gangs);
+        return -1;
+    }
+    memcpy(dst, src, src->total_size);
+    return 0;
+}
+
+int catalog_find_target(const TargetCatalog *catalog, const char *name) {
+    for (int t = 0; t < catalog->num_targets; t++) {
+        if (strncmp(catalog_target_name(catalog, t), name, CATALOG_NAME_LEN) == 0) {
+            return t;
+        }
+    }
+    return -1;
+}
+
+float catalog_score(const TargetCatalog *catalog, int target, const float *attributes) {
+    // Unused attribute slots hold zero weight, so the full row can be summed
+    const float *weights = catalog_weights(catalog, target);
+    float score = 0.0f;
+    for (int a = 0; a < MAX_ATTRIBUTES; a++) {
+        score += weights[a] * attributes[a];
+    }
+    return score;
+}
+
+int catalog_select_target(const TargetCatalog *catalog, int gang_id, const float *attributes) {
+    const int n = catalog->num_targets;
+    if (n <= 0) {
+        return 0;
+    }
+
+    const float *target_heat = catalog_target_heat(catalog);
+    const float *gang_heat = catalog_gang_heat(catalog, gang_id);
+
+    // Pass 1: minimum heat over the whole row
+    float min_heat = FLT_MAX;
+    for (int t = 0; t < n; t++) {
+        float heat = target_heat[t] * gang_heat[t];
+        min_heat = heat < min_heat ? heat : min_heat;
+    }
+
+    // Pass 2: among the coolest targets keep the best fits (k is tiny, so an
+    // insertion into a sorted array beats a heap)
+    int best[TARGET_TOP_K];
+    float best_score[TARGET_TOP_K];
+    int found = 0;
+    for (int t = 0; t < n; t++) {
+        if (target_heat[t] * gang_heat[t] > min_heat) {
+            continue;
+        }
+        float score = catalog_score(catalog, t, attributes);
+        if (found == TARGET_TOP_K && score <= best_score[TARGET_TOP_K - 1]) {
+            continue;
+        }
+        int pos = found < TARGET_TOP_K ? found++ : TARGET_TOP_K - 1;
+        while (pos > 0 && best_score[pos - 1] < score) {
+            best[pos] = best[pos - 1];
+            best_score[pos] = best_score[pos - 1];
+            pos--;
+        }
+        best[pos] = t;
+        best_score[pos] = score;
+    }
+
+    return best[random_int(0, found - 1)];
+}
@@ -0,0 +1,225 @@
+#include "timer_wheel.h"
+#include <stddef.h>
+
+#define SLOT_MASK (TIMER_WHEEL_SLOTS - 1)
+#define WHEEL_SPAN (1ULL << (TIMER_WHEEL_BITS * TIMER_WHEEL_LEVELS))
+
+static uint64_t level_span(int level) {
+    return 1ULL << (TIMER_WHEEL_BITS * level);
+}
+
+static void list_init(TimerNode *head) {
+    head->next = head;
+    head->prev = head;
+}
+
+// Put a timer in the slot it is due in, relative to the wheel's now. One
+// due already goes in the current slot, which is fired next.
+static void place(TimerWheel *wheel, TimerNode *timer) {
+    uint64_t due = timer->expires;
+    if (due < wheel->now) {
+        due = wheel->now;
+    }
+    uint64_t delta = due - wheel->now;
+    if (delta >= WHEEL_SPAN) {
+        due = wheel->now + WHEEL_SPAN - 1;
+        delta = WHEEL_SPAN - 1;
+    }
+    int level = 0;
+    while (level < TIMER_WHEEL_LEVELS - 1 && delta >= level_span(level + 1)) {
+        level++;
+    }
+    int index = (int)((due >> (TIMER_WHEEL_BITS * level)) & SLOT_MASK);
+
+    TimerNode *head = &wheel->slots[level][index];
+    timer->prev = head->prev;
+    timer->next = head;
+    head->prev->next = timer;
+    head->prev = timer;
+    timer->slot = level * TIMER_WHEEL_SLOTS + index;
+    wheel->occupied[level] |= 1ULL << index;
+    wheel->num_pending++;
+}
+
+static void unlink_timer(TimerWheel *wheel, TimerNode *timer) {
+    timer->prev->next = timer->next;
+    timer->next->prev = timer->prev;
+    if (timer->slot >= 0) {
+        int level = timer->slot / TIMER_WHEEL_SLOTS;
+        int index = timer->slot & SLOT_MASK;
+        TimerNode *head = &wheel->slots[level][index];
+        if (head->next == head) {
+            wheel->occupied[level] &= ~(1ULL << index);
+        }
+    }
+    timer->next = NULL;
+    timer->prev = NULL;
+    wheel->num_pending--;
+}
+
+// Take a slot's timers onto a list of their own; they stay pending, and
+// cancellable, until they are taken off it
+static void detach_slot(TimerWheel *wheel, int level, int index, TimerNode *list) {
+    TimerNode *head = &wheel->slots[level][index];
+    list_init(list);
+    if (head->next == head) {
+        return;
+    }
+    list->next = head->next;
+    list->prev = head->prev;
+    list->next->prev = list;
+    list->prev->next = list;
+    list_init(head);
+    wheel->occupied[level] &= ~(1ULL << index);
+    for (TimerNode *timer = list->next; timer != list; timer = timer->next) {
+        timer->slot = -1;
+    }
+}
+
+static void cascade(TimerWheel *wheel, int level, int index) {
+    TimerNode list;
+    detach_slot(wheel, level, index, &list);
+    while (list.next != &list) {
+        TimerNode *timer = list.next;
+        unlink_timer(wheel, timer);
+        place(wheel, timer);
+    }
+}
+
+static int fire_slot(TimerWheel *wheel, int index) {
+    TimerNode list;
+    int fired = 0;
+    detach_slot(wheel, 0, index, &list);
+    // A callback can cancel a timer further down the list, so it is walked
+    // from the head each time
+    while (list.next != &list) {
+        TimerNode *timer = list.next;
+        unlink_timer(wheel, timer);
+        if (timer->expires > wheel->now) {
+            place(wheel, timer);  // Further out than the wheel reaches
+            continue;
+        }
+        timer->callback(timer, timer->arg);
+        fired++;
+    }
+    return fired;
+}
+
+void timer_wheel_init(TimerWheel *wheel, uint64_t now) {
+    wheel->now = now;
+    wheel->num_pending = 0;
+    for (int level = 0; level < TIMER_WHEEL_LEVELS; level++) {
+        wheel->occupied[level] = 0;
+        for (int index = 0; index < TIMER_WHEEL_SLOTS; index++) {
+            list_init(&wheel->slots[level][index]);
+        }
+    }
+}
+
+void timer_init(TimerNode *timer, TimerCallback callback, void *arg) {
+    timer->next = NULL;
+    timer->prev = NULL;
+    timer->expires = 0;
+    timer->slot = -1;
+    timer->callback = callback;
+    timer->arg = arg;
+}
+
+void timer_arm(TimerWheel *wheel, TimerNode *timer, uint64_t delay) {
+    if (timer_pending(timer)) {
+        unlink_timer(wheel, timer);
+    }
+    // The current slot has been fired already
+    timer->expires = wheel->now + (delay > 0 ? delay : 1);
+    place(wheel, timer);
+}
+
+bool timer_cancel(TimerWheel *wheel, TimerNode *timer) {
+    if (!timer_pending(timer)) {
+        return false;
+    }
+    unlink_timer(wheel, timer);
+    return true;
+}
+
+void timer_move(TimerWheel *wheel, TimerNode *dst, TimerNode *src) {
+    if (dst == src) {
+        return;
+    }
+    timer_cancel(wheel, dst);
+    if (!timer_pending(src)) {
+        return;
+    }
+    dst->next = src->next;
+    dst->prev = src->prev;
+    dst->expires = src->expires;
+    dst->slot = src->slot;
+    dst->prev->next = dst;
+    dst->next->prev = dst;
+    src->next = NULL;
+    src->prev = NULL;
+}
+
+uint64_t timer_wheel_next(const TimerWheel *wheel) {
+    uint64_t next = UINT64_MAX;
+    for (int level = 0; level < TIMER_WHEEL_LEVELS; level++) {
+        uint64_t occupied = wheel->occupied[level];
+        if (occupied == 0) {
+            continue;
+        }
+        // Nearest occupied slot after the current one, going round once;
+        // the current slot itself holds the next time round
+        uint64_t position = wheel->now >> (TIMER_WHEEL_BITS * level);
+        int current = (int)(position & SLOT_MASK);
+        int shift = (current + 1) & SLOT_MASK;
+        uint64_t rotated = shift == 0 ? occupied : (occupied >> shift) | (occupied << (TIMER_WHEEL_SLOTS - shift));
+        uint64_t ahead = (uint64_t)__builtin_ctzll(rotated) + 1;
+        uint64_t tick = (position + ahead) << (TIMER_WHEEL_BITS * level);
+        if (tick - wheel->now < next) {
+            next = tick - wheel->now;
+        }
+    }
+    return next;
+}
+
+int timer_wheel_advance(TimerWheel *wheel, uint64_t now) {
+    int fired = 0;
+    while (wheel->now < now) {
+        // Skip the ticks nothing happens on
+        uint64_t next = timer_wheel_next(wheel);
+        if (next == UINT64_MAX || next > now - wheel->now) {
+            wheel->now = now;
+            break;
+        }
+        wheel->now += next;
+
+        // Higher levels first, so what they hand down is cascaded on
+        for (int level = TIMER_WHEEL_LEVELS - 1; level > 0; level--) {
+            if ((wheel->now & (level_span(level) - 1)) == 0) {
+                cascade(wheel, level, (int)((wheel->now >> (TIMER_WHEEL_BITS * level)) & SLOT_MASK));
+            }
+        }
+        fired += fire_slot(wheel, (int)(wheel->now & SLOT_MASK));
+    }
+    return fired;
+}
+
+uint64_t timer_wheel_timeout(const TimerWheel *wheel, uint64_t max_ms) {
+    uint64_t wait = timer_wheel_next(wheel);
+    if (wait > max_ms) {
+        wait = max_ms;
+    }
+    uint64_t due = wheel->now + wait;
+    uint64_t now = timer_now_ms();
+    return due > now ? due - now : 0;
+}
+
+int timer_wheel_wait(TimerWheel *wheel, uint64_t max_ms) {
+    uint64_t ms = timer_wheel_timeout(wheel, max_ms);
+    if (ms > 0) {
+        // A signal cuts the sleep short; the caller looks around and waits again
+        struct timespec ts = {(time_t)(ms / 1000), (long)(ms % 1000) * 1000000L};
+        nanosleep(&ts, NULL);
+    }
+    return timer_wheel_advance(wheel, timer_now_ms());
+}
@@ -0,0 +1,393 @@
+#include "timeseries.h"
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t num_tables;
+} FileHeader;
+
+typedef struct {
+    char name[COLUMN_NAME_LEN];
+    uint32_t num_entities;
+    uint32_t num_columns;
+} TableHeader;
+
+static uint32_t zigzag(int32_t value) {
+    return ((uint32_t)value << 1) ^ (uint32_t)(value >> 31);
+}
+
+static int32_t unzigzag(uint32_t value) {
+    return (int32_t)(value >> 1) ^ -(int32_t)(value & 1);
+}
+
+// Difference of a value to the previous one of its series
+static uint32_t residual(uint32_t type, ColumnValue value, ColumnValue previous) {
+    if (type == COLUMN_FLOAT32) {
+        return value.u ^ previous.u;
+    }
+    return zigzag((int32_t)(value.u - previous.u));
+}
+
+static ColumnValue undo_residual(uint32_t type, uint32_t residual, ColumnValue previous) {
+    ColumnValue value;
+    if (type == COLUMN_FLOAT32) {
+        value.u = residual ^ previous.u;
+    } else {
+        value.u = previous.u + (uint32_t)unzigzag(residual);
+    }
+    return value;
+}
+
+static uint8_t *put_varint(uint8_t *out, uint32_t value) {
+    while (value >= 0x80) {
+        *out++ = (uint8_t)(value | 0x80);
+        value >>= 7;
+    }
+    *out++ = (uint8_t)value;
+    return out;
+}
+
+static const uint8_t *get_varint(const uint8_t *in, const uint8_t *end, uint32_t *value) {
+    uint32_t result = 0;
+    for (int shift = 0; shift < 35 && in < end; shift += 7) {
+        uint8_t byte = *in++;
+        result |= (uint32_t)(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0) {
+            *value = result;
+            return in;
+        }
+    }
+    return NULL;
+}
+
+// Varints, with a run of zeros written as a 0 byte and the run length - 1.
+// A non-zero varint never starts with a 0 byte, so the two can't be confused.
+static size_t encode_residuals(const uint32_t *residuals, size_t count, uint8_t *out) {
+    uint8_t *p = out;
+    for (size_t i = 0; i < count; ) {
+        if (residuals[i] != 0) {
+            p = put_varint(p, residuals[i++]);
+            continue;
+        }
+        size_t run = 1;
+        while (i + run < count && residuals[i + run] == 0) run++;
+        *p++ = 0;
+        p = put_varint(p, (uint32_t)(run - 1));
+        i += run;
+    }
+    return (size_t)(p - out);
+}
+
+static int decode_residuals(const uint8_t *in, size_t size, uint32_t *residuals, size_t count) {
+    const uint8_t *end = in + size;
+    for (size_t i = 0; i < count; ) {
+        if (in >= end) return -1;
+        if (*in == 0) {
+            uint32_t run;
+            in = get_varint(in + 1, end, &run);
+            if (in == NULL || i + run + 1 > count) return -1;
+            memset(residuals + i, 0, (run + 1) * sizeof(uint32_t));
+            i += run + 1;
+        } else {
+            in = get_varint(in, end, &residuals[i]);
+            if (in == NULL) return -1;
+            i++;
+        }
+    }
+    return in == end ? 0 : -1;
+}
+
+static size_t table_values(const TimeSeriesTable *table) {
+    return (size_t)table->num_columns * table->num_entities;
+}
+
+int timeseries_open(TimeSeriesWriter *writer, const char *path, const TimeSeriesTableDesc *tables,
+                    int num_tables, int chunk_samples) {
+    memset(writer, 0, sizeof(*writer));
+    if (num_tables < 1 || num_tables > TIMESERIES_MAX_TABLES) {
+        fprintf(stderr, "Time series needs 1 to %d tables\n", TIMESERIES_MAX_TABLES);
+        return -1;
+    }
+    writer->num_tables = num_tables;
+    writer->chunk_samples = chunk_samples > 0 ? chunk_samples : 1;
+
+    size_t largest = 0;
+    for (int t = 0; t < num_tables; t++) {
+        TimeSeriesTable *table = &writer->tables[t];
+        strncpy(table->name, tables[t].name, COLUMN_NAME_LEN - 1);
+        table->num_entities = tables[t].num_entities;
+        table->num_columns = tables[t].num_columns;
+        // Copy names through a zeroed table so the header is deterministic
+        table->columns = calloc(table->num_columns, sizeof(ColumnDesc));
+        table->buffer = calloc(table_values(table) * writer->chunk_samples + 1, sizeof(ColumnValue));
+        if (table->columns == NULL || table->buffer == NULL) {
+            fprintf(stderr, "Failed to allocate time series table %s\n", tables[t].name);
+            timeseries_close(writer);
+            return -1;
+        }
+        for (int c = 0; c < table->num_columns; c++) {
+            strncpy(table->columns[c].name, tables[t].columns[c].name, COLUMN_NAME_LEN - 1);
+            table->columns[c].type = tables[t].columns[c].type;
+        }
+        if (table_values(table) > largest) largest = table_values(table);
+    }
+
+    size_t max_residuals = (largest + 1) * writer->chunk_samples;
+    writer->times = calloc(writer->chunk_samples, sizeof(uint32_t));
+    writer->residuals = malloc(max_residuals * sizeof(uint32_t));
+    writer->scratch = malloc(max_residuals * 5);
+    if (writer->times == NULL || writer->residuals == NULL || writer->scratch == NULL) {
+        fprintf(stderr, "Failed to allocate time series buffers\n");
+        timeseries_close(writer);
+        return -1;
+    }
+
+    writer->file = fopen(path, "wb");
+    if (!writer->file) {
+        perror("Error creating time series file");
+        timeseries_close(writer);
+        return -1;
+    }
+
+    FileHeader header = {TIMESERIES_MAGIC, TIMESERIES_VERSION, (uint32_t)num_tables};
+    int ok = fwrite(&header, sizeof(header), 1, writer->file) == 1;
+    for (int t = 0; ok && t < num_tables; t++) {
+        const TimeSeriesTable *table = &writer->tables[t];
+        TableHeader table_header;
+        memset(&table_header, 0, sizeof(table_header));
+        memcpy(table_header.name, table->name, COLUMN_NAME_LEN);
+        table_header.num_entities = (uint32_t)table->num_entities;
+        table_header.num_columns = (uint32_t)table->num_columns;
+        ok = fwrite(&table_header, sizeof(table_header), 1, writer->file) == 1 &&
+             fwrite(table->columns, sizeof(ColumnDesc), table->num_columns, writer->file) == (size_t)table->num_columns;
+    }
+    if (!ok) {
+        perror("Error writing time series header");
+        timeseries_close(writer);
+        return -1;
+    }
+    writer->bytes_written = ftell(writer->file);
+    return fflush(writer->file) == 0 ? 0 : -1;
+}
+
+void timeseries_put(TimeSeriesWriter *writer, int table_index, int entity, const ColumnValue *row) {
+    TimeSeriesTable *table = &writer->tables[table_index];
+    size_t series = (size_t)entity;
+    for (int c = 0; c < table->num_columns; c++, series += table->num_entities) {
+        table->buffer[series * writer->chunk_samples + writer->samples] = row[c];
+    }
+}
+
+int timeseries_commit(TimeSeriesWriter *writer, uint32_t time_ms) {
+    writer->times[writer->samples++] = time_ms;
+    if (writer->samples == writer->chunk_samples) {
+        return timeseries_flush(writer);
+    }
+    return 0;
+}
+
+// Encode and write the buffered samples of one table
+static int write_chunk(TimeSeriesWriter *writer, int table_index) {
+    const TimeSeriesTable *table = &writer->tables[table_index];
+    const int samples = writer->samples;
+    uint32_t *r = writer->residuals;
+
+    uint32_t previous_time = 0;
+    for (int s = 0; s < samples; s++) {
+        *r++ = zigzag((int32_t)(writer->times[s] - previous_time));
+        previous_time = writer->times[s];
+    }
+    for (int c = 0; c < table->num_columns; c++) {
+        uint32_t type = table->columns[c].type;
+        for (int e = 0; e < table->num_entities; e++) {
+            const ColumnValue *series = table->buffer + ((size_t)c * table->num_entities + e) * writer->chunk_samples;
+            ColumnValue previous = {0};
+            for (int s = 0; s < samples; s++) {
+                *r++ = residual(type, series[s], previous);
+                previous = series[s];
+            }
+        }
+    }
+
+    size_t payload = encode_residuals(writer->residuals, (size_t)(r - writer->residuals), writer->scratch);
+    TimeSeriesChunk chunk;
+    memset(&chunk, 0, sizeof(chunk));
+    chunk.magic = TIMESERIES_CHUNK_MAGIC;
+    chunk.table = (uint16_t)table_index;
+    chunk.samples = (uint32_t)samples;
+    chunk.num_entities = (uint32_t)table->num_entities;
+    chunk.first_sample = writer->first_sample;
+    chunk.payload_size = (uint32_t)payload;
+    if (fwrite(&chunk, sizeof(chunk), 1, writer->file) != 1 ||
+        fwrite(writer->scratch, 1, payload, writer->file) != payload) {
+        perror("Error writing time series chunk");
+        return -1;
+    }
+    writer->bytes_written += sizeof(chunk) + payload;
+    return 0;
+}
+
+int timeseries_flush(TimeSeriesWriter *writer) {
+    if (writer->file == NULL) return -1;
+    if (writer->samples > 0) {
+        for (int t = 0; t < writer->num_tables; t++) {
+            if (write_chunk(writer, t) == -1) {
+                return -1;
+            }
+        }
+        writer->first_sample += writer->samples;
+        writer->samples = 0;
+    }
+    return fflush(writer->file) == 0 ? 0 : -1;
+}
+
+int timeseries_close(TimeSeriesWriter *writer) {
+    int result = 0;
+    if (writer->file) {
+        result = timeseries_flush(writer);
+        fclose(writer->file);
+    }
+    for (int t = 0; t < writer->num_tables; t++) {
+        free(writer->tables[t].columns);
+        free(writer->tables[t].buffer);
+    }
+    free(writer->times);
+    free(writer->residuals);
+    free(writer->scratch);
+    memset(writer, 0, sizeof(*writer));
+    return result;
+}
+
+int timeseries_find_table(const TimeSeriesReader *reader, const char *name) {
+    for (int t = 0; t < reader->num_tables; t++) {
+        if (strncmp(reader->tables[t].name, name, COLUMN_NAME_LEN) == 0) return t;
+    }
+    return -1;
+}
+
+int timeseries_reader_open(TimeSeriesReader *reader, const char *path) {
+    memset(reader, 0, sizeof(*reader));
+    reader->file = fopen(path, "rb");
+    if (!reader->file) {
+        return -1;
+    }
+
+    FileHeader header;
+    if (fread(&header, sizeof(header), 1, reader->file) != 1 || header.magic != TIMESERIES_MAGIC ||
+        header.version != TIMESERIES_VERSION || header.num_tables == 0 ||
+        header.num_tables > TIMESERIES_MAX_TABLES) {
+        fprintf(stderr, "Time series file %s has a bad header\n", path);
+        timeseries_reader_close(reader);
+        return -1;
+    }
+    for (uint32_t t = 0; t < header.num_tables; t++) {
+        TableHeader table_header;
+        TimeSeriesTable *table = &reader->tables[t];
+        if (fread(&table_header, sizeof(table_header), 1, reader->file) != 1 ||
+            table_header.num_columns == 0 || table_header.num_columns > 4096) {
+            fprintf(stderr, "Time series file %s has a bad table header\n", path);
+            timeseries_reader_close(reader);
+            return -1;
+        }
+        reader->num_tables = (int)t + 1;
+        memcpy(table->name, table_header.name, COLUMN_NAME_LEN);
+        table->name[COLUMN_NAME_LEN - 1] = '\0';
+        table->num_entities = (int)table_header.num_entities;
+        table->num_columns = (int)table_header.num_columns;
+        table->columns = malloc(table->num_columns * sizeof(ColumnDesc));
+        if (table->columns == NULL ||
+            fread(table->columns, sizeof(ColumnDesc), table->num_columns, reader->file) != (size_t)table->num_columns) {
+            fprintf(stderr, "Time series file %s has a bad table header\n", path);
+            timeseries_reader_close(reader);
+            return -1;
+        }
+    }
+    return 0;
+}
+
+// Grow a buffer to hold at least count elements of size bytes
+static int reserve(void **buffer, size_t *capacity, size_t count, size_t size) {
+    if (count <= *capacity) return 0;
+    void *grown = realloc(*buffer, count * size);
+    if (grown == NULL) {
+        fprintf(stderr, "Failed to allocate a time series chunk\n");
+        return -1;
+    }
+    *buffer = grown;
+    *capacity = count;
+    return 0;
+}
+
+int timeseries_reader_next(TimeSeriesReader *reader) {
+    TimeSeriesChunk chunk;
+    reader->samples = 0;
+    if (fread(&chunk, sizeof(chunk), 1, reader->file) != 1 || chunk.magic != TIMESERIES_CHUNK_MAGIC ||
+        chunk.table >= reader->num_tables || chunk.samples == 0 ||
+        (int)chunk.num_entities != reader->tables[chunk.table].num_entities) {
+        return 0;
+    }
+    const TimeSeriesTable *table = &reader->tables[chunk.table];
+
+    if (reserve((void **)&reader->payload, &reader->payload_capacity, chunk.payload_size, 1) == -1) {
+        return 0;
+    }
+    if (fread(reader->payload, 1, chunk.payload_size, reader->file) != chunk.payload_size) {
+        return 0;  // cut off at the end of the file
+    }
+
+    // Residuals are decoded in place at the end of the value buffer, which
+    // then holds the values column by column
+    size_t values = table_values(table) * chunk.samples;
+    size_t count = values + chunk.samples;
+    if (reserve((void **)&reader->data, &reader->data_capacity, count, sizeof(ColumnValue)) == -1) {
+        return 0;
+    }
+    free(reader->times);
+    reader->times = malloc(chunk.samples * sizeof(uint32_t));
+    if (reader->times == NULL) {
+        return 0;
+    }
+    uint32_t *residuals = (uint32_t *)reader->data;
+    if (decode_residuals(reader->payload, chunk.payload_size, residuals, count) == -1) {
+        fprintf(stderr, "Time series chunk %llu of table %s is corrupt\n",
+                (unsigned long long)chunk.first_sample, table->name);
+        return 0;
+    }
+
+    uint32_t time = 0;
+    for (uint32_t s = 0; s < chunk.samples; s++) {
+        time += (uint32_t)unzigzag(residuals[s]);
+        reader->times[s] = time;
+    }
+    // Every value lands one sample-run before its residual, so the shift
+    // never overwrites a residual that is still needed
+    for (int c = 0; c < table->num_columns; c++) {
+        uint32_t type = table->columns[c].type;
+        for (int e = 0; e < table->num_entities; e++) {
+            size_t base = ((size_t)c * table->num_entities + e) * chunk.samples;
+            ColumnValue previous = {0};
+            for (uint32_t s = 0; s < chunk.samples; s++) {
+                previous = undo_residual(type, residuals[chunk.samples + base + s], previous);
+                reader->data[base + s] = previous;
+            }
+        }
+    }
+
+    reader->table = chunk.table;
+    reader->samples = (int)chunk.samples;
+    reader->first_sample = chunk.first_sample;
+    return reader->samples;
+}
+
+void timeseries_reader_close(TimeSeriesReader *reader) {
+    if (reader->file) fclose(reader->file);
+    for (int t = 0; t < reader->num_tables; t++) {
+        free(reader->tables[t].columns);
+    }
+    free(reader->times);
+    free(reader->data);
+    free(reader->payload);
+    memset(reader, 0, sizeof(*reader));
+}
@@ -0,0 +1,88 @@
+#include <gtest/gtest.h>
+#include "agent_mailbox.h"
+#include <atomic>
+#include <thread>
+
+class AgentMailboxTest : public ::testing::Test {
+protected:
+    AgentMailbox row[3]{};
+
+    void SetUp() override {
+        for (auto &box : row) {
+            agent_mailbox_clear(&box);
+        }
+    }
+};
+
+// Only the newest report is kept, and the reader tells it from the last one
+TEST_F(AgentMailboxTest, LatestReportWins) {
+    int slot = agent_mailbox_find(row, 3, AGENT_MAILBOX_FREE);
+    ASSERT_EQ(slot, 0);
+    agent_mailbox_claim(&row[slot], 42);
+    EXPECT_EQ(agent_mailbox_find(row, 3, 42), 0);
+    EXPECT_EQ(agent_mailbox_find(row, 3, AGENT_MAILBOX_FREE), 1);
+
+    AgentReport report;
+    ASSERT_EQ(agent_mailbox_read(&row[0], &report), 0);
+    EXPECT_EQ(report.agent_id, 42);
+    EXPECT_EQ(report.game_time, -1);  // Nothing reported yet
+    uint32_t seen = report.sequence;
+
+    agent_mailbox_post(&row[0], 0.2f, 5, 0);
+    uint32_t raised = agent_mailbox_now_us();
+    agent_mailbox_post(&row[0], 0.9f, 7, raised);
+    ASSERT_EQ(agent_mailbox_read(&row[0], &report), 0);
+    EXPECT_NE(report.sequence, seen);
+    EXPECT_EQ(report.agent_id, 42);
+    EXPECT_FLOAT_EQ(report.knowledge, 0.9f);
+    EXPECT_EQ(report.game_time, 7);
+    EXPECT_EQ(report.raised_us, raised);
+    EXPECT_NE(raised, 0u);
+
+    // A routine report after an alert is no longer urgent
+    agent_mailbox_post(&row[0], 0.3f, 8, 0);
+    ASSERT_EQ(agent_mailbox_read(&row[0], &report), 0);
+    EXPECT_EQ(report.raised_us, 0u);
+
+    // Nothing new until the next post
+    seen = report.sequence;
+    ASSERT_EQ(agent_mailbox_read(&row[0], &report), 0);
+    EXPECT_EQ(report.sequence, seen);
+
+    agent_mailbox_clear(&row[0]);
+    EXPECT_EQ(agent_mailbox_find(row, 3, 42), -1);
+    EXPECT_EQ(agent_mailbox_find(row, 3, AGENT_MAILBOX_FREE), 0);
+}
+
+// A slot left in the middle of a write isn't read forever
+TEST_F(AgentMailboxTest, AbandonedWrite) {
+    agent_mailbox_claim(&row[1], 7);
+    row[1].sequence |= 1u;
+    AgentReport report;
+    EXPECT_EQ(agent_mailbox_read(&row[1], &report), -1);
+}
+
+// A reader racing the writer only ever sees whole reports
+TEST_F(AgentMailboxTest, ConcurrentReadsAreConsistent) {
+    agent_mailbox_claim(&row[2], 9);
+    std::atomic<bool> done{false};
+    std::thread writer([&] {
+        for (int i = 1; i <= 20000; i++) {
+            agent_mailbox_post(&row[2], (float)i, i, (uint32_t)i);
+        }
+        done = true;
+    });
+    int last = -1;
+    while (!done) {
+        AgentReport report;
+        if (agent_mailbox_read(&row[2], &report) == 0) {
+            if (report.game_time >= 0) {
+                ASSERT_EQ((float)report.game_time, report.knowledge);
+                ASSERT_EQ((uint32_t)report.game_time, report.raised_us);
+            }
+            ASSERT_GE(report.game_time, last);
+            last = report.game_time;
+        }
+    }
+    writer.join();
+}
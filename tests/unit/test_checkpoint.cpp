@@ -0,0 +1,123 @@
+#include <gtest/gtest.h>
+#include <unistd.h>
+#include "checkpoint.h"
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+class CheckpointTest : public ::testing::Test {
+protected:
+    const char* test_path = "test_state.ckpt";
+
+    void SetUp() override {
+        std::remove(test_path);
+    }
+
+    void TearDown() override {
+        std::remove(test_path);
+    }
+};
+
+// The segment comes back byte for byte from a page-aligned section
+TEST_F(CheckpointTest, WriteAndOpen) {
+    std::vector<unsigned char> shm(10000);
+    for (size_t i = 0; i < shm.size(); i++) shm[i] = (unsigned char)(i * 7);
+
+    long size = checkpoint_write(test_path, shm.data(), shm.size(), nullptr, 0, 100, 200, 300, nullptr, 0);
+    ASSERT_GT(size, 0);
+
+    CheckpointImage image;
+    ASSERT_EQ(checkpoint_open(&image, test_path, 100, 200, 300), 0);
+    EXPECT_EQ(image.header->shm_size, shm.size());
+    EXPECT_EQ(image.header->shm_offset % CHECKPOINT_ALIGN, 0u);
+    EXPECT_EQ(image.header->message_count, 0u);
+    EXPECT_EQ(std::memcmp(image.shm, shm.data(), shm.size()), 0);
+    checkpoint_close(&image);
+}
+
+// Member segments come back per slot; empty slots stay empty
+TEST_F(CheckpointTest, Segments) {
+    std::vector<unsigned char> shm(100, 3);
+    std::vector<unsigned char> first(5000), third(300);
+    for (size_t i = 0; i < first.size(); i++) first[i] = (unsigned char)(i * 3);
+    for (size_t i = 0; i < third.size(); i++) third[i] = (unsigned char)(i + 1);
+    CheckpointSegment segments[3] = {{first.data(), first.size()}, {nullptr, 0}, {third.data(), third.size()}};
+    ASSERT_GT(checkpoint_write(test_path, shm.data(), shm.size(), segments, 3, 100, 200, 300, nullptr, 0), 0);
+
+    CheckpointImage image;
+    ASSERT_EQ(checkpoint_open(&image, test_path, 100, 200, 300), 0);
+    EXPECT_EQ(image.header->segment_count, 3u);
+    size_t size;
+    const void *data = checkpoint_segment(&image, 0, &size);
+    ASSERT_EQ(size, first.size());
+    EXPECT_EQ(std::memcmp(data, first.data(), size), 0);
+    EXPECT_EQ(checkpoint_segment(&image, 1, &size), nullptr);
+    EXPECT_EQ(size, 0u);
+    data = checkpoint_segment(&image, 2, &size);
+    ASSERT_EQ(size, third.size());
+    EXPECT_EQ(std::memcmp(data, third.data(), size), 0);
+    EXPECT_EQ(checkpoint_segment(&image, 3, &size), nullptr);
+    checkpoint_close(&image);
+}
+
+// A build with a different state layout refuses the file
+TEST_F(CheckpointTest, LayoutMismatch) {
+    std::vector<unsigned char> shm(64, 1);
+    ASSERT_GT(checkpoint_write(test_path, shm.data(), shm.size(), nullptr, 0, 100, 200, 300, nullptr, 0), 0);
+
+    CheckpointImage image;
+    EXPECT_EQ(checkpoint_open(&image, test_path, 100, 200, 301), -1);
+}
+
+// Cutting the file short is detected
+TEST_F(CheckpointTest, Truncated) {
+    std::vector<unsigned char> shm(10000, 1);
+    ASSERT_GT(checkpoint_write(test_path, shm.data(), shm.size(), nullptr, 0, 100, 200, 300, nullptr, 0), 0);
+    ASSERT_EQ(truncate(test_path, 5000), 0);
+
+    CheckpointImage image;
+    EXPECT_EQ(checkpoint_open(&image, test_path, 100, 200, 300), -1);
+}
+
+// Pending messages go back on the queue of the gang slot they were saved from
+TEST_F(CheckpointTest, MessagesKeepTheirQueue) {
+    int saved[3] = {create_private_queue(0), -1, create_private_queue(0)};
+    ASSERT_NE(saved[0], -1);
+    ASSERT_NE(saved[2], -1);
+    Message first = {}, second = {}, third = {};
+    first.mtype = 1; first.MessageContent.agent_id = 10;
+    second.mtype = 1; second.MessageContent.agent_id = 11;
+    third.mtype = 2; third.MessageContent.agent_id = 20;
+    ASSERT_EQ(send_message(saved[0], &first), 0);
+    ASSERT_EQ(send_message(saved[0], &second), 0);
+    ASSERT_EQ(send_message(saved[2], &third), 0);
+
+    std::vector<unsigned char> shm(64, 1);
+    ASSERT_GT(checkpoint_write(test_path, shm.data(), shm.size(), nullptr, 0, 100, 200, 300, saved, 3), 0);
+
+    // Writing left the messages where they were
+    uint32_t messages, bytes;
+    ASSERT_EQ(message_queue_depth(saved[0], &messages, &bytes), 0);
+    EXPECT_EQ(messages, 2u);
+    EXPECT_EQ(bytes, 2 * (uint32_t)(MESSAGE_SIZE));
+
+    int fresh[3] = {create_private_queue(0), create_private_queue(0), create_private_queue(0)};
+    CheckpointImage image;
+    ASSERT_EQ(checkpoint_open(&image, test_path, 100, 200, 300), 0);
+    EXPECT_EQ(image.header->message_count, 3u);
+    ASSERT_EQ(checkpoint_requeue(&image, fresh, 3), 0);
+    checkpoint_close(&image);
+
+    Message msg;
+    ASSERT_EQ(receive_message_nonblocking(fresh[0], &msg, 0), 0);
+    EXPECT_EQ(msg.MessageContent.agent_id, 10);
+    ASSERT_EQ(receive_message_nonblocking(fresh[0], &msg, 0), 0);
+    EXPECT_EQ(msg.MessageContent.agent_id, 11);
+    EXPECT_EQ(receive_message_nonblocking(fresh[1], &msg, 0), -1);
+    ASSERT_EQ(receive_message_nonblocking(fresh[2], &msg, 0), 0);
+    EXPECT_EQ(msg.MessageContent.agent_id, 20);
+
+    for (int id : {saved[0], saved[2], fresh[0], fresh[1], fresh[2]}) {
+        delete_message_queue(id);
+    }
+}
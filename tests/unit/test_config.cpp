@@ -112,6 +112,17 @@ TEST_F(ConfigTest, LoadValidConfigFile) {
     EXPECT_EQ(config.min_prison_period, 3);
     EXPECT_EQ(config.max_prison_period, 10);
     EXPECT_FLOAT_EQ(config.knowledge_threshold, 0.5f);
+    // Optional keys missing from the file keep their defaults
+    EXPECT_EQ(config.viewer_snapshot_hz, 10);
+    EXPECT_EQ(config.shm_huge_pages, SHM_PAGES_DEFAULT);
+    EXPECT_EQ(config.shm_prefault, 1);
+    EXPECT_EQ(config.shm_lock, 0);
+    EXPECT_EQ(config.gang_size_limit, 0);
+    EXPECT_EQ(config.active_gangs, 0);
+    EXPECT_EQ(config.recruits_per_success, 0);
+    EXPECT_EQ(config.police_departments, 0);
+    EXPECT_EQ(config.active_departments, 0);
+    EXPECT_EQ(config.gang_queue_bytes, 0);
 
 }
 
@@ -276,4 +287,63 @@ TEST_F(ConfigTest, CommentsAndEmptyLines) {
     EXPECT_EQ(result, -1);
     EXPECT_EQ(config.max_thwarted_plans, 3);
     EXPECT_EQ(config.max_successful_plans, 3);
-}
\ No newline at end of file
+}
+
+// Test publishing and reading the shared config block
+TEST_F(ConfigTest, ConfigBlockRoundTrip) {
+    ConfigBlock block{};
+    Config out{};
+
+    // Nothing published yet
+    EXPECT_EQ(config_block_read(&block, &out, nullptr), -1);
+
+    config.num_gangs = 5;
+    config.suspicion_threshold = 0.75f;
+    config.random_seed = 123456789u;
+    config_block_publish(&block, &config);
+
+    uint32_t generation = 0;
+    ASSERT_EQ(config_block_read(&block, &out, &generation), 0);
+    EXPECT_EQ(memcmp(&out, &config, sizeof(Config)), 0);
+    EXPECT_EQ(generation, config_block_generation(&block));
+
+    // A new publish is visible as a new generation
+    config.num_gangs = 6;
+    config_block_publish(&block, &config);
+    EXPECT_NE(config_block_generation(&block), generation);
+    ASSERT_EQ(config_block_read(&block, &out, nullptr), 0);
+    EXPECT_EQ(out.num_gangs, 6);
+
+    // Corruption is caught by the checksum
+    block.config.max_gang_size ^= 1;
+    EXPECT_EQ(config_block_read(&block, &out, nullptr), -1);
+}
+
+// Test that a refresh only takes over the reloadable parameters
+TEST_F(ConfigTest, ConfigRefreshKeepsLayoutFields) {
+    ConfigBlock block{};
+    config.num_gangs = 4;
+    config.max_gang_size = 10;
+    config.suspicion_threshold = 0.5f;
+    config_block_publish(&block, &config);
+
+    Config local = config;
+    uint32_t generation = config_block_generation(&block);
+    EXPECT_EQ(config_refresh(&block, &local, &generation), 0);
+
+    config.num_gangs = 9;
+    config.max_gang_size = 20;
+    config.suspicion_threshold = 0.9f;
+    config.active_gangs = 7;
+    config.active_departments = 2;
+    config_block_publish(&block, &config);
+
+    EXPECT_EQ(config_refresh(&block, &local, &generation), 1);
+    EXPECT_EQ(generation, config_block_generation(&block));
+    EXPECT_FLOAT_EQ(local.suspicion_threshold, 0.9f);
+    EXPECT_EQ(local.active_gangs, 7);
+    EXPECT_EQ(local.active_departments, 2);
+    EXPECT_EQ(local.num_gangs, 4);
+    EXPECT_EQ(local.max_gang_size, 10);
+    EXPECT_EQ(config_refresh(&block, &local, &generation), 0);
+}
@@ -0,0 +1,88 @@
+#include <gtest/gtest.h>
+#include "gang_directory.h"
+#include "instance.h"
+#include <cstdlib>
+#include <vector>
+
+class GangDirectoryTest : public ::testing::Test {
+protected:
+    static constexpr int kSlots = 3;
+    static constexpr int kLimit = 64;
+    std::vector<unsigned char> block = std::vector<unsigned char>(gang_directory_size(kSlots));
+    GangDirectory* directory = nullptr;
+    GangMapping mappings[kSlots]{};
+    uint32_t generation = 0;
+
+    void SetUp() override {
+        // Segments of an instance of its own, clear of any game running here
+        setenv(INSTANCE_ENV, "32101", 1);
+        directory = reinterpret_cast<GangDirectory*>(block.data());
+        gang_directory_init(directory, kSlots, kLimit);
+    }
+
+    void TearDown() override {
+        gang_mappings_release(directory, mappings);
+        for (int s = 0; s < kSlots; s++) {
+            gang_segment_retire(directory, s);
+        }
+    }
+};
+
+TEST_F(GangDirectoryTest, CreateMapsAndGrowsInPlace) {
+    ASSERT_EQ(gang_segment_create(directory, 1, 4, 0), 0);
+    EXPECT_TRUE(gang_slot_active(directory, 1));
+    EXPECT_FALSE(gang_slot_active(directory, 0));
+    EXPECT_EQ(directory->num_active, 1u);
+    EXPECT_EQ(directory->slots[1].incarnation, 1u);
+
+    ASSERT_EQ(gang_mappings_refresh(directory, mappings, &generation), 1);
+    ASSERT_NE(mappings[1].members, nullptr);
+    EXPECT_EQ(mappings[0].members, nullptr);
+    EXPECT_EQ(mappings[1].capacity, 4u);
+    Member* members = mappings[1].members;
+    members[3].member_id = 3;
+    EXPECT_EQ(gang_mappings_refresh(directory, mappings, &generation), 0);
+
+    // Growing moves nothing and leaves what was written in place
+    EXPECT_EQ(gang_segment_grow(directory, 1, 16), 16);
+    EXPECT_EQ(gang_mappings_refresh(directory, mappings, &generation), 1);
+    EXPECT_EQ(mappings[1].members, members);
+    EXPECT_EQ(mappings[1].capacity, 16u);
+    EXPECT_EQ(members[3].member_id, 3);
+    members[15].member_id = 15;
+
+    // Never past the limit, never smaller
+    EXPECT_EQ(gang_segment_grow(directory, 1, 1000), kLimit);
+    EXPECT_EQ(gang_segment_grow(directory, 1, 8), kLimit);
+    EXPECT_EQ(gang_segment_create(directory, 2, kLimit + 1, 0), -1);
+    EXPECT_EQ(gang_segment_create(directory, 1, 4, 0), -1);
+}
+
+TEST_F(GangDirectoryTest, RespawnIsANewIncarnation) {
+    ASSERT_EQ(gang_segment_create(directory, 0, 2, 0), 0);
+    ASSERT_EQ(gang_mappings_refresh(directory, mappings, &generation), 1);
+    mappings[0].members[0].member_id = 7;
+
+    gang_segment_retire(directory, 0);
+    EXPECT_FALSE(gang_slot_active(directory, 0));
+    EXPECT_EQ(directory->num_active, 0u);
+    EXPECT_EQ(gang_segment_grow(directory, 0, 4), -1);
+    ASSERT_EQ(gang_mappings_refresh(directory, mappings, &generation), 1);
+    EXPECT_EQ(mappings[0].members, nullptr);
+
+    // The slot comes back empty, on a segment of its own
+    ASSERT_EQ(gang_segment_create(directory, 0, 2, 0), 0);
+    EXPECT_EQ(directory->slots[0].incarnation, 2u);
+    ASSERT_EQ(gang_mappings_refresh(directory, mappings, &generation), 1);
+    ASSERT_NE(mappings[0].members, nullptr);
+    EXPECT_EQ(mappings[0].incarnation, 2u);
+    EXPECT_EQ(mappings[0].members[0].member_id, 0);
+}
+
+TEST_F(GangDirectoryTest, RestoreRecreatesTheSavedIncarnation) {
+    ASSERT_EQ(gang_segment_create(directory, 2, 3, 5), 0);
+    EXPECT_EQ(directory->slots[2].incarnation, 5u);
+    ASSERT_EQ(gang_mappings_refresh(directory, mappings, &generation), 1);
+    EXPECT_EQ(mappings[2].incarnation, 5u);
+    EXPECT_EQ(mappings[2].capacity, 3u);
+}
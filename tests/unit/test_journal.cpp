@@ -0,0 +1,91 @@
+#include <gtest/gtest.h>
+#include "journal.h"
+#include <cstdio>
+#include <cstring>
+#include <unistd.h>
+
+class JournalTest : public ::testing::Test {
+protected:
+    const char* test_path = "test_journal.ocfj";
+    uint64_t seq = 0;
+    int clock = 0;
+
+    void SetUp() override {
+        std::remove(test_path);
+    }
+
+    void TearDown() override {
+        journal_close();
+        std::remove(test_path);
+    }
+
+    void appendRelease(int gang_id) {
+        JournalRelease release = {gang_id, 0};
+        ASSERT_EQ(journal_append(JOURNAL_RELEASE, JOURNAL_SOURCE_POLICE, &release, sizeof(release), NULL, 0), 0);
+    }
+};
+
+TEST_F(JournalTest, RecordsComeBackInSequenceOrder) {
+    ASSERT_EQ(journal_create(test_path, &seq, &clock), 0);
+    EXPECT_STREQ(getenv(JOURNAL_ENV), test_path);
+
+    // Another process took the earlier numbers but wrote later
+    seq = 5;
+    clock = 3;
+    appendRelease(1);
+    seq = 2;
+    appendRelease(0);
+    const char name[] = "odd-sized";
+    ASSERT_EQ(journal_append(JOURNAL_CONFIG, JOURNAL_SOURCE_MAIN, name, sizeof(name), NULL, 0), 0);
+    journal_close();
+
+    JournalReader reader;
+    ASSERT_EQ(journal_read(&reader, test_path), 0);
+    ASSERT_EQ(reader.count, 3u);
+    EXPECT_EQ(reader.dropped_bytes, 0u);
+    EXPECT_EQ(reader.records[0]->seq, 2u);
+    EXPECT_EQ(reader.records[1]->seq, 3u);
+    EXPECT_EQ(reader.records[2]->seq, 5u);
+    EXPECT_EQ(reader.records[0]->tick, 3);
+    EXPECT_EQ(((const JournalRelease *)journal_body(reader.records[0]))->gang_id, 0);
+    EXPECT_EQ(reader.records[1]->type, JOURNAL_CONFIG);
+    EXPECT_STREQ((const char *)journal_body(reader.records[1]), name);
+    EXPECT_EQ(reader.records[1]->size % 8, 0u);
+    journal_reader_close(&reader);
+}
+
+TEST_F(JournalTest, CutOffRecordIsDropped) {
+    ASSERT_EQ(journal_create(test_path, &seq, &clock), 0);
+    appendRelease(0);
+    appendRelease(1);
+    journal_close();
+
+    FILE *file = fopen(test_path, "r+b");
+    ASSERT_NE(file, nullptr);
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    ASSERT_EQ(ftruncate(fileno(file), size - 4), 0);
+    fclose(file);
+
+    JournalReader reader;
+    ASSERT_EQ(journal_read(&reader, test_path), 0);
+    EXPECT_EQ(reader.count, 1u);
+    EXPECT_GT(reader.dropped_bytes, 0u);
+    journal_reader_close(&reader);
+}
+
+TEST_F(JournalTest, GangHashIgnoresDeadMembers) {
+    Gang gang;
+    memset(&gang, 0, sizeof(gang));
+    gang.max_member_count = 2;
+    Member members[2];
+    memset(members, 0, sizeof(members));
+    members[0].is_alive = true;
+    members[0].suspicion = 0.25f;
+
+    uint64_t hash = journal_hash_gang(&gang, members);
+    members[1].suspicion = 0.9f;
+    EXPECT_EQ(journal_hash_gang(&gang, members), hash);
+    members[0].suspicion = 0.5f;
+    EXPECT_NE(journal_hash_gang(&gang, members), hash);
+}
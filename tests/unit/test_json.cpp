@@ -4,6 +4,7 @@
 #include <gtest/gtest.h>
 #include "json/json-config.h"
 #include "gang.h"
+#include <cstdlib>
 #include <cstring>
 #include <fstream>
 #include <string>
@@ -247,4 +248,128 @@ TEST_F(JsonConfigTest, LoadActualConfigJson) {
                 << "Target " << target.name << " has invalid weights";
         }
     }
-}
\ No newline at end of file
+}
+
+// Test loading a catalog with a custom target, a new attribute and heat
+TEST_F(JsonConfigTest, LoadTargetCatalog) {
+    std::string content = R"({
+        "targets": {
+            "bank_robbery": {
+                "smartness": 0.10,
+                "tech_skills": 0.90
+            },
+            "cyber_heist": {
+                "tech_skills": 0.50,
+                "hacking": 0.50,
+                "heat": 2.5
+            }
+        }
+    })";
+
+    createTestJsonFile(content);
+    TargetCatalog *catalog = load_target_catalog_from_json(test_json_path, 3);
+    ASSERT_NE(catalog, nullptr);
+
+    EXPECT_EQ(catalog->num_targets, 2);
+    EXPECT_EQ(catalog->num_attributes, NUM_ATTRIBUTES + 1);
+    EXPECT_EQ(catalog->num_gangs, 3);
+    EXPECT_STREQ(catalog_attribute_name(catalog, ATTR_SMARTNESS), "smartness");
+    EXPECT_STREQ(catalog_attribute_name(catalog, NUM_ATTRIBUTES), "hacking");
+
+    int heist = catalog_find_target(catalog, "cyber_heist");
+    ASSERT_GE(heist, 0);
+    EXPECT_FLOAT_EQ(catalog_weights(catalog, heist)[NUM_ATTRIBUTES], 0.50f);
+    EXPECT_FLOAT_EQ(catalog_weights(catalog, heist)[ATTR_SMARTNESS], 0.0f);
+    EXPECT_FLOAT_EQ(catalog_target_heat(catalog)[heist], 2.5f);
+    EXPECT_FLOAT_EQ(catalog_target_heat(catalog)[catalog_find_target(catalog, "bank_robbery")], 1.0f);
+    EXPECT_FLOAT_EQ(catalog_gang_heat(catalog, 2)[heist], 1.0f);
+    EXPECT_EQ(catalog_find_target(catalog, "art_theft"), -1);
+
+    free(catalog);
+}
+
+// The coolest target wins, whatever the fit
+TEST_F(JsonConfigTest, CatalogSelectsCoolestTarget) {
+    std::string content = R"({
+        "targets": {
+            "bank_robbery": { "tech_skills": 1.0 },
+            "kidnapping": { "strength": 1.0 },
+            "blackmail": { "negotiation": 1.0 }
+        }
+    })";
+
+    createTestJsonFile(content);
+    TargetCatalog *catalog = load_target_catalog_from_json(test_json_path, 2);
+    ASSERT_NE(catalog, nullptr);
+
+    float attributes[MAX_ATTRIBUTES] = {};
+    attributes[ATTR_TECH_SKILLS] = 1.0f;
+
+    int kidnapping = catalog_find_target(catalog, "kidnapping");
+    int blackmail = catalog_find_target(catalog, "blackmail");
+    catalog_gang_heat(catalog, 1)[catalog_find_target(catalog, "bank_robbery")] = 3.0f;
+    catalog_gang_heat(catalog, 1)[blackmail] = 2.0f;
+
+    for (int i = 0; i < 20; i++) {
+        EXPECT_EQ(catalog_select_target(catalog, 1, attributes), kidnapping);
+    }
+    free(catalog);
+}
+
+// Among equally cool targets only the TARGET_TOP_K best fits are picked
+TEST_F(JsonConfigTest, CatalogPicksAmongBestFits) {
+    std::string content = R"({
+        "targets": {
+            "bank_robbery": { "tech_skills": 0.2 },
+            "kidnapping": { "tech_skills": 0.5 },
+            "blackmail": { "tech_skills": 0.1 },
+            "art_theft": { "tech_skills": 0.4 },
+            "arms_trafficking": { "tech_skills": 0.3 }
+        }
+    })";
+
+    createTestJsonFile(content);
+    TargetCatalog *catalog = load_target_catalog_from_json(test_json_path, 1);
+    ASSERT_NE(catalog, nullptr);
+    ASSERT_EQ(TARGET_TOP_K, 3);
+
+    float attributes[MAX_ATTRIBUTES] = {};
+    attributes[ATTR_TECH_SKILLS] = 1.0f;
+
+    int kidnapping = catalog_find_target(catalog, "kidnapping");
+    int art_theft = catalog_find_target(catalog, "art_theft");
+    int arms = catalog_find_target(catalog, "arms_trafficking");
+    int picks[5] = {};
+    for (int i = 0; i < 300; i++) {
+        picks[catalog_select_target(catalog, 0, attributes)]++;
+    }
+    EXPECT_GT(picks[kidnapping], 0);
+    EXPECT_GT(picks[art_theft], 0);
+    EXPECT_GT(picks[arms], 0);
+    EXPECT_EQ(picks[kidnapping] + picks[art_theft] + picks[arms], 300);
+
+    // Fewer cool targets than TARGET_TOP_K: only those are candidates
+    catalog_gang_heat(catalog, 0)[kidnapping] = 2.0f;
+    catalog_gang_heat(catalog, 0)[art_theft] = 2.0f;
+    catalog_gang_heat(catalog, 0)[catalog_find_target(catalog, "blackmail")] = 2.0f;
+    for (int i = 0; i < 50; i++) {
+        int t = catalog_select_target(catalog, 0, attributes);
+        EXPECT_TRUE(t == arms || t == catalog_find_target(catalog, "bank_robbery"));
+    }
+    free(catalog);
+}
+
+// Names longer than the catalog holds are refused, not cut short
+TEST_F(JsonConfigTest, CatalogRejectsLongAttributeNames) {
+    std::string content = R"({
+        "targets": {
+            "cyber_heist": {
+                "hacking_with_an_unreasonably_long_name_a": 0.5,
+                "hacking_with_an_unreasonably_long_name_b": 0.5
+            }
+        }
+    })";
+
+    createTestJsonFile(content);
+    EXPECT_EQ(load_target_catalog_from_json(test_json_path, 1), nullptr);
+}
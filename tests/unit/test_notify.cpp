@@ -0,0 +1,86 @@
+#include <gtest/gtest.h>
+#include "notify.h"
+#include <chrono>
+#include <thread>
+
+class NotifyTest : public ::testing::Test {
+protected:
+    NotifyBoard board{};
+    uint32_t gangs[4]{};
+
+    static long elapsed_ms(std::chrono::steady_clock::time_point start) {
+        return (long)std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - start).count();
+    }
+
+    void SetUp() override {
+        notify_attach(&board);
+    }
+
+    void TearDown() override {
+        notify_attach(nullptr);
+    }
+};
+
+TEST_F(NotifyTest, WaitTimesOutWithoutAChange) {
+    uint32_t seen = notify_generation(&board.any);
+    EXPECT_EQ(notify_wait(&board.any, seen, 0), 0);
+
+    auto start = std::chrono::steady_clock::now();
+    EXPECT_EQ(notify_wait(&board.any, seen, 50), 0);
+    EXPECT_GE(elapsed_ms(start), 40);
+
+    // A value already moved returns at once
+    notify_changed();
+    EXPECT_EQ(notify_wait(&board.any, seen, -1), 1);
+    EXPECT_NE(notify_generation(&board.any), seen);
+}
+
+TEST_F(NotifyTest, BumpWakesASleeper) {
+    uint32_t seen = notify_generation(&gangs[1]);
+    std::thread writer([this] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(30));
+        notify_bump(&gangs[1]);
+    });
+    auto start = std::chrono::steady_clock::now();
+    EXPECT_EQ(notify_wait(&gangs[1], seen, 5000), 1);
+    EXPECT_LT(elapsed_ms(start), 2000);
+    writer.join();
+
+    // The waker cleared the sleeper's mark, so bumps nobody waits for stay cheap
+    EXPECT_EQ(gangs[1] & NOTIFY_WAITING, 0u);
+    EXPECT_EQ(notify_generation(&gangs[1]), seen + NOTIFY_STEP);
+}
+
+TEST_F(NotifyTest, SubscriptionReportsWhichCountersMoved) {
+    NotifySubscription sub;
+    ASSERT_EQ(notify_subscribe(&sub, &board.any, 3), 0);
+    EXPECT_EQ(notify_watch(&sub, &gangs[0]), 0);
+    EXPECT_EQ(notify_watch(&sub, &gangs[2]), 1);
+    EXPECT_EQ(notify_watch(&sub, &board.game), 2);
+    EXPECT_EQ(notify_watch(&sub, &gangs[3]), -1);
+
+    // A change to a counter it doesn't watch doesn't end the wait
+    int changed[3];
+    std::thread writer([this] {
+        notify_bump(&gangs[1]);
+        notify_changed();
+        std::this_thread::sleep_for(std::chrono::milliseconds(30));
+        notify_bump(&gangs[2]);
+        notify_changed();
+    });
+    ASSERT_EQ(notify_wait_any(&sub, 5000, changed), 1);
+    EXPECT_EQ(changed[0], 1);
+    writer.join();
+
+    // Reported once; the header bumps both board counters
+    EXPECT_EQ(notify_wait_any(&sub, 0, changed), 0);
+    notify_bump(&gangs[0]);
+    notify_game_changed();
+    ASSERT_EQ(notify_wait_any(&sub, 0, changed), 2);
+    EXPECT_EQ(changed[0], 0);
+    EXPECT_EQ(changed[1], 2);
+
+    EXPECT_EQ(notify_wait_any(&sub, 30, changed), 0);
+    notify_unsubscribe(&sub);
+}
@@ -0,0 +1,65 @@
+#include <gtest/gtest.h>
+#include "police_shard.h"
+#include <vector>
+
+class PoliceShardTest : public ::testing::Test {
+protected:
+    static constexpr int kGangs = 1000;
+    PoliceRing ring{};
+
+    void TearDown() override {
+        police_ring_free(&ring);
+    }
+
+    std::vector<int> owners() {
+        std::vector<int> result(kGangs);
+        for (int g = 0; g < kGangs; g++) {
+            result[g] = police_ring_owner(&ring, g);
+        }
+        return result;
+    }
+};
+
+TEST_F(PoliceShardTest, EveryGangHasOneOwner) {
+    EXPECT_EQ(police_ring_owner(&ring, 0), -1);
+
+    ASSERT_EQ(police_ring_build(&ring, 1), 0);
+    for (int owner : owners()) {
+        EXPECT_EQ(owner, 0);
+    }
+
+    // Four departments each get a fair share
+    ASSERT_EQ(police_ring_build(&ring, 4), 0);
+    std::vector<int> shard(4);
+    for (int owner : owners()) {
+        ASSERT_GE(owner, 0);
+        ASSERT_LT(owner, 4);
+        shard[owner]++;
+    }
+    for (int d = 0; d < 4; d++) {
+        EXPECT_GT(shard[d], kGangs / 8) << "department " << d;
+        EXPECT_LT(shard[d], kGangs / 2) << "department " << d;
+    }
+}
+
+TEST_F(PoliceShardTest, AddingADepartmentOnlyMovesGangsToIt) {
+    ASSERT_EQ(police_ring_build(&ring, 4), 0);
+    std::vector<int> before = owners();
+    ASSERT_EQ(police_ring_build(&ring, 5), 0);
+    std::vector<int> after = owners();
+
+    int moved = 0;
+    for (int g = 0; g < kGangs; g++) {
+        if (after[g] != before[g]) {
+            EXPECT_EQ(after[g], 4) << "gang " << g;
+            moved++;
+        }
+    }
+    // About a fifth of the gangs, nowhere near all of them
+    EXPECT_GT(moved, kGangs / 10);
+    EXPECT_LT(moved, kGangs / 3);
+
+    // Taking it off duty gives back exactly the same shards
+    ASSERT_EQ(police_ring_build(&ring, 4), 0);
+    EXPECT_EQ(owners(), before);
+}
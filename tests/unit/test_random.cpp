@@ -0,0 +1,223 @@
+#include <gtest/gtest.h>
+#include "random.h"
+#include <cmath>
+#include <thread>
+#include <vector>
+
+// Same master seed and IDs must give the same sequence
+TEST(RandomTest, StreamsAreReproducible) {
+    RandomStream a, b;
+    random_stream_seed(&a, 1234, RANDOM_PROC_GANG, 3, 7);
+    random_stream_seed(&b, 1234, RANDOM_PROC_GANG, 3, 7);
+
+    for (int i = 0; i < 1000; i++) {
+        EXPECT_EQ(random_stream_next(&a), random_stream_next(&b));
+    }
+}
+
+// Neighbouring IDs must not give overlapping streams
+TEST(RandomTest, StreamsDifferByIds) {
+    RandomStream a, b, c;
+    random_stream_seed(&a, 1234, RANDOM_PROC_GANG, 3, 7);
+    random_stream_seed(&b, 1234, RANDOM_PROC_GANG, 3, 8);
+    random_stream_seed(&c, 1234, RANDOM_PROC_POLICE, 3, 7);
+
+    uint64_t first_a = random_stream_next(&a);
+    EXPECT_NE(first_a, random_stream_next(&b));
+    EXPECT_NE(first_a, random_stream_next(&c));
+}
+
+// Thread streams depend only on the seed and IDs, not on thread scheduling
+TEST(RandomTest, ThreadStreamsAreIndependent) {
+    init_random_seeded(42, RANDOM_PROC_GANG);
+
+    std::vector<float> expected(4);
+    for (int m = 0; m < 4; m++) {
+        random_seed_thread(0, m);
+        expected[m] = random_float(0.0f, 1.0f);
+    }
+
+    std::vector<float> got(4);
+    std::vector<std::thread> threads;
+    for (int m = 0; m < 4; m++) {
+        threads.emplace_back([m, &got]() {
+            random_seed_thread(0, m);
+            got[m] = random_float(0.0f, 1.0f);
+        });
+    }
+    for (auto &t : threads) t.join();
+
+    for (int m = 0; m < 4; m++) {
+        EXPECT_FLOAT_EQ(got[m], expected[m]);
+    }
+}
+
+TEST(RandomTest, IntAndFloatRanges) {
+    init_random_seeded(7, RANDOM_PROC_MAIN);
+
+    bool seen[6] = {};
+    for (int i = 0; i < 10000; i++) {
+        int v = random_int(3, 8);
+        ASSERT_GE(v, 3);
+        ASSERT_LE(v, 8);
+        seen[v - 3] = true;
+
+        float f = random_float(0.5f, 2.0f);
+        ASSERT_GE(f, 0.5f);
+        ASSERT_LT(f, 2.0f);
+    }
+    for (bool s : seen) EXPECT_TRUE(s);
+    EXPECT_EQ(random_int(5, 5), 5);
+}
+
+// Ziggurat samples should match the requested mean and standard deviation
+TEST(RandomTest, NormalMoments) {
+    init_random_seeded(99, RANDOM_PROC_MAIN);
+
+    const int n = 200000;
+    double sum = 0.0, sum_sq = 0.0;
+    int tail = 0;
+    for (int i = 0; i < n; i++) {
+        double x = random_normal(2.0f, 0.5f);
+        sum += x;
+        sum_sq += x * x;
+        if (std::fabs(x - 2.0) > 3 * 0.5) tail++;
+    }
+    double mean = sum / n;
+    double var = sum_sq / n - mean * mean;
+
+    EXPECT_NEAR(mean, 2.0, 0.01);
+    EXPECT_NEAR(std::sqrt(var), 0.5, 0.01);
+    // About 0.27% of samples fall beyond 3 sigma
+    EXPECT_NEAR((double)tail / n, 0.0027, 0.001);
+}
+
+// A filled buffer is standard normal, and consecutive fills keep drawing
+TEST(RandomTest, NormalFillMoments) {
+    init_random_seeded(99, RANDOM_PROC_MAIN);
+
+    const int n = 200000;
+    std::vector<float> buf(n);
+    random_normal_fill(buf.data(), n / 2);
+    random_normal_fill(buf.data() + n / 2, n / 2);
+
+    double sum = 0.0, sum_sq = 0.0;
+    for (float x : buf) {
+        sum += x;
+        sum_sq += (double)x * x;
+    }
+    double mean = sum / n;
+    double var = sum_sq / n - mean * mean;
+
+    EXPECT_NEAR(mean, 0.0, 0.01);
+    EXPECT_NEAR(std::sqrt(var), 1.0, 0.01);
+    EXPECT_NE(buf[0], buf[n / 2]);
+}
+
+// Same values as gang.c
+static const float batch_means[NUM_ATTRIBUTES] = {0.5f, 0.5f, 0.5f, 0.4f, 0.6f, 0.5f, 0.5f};
+static const float batch_stddevs[NUM_ATTRIBUTES] = {0.15f, 0.15f, 0.15f, 0.20f, 0.15f, 0.15f, 0.15f};
+static const float batch_correlation[NUM_ATTRIBUTES][NUM_ATTRIBUTES] = {
+    {0.2f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f},
+    {0.1f, 0.2f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f},
+    {0.0f, 0.0f, 0.2f, 0.0f, 0.0f, 0.0f, 0.0f},
+    {0.15f, 0.1f, 0.0f, 0.2f, 0.0f, 0.0f, 0.0f},
+    {0.0f, 0.0f, 0.15f, 0.0f, 0.2f, 0.0f, 0.0f},
+    {0.1f, 0.0f, 0.0f, 0.0f, 0.0f, 0.2f, 0.0f},
+    {0.1f, 0.0f, 0.0f, 0.0f, 0.1f, 0.15f, 0.2f}
+};
+
+// Laid out like Member: attributes followed by other fields
+struct BatchRow {
+    float attributes[NUM_ATTRIBUTES];
+    int other;
+};
+
+static void generate_batch(std::vector<BatchRow> &rows) {
+    generate_multivariate_attributes_batch(rows[0].attributes, sizeof(BatchRow), (int)rows.size(),
+                                           batch_means, batch_stddevs, batch_correlation);
+}
+
+// Batch members follow mean + stddev * L z: check the moments and the
+// pairwise correlations that matrix implies
+TEST(RandomTest, BatchAttributeMoments) {
+    init_random_seeded(5, RANDOM_PROC_MAIN);
+
+    const int n = 100000;  // Not a multiple of the block size
+    std::vector<BatchRow> rows(n);
+    for (auto &r : rows) r.other = -1;
+    generate_batch(rows);
+
+    double mean[NUM_ATTRIBUTES] = {};
+    for (const auto &r : rows) {
+        ASSERT_EQ(r.other, -1);  // Stride respected
+        for (int i = 0; i < NUM_ATTRIBUTES; i++) {
+            ASSERT_GE(r.attributes[i], 0.0f);
+            ASSERT_LE(r.attributes[i], 1.0f);
+            mean[i] += r.attributes[i];
+        }
+    }
+    for (int i = 0; i < NUM_ATTRIBUTES; i++) mean[i] /= n;
+
+    double cov[NUM_ATTRIBUTES][NUM_ATTRIBUTES] = {};
+    for (const auto &r : rows) {
+        for (int i = 0; i < NUM_ATTRIBUTES; i++) {
+            for (int k = 0; k <= i; k++) {
+                cov[i][k] += (r.attributes[i] - mean[i]) * (r.attributes[k] - mean[k]);
+            }
+        }
+    }
+
+    // Expected covariance: s_i s_k sum_j L[i][j] L[k][j]
+    double expected[NUM_ATTRIBUTES][NUM_ATTRIBUTES] = {};
+    for (int i = 0; i < NUM_ATTRIBUTES; i++) {
+        for (int k = 0; k <= i; k++) {
+            for (int j = 0; j <= k; j++) {
+                expected[i][k] += batch_correlation[i][j] * batch_correlation[k][j];
+            }
+            expected[i][k] *= batch_stddevs[i] * batch_stddevs[k];
+        }
+    }
+
+    for (int i = 0; i < NUM_ATTRIBUTES; i++) {
+        EXPECT_NEAR(mean[i], batch_means[i], 0.001) << "attribute " << i;
+        EXPECT_NEAR(std::sqrt(cov[i][i] / n), std::sqrt(expected[i][i]), 0.001) << "attribute " << i;
+        for (int k = 0; k < i; k++) {
+            double corr = cov[i][k] / std::sqrt(cov[i][i] * cov[k][k]);
+            double want = expected[i][k] / std::sqrt(expected[i][i] * expected[k][k]);
+            EXPECT_NEAR(corr, want, 0.02) << "attributes " << i << ", " << k;
+        }
+    }
+}
+
+// A chunk's members depend only on the seed and the chunk's stream
+TEST(RandomTest, BatchIsReproduciblePerChunk) {
+    const int n = 150;
+    std::vector<BatchRow> a(n), b(n), c(n), d(n);
+
+    RandomStream stream;
+    random_stream_seed(&stream, 77, RANDOM_PROC_GANG_INIT, 2, 4);
+    random_bind_stream(&stream);
+    generate_batch(a);
+
+    random_stream_seed(&stream, 77, RANDOM_PROC_GANG_INIT, 2, 4);
+    generate_batch(b);
+
+    random_stream_seed(&stream, 77, RANDOM_PROC_GANG_INIT, 2, 5);
+    generate_batch(c);
+
+    random_stream_seed(&stream, 78, RANDOM_PROC_GANG_INIT, 2, 4);
+    generate_batch(d);
+    random_bind_stream(NULL);
+
+    bool chunk_differs = false, seed_differs = false;
+    for (int k = 0; k < n; k++) {
+        for (int i = 0; i < NUM_ATTRIBUTES; i++) {
+            EXPECT_EQ(a[k].attributes[i], b[k].attributes[i]);
+            chunk_differs |= a[k].attributes[i] != c[k].attributes[i];
+            seed_differs |= a[k].attributes[i] != d[k].attributes[i];
+        }
+    }
+    EXPECT_TRUE(chunk_differs);
+    EXPECT_TRUE(seed_differs);
+}
@@ -0,0 +1,82 @@
+#include <gtest/gtest.h>
+#include "routing.h"
+#include <set>
+
+class RoutingTest : public ::testing::Test {
+protected:
+    RoutingTable table{};
+    int msgid = -1;
+
+    void SetUp() override {
+        ASSERT_EQ(routing_init(&table, 8), 0);
+    }
+
+    void TearDown() override {
+        if (msgid != -1) {
+            delete_message_queue(msgid);
+        }
+    }
+
+    Message handshake_for(EndpointKind kind, int slot) {
+        Message message{};
+        message.mtype = route_to(&table, kind, slot);
+        message.mode = MSG_HANDSHAKE;
+        return message;
+    }
+};
+
+// Every endpoint has a type of its own, and the type leads back to it
+TEST_F(RoutingTest, TypesAreDistinctAndResolve) {
+    std::set<long> types;
+    for (int kind = 0; kind < ENDPOINT_KINDS; kind++) {
+        for (int slot = 0; slot < 8; slot++) {
+            long mtype = route_to(&table, (EndpointKind)kind, slot);
+            EXPECT_GT(mtype, 0);
+            EXPECT_TRUE(types.insert(mtype).second) << "type " << mtype << " given twice";
+
+            EndpointKind found;
+            int found_slot;
+            ASSERT_EQ(route_resolve(&table, mtype, &found, &found_slot), 0);
+            EXPECT_EQ(found, kind);
+            EXPECT_EQ(found_slot, slot);
+        }
+    }
+
+    EndpointKind kind;
+    int slot;
+    EXPECT_EQ(route_resolve(&table, 0, &kind, &slot), -1);
+    EXPECT_EQ(route_resolve(&table, route_to(&table, ENDPOINT_OFFICER, 8), &kind, &slot), -1);
+
+    RoutingTable bad{};
+    EXPECT_EQ(routing_init(&bad, 0), -1);
+}
+
+// A full queue doesn't block the sender; what nobody takes is counted
+TEST_F(RoutingTest, UndeliverableMessagesAreCounted) {
+    msgid = create_private_queue((int)(MESSAGE_SIZE) * 2);
+    ASSERT_NE(msgid, -1);
+
+    Message message = handshake_for(ENDPOINT_GANG, 3);
+    EXPECT_EQ(route_send(&table, msgid, &message), 0);
+    EXPECT_EQ(route_send(&table, msgid, &message), 0);
+    EXPECT_EQ(route_send(&table, msgid, &message), -1);
+    EXPECT_EQ(table.undeliverable, 1u);
+
+    // Nobody's type
+    message.mtype = 1000;
+    EXPECT_EQ(route_send(&table, msgid, &message), -1);
+    EXPECT_EQ(table.undeliverable, 2u);
+
+    // Only the endpoint's own messages are withdrawn
+    message = handshake_for(ENDPOINT_OFFICER, 3);
+    uint32_t messages, bytes;
+    Message taken;
+    ASSERT_EQ(receive_message_nonblocking(msgid, &taken, route_to(&table, ENDPOINT_GANG, 3)), 0);
+    ASSERT_EQ(route_send(&table, msgid, &message), 0);
+    EXPECT_EQ(route_withdraw(&table, msgid, route_to(&table, ENDPOINT_GANG, 3)), 1);
+    EXPECT_EQ(table.withdrawn, 1u);
+    EXPECT_EQ(table.undeliverable, 2u);  // Withdrawn messages are counted apart
+    ASSERT_EQ(message_queue_depth(msgid, &messages, &bytes), 0);
+    EXPECT_EQ(messages, 1u);
+    EXPECT_EQ(route_withdraw(&table, msgid, route_to(&table, ENDPOINT_GANG, 3)), 0);
+}
@@ -0,0 +1,67 @@
+#include <gtest/gtest.h>
+#include "shm_arena.h"
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+class ShmArenaTest : public ::testing::Test {
+protected:
+    static constexpr size_t kSize = 4096;
+    std::vector<unsigned char> block = std::vector<unsigned char>(kSize + SHM_ARENA_ALIGN);
+    ShmArena* arena = nullptr;
+
+    void SetUp() override {
+        // Line the header up the way mmap would
+        uintptr_t base = reinterpret_cast<uintptr_t>(block.data());
+        base = (base + SHM_ARENA_ALIGN - 1) & ~static_cast<uintptr_t>(SHM_ARENA_ALIGN - 1);
+        arena = reinterpret_cast<ShmArena*>(base);
+        shm_arena_init(arena, kSize);
+    }
+};
+
+TEST_F(ShmArenaTest, AllocatesAlignedUntilFull) {
+    ShmOffset first = shm_arena_alloc(arena, 10);
+    ShmOffset second = shm_arena_alloc(arena, 100);
+    EXPECT_EQ(first, shm_arena_header_size());
+    EXPECT_EQ(second, first + SHM_ARENA_ALIGN);
+    EXPECT_EQ(second % SHM_ARENA_ALIGN, 0u);
+
+    EXPECT_EQ(shm_arena_alloc(arena, kSize), 0u);
+    size_t left = kSize - arena->used;
+    EXPECT_NE(shm_arena_alloc(arena, left), 0u);
+    EXPECT_EQ(arena->used, kSize);
+    EXPECT_EQ(shm_arena_alloc(arena, 1), 0u);
+}
+
+TEST_F(ShmArenaTest, RegionsResolveFromACopyAtAnotherAddress) {
+    ShmOffset gangs = shm_arena_add_region(arena, SHM_REGION_GANGS, 4, sizeof(int));
+    ASSERT_NE(gangs, 0u);
+    static_cast<int*>(shm_arena_ptr(arena, gangs))[3] = 42;
+
+    // Another process maps the same bytes somewhere else
+    std::vector<unsigned char> copy(kSize + SHM_ARENA_ALIGN);
+    uintptr_t base = reinterpret_cast<uintptr_t>(copy.data());
+    base = (base + SHM_ARENA_ALIGN - 1) & ~static_cast<uintptr_t>(SHM_ARENA_ALIGN - 1);
+    ShmArena* other = reinterpret_cast<ShmArena*>(base);
+    memcpy(other, arena, kSize);
+
+    ASSERT_EQ(shm_arena_check(other, kSize), 0);
+    EXPECT_EQ(shm_arena_check_region(other, SHM_REGION_GANGS, sizeof(int)), 0);
+    EXPECT_EQ(shm_arena_check_region(other, SHM_REGION_GANGS, sizeof(long long)), -1);
+    EXPECT_EQ(shm_arena_check_region(other, SHM_REGION_GAME, 1), -1);
+    EXPECT_EQ(static_cast<int*>(shm_arena_region(other, SHM_REGION_GANGS))[3], 42);
+    EXPECT_EQ(shm_arena_ptr(other, 0), nullptr);
+}
+
+TEST_F(ShmArenaTest, CheckRejectsForeignOrTruncatedSegments) {
+    shm_arena_add_region(arena, SHM_REGION_GAME, 1, 512);
+    EXPECT_EQ(shm_arena_check(arena, kSize), 0);
+    EXPECT_EQ(shm_arena_check(arena, kSize / 2), -1);
+
+    arena->regions[SHM_REGION_GAME].size = kSize;
+    EXPECT_EQ(shm_arena_check(arena, kSize), -1);
+
+    arena->regions[SHM_REGION_GAME].size = 512;
+    arena->magic = 0;
+    EXPECT_EQ(shm_arena_check(arena, kSize), -1);
+}
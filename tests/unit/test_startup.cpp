@@ -0,0 +1,104 @@
+#include <gtest/gtest.h>
+#include "startup.h"
+#include <chrono>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <vector>
+
+#define MAX_CHILDREN 8
+
+// Laid out like the game header: the barrier and the children's timings
+// in memory every process maps
+struct SharedStartup {
+    StartupBarrier barrier;
+    StartupTimes children[MAX_CHILDREN];
+    int passed;  // Children that got through the barrier
+};
+
+class StartupTest : public ::testing::Test {
+protected:
+    SharedStartup *shared = nullptr;
+    std::vector<pid_t> children;
+
+    static long elapsed_ms(std::chrono::steady_clock::time_point start) {
+        return (long)std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - start).count();
+    }
+
+    void SetUp() override {
+        void *p = mmap(nullptr, sizeof(SharedStartup), PROT_READ | PROT_WRITE,
+                       MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+        ASSERT_NE(p, MAP_FAILED);
+        shared = static_cast<SharedStartup *>(p);
+    }
+
+    void TearDown() override {
+        if (shared == nullptr) return;
+        startup_barrier_destroy(&shared->barrier);
+        munmap(shared, sizeof(SharedStartup));
+    }
+
+    // Fork a child that arrives at the barrier and exits once released
+    void arrive(int index) {
+        pid_t pid = fork();
+        ASSERT_NE(pid, -1);
+        if (pid == 0) {
+            startup_arrive_and_wait(&shared->barrier, &shared->children[index]);
+            __atomic_fetch_add(&shared->passed, 1, __ATOMIC_RELAXED);
+            _exit(0);
+        }
+        children.push_back(pid);
+    }
+
+    void reap() {
+        for (pid_t pid : children) {
+            int status;
+            ASSERT_EQ(waitpid(pid, &status, 0), pid);
+            EXPECT_TRUE(WIFEXITED(status));
+            EXPECT_EQ(WEXITSTATUS(status), 0);
+        }
+        children.clear();
+    }
+};
+
+TEST_F(StartupTest, ReleasesOnceEveryChildArrives) {
+    const int n = 4;
+    ASSERT_EQ(startup_barrier_init(&shared->barrier, n), 0);
+    for (int i = 0; i < n; i++) {
+        arrive(i);
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    EXPECT_EQ(startup_wait_all(&shared->barrier, 5000), n);
+    EXPECT_LT(elapsed_ms(start), 2000);
+
+    // Nobody passes before main lets them go
+    usleep(20000);
+    EXPECT_EQ(__atomic_load_n(&shared->passed, __ATOMIC_RELAXED), 0);
+
+    startup_release(&shared->barrier);
+    reap();
+    EXPECT_EQ(shared->passed, n);
+    EXPECT_GT(shared->barrier.release_ns, shared->barrier.launch_ns);
+    for (int i = 0; i < n; i++) {
+        EXPECT_GT(shared->children[i].phase_ns[STARTUP_READY], 0u);
+    }
+}
+
+TEST_F(StartupTest, WaitGivesUpAfterTimeout) {
+    ASSERT_EQ(startup_barrier_init(&shared->barrier, 3), 0);
+    arrive(0);
+    arrive(1);
+
+    auto start = std::chrono::steady_clock::now();
+    EXPECT_EQ(startup_wait_all(&shared->barrier, 100), 2);
+    EXPECT_GE(elapsed_ms(start), 90);
+    EXPECT_EQ(__atomic_load_n(&shared->passed, __ATOMIC_RELAXED), 0);
+
+    // Those that did arrive still go once released
+    startup_release(&shared->barrier);
+    reap();
+    EXPECT_EQ(shared->passed, 2);
+    EXPECT_EQ(shared->children[2].phase_ns[STARTUP_READY], 0u);
+}
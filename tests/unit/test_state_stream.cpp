@@ -0,0 +1,121 @@
+#include <gtest/gtest.h>
+#include "state_stream.h"
+#include "police.h"
+#include <cstdlib>
+#include <cstring>
+#include <unistd.h>
+
+class StateStreamTest : public ::testing::Test {
+protected:
+    static constexpr int kGangs = 2;
+    static constexpr int kMembers = 3;
+    static constexpr int kAgents = 2;
+    const char* address = "test_state_stream.sock";
+
+    Config config{};
+    Game* game = nullptr;
+    Gang gangs[kGangs]{};
+    Member members[kGangs][kMembers]{};  // Each gang's segment
+    GangMapping mappings[kGangs]{};
+    TargetCatalog* catalog = nullptr;
+    void* police = nullptr;
+    ShmPtrs shm{};
+
+    // What a viewer holds
+    Game* mirror_game = nullptr;
+    Gang mirror_gangs[kGangs]{};
+    Member mirror_members[kGangs][kMembers]{};
+    Member* mirror_rows[kGangs] = {mirror_members[0], mirror_members[1]};
+    uint32_t versions[kGangs]{};
+    StreamClient client{};
+
+    void SetUp() override {
+        config.num_gangs = kGangs;
+        config.max_gangs = kGangs;
+        config.max_gang_size = kMembers;
+        config.gang_size_limit = kMembers;
+        config.max_agents_per_gang = kAgents;
+        game = static_cast<Game*>(calloc(1, sizeof(Game)));
+        mirror_game = static_cast<Game*>(calloc(1, sizeof(Game)));
+        catalog = static_cast<TargetCatalog*>(calloc(1, target_catalog_size(2, 1, kGangs)));
+        target_catalog_init(catalog, 2, 1, kGangs);
+        game->elapsed_time = 7;
+        for (int g = 0; g < kGangs; g++) {
+            gangs[g].gang_id = g;
+            gangs[g].max_member_count = kMembers;
+            mappings[g].members = members[g];
+            mappings[g].capacity = kMembers;
+            for (int m = 0; m < kMembers; m++) {
+                members[g][m].member_id = m;
+                members[g][m].knowledge = 0.1f * (m + 1);
+            }
+        }
+        shm.shared_game = game;
+        shm.gangs = gangs;
+        shm.catalog = catalog;
+        shm.mappings = mappings;  // No directory: the publisher reads these as they are
+        police = calloc(1, police_tables_size(kGangs, kAgents));
+        shm.police = police_tables_at(police, kGangs, kAgents);
+        shm.police.officers[1].num_agents = 1;
+        police_agents(&shm.police, kAgents, 1)[0].agent_id = 4;
+        ASSERT_EQ(stream_publisher_start(address, &shm, &config, 100), 0);
+        ASSERT_EQ(stream_connect(&client, address), 0);
+    }
+
+    void TearDown() override {
+        stream_close(&client);
+        stream_publisher_stop();
+        free(game);
+        free(mirror_game);
+        free(catalog);
+        free(police);
+    }
+
+    void applyNext() {
+        ASSERT_EQ(stream_next(&client, 2000), 1);
+        ASSERT_EQ(stream_apply(&client, mirror_game, mirror_gangs, mirror_rows, versions), 0);
+    }
+};
+
+TEST_F(StateStreamTest, FirstFrameCarriesEverything) {
+    EXPECT_EQ(client.config.num_gangs, kGangs);
+    EXPECT_EQ(client.catalog->num_targets, 2);
+
+    applyNext();
+    EXPECT_EQ(client.num_changed, kGangs);
+    EXPECT_EQ(mirror_game->elapsed_time, 7);
+    for (int g = 0; g < kGangs; g++) {
+        EXPECT_EQ(memcmp(mirror_members[g], members[g], sizeof(mirror_members[g])), 0);
+    }
+    EXPECT_EQ(mirror_gangs[1].gang_id, 1);
+
+    PoliceTables mirror_police = police_tables_at(client.police, kGangs, kAgents);
+    EXPECT_EQ(mirror_police.officers[1].num_agents, 1);
+    EXPECT_EQ(police_agents(&mirror_police, kAgents, 1)[0].agent_id, 4);
+}
+
+TEST_F(StateStreamTest, LaterFramesCarryOnlyWhatChanged) {
+    applyNext();
+
+    members[1][2].knowledge = 0.9f;
+    gang_touch(&gangs[1]);
+    applyNext();
+
+    ASSERT_EQ(client.num_changed, 1);
+    EXPECT_EQ(client.changed[0], 1);
+    EXPECT_EQ(versions[1], gang_version(&gangs[1]));
+    EXPECT_FLOAT_EQ(mirror_members[1][2].knowledge, 0.9f);
+    // One gang record with one member, no game or catalog blocks
+    EXPECT_EQ(client.length, sizeof(StreamFrame) + sizeof(StreamGangRecord) + sizeof(Gang) +
+                             sizeof(uint32_t) + sizeof(Member));
+
+    // Only the block holding the clock is resent when it ticks
+    game->elapsed_time = 8;
+    applyNext();
+    EXPECT_EQ(client.num_changed, 0);
+    EXPECT_EQ(mirror_game->elapsed_time, 8);
+    EXPECT_EQ(client.length, sizeof(StreamFrame) + sizeof(uint32_t) + STREAM_BLOCK);
+
+    // Nothing changed: no frame at all
+    EXPECT_EQ(stream_next(&client, 100), 0);
+}
@@ -0,0 +1,118 @@
+#include <gtest/gtest.h>
+#include "timer_wheel.h"
+#include <vector>
+
+class TimerWheelTest : public ::testing::Test {
+protected:
+    TimerWheel wheel;
+    std::vector<std::pair<int, uint64_t>> fired;  // Timer and tick it fired at
+
+    struct Periodic {
+        TimerWheelTest *test;
+        uint64_t period;
+        int left;
+    };
+
+    static void record(TimerNode *timer, void *arg) {
+        auto *test = static_cast<TimerWheelTest *>(arg);
+        test->fired.emplace_back(static_cast<int>(timer->expires), test->wheel.now);
+    }
+
+    static void repeat(TimerNode *timer, void *arg) {
+        auto *periodic = static_cast<Periodic *>(arg);
+        periodic->test->fired.emplace_back(-1, periodic->test->wheel.now);
+        if (--periodic->left > 0) {
+            timer_arm(&periodic->test->wheel, timer, periodic->period);
+        }
+    }
+
+    void SetUp() override {
+        timer_wheel_init(&wheel, 1000);
+    }
+};
+
+TEST_F(TimerWheelTest, FiresEachTimerOnItsTickAcrossLevels) {
+    // Delays on every level and on the level boundaries
+    const uint64_t delays[] = {1, 5, 63, 64, 65, 100, 4095, 4096, 5000, 262144, 300000, 20000000};
+    std::vector<TimerNode> timers(sizeof(delays) / sizeof(delays[0]));
+    for (size_t i = 0; i < timers.size(); i++) {
+        timer_init(&timers[i], record, this);
+        timer_arm(&wheel, &timers[i], delays[i]);
+    }
+    EXPECT_EQ(wheel.num_pending, (int)timers.size());
+    EXPECT_EQ(timer_wheel_next(&wheel), 1u);
+
+    // Turned in uneven steps, including ones that skip whole levels
+    uint64_t now = 1000;
+    const uint64_t steps[] = {1, 3, 70, 4000, 1, 100000, 3, 1000000, 19000000, 5000000};
+    for (uint64_t step : steps) {
+        now += step;
+        timer_wheel_advance(&wheel, now);
+    }
+    ASSERT_EQ(fired.size(), timers.size());
+    for (size_t i = 0; i < fired.size(); i++) {
+        // In order, and never before they were due
+        EXPECT_EQ(fired[i].first, (int)(1000 + delays[i]));
+        EXPECT_GE(fired[i].second, 1000 + delays[i]);
+    }
+    EXPECT_EQ(wheel.num_pending, 0);
+    EXPECT_EQ(timer_wheel_next(&wheel), UINT64_MAX);
+}
+
+TEST_F(TimerWheelTest, TickByTickFiresExactlyOnTime) {
+    std::vector<TimerNode> timers(50);
+    for (size_t i = 0; i < timers.size(); i++) {
+        timer_init(&timers[i], record, this);
+        timer_arm(&wheel, &timers[i], 1 + i * 97);
+    }
+    for (uint64_t now = 1001; now <= 1000 + 50 * 97; now++) {
+        timer_wheel_advance(&wheel, now);
+    }
+    ASSERT_EQ(fired.size(), timers.size());
+    for (const auto &f : fired) {
+        EXPECT_EQ((uint64_t)f.first, f.second);
+    }
+}
+
+TEST_F(TimerWheelTest, CancelRearmAndMove) {
+    TimerNode a, b, c;
+    timer_init(&a, record, this);
+    timer_init(&b, record, this);
+    timer_init(&c, record, this);
+    EXPECT_FALSE(timer_cancel(&wheel, &a));
+
+    timer_arm(&wheel, &a, 10);
+    timer_arm(&wheel, &b, 200);
+    EXPECT_TRUE(timer_pending(&a));
+    EXPECT_TRUE(timer_cancel(&wheel, &a));
+    EXPECT_FALSE(timer_pending(&a));
+
+    // Arming a pending timer moves it
+    timer_arm(&wheel, &b, 20);
+    EXPECT_EQ(wheel.num_pending, 1);
+
+    // c takes over what b was pending for
+    timer_move(&wheel, &c, &b);
+    EXPECT_FALSE(timer_pending(&b));
+    EXPECT_TRUE(timer_pending(&c));
+
+    timer_wheel_advance(&wheel, 2000);
+    ASSERT_EQ(fired.size(), 1u);
+    EXPECT_EQ(fired[0].first, 1020);
+    EXPECT_EQ(fired[0].second, 1020u);
+}
+
+TEST_F(TimerWheelTest, CallbacksRearmThemselves) {
+    TimerNode timer;
+    Periodic periodic{this, 1000, 5};
+    timer_init(&timer, repeat, &periodic);
+    timer_arm(&wheel, &timer, 1000);
+
+    // One long jump still fires each round on its own tick
+    EXPECT_EQ(timer_wheel_advance(&wheel, 10000), 5);
+    ASSERT_EQ(fired.size(), 5u);
+    for (size_t i = 0; i < fired.size(); i++) {
+        EXPECT_EQ(fired[i].second, 2000 + 1000 * i);
+    }
+    EXPECT_FALSE(timer_pending(&timer));
+}
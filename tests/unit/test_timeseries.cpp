@@ -0,0 +1,106 @@
+#include <gtest/gtest.h>
+#include "timeseries.h"
+#include <cstdio>
+#include <unistd.h>
+
+class TimeSeriesTest : public ::testing::Test {
+protected:
+    const char* test_path = "test_series.octs";
+    ColumnDesc columns[2] = {{"count", COLUMN_INT32}, {"level", COLUMN_FLOAT32}};
+    ColumnDesc totals[1] = {{"total", COLUMN_UINT32}};
+
+    void SetUp() override {
+        std::remove(test_path);
+    }
+
+    void TearDown() override {
+        std::remove(test_path);
+    }
+
+    // Entity e at sample s
+    static int count(int e, int s) { return e * 100 - s / 3; }
+    static float level(int e, int s) { return e + (s % 5) * 0.25f; }
+
+    void writeSamples(int samples, int chunk_samples) {
+        TimeSeriesTableDesc tables[2] = {{"items", columns, 2, 3}, {"totals", totals, 1, 1}};
+        TimeSeriesWriter writer;
+        ASSERT_EQ(timeseries_open(&writer, test_path, tables, 2, chunk_samples), 0);
+        for (int s = 0; s < samples; s++) {
+            for (int e = 0; e < 3; e++) {
+                ColumnValue row[2];
+                row[0].i = count(e, s);
+                row[1].f = level(e, s);
+                timeseries_put(&writer, 0, e, row);
+            }
+            ColumnValue total;
+            total.u = 4000000000u + s;
+            timeseries_put(&writer, 1, 0, &total);
+            ASSERT_EQ(timeseries_commit(&writer, s * 100), 0);
+        }
+        ASSERT_EQ(timeseries_close(&writer), 0);
+    }
+
+    int readItems() {
+        TimeSeriesReader reader;
+        if (timeseries_reader_open(&reader, test_path) != 0) return -1;
+        int items = timeseries_find_table(&reader, "items");
+        EXPECT_EQ(items, 0);
+        int samples = 0;
+        while (timeseries_reader_next(&reader) > 0) {
+            if (reader.table != items) {
+                EXPECT_EQ(timeseries_value(&reader, 0, 0, 0).u, 4000000000u + reader.first_sample);
+                continue;
+            }
+            for (int s = 0; s < reader.samples; s++) {
+                int sample = (int)reader.first_sample + s;
+                EXPECT_EQ(sample, samples + s);
+                EXPECT_EQ(reader.times[s], (uint32_t)sample * 100);
+                for (int e = 0; e < 3; e++) {
+                    EXPECT_EQ(timeseries_value(&reader, 0, e, s).i, count(e, sample));
+                    EXPECT_EQ(timeseries_value(&reader, 1, e, s).f, level(e, sample));
+                }
+            }
+            samples += reader.samples;
+        }
+        timeseries_reader_close(&reader);
+        return samples;
+    }
+};
+
+TEST_F(TimeSeriesTest, RoundTrip) {
+    writeSamples(100, 16);
+    EXPECT_EQ(readItems(), 100);
+}
+
+TEST_F(TimeSeriesTest, UnchangedValuesCompress) {
+    ColumnDesc flat[1] = {{"value", COLUMN_FLOAT32}};
+    TimeSeriesTableDesc table = {"flat", flat, 1, 1000};
+    TimeSeriesWriter writer;
+    ASSERT_EQ(timeseries_open(&writer, test_path, &table, 1, 128), 0);
+    for (int s = 0; s < 128; s++) {
+        for (int e = 0; e < 1000; e++) {
+            ColumnValue value;
+            value.f = 0.5f;
+            timeseries_put(&writer, 0, e, &value);
+        }
+        ASSERT_EQ(timeseries_commit(&writer, s * 100), 0);
+    }
+    ASSERT_EQ(timeseries_flush(&writer), 0);
+    // 128000 values; each series is its first value and one run of zeros
+    EXPECT_LT(writer.bytes_written, 10000u);
+    timeseries_close(&writer);
+}
+
+TEST_F(TimeSeriesTest, CutOffChunkIsIgnored) {
+    writeSamples(40, 16);
+    FILE *file = fopen(test_path, "r+b");
+    ASSERT_NE(file, nullptr);
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    ASSERT_EQ(ftruncate(fileno(file), size - 3), 0);
+    fclose(file);
+
+    // The last chunk of the items table (samples 32..39) is still whole; the
+    // totals chunk after it is not
+    EXPECT_EQ(readItems(), 40);
+}
@@ -0,0 +1,75 @@
+#include <gtest/gtest.h>
+#include "viewer_lod.h"
+
+class ViewerLodTest : public ::testing::Test {
+protected:
+    LodViews lod{};
+    Gang gangs[2]{};
+    Member members[2][4]{};
+
+    void SetUp() override {
+        for (int g = 0; g < 2; g++) {
+            gangs[g].max_member_count = 4;
+            for (int m = 0; m < 4; m++) {
+                members[g][m].is_alive = true;
+                members[g][m].agent_id = -1;
+                members[g][m].knowledge = 0.5f;
+            }
+            gangs[g].num_alive_members = 4;
+        }
+        ASSERT_EQ(lod_init(&lod, 2, 4, 1), 0);
+    }
+
+    void TearDown() override {
+        lod_free(&lod);
+    }
+
+    float value(int view, int x, int y) {
+        const LodImage *image = &lod.images[view];
+        return image->values[y * image->width + x];
+    }
+};
+
+TEST_F(ViewerLodTest, HistogramsAndDensity) {
+    // Gang 0: two agents at either end of the suspicion range, one dead member
+    members[0][0].agent_id = 1;
+    members[0][0].suspicion = 0.05f;
+    members[0][1].agent_id = 2;
+    members[0][1].suspicion = 3.0f;  // Above the threshold: last bin
+    members[0][3].is_alive = false;
+    members[0][3].knowledge = 0.0f;
+    gangs[0].num_alive_members = 3;
+    gangs[0].num_agents = 2;
+
+    Member *const ptrs[2] = {members[0], members[1]};
+    lod_compute(&lod, gangs, ptrs, nullptr, 1.0f);
+
+    EXPECT_EQ(lod.rows, 2);
+    EXPECT_EQ(lod.gangs_per_row, 1);
+    EXPECT_FLOAT_EQ(value(LOD_SUSPICION, 0, 0), 1.0f);
+    EXPECT_FLOAT_EQ(value(LOD_SUSPICION, LOD_HIST_BINS - 1, 0), 1.0f);
+    EXPECT_FLOAT_EQ(value(LOD_SUSPICION, 5, 0), 0.0f);
+    // No agents in gang 1: an empty row
+    for (int b = 0; b < LOD_HIST_BINS; b++) {
+        EXPECT_FLOAT_EQ(value(LOD_SUSPICION, b, 1), 0.0f);
+    }
+    // Dead member's knowledge is not counted
+    EXPECT_FLOAT_EQ(value(LOD_KNOWLEDGE, LOD_HIST_BINS / 2, 0), 1.0f);
+    EXPECT_FLOAT_EQ(value(LOD_KNOWLEDGE, 0, 0), 0.0f);
+
+    EXPECT_NEAR(value(LOD_DENSITY, 0, 0), 2.0f / 3.0f, 1e-6);
+    EXPECT_FLOAT_EQ(value(LOD_DENSITY, 1, 0), 0.0f);
+    EXPECT_NE(lod.images[LOD_DENSITY].pixels[0], lod.images[LOD_DENSITY].pixels[1]);
+}
+
+TEST(ViewerLod, LargeGamesShareRows) {
+    LodViews lod{};
+    ASSERT_EQ(lod_init(&lod, 3000, 10, 4), 0);
+    EXPECT_EQ(lod.gangs_per_row, 3);
+    EXPECT_EQ(lod.rows, 1000);
+    EXPECT_EQ(lod.images[LOD_HEAT].width, 4);
+    EXPECT_EQ(lod.images[LOD_DENSITY].width * lod.images[LOD_DENSITY].height >= 3000, true);
+    EXPECT_TRUE(lod_wanted(3000, 10));
+    EXPECT_FALSE(lod_wanted(20, 10));
+    lod_free(&lod);
+}